@@ -0,0 +1,63 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "atomic_file.h"
+
+#include <filesystem>
+#include <system_error>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+bool atomic_write_file(const std::string &path, const std::function<bool(const std::string &tempPath)> &write, std::string &error)
+{
+	std::string tempPath = path + ".tmp";
+	std::error_code ec;
+
+	// A leftover of a previous crash is simply overwritten
+	if (!write(tempPath))
+	{
+		error = "cannot write " + tempPath;
+		std::filesystem::remove(tempPath, ec);
+		return false;
+	}
+
+#if defined(_WIN32)
+	if (!MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+	{
+		error = "cannot replace " + path + " (error " + std::to_string(GetLastError()) + ")";
+		DeleteFileA(tempPath.c_str());
+		return false;
+	}
+#else
+	std::filesystem::rename(tempPath, path, ec);
+
+	if (ec)
+	{
+		error = "cannot replace " + path + " (" + ec.message() + ")";
+		std::filesystem::remove(tempPath, ec);
+		return false;
+	}
+#endif
+
+	return true;
+}
@@ -32,6 +32,8 @@ extern "C" {
 #endif
 
 #include <libvgmstream/util/log.h>
+#include <algorithm>
+#include <filesystem>
 
 #if defined(__cplusplus)
 }
@@ -133,7 +135,7 @@ bool NxAudioEngine::getFilenameFullPath(char *_out, const char* _key, NxAudioEng
 			break;
 		}
 
-		if (fileExists(_out)) {
+		if (_type == NxAudioEngineLayer::NXAUDIOENGINE_VOICE ? voiceFileExists(_out) : fileExists(_out)) {
 			return true;
 		}
 	}
@@ -151,6 +153,43 @@ bool NxAudioEngine::fileExists(const char* filename)
 	return ret;
 }
 
+bool NxAudioEngine::voiceFileExists(const char* filename)
+{
+	std::filesystem::path path(filename);
+	std::string directory = path.parent_path().string(), name = path.filename().string();
+
+	std::transform(directory.begin(), directory.end(), directory.begin(), ::tolower);
+	std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+	auto it = _voiceDirectoryIndex.find(directory);
+
+	// Every line probes several name patterns and extensions, list each voice directory once instead
+	if (it == _voiceDirectoryIndex.end())
+	{
+		std::unordered_set<std::string> files;
+		std::error_code ec;
+
+		for (const auto& entry : std::filesystem::directory_iterator(path.parent_path(), ec))
+		{
+			std::string file = entry.path().filename().string();
+
+			std::transform(file.begin(), file.end(), file.begin(), ::tolower);
+			files.insert(file);
+		}
+
+		if (trace_all || trace_voice) ffnx_trace("NxAudioEngine::%s: indexed %s (%u files)\n", __func__, directory.c_str(), files.size());
+
+		it = _voiceDirectoryIndex.emplace(directory, std::move(files)).first;
+	}
+
+	bool ret = it->second.contains(name);
+
+	if (!ret && (trace_all || trace_voice))
+		ffnx_warning("NxAudioEngine::%s: Could not find file %s\n", __func__, filename);
+
+	return ret;
+}
+
 // PUBLIC
 
 bool NxAudioEngine::init()
@@ -219,11 +258,39 @@ void NxAudioEngine::flush()
 
 void NxAudioEngine::cleanup()
 {
+	_sfxCache.stop();
+	_voicePrefetch.stop();
+
 	_engine.deinit();
 }
 
+unsigned int NxAudioEngine::getActiveVoiceCount()
+{
+	return _engineInitialized ? _engine.getActiveVoiceCount() : 0;
+}
+
+unsigned int NxAudioEngine::getVoiceStartLatency()
+{
+	if (_voiceStartProbe && _voiceStartProbe->latency() >= 0)
+	{
+		_voiceStartLatency = (unsigned int)_voiceStartProbe->latency();
+		_voiceStartProbe.reset();
+	}
+
+	return _voiceStartLatency;
+}
+
 // SFX
-SoLoud::VGMStream* NxAudioEngine::loadSFX(std::string id, bool loop)
+SoLoud::AudioSource* NxAudioEngine::loadCachedSFX(const char* filename, bool loop)
+{
+	std::shared_ptr<const SoLoud::PcmBuffer> buffer = _sfxCache.find(std::string(filename) + (loop ? "|loop" : ""));
+
+	if (!buffer) return nullptr;
+
+	return new SoLoud::PcmStream(buffer);
+}
+
+SoLoud::AudioSource* NxAudioEngine::loadSFX(std::string id, bool loop)
 {
 	if (_engineInitialized)
 	{
@@ -245,6 +312,10 @@ SoLoud::VGMStream* NxAudioEngine::loadSFX(std::string id, bool loop)
 
 			if (trace_all || trace_sfx) ffnx_trace("NxAudioEngine::%s: filename=%s,loop=%d\n", __func__, filename, loop);
 
+			SoLoud::AudioSource* cached = loadCachedSFX(filename, loop);
+
+			if (cached != nullptr) return cached;
+
 			SoLoud::VGMStream* sfx = new SoLoud::VGMStream();
 
 			sfx->setLooping(loop);
@@ -256,6 +327,25 @@ SoLoud::VGMStream* NxAudioEngine::loadSFX(std::string id, bool loop)
 				return nullptr;
 			}
 
+			// Decode short effects once in the background, plays stream from the file until the buffer is ready
+			if (sfx->getLength() <= NXAUDIOENGINE_SFX_CACHE_MAX_LENGTH)
+			{
+				std::string path(filename);
+
+				bool queued = _sfxCache.request(path + (loop ? "|loop" : ""), [path, loop]() -> std::shared_ptr<const SoLoud::PcmBuffer> {
+					SoLoud::VGMStream stream;
+					std::shared_ptr<SoLoud::PcmBuffer> buffer = std::make_shared<SoLoud::PcmBuffer>();
+
+					stream.setLooping(loop);
+
+					if (stream.load(path.c_str()) != SoLoud::SO_NO_ERROR || stream.decode(*buffer) != SoLoud::SO_NO_ERROR || buffer->mSampleCount == 0) return nullptr;
+
+					return buffer;
+				});
+
+				if (queued && (trace_all || trace_sfx)) ffnx_trace("NxAudioEngine::%s: decode %s in the background\n", __func__, filename);
+			}
+
 			return sfx;
 		}
 	}
@@ -1089,8 +1179,34 @@ bool NxAudioEngine::canPlayVoice(const char* name)
 	return getFilenameFullPath(filename, name, NxAudioEngineLayer::NXAUDIOENGINE_VOICE);
 }
 
+void NxAudioEngine::prefetchVoice(const char* name)
+{
+	char filename[MAX_PATH];
+
+	if (!_engineInitialized || !getFilenameFullPath(filename, name, NxAudioEngineLayer::NXAUDIOENGINE_VOICE)) return;
+
+	std::string path(filename);
+
+	// Only the page coming next matters, a line still queued for a page already skipped is dropped
+	_voicePrefetch.cancel();
+
+	bool queued = _voicePrefetch.request(path, [path]() -> std::shared_ptr<const SoLoud::PcmBuffer> {
+		SoLoud::VGMStream stream;
+		std::shared_ptr<SoLoud::PcmBuffer> buffer = std::make_shared<SoLoud::PcmBuffer>();
+
+		if (stream.load(path.c_str()) != SoLoud::SO_NO_ERROR || stream.getLength() > NXAUDIOENGINE_SFX_CACHE_MAX_LENGTH) return nullptr;
+
+		if (stream.decode(*buffer) != SoLoud::SO_NO_ERROR || buffer->mSampleCount == 0) return nullptr;
+
+		return buffer;
+	});
+
+	if (queued && (trace_all || trace_voice)) ffnx_trace("NxAudioEngine::%s: decode %s in the background\n", __func__, filename);
+}
+
 bool NxAudioEngine::playVoice(const char* name, int slot, float volume, int game_moment)
 {
+	std::shared_ptr<SoLoud::StartProbe> probe = std::make_shared<SoLoud::StartProbe>();
 	char filename[MAX_PATH];
 
 	bool exists = false;
@@ -1170,17 +1286,40 @@ bool NxAudioEngine::playVoice(const char* name, int slot, float volume, int game
 			_currentVoice[slot].handle = NXAUDIOENGINE_INVALID_HANDLE;
 		}
 
-		_currentVoice[slot].stream = new SoLoud::VGMStream();
+		// Never wait for a decode still in flight, the line is then streamed from the file
+		std::shared_ptr<const SoLoud::PcmBuffer> prefetched = _voicePrefetch.find(filename);
 
-		SoLoud::result res = _currentVoice[slot].stream->load(filename);
-		if (res != SoLoud::SO_NO_ERROR) {
-			ffnx_error("NxAudioEngine::%s: Cannot load %s with vgmstream ( SoLoud error: %u )\n", __func__, filename, res);
-			delete _currentVoice[slot].stream;
-			return false;
+		if (trace_all || trace_voice) ffnx_trace("NxAudioEngine::%s: slot[%d] %s prefetched=%d\n", __func__, slot, filename, prefetched != nullptr);
+
+		if (prefetched)
+		{
+			SoLoud::PcmStream* voice = new SoLoud::PcmStream(prefetched);
+
+			voice->mStartProbe = probe;
+
+			_currentVoice[slot].stream = voice;
+		}
+		else
+		{
+			SoLoud::VGMStream* voice = new SoLoud::VGMStream();
+
+			SoLoud::result res = voice->load(filename);
+			if (res != SoLoud::SO_NO_ERROR) {
+				ffnx_error("NxAudioEngine::%s: Cannot load %s with vgmstream ( SoLoud error: %u )\n", __func__, filename, res);
+				delete voice;
+				return false;
+			}
+
+			voice->mStartProbe = probe;
+
+			_currentVoice[slot].stream = voice;
 		}
 
 		_currentVoice[slot].handle = _engine.play(*_currentVoice[slot].stream, _currentVoice[slot].volume);
 
+		// Read back by getVoiceStartLatency once the mixer reached the first samples
+		_voiceStartProbe = probe;
+
 		return _engine.isValidVoiceHandle(_currentVoice[slot].handle);
 	}
 	else
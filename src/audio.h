@@ -21,17 +21,27 @@
 
 #pragma once
 
+#include <memory>
 #include <stack>
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <soloud.h>
 #include "audio/memorystream/memorystream.h"
+#include "audio/pcmstream/pcmcache.h"
+#include "audio/pcmstream/pcmstream.h"
 #include "audio/vgmstream/vgmstream.h"
 
 #include "log.h"
 
 #define NXAUDIOENGINE_INVALID_HANDLE 0xfffff000
+// Decoded SFX kept in memory, in bytes
+#define NXAUDIOENGINE_SFX_CACHE_BUDGET (64 * 1024 * 1024)
+// Longer SFX are streamed from the file instead, in seconds
+#define NXAUDIOENGINE_SFX_CACHE_MAX_LENGTH 30.0
+// Decoded voice lines of the upcoming dialog pages kept in memory, in bytes
+#define NXAUDIOENGINE_VOICE_PREFETCH_BUDGET (32 * 1024 * 1024)
 
 static void NxAudioEngineVgmstreamCallback(int level, const char* str)
 {
@@ -74,7 +84,7 @@ public:
 		{}
 		int game_id;
 		int id;
-		SoLoud::VGMStream *stream;
+		SoLoud::AudioSource *stream;
 		SoLoud::handle handle;
 		float volume;
 		bool loop;
@@ -115,7 +125,7 @@ public:
 			stream(nullptr),
 			volume(1.0f) {}
 		SoLoud::handle handle;
-		SoLoud::VGMStream* stream;
+		SoLoud::AudioSource* stream;
 		float volume;
 	};
 
@@ -174,10 +184,13 @@ private:
 	float _sfxMasterVolume = -1.0f;
 	std::map<int, NxAudioEngineSFX> _sfxChannels;
 	std::map<std::string, int> _sfxSequentialIndexes;
-	std::map<int, SoLoud::VGMStream*> _sfxEffectsHandler;
+	std::map<int, SoLoud::AudioSource*> _sfxEffectsHandler;
 	std::vector<short> _sfxLazyUnloadChannels;
+	// Short effects decoded once in the background, shared by every play
+	SoLoud::PcmCache _sfxCache{ NXAUDIOENGINE_SFX_CACHE_BUDGET };
 
-	SoLoud::VGMStream* loadSFX(std::string id, bool loop = false);
+	SoLoud::AudioSource* loadSFX(std::string id, bool loop = false);
+	SoLoud::AudioSource* loadCachedSFX(const char* filename, bool loop);
 	void unloadSFXChannel(int channel);
 
 	// MUSIC
@@ -202,6 +215,12 @@ private:
 	float _voiceMasterVolume = -1.0f;
 	std::map<int, NxAudioEngineVoice> _currentVoice;
 	std::map<std::string, int> _voiceSequentialIndexes;
+	// Next dialog page lines, decoded one at a time on a worker, a new page replaces the queued one
+	SoLoud::PcmCache _voicePrefetch{ NXAUDIOENGINE_VOICE_PREFETCH_BUDGET };
+	// Marked by the mixer when it reads the first samples of the last played voice
+	std::shared_ptr<SoLoud::StartProbe> _voiceStartProbe;
+	// Time between the last playVoice call and its first mixed sample, in microseconds
+	unsigned int _voiceStartLatency = 0;
 
 	// AMBIENT
 	float _ambientMasterVolume = -1.0f;
@@ -223,6 +242,11 @@ private:
 
 	bool fileExists(const char* filename);
 
+	// Directory listings of the voice path, lowercase file names by lowercase directory
+	std::unordered_map<std::string, std::unordered_set<std::string>> _voiceDirectoryIndex;
+
+	bool voiceFileExists(const char* filename);
+
 	// CFG
 	std::unordered_map<NxAudioEngineLayer,toml::parse_result> nxAudioEngineConfig;
 
@@ -234,6 +258,9 @@ public:
 	void flush();
 	void cleanup();
 
+	unsigned int getActiveVoiceCount();
+	unsigned int getVoiceStartLatency();
+
 	// SFX
 	int getSFXIdFromChannel(int channel);
 	void unloadSFX(int id);
@@ -278,6 +305,7 @@ public:
 
 	// Voice
 	bool canPlayVoice(const char* name);
+	void prefetchVoice(const char* name);
 	bool playVoice(const char* name, int slot = 0, float volume = 1.0f, int game_moment = -1);
 	void stopVoice(int slot = 0, double time = 0);
 	void pauseVoice(int slot = 0, double time = 0);
@@ -0,0 +1,63 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+
+#include "pcmbuffer.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace SoLoud
+{
+	unsigned int PcmBuffer::read(unsigned int& aOffset, bool aLooping, float* aBuffer, unsigned int aSamplesToRead) const
+	{
+		bool looping = canLoop(aLooping);
+		unsigned int end = looping ? mLoopEndSample : mSampleCount;
+		unsigned int written = 0;
+
+		while (written < aSamplesToRead)
+		{
+			if (aOffset >= end)
+			{
+				if (!looping) break;
+
+				aOffset = mLoopStartSample;
+			}
+
+			unsigned int count = std::min(aSamplesToRead - written, end - aOffset);
+
+			for (unsigned int k = 0; k < mChannels; k++)
+			{
+				memcpy(aBuffer + k * aSamplesToRead + written, mData.data() + k * mSampleCount + aOffset, count * sizeof(float));
+			}
+
+			written += count;
+			aOffset += count;
+		}
+
+		return written;
+	}
+
+	bool PcmBuffer::hasEnded(unsigned int aOffset, bool aLooping) const
+	{
+		return !canLoop(aLooping) && aOffset >= mSampleCount;
+	}
+};
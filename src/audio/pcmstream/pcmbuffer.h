@@ -0,0 +1,48 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+namespace SoLoud
+{
+	// Fully decoded audio, one plane of samples per channel
+	struct PcmBuffer
+	{
+		std::vector<float> mData;
+		float mSamplerate = 0.0f;
+		unsigned int mChannels = 0;
+		unsigned int mSampleCount = 0;
+		unsigned int mLoopStartSample = 0;
+		unsigned int mLoopEndSample = 0;
+		bool mLooping = false;
+
+		size_t size() const { return mData.size() * sizeof(float); }
+		// A loop needs a loop end after its start, otherwise the buffer plays once
+		bool canLoop(bool aLooping) const { return aLooping && mLoopEndSample > mLoopStartSample; }
+		// Copies up to aSamplesToRead samples per channel from aOffset into planes of aSamplesToRead samples, wrapping at the loop end
+		unsigned int read(unsigned int& aOffset, bool aLooping, float* aBuffer, unsigned int aSamplesToRead) const;
+		bool hasEnded(unsigned int aOffset, bool aLooping) const;
+	};
+};
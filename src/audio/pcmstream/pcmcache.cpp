@@ -0,0 +1,194 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+
+#include "pcmcache.h"
+
+namespace SoLoud
+{
+	PcmCache::PcmCache(size_t aBudget) : mBudget(aBudget)
+	{
+	}
+
+	PcmCache::~PcmCache()
+	{
+		stop();
+	}
+
+	std::shared_ptr<const PcmBuffer> PcmCache::find(const std::string& aKey)
+	{
+		collect();
+
+		auto it = mEntries.find(aKey);
+
+		if (it == mEntries.end()) return nullptr;
+
+		it->second.lastUsed = ++mTick;
+
+		return it->second.buffer;
+	}
+
+	bool PcmCache::request(const std::string& aKey, Decoder aDecoder)
+	{
+		collect();
+
+		if (mEntries.count(aKey) || mFailed.count(aKey)) return false;
+
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		if (mRunning == aKey) return false;
+
+		for (const Job& job : mJobs)
+		{
+			if (job.key == aKey) return false;
+		}
+
+		mJobs.push_back(Job{ aKey, aDecoder });
+
+		if (!mThread.joinable())
+		{
+			mStopping = false;
+			mThread = std::thread(&PcmCache::run, this);
+		}
+
+		mWakeUp.notify_one();
+
+		return true;
+	}
+
+	void PcmCache::cancel()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		mJobs.clear();
+	}
+
+	void PcmCache::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			mJobs.clear();
+			mStopping = true;
+		}
+
+		mWakeUp.notify_one();
+
+		if (mThread.joinable()) mThread.join();
+	}
+
+	void PcmCache::clear()
+	{
+		stop();
+
+		mDone.clear();
+		mEntries.clear();
+		mFailed.clear();
+		mSize = 0;
+	}
+
+	bool PcmCache::isPending(const std::string& aKey)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		if (mRunning == aKey) return true;
+
+		for (const Job& job : mJobs)
+		{
+			if (job.key == aKey) return true;
+		}
+
+		for (const auto& done : mDone)
+		{
+			if (done.first == aKey) return true;
+		}
+
+		return false;
+	}
+
+	void PcmCache::collect()
+	{
+		std::deque<std::pair<std::string, std::shared_ptr<const PcmBuffer>>> done;
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+
+			if (mDone.empty()) return;
+
+			done.swap(mDone);
+		}
+
+		for (auto& result : done)
+		{
+			if (result.second) insert(result.first, result.second);
+			else mFailed.insert(result.first);
+		}
+	}
+
+	void PcmCache::insert(const std::string& aKey, std::shared_ptr<const PcmBuffer> aBuffer)
+	{
+		auto it = mEntries.find(aKey);
+
+		if (it != mEntries.end()) mSize -= it->second.buffer->size();
+
+		mEntries[aKey] = Entry{ aBuffer, ++mTick };
+		mSize += aBuffer->size();
+
+		// Evict least recently used entries, streams still playing keep their own reference
+		while (mSize > mBudget && mEntries.size() > 1)
+		{
+			auto oldest = mEntries.end();
+
+			for (auto it = mEntries.begin(); it != mEntries.end(); ++it)
+			{
+				if (it->first != aKey && (oldest == mEntries.end() || it->second.lastUsed < oldest->second.lastUsed)) oldest = it;
+			}
+
+			mSize -= oldest->second.buffer->size();
+			mEntries.erase(oldest);
+		}
+	}
+
+	void PcmCache::run()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		while (true)
+		{
+			mWakeUp.wait(lock, [this] { return mStopping || !mJobs.empty(); });
+
+			if (mStopping) break;
+
+			Job job = std::move(mJobs.front());
+			mJobs.pop_front();
+			mRunning = job.key;
+
+			lock.unlock();
+
+			std::shared_ptr<const PcmBuffer> buffer = job.decoder();
+
+			lock.lock();
+
+			mRunning.clear();
+			mDone.emplace_back(job.key, buffer);
+		}
+	}
+};
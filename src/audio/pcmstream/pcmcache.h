@@ -0,0 +1,95 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include "pcmbuffer.h"
+
+namespace SoLoud
+{
+	// Decoded audio by key, kept under a size budget by evicting the least recently used entries.
+	// Decodes run in order on one worker thread, the game thread only queues them and picks their result.
+	class PcmCache
+	{
+	public:
+		// Runs on the worker, returns nullptr when the audio cannot be decoded
+		typedef std::function<std::shared_ptr<const PcmBuffer>()> Decoder;
+
+		PcmCache(size_t aBudget);
+		~PcmCache();
+
+		// Decoded buffer, or nullptr when it is not decoded yet
+		std::shared_ptr<const PcmBuffer> find(const std::string& aKey);
+		// Queues a decode unless the key is already cached, queued or failed
+		bool request(const std::string& aKey, Decoder aDecoder);
+		// Drops the queued decodes, the one in progress still completes
+		void cancel();
+		// Waits for the decode in progress and stops the worker, the next request starts it again
+		void stop();
+		void clear();
+
+		size_t size() const { return mSize; }
+		size_t count() const { return mEntries.size(); }
+		bool isPending(const std::string& aKey);
+	private:
+		struct Entry
+		{
+			std::shared_ptr<const PcmBuffer> buffer;
+			unsigned int lastUsed;
+		};
+
+		struct Job
+		{
+			std::string key;
+			Decoder decoder;
+		};
+
+		// Owned by the game thread
+		std::unordered_map<std::string, Entry> mEntries;
+		std::unordered_set<std::string> mFailed;
+		size_t mBudget;
+		size_t mSize = 0;
+		unsigned int mTick = 0;
+
+		// Shared with the worker
+		std::mutex mMutex;
+		std::condition_variable mWakeUp;
+		std::deque<Job> mJobs;
+		std::string mRunning;
+		std::deque<std::pair<std::string, std::shared_ptr<const PcmBuffer>>> mDone;
+		bool mStopping = false;
+		std::thread mThread;
+
+		void collect();
+		void insert(const std::string& aKey, std::shared_ptr<const PcmBuffer> aBuffer);
+		void run();
+	};
+};
@@ -0,0 +1,90 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+
+#include "pcmstream.h"
+
+#include <algorithm>
+
+namespace SoLoud
+{
+	PcmStreamInstance::PcmStreamInstance(PcmStream* aParent)
+	{
+		mParent = aParent;
+
+		rewind();
+	}
+
+	unsigned int PcmStreamInstance::getAudio(float* aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize)
+	{
+		unsigned int ret = mParent->mBuffer->read(mOffset, (mFlags & AudioSourceInstance::LOOPING) != 0, aBuffer, aSamplesToRead);
+
+		if (mParent->mStartProbe) mParent->mStartProbe->mark();
+
+		return ret;
+	}
+
+	result PcmStreamInstance::rewind()
+	{
+		mOffset = 0;
+		mStreamPosition = 0.0f;
+		return SO_NO_ERROR;
+	}
+
+	result PcmStreamInstance::seek(double aSeconds, float* mScratch, unsigned int mScratchSize)
+	{
+		mOffset = std::min((unsigned int)floor(mSamplerate * aSeconds), mParent->mBuffer->mSampleCount);
+
+		mStreamPosition = aSeconds;
+		return SO_NO_ERROR;
+	}
+
+	bool PcmStreamInstance::hasEnded()
+	{
+		return mParent->mBuffer->hasEnded(mOffset, (mFlags & AudioSourceInstance::LOOPING) != 0);
+	}
+
+	PcmStream::PcmStream(std::shared_ptr<const PcmBuffer> aBuffer) : mBuffer(aBuffer)
+	{
+		mBaseSamplerate = mBuffer->mSamplerate;
+		mChannels = mBuffer->mChannels;
+
+		if (mBuffer->mLooping) setLooping(true);
+	}
+
+	PcmStream::~PcmStream()
+	{
+		stop();
+	}
+
+	AudioSourceInstance* PcmStream::createInstance()
+	{
+		return new PcmStreamInstance(this);
+	}
+
+	double PcmStream::getLength()
+	{
+		if (mBaseSamplerate == 0)
+			return 0;
+
+		return mBuffer->mSampleCount / mBaseSamplerate;
+	}
+};
@@ -0,0 +1,58 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <soloud.h>
+#include "pcmbuffer.h"
+#include "startprobe.h"
+
+namespace SoLoud
+{
+	class PcmStream : public AudioSource
+	{
+	public:
+		std::shared_ptr<const PcmBuffer> mBuffer;
+		// Optional, marked when the mixer first reads from this source
+		std::shared_ptr<StartProbe> mStartProbe;
+
+		PcmStream(std::shared_ptr<const PcmBuffer> aBuffer);
+		virtual ~PcmStream();
+
+		virtual AudioSourceInstance* createInstance();
+		time getLength();
+	};
+
+	class PcmStreamInstance : public AudioSourceInstance
+	{
+		PcmStream* mParent;
+		unsigned int mOffset;
+	public:
+		PcmStreamInstance(PcmStream* aParent);
+		virtual unsigned int getAudio(float* aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize);
+		virtual result rewind();
+		virtual result seek(double aSeconds, float *mScratch, unsigned int mScratchSize);
+		virtual bool hasEnded();
+	};
+};
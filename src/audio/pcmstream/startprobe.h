@@ -0,0 +1,51 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+namespace SoLoud
+{
+	// Time between the creation of the probe and the first samples the mixer reads from the source holding it
+	class StartProbe
+	{
+	public:
+		StartProbe() : mStart(std::chrono::steady_clock::now()) {}
+
+		// Called by the mixer on every read, only the first one is kept
+		void mark()
+		{
+			if (mLatency.load(std::memory_order_relaxed) >= 0) return;
+
+			long long expected = -1;
+			mLatency.compare_exchange_strong(expected, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - mStart).count());
+		}
+
+		// In microseconds, -1 while nothing was read yet
+		long long latency() const { return mLatency.load(std::memory_order_relaxed); }
+	private:
+		std::chrono::steady_clock::time_point mStart;
+		std::atomic<long long> mLatency = -1;
+	};
+};
@@ -22,8 +22,54 @@
 #include "vgmstream.h"
 #include "../../utils.h"
 
+#include <algorithm>
+#include <emmintrin.h>
+
 namespace SoLoud
 {
+	// Convert interleaved 16-bit frames to planar float, channel k is written at aDst + k * aDstStride
+	static void deinterleave(const sample_t* aSrc, float* aDst, unsigned int aSampleCount, unsigned int aChannels, unsigned int aDstStride)
+	{
+		const __m128 scale = _mm_set1_ps((float)INT16_MAX);
+		unsigned int j = 0;
+
+		if (aChannels == 1)
+		{
+			for (; j + 8 <= aSampleCount; j += 8)
+			{
+				__m128i v = _mm_loadu_si128((const __m128i*)(aSrc + j));
+				__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+				__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+
+				_mm_storeu_ps(aDst + j, _mm_div_ps(_mm_cvtepi32_ps(lo), scale));
+				_mm_storeu_ps(aDst + j + 4, _mm_div_ps(_mm_cvtepi32_ps(hi), scale));
+			}
+		}
+		else if (aChannels == 2)
+		{
+			float* left = aDst;
+			float* right = aDst + aDstStride;
+
+			for (; j + 4 <= aSampleCount; j += 4)
+			{
+				__m128i v = _mm_loadu_si128((const __m128i*)(aSrc + j * 2));
+				__m128i l = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+				__m128i r = _mm_srai_epi32(v, 16);
+
+				_mm_storeu_ps(left + j, _mm_div_ps(_mm_cvtepi32_ps(l), scale));
+				_mm_storeu_ps(right + j, _mm_div_ps(_mm_cvtepi32_ps(r), scale));
+			}
+		}
+
+		for (; j < aSampleCount; j++)
+		{
+			for (unsigned int k = 0; k < aChannels; k++)
+			{
+				aDst[k * aDstStride + j] = aSrc[(j * aChannels) + k] / (float)INT16_MAX;
+			}
+		}
+	}
+
 	VGMStreamInstance::VGMStreamInstance(VGMStream* aParent)
 	{
 		mParent = aParent;
@@ -39,16 +85,11 @@ namespace SoLoud
 
 	unsigned int VGMStreamInstance::getAudio(float* aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize)
 	{
-		memset(mStreamBuffer, 0, sizeof(sample_t) * SAMPLE_GRANULARITY * mChannels);
 		int sample_count = render_vgmstream2(mStreamBuffer, aSamplesToRead, mParent->mStream);
 
-		for (int j = 0; j < sample_count; j++)
-		{
-			for (unsigned int k = 0; k < mChannels; k++)
-			{
-				aBuffer[k * aSamplesToRead + j] = mStreamBuffer[(j * mChannels) + k] / (float)INT16_MAX;
-			}
-		}
+		if (sample_count > 0) deinterleave(mStreamBuffer, aBuffer, sample_count, mChannels, aSamplesToRead);
+
+		if (mParent->mStartProbe) mParent->mStartProbe->mark();
 
 		mOffset += sample_count;
 
@@ -150,6 +191,58 @@ namespace SoLoud
 		return SO_NO_ERROR;
 	}
 
+	result VGMStream::decode(PcmBuffer& aBuffer)
+	{
+		if (mStream == nullptr)
+			return INVALID_PARAMETER;
+
+		bool looping = mFlags & AudioSource::SHOULD_LOOP;
+		unsigned int sampleCount = looping ? mLoopEndSample : mSampleCount;
+		sample_t* streamBuffer = new sample_t[SAMPLE_GRANULARITY * mChannels];
+
+		aBuffer.mData.resize(size_t(sampleCount) * mChannels);
+		aBuffer.mSamplerate = mBaseSamplerate;
+		aBuffer.mChannels = mChannels;
+		aBuffer.mLooping = looping;
+		aBuffer.mLoopStartSample = looping ? mStream->loop_start_sample : 0;
+		aBuffer.mLoopEndSample = mLoopEndSample;
+
+		reset_vgmstream(mStream);
+
+		unsigned int offset = 0;
+
+		while (offset < sampleCount)
+		{
+			int sample_count = render_vgmstream2(streamBuffer, std::min(sampleCount - offset, (unsigned int)SAMPLE_GRANULARITY), mStream);
+
+			if (sample_count <= 0) break;
+
+			deinterleave(streamBuffer, aBuffer.mData.data() + offset, sample_count, mChannels, sampleCount);
+
+			offset += sample_count;
+		}
+
+		delete[] streamBuffer;
+
+		// Shorter than announced, keep the planes contiguous
+		if (offset < sampleCount)
+		{
+			for (unsigned int k = 1; k < mChannels; k++)
+			{
+				memmove(aBuffer.mData.data() + k * offset, aBuffer.mData.data() + k * sampleCount, offset * sizeof(float));
+			}
+
+			aBuffer.mData.resize(size_t(offset) * mChannels);
+			aBuffer.mLoopEndSample = std::min(aBuffer.mLoopEndSample, offset);
+		}
+
+		aBuffer.mSampleCount = offset;
+
+		reset_vgmstream(mStream);
+
+		return SO_NO_ERROR;
+	}
+
 	AudioSourceInstance* VGMStream::createInstance()
 	{
 		return new VGMStreamInstance(this);
@@ -22,6 +22,7 @@
 #pragma once
 
 #include <soloud.h>
+#include "../pcmstream/pcmstream.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -44,10 +45,14 @@ namespace SoLoud
 		unsigned int mLoopEndSample;
 
 		sample_t* mData;
+		// Optional, marked when the mixer first reads from this source
+		std::shared_ptr<StartProbe> mStartProbe;
 
 		VGMStream();
 		virtual ~VGMStream();
 		result load(const char* aFilename, const char* ext = nullptr);
+		// Decode the whole stream (up to the loop end when looping) into aBuffer
+		result decode(PcmBuffer& aBuffer);
 
 		virtual AudioSourceInstance* createInstance();
 		time getLength();
@@ -80,6 +80,9 @@ bool trace_battle_animation;
 bool trace_battle_text;
 bool vertex_log;
 bool uniform_log;
+std::string draw_capture_path;
+uint32_t draw_capture_frames;
+int32_t draw_capture_start_frame;
 bool show_renderer_backend;
 bool show_fps;
 bool show_stats;
@@ -115,6 +118,7 @@ bool create_crash_dump;
 std::string steam_game_userdata;
 std::string hext_patching_path;
 std::string override_path;
+bool override_path_watch;
 std::string override_mod_path;
 std::string direct_mode_path;
 std::string save_path;
@@ -249,6 +253,9 @@ void read_cfg()
 	trace_battle_text = config["trace_battle_text"].value_or(false);
 	vertex_log = config["vertex_log"].value_or(false);
 	uniform_log = config["uniform_log"].value_or(false);
+	draw_capture_path = config["draw_capture_path"].value_or("");
+	draw_capture_frames = config["draw_capture_frames"].value_or(60);
+	draw_capture_start_frame = config["draw_capture_start_frame"].value_or(0);
 	show_renderer_backend = config["show_renderer_backend"].value_or(true);
 	show_fps = config["show_fps"].value_or(false);
 	show_stats = config["show_stats"].value_or(false);
@@ -284,6 +291,7 @@ void read_cfg()
 	steam_game_userdata = config["steam_game_userdata"].value_or("");
 	hext_patching_path = config["hext_patching_path"].value_or("");
 	override_path = config["override_path"].value_or("");
+	override_path_watch = config["override_path_watch"].value_or(false);
 	override_mod_path = config["override_mod_path"].value_or("");
 	direct_mode_path = config["direct_mode_path"].value_or("");
 	save_path = config["save_path"].value_or("");
@@ -102,6 +102,9 @@ extern bool trace_battle_animation;
 extern bool trace_battle_text;
 extern bool vertex_log;
 extern bool uniform_log;
+extern std::string draw_capture_path;
+extern uint32_t draw_capture_frames;
+extern int32_t draw_capture_start_frame;
 extern bool show_renderer_backend;
 extern bool show_fps;
 extern bool show_stats;
@@ -137,6 +140,7 @@ extern bool create_crash_dump;
 extern std::string steam_game_userdata;
 extern std::string hext_patching_path;
 extern std::string override_path;
+extern bool override_path_watch;
 extern std::string override_mod_path;
 extern std::string direct_mode_path;
 extern std::string save_path;
@@ -0,0 +1,142 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// Collects values by key on a worker thread and hands them over in one batch once no new value came for a while.
+// A newer value for a key replaces the pending one. After stop() values are flushed right away on the caller thread.
+template<typename Key, typename Value>
+class CoalescingQueue
+{
+public:
+	typedef std::map<Key, Value> Batch;
+	typedef std::function<void(const Batch &batch)> Flush;
+
+	// The wait restarts on every push, but a batch never waits longer than maxDelay
+	CoalescingQueue(std::chrono::milliseconds delay, std::chrono::milliseconds maxDelay, Flush flush) :
+		delay(delay), maxDelay(maxDelay), flush(flush)
+	{
+	}
+
+	~CoalescingQueue()
+	{
+		// The process exited without stop(), the thread is already gone
+		if (worker.joinable()) worker.detach();
+	}
+
+	void push(const Key &key, Value value)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+		if (pending.empty()) firstPush = now;
+
+		pending[key] = value;
+		lastPush = now;
+
+		if (stopping)
+		{
+			lock.unlock();
+			flushPending();
+			return;
+		}
+
+		if (!worker.joinable()) worker = std::thread(&CoalescingQueue::run, this);
+
+		wakeUp.notify_one();
+	}
+
+	// Flushes what is pending and joins the worker
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			stopping = true;
+			wakeUp.notify_one();
+		}
+
+		if (worker.joinable()) worker.join();
+
+		flushPending();
+	}
+
+private:
+	std::chrono::milliseconds delay, maxDelay;
+	Flush flush;
+
+	std::thread worker;
+	std::mutex mutex;
+	// Held while flushing, so the worker and a push after stop() never flush at the same time
+	std::mutex flushMutex;
+	std::condition_variable wakeUp;
+	Batch pending;
+	std::chrono::steady_clock::time_point firstPush, lastPush;
+	bool stopping = false;
+
+	void flushPending()
+	{
+		std::lock_guard<std::mutex> flushLock(flushMutex);
+		Batch batch;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			batch.swap(pending);
+		}
+
+		if (!batch.empty()) flush(batch);
+	}
+
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (true)
+		{
+			wakeUp.wait(lock, [this] { return stopping || !pending.empty(); });
+
+			if (stopping) break;
+
+			// Wait until no push came for the delay
+			std::chrono::steady_clock::time_point deadline;
+
+			while (!stopping && std::chrono::steady_clock::now() < (deadline = std::min(lastPush + delay, firstPush + maxDelay)))
+			{
+				wakeUp.wait_until(lock, deadline);
+			}
+
+			lock.unlock();
+
+			flushPending();
+
+			lock.lock();
+		}
+	}
+};
@@ -29,6 +29,7 @@
 #include <steamworkssdk/steam_api.h>
 #include <hwinfo/hwinfo.h>
 #include <regex>
+#include <algorithm>
 #include <shlwapi.h>
 #include <shlobj.h>
 #include <psapi.h>
@@ -62,6 +63,9 @@
 #include "audio.h"
 #include "voice.h"
 #include "metadata.h"
+#include "draw_capture.h"
+#include "redirect.h"
+#include "frame_pacer.h"
 #include "lighting.h"
 #include "achievement.h"
 #include "game_cfg.h"
@@ -73,6 +77,7 @@
 #include "ff7/time.h"
 #include "ff7/field/defs.h"
 #include "ff7/field/model.h"
+#include "ff7/battle/defs.h"
 
 #include "ff8/vram.h"
 #include "ff8/vibration.h"
@@ -218,6 +223,8 @@ uint32_t noop_a3(uint32_t a1, uint32_t a2, uint32_t a3) { return 0; }
 time_t profile_start;
 time_t profile_end;
 time_t profile_total;
+time_t profile_ibl_load;
+time_t profile_magic_load;
 #endif PROFILE
 
 // support code for the HEAP_DEBUG option
@@ -664,6 +671,9 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 			{
 				switch (LOWORD(wParam))
 				{
+				case VK_F10:
+					drawCapture.toggle();
+					break;
 				case VK_F11:
 					newRenderer.toggleCaptureFrame();
 					break;
@@ -1114,6 +1124,8 @@ uint32_t common_init(struct game_obj *game_object)
 	nxAudioEngine.setAmbientMasterVolume(external_ambient_volume / 100.0f);
 	nxAudioEngine.setVoiceMasterVolume(external_voice_volume / 100.0f);
 
+	drawCapture.init();
+
 	proxyWndProc = true;
 
 	return true;
@@ -1148,8 +1160,14 @@ void common_cleanup(struct game_obj *game_object)
 	if(enable_steam_achievements)
 		SteamAPI_Shutdown();
 
+	// Write pending save metadata
+	if (steam_edition) metadataPatcher.shutdown();
+
+	close_override_files_watch();
+	if (!ff8) ff7_multibyte_tuning_shutdown();
 	nxAudioEngine.cleanup();
 	newRenderer.shutdown();
+	qpc_wait_frame_cleanup();
 }
 
 // unused and unnecessary
@@ -1183,9 +1201,18 @@ void common_flip(struct game_obj *game_object)
 	// Update RAM usage info
 	GlobalMemoryStatusEx(&last_ram_state);
 
+	stats.audio_voices = nxAudioEngine.getActiveVoiceCount();
+	stats.voice_start_latency = nxAudioEngine.getVoiceStartLatency();
+
 	// Draw with lighting
 	if (!ff8 && enable_lighting) lighting.draw(game_object);
 
+	// Warm up the files of the next battle effect while the action is announced
+	if (!ff8 && mode->driver_mode == MODE_BATTLE) ff7::battle::magic_prefetch_update();
+
+	// Apply multibyte font tuning reloaded by the watcher between frames
+	if (!ff8) ff7_multibyte_tuning_flip();
+
 	// draw any z-sorted content now that we're done drawing everything else
 	gl_draw_sorted_deferred();
 
@@ -1221,15 +1248,29 @@ void common_flip(struct game_obj *game_object)
 #endif
 #ifdef PROFILE
 			gl_draw_text(col, row++, color, 255, "Profiling: %I64u us", (time_t)((profile_total * 1000000.0) / VREF(game_object, countspersecond)));
+			gl_draw_text(col, row++, color, 255, "IBL load: %I64u us", (time_t)((profile_ibl_load * 1000000.0) / VREF(game_object, countspersecond)));
+			if (!ff8) gl_draw_text(col, row++, color, 255, "Magic load: %I64u us", (time_t)((profile_magic_load * 1000000.0) / VREF(game_object, countspersecond)));
 #endif
 			gl_draw_text(col, row++, color, 255, "RAM usage: %llu MB / %llu MB", (last_ram_state.ullTotalVirtual - last_ram_state.ullAvailVirtual) / (1024 * 1024), last_ram_state.ullTotalVirtual / ( 1024 * 1024 ));
 			gl_draw_text(col, row++, color, 255, "Textures: %u", stats.texture_count);
 			gl_draw_text(col, row++, color, 255, "External textures: %u", stats.external_textures);
+			gl_draw_text(col, row++, color, 255, "Resident mod images: %u (%u MB)", stats.mod_images, stats.mod_images_size / (1024 * 1024));
+			gl_draw_text(col, row++, color, 255, "Resident mod palettes: %u / %u (%u textures)", stats.mod_palettes_resident, stats.mod_palettes, stats.mod_textures);
+			gl_draw_text(col, row++, color, 255, "Mod image loads: %u", stats.mod_image_loads);
+			gl_draw_text(col, row++, color, 255, "Redirect probes avoided: %u", stats.redirect_probes_avoided);
 			gl_draw_text(col, row++, color, 255, "Texture reloads: %u", stats.texture_reloads);
+			gl_draw_text(col, row++, color, 255, "Texture reload bytes: %u KB hashed, %u KB uploaded", stats.texture_reload_bytes_compared / 1024, stats.texture_reload_bytes_uploaded / 1024);
+			gl_draw_text(col, row++, color, 255, "Texture uploads: %u (%u KB)", stats.texture_uploads, stats.texture_upload_bytes / 1024);
+			gl_draw_text(col, row++, color, 255, "Surface uploads: %u KB", stats.surface_bytes_uploaded / 1024);
 			gl_draw_text(col, row++, color, 255, "Palette writes: %u", stats.palette_writes);
 			gl_draw_text(col, row++, color, 255, "Palette changes: %u", stats.palette_changes);
 			gl_draw_text(col, row++, color, 255, "Zsort layers: %u", stats.deferred);
 			gl_draw_text(col, row++, color, 255, "Vertices: %u", stats.vertex_count);
+			gl_draw_text(col, row++, color, 255, "Draw calls: %u", stats.draw_calls);
+			gl_draw_text(col, row++, color, 255, "File I/O: %u opens, %u KB read", stats.file_opens, stats.file_read_bytes / 1024);
+			gl_draw_text(col, row++, color, 255, "Shadow casters culled: %u", stats.shadow_culled);
+			gl_draw_text(col, row++, color, 255, "Frame pacing: %u us late, %u us jitter, %u us spin", stats.frame_pacing_error, stats.frame_pacing_jitter, stats.frame_pacing_spin);
+			gl_draw_text(col, row++, color, 255, "Last voice start: %u us", stats.voice_start_latency);
 			gl_draw_text(col, row++, color, 255, "Timer: %I64u", stats.timer);
 		}
 	}
@@ -1304,6 +1345,17 @@ void common_flip(struct game_obj *game_object)
 	stats.palette_changes = 0;
 	stats.vertex_count = 0;
 	stats.deferred = 0;
+	stats.shadow_culled = 0;
+	stats.mod_image_loads = 0;
+	stats.texture_reload_bytes_compared = 0;
+	stats.texture_reload_bytes_uploaded = 0;
+	stats.surface_bytes_uploaded = 0;
+	stats.texture_uploads = 0;
+	stats.texture_upload_bytes = 0;
+	stats.draw_calls = 0;
+	stats.file_opens = 0;
+	stats.file_read_bytes = 0;
+	stats.redirect_probes_avoided = 0;
 
 	newRenderer.show();
 
@@ -1356,6 +1408,8 @@ void common_flip(struct game_obj *game_object)
 		}
 	}
 
+	drawCapture.recordFlip();
+
 	frame_counter++;
 
 	// We need to process Gamepad input on each frame
@@ -1544,6 +1598,9 @@ void common_unload_texture(struct texture_set *texture_set)
 	if(trace_all) ffnx_trace("dll_gfx: unload_texture 0x%x\n", VPTR(texture_set));
 
 	if(!VPTR(texture_set)) return;
+
+	drawCapture.forgetTexture(VPTR(texture_set));
+
 	if(!VREF(texture_set, texturehandle)) return;
 	if(!VREF(texture_set, ogl.gl_set)) return;
 
@@ -1884,6 +1941,8 @@ struct texture_set *common_load_texture(struct texture_set *_texture_set, struct
 	VRASS(texture_set, tex_header, _tex_header);
 	VRASS(texture_set, texture_format, texture_format);
 
+	VRASS(texture_set, ogl.gl_set->draw_policy, gl_texture_set_policy(_tex_header));
+
 	// check if this is suppposed to be a framebuffer texture, we may not have to do anything
 	if(create_framebuffer_texture(_texture_set, _tex_header))
 	{
@@ -1962,6 +2021,8 @@ struct texture_set *common_load_texture(struct texture_set *_texture_set, struct
 				memset(VREF(texture_set, texturehandle), 0, VREF(texture_set, ogl.gl_set->textures) * sizeof(uint32_t));
 				VREF(texture_set, ogl.gl_set->default_texture_id) = 0;
 
+				ff8_texture_handles_changed(VPTRCAST(ff8_texture_set, texture_set));
+
 				memcpy(VREF(tex_header, old_palette_data), tex_format->palette_data, 4 * tex_format->palette_size);
 			}
 		}
@@ -2044,6 +2105,57 @@ struct texture_set *common_load_texture(struct texture_set *_texture_set, struct
 	return _texture_set;
 }
 
+// convert some rows of the game image data again and upload them to a texture created mutable by gl_upload_texture
+// returns the uploaded size, 0 when the texture does not match the image data anymore and has to be reloaded
+uint32_t common_update_texture_rows(struct texture_set *_texture_set, uint32_t texture, uint32_t first_row, uint32_t rows)
+{
+	VOBJ(texture_set, texture_set, _texture_set);
+	VOBJ(tex_header, tex_header, VREF(texture_set, tex_header));
+	static std::vector<uint32_t> image_data;
+
+	if(!VREF(texture_set, ogl.gl_set) || VREF(texture_set, ogl.external) || VREF(texture_set, ogl.gl_set->is_animated) || save_textures) return 0;
+	if(VREF(tex_header, version) == FB_TEX_VERSION || VREF(tex_header, image_data) == 0) return 0;
+
+	struct texture_format *tex_format = VREFP(tex_header, tex_format);
+	uint32_t palette_index = VREF(tex_header, palette_index);
+
+	if(palette_index >= VREF(texture_set, ogl.gl_set->textures) || VREF(texture_set, texturehandle[palette_index]) != texture) return 0;
+
+	// a palette change is only detected by a full load
+	if(tex_format->bytesperpixel == 1 && VREF(tex_header, palettes) > 0)
+	{
+		if(!VREF(tex_header, old_palette_data) || memcmp(VREF(tex_header, old_palette_data), tex_format->palette_data, 4 * tex_format->palette_size) != 0) return 0;
+	}
+
+	uint32_t w = tex_format->width, h = tex_format->height;
+
+	if(first_row + rows > h) return 0;
+
+	// same conversion parameters as common_load_texture
+	uint32_t invert_alpha = tex_format->bitsperpixel == 16 && tex_format->alpha_mask == 0x8000;
+	uint32_t color_key = false;
+	uint32_t palette_offset = palette_index * VREF(tex_header, palette_entries);
+	uint32_t reference_alpha = (VREF(tex_header, reference_alpha) & 0xFF) << 24;
+
+	if(!ff8)
+	{
+		color_key = VREF(tex_header, color_key);
+
+		if(VREF(tex_header, use_palette_colorkey)) color_key = VREF(tex_header, palette_colorkey[palette_index]);
+	}
+
+	image_data.resize(w * h);
+
+	convert_image_data(VREF(tex_header, image_data) + first_row * w * tex_format->bytesperpixel, image_data.data() + first_row * w, w, rows, tex_format, invert_alpha, color_key, palette_offset, reference_alpha);
+
+	uint32_t uploaded = newRenderer.updateTexture(texture, (uint8_t *)image_data.data(), 0, first_row, w, rows, w * 4);
+
+	stats.texture_uploads++;
+	stats.texture_upload_bytes += uploaded;
+
+	return uploaded;
+}
+
 // called by the game to indicate when a texture has switched to using another palette
 // Either palette_entry_mul_index1 or palette_entry_mul_index2 can be filled. Not both! If palette_entry_mul_index1 has a value, then palette_entry_mul_index2 is 0, for eg.
 // If it is one or the other filled, means coming from two different points in the engine ( for FF8 at least )
@@ -2089,6 +2201,8 @@ uint32_t common_write_palette(uint32_t source_offset, uint32_t size, void *sourc
 	// anything before the texture is reloaded
 	if(VREF(texture_set, ogl.gl_set->textures) != VREF(tex_header, palettes) * 2 && !(VREF(tex_header, palettes) == 0 && VREF(texture_set, ogl.gl_set->textures) == 1)) return true;
 
+	drawCapture.recordPalette(texture_set, dest_offset, size, source ? (uint32_t *)source + source_offset : nullptr);
+
 	palette_index = dest_offset / VREF(tex_header, palette_entries);
 	palettes = size / VREF(tex_header, palette_entries);
 
@@ -2201,6 +2315,8 @@ uint32_t common_write_palette(uint32_t source_offset, uint32_t size, void *sourc
 
 				memset(VREFP(texture_set, texturehandle[palette_index]), 0, palettes * sizeof(uint32_t));
 				VREF(texture_set, ogl.gl_set->default_texture_id) = 0;
+
+				ff8_texture_handles_changed(VPTRCAST(ff8_texture_set, texture_set));
 			}
 
 			stats.texture_reloads++;
@@ -2739,6 +2855,80 @@ time_t qpc_diff_time(time_t* t1, time_t* t2, time_t* out)
 	return ret;
 }
 
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+static HANDLE qpc_wait_timer = nullptr;
+static bool qpc_wait_timer_period = false;
+
+// wait until frame_time counts have passed since last_gametime
+// most of the wait is spent sleeping on a waitable timer, the last part is spun since waking up from a sleep is never exact
+time_t qpc_wait_frame(time_t last_gametime, double frame_time)
+{
+	static time_t frequency = 0;
+	static FramePacer pacer;
+	HANDLE &timer = qpc_wait_timer;
+	time_t gametime, before;
+
+	if (frequency == 0)
+	{
+		QueryPerformanceFrequency((LARGE_INTEGER *)&frequency);
+
+		timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+
+		// High resolution timers require Windows 10 1803, regular ones follow the system timer resolution
+		if (timer == nullptr)
+		{
+			qpc_wait_timer_period = timeBeginPeriod(1) == TIMERR_NOERROR;
+			timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+		}
+
+		pacer.init(double(frequency));
+	}
+
+	qpc_get_time(&before);
+
+	double remaining = frame_time - qpc_diff_time(&before, &last_gametime, nullptr);
+	double sleep_time = before > last_gametime ? pacer.sleepTime(remaining) : 0.0;
+
+	if (timer != nullptr && sleep_time > 0.0)
+	{
+		LARGE_INTEGER due_time;
+
+		// negative means relative, in 100ns units
+		due_time.QuadPart = -(LONGLONG)(sleep_time * 10000000.0 / frequency);
+
+		if (SetWaitableTimer(timer, &due_time, 0, nullptr, nullptr, FALSE)) WaitForSingleObject(timer, INFINITE);
+
+		qpc_get_time(&gametime);
+
+		pacer.wokeUp(sleep_time, double(qpc_diff_time(&gametime, &before, nullptr)));
+	}
+
+	do qpc_get_time(&gametime);
+	while (gametime > last_gametime && qpc_diff_time(&gametime, &last_gametime, nullptr) < frame_time);
+
+	// only meaningful when the frame finished early enough to be paced
+	if (before > last_gametime && remaining > 0.0) pacer.frameDone(qpc_diff_time(&gametime, &last_gametime, nullptr) - frame_time);
+
+	stats.frame_pacing_error = (uint32_t)pacer.toMicroseconds(pacer.error());
+	stats.frame_pacing_jitter = (uint32_t)pacer.toMicroseconds(pacer.jitter());
+	stats.frame_pacing_spin = (uint32_t)pacer.toMicroseconds(pacer.spin());
+
+	return gametime;
+}
+
+// give the system timer resolution back, raised by qpc_wait_frame when it had to use a regular timer
+void qpc_wait_frame_cleanup()
+{
+	if (qpc_wait_timer_period) timeEndPeriod(1);
+	qpc_wait_timer_period = false;
+
+	if (qpc_wait_timer != nullptr) CloseHandle(qpc_wait_timer);
+	qpc_wait_timer = nullptr;
+}
+
 // version check reads from a given offset in memory
 uint32_t version_check(uint32_t offset)
 {
@@ -28,6 +28,7 @@
 #include <dsound.h>
 
 #include "common_imports.h"
+#include "game_modes.h"
 
 // all known OFFICIAL versions of FF7 & FF8 released for the PC
 #define VERSION_FF7_102_US          1
@@ -74,31 +75,6 @@ enum
 	NUM_TEXTCOLORS
 };
 
-enum game_modes
-{
-	MODE_FIELD = 0,
-	MODE_BATTLE,
-	MODE_WORLDMAP,
-	MODE_MENU,
-	MODE_HIGHWAY,
-	MODE_CHOCOBO,
-	MODE_SNOWBOARD,
-	MODE_CONDOR,
-	MODE_SUBMARINE,
-	MODE_COASTER,
-	MODE_CDCHECK,
-	MODE_EXIT,
-	MODE_SWIRL,
-	MODE_GAMEOVER,
-	MODE_ENDINGMOVIE,
-	MODE_CREDITS,
-	MODE_INTRO,
-	MODE_CARDGAME,
-	MODE_UNKNOWN,
-	MODE_AFTER_BATTLE,
-	MODE_MAIN_MENU,
-};
-
 enum AspectRatioMode
 {
 	AR_ORIGINAL = 0,
@@ -331,8 +307,22 @@ void *driver_realloc(void *ptr, uint32_t size);
 extern time_t profile_start;
 extern time_t profile_end;
 extern time_t profile_total;
+extern time_t profile_ibl_load;
+extern time_t profile_magic_load;
 #endif PROFILE
 
+// Largest FF8 mod textures reported in the driver stats
+#define MOD_TEXTURE_STATS_COUNT 8
+
+struct mod_texture_stats
+{
+	char name[64];
+	uint32_t palettes;
+	uint32_t palettes_resident;
+	uint32_t images_size;
+	uint32_t image_loads;
+};
+
 struct driver_stats
 {
 	uint32_t texture_count;
@@ -343,11 +333,36 @@ struct driver_stats
 	uint32_t palette_changes;
 	uint32_t vertex_count;
 	uint32_t deferred;
+	uint32_t shadow_culled;
+	uint32_t mod_images;
+	uint32_t mod_images_size;
+	uint32_t mod_image_loads;
+	uint32_t mod_textures;
+	uint32_t mod_palettes;
+	uint32_t mod_palettes_resident;
+	uint32_t mod_texture_stats_count;
+	struct mod_texture_stats mod_texture_stats[MOD_TEXTURE_STATS_COUNT]; // Sorted by resident size
+	uint32_t redirect_probes_avoided;
+	uint32_t texture_reload_bytes_compared;
+	uint32_t texture_reload_bytes_uploaded;
+	uint32_t surface_bytes_uploaded;
+	uint32_t texture_uploads;
+	uint32_t texture_upload_bytes;
+	uint32_t frame_pacing_error;
+	uint32_t frame_pacing_jitter;
+	uint32_t frame_pacing_spin;
+	uint32_t draw_calls;
+	uint32_t file_opens;
+	uint32_t file_read_bytes;
+	uint32_t audio_voices;
+	uint32_t voice_start_latency;
 	time_t timer;
 };
 
 time_t qpc_get_time(time_t *dest);
 time_t qpc_diff_time(time_t* t1, time_t* t2, time_t* out);
+time_t qpc_wait_frame(time_t last_gametime, double frame_time);
+void qpc_wait_frame_cleanup();
 uint32_t get_version();
 struct game_mode *getmode();
 struct game_mode *getmode_cached();
@@ -355,6 +370,7 @@ struct tex_header *make_framebuffer_tex(uint32_t tex_w, uint32_t tex_h, uint32_t
 void internal_set_renderstate(uint32_t state, uint32_t option, struct game_obj *game_object);
 uint32_t create_framebuffer_texture(struct texture_set *texture_set, struct tex_header *tex_header);
 void blit_framebuffer_texture(struct texture_set *texture_set, struct tex_header *tex_header);
+uint32_t common_update_texture_rows(struct texture_set *texture_set, uint32_t texture, uint32_t first_row, uint32_t rows);
 
 void get_data_lang_path(PCHAR buffer);
 void get_userdata_path(PCHAR buffer, size_t bufSize, bool isSavegameFile);
@@ -0,0 +1,163 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "draw_capture.h"
+#include "cfg.h"
+#include "log.h"
+#include "globals.h"
+#include "renderer.h"
+
+static_assert(sizeof(draw_capture_vertex) == sizeof(struct nvertex), "draw_capture_vertex must match struct nvertex");
+
+DrawCapture drawCapture;
+
+// PRIVATE
+
+uint32_t DrawCapture::textureId(struct texture_set *texture_set)
+{
+	if (texture_set == nullptr) return 0;
+
+	auto it = textureIds.find(texture_set);
+
+	if (it != textureIds.end()) return it->second;
+
+	textureIds[texture_set] = nextTextureId;
+
+	return nextTextureId++;
+}
+
+void DrawCapture::start()
+{
+	framesBeforeStart = -1;
+
+	if (!writer.open(draw_capture_path.c_str(), ff8))
+	{
+		ffnx_error("DrawCapture: cannot open %s for writing\n", draw_capture_path.c_str());
+		return;
+	}
+
+	// Textures uploaded before the recording are not in the trace, the replay draws them untextured
+	textureIds.clear();
+	nextTextureId = 1;
+	remainingFrames = draw_capture_frames;
+
+	ffnx_info("DrawCapture: recording %u frames to %s\n", remainingFrames, draw_capture_path.c_str());
+}
+
+void DrawCapture::stop()
+{
+	writer.close();
+	textureIds.clear();
+
+	ffnx_info("DrawCapture: recording done\n");
+}
+
+// PUBLIC
+
+void DrawCapture::init()
+{
+	if (draw_capture_path.empty() || draw_capture_frames == 0 || draw_capture_start_frame < 0) return;
+
+	if (draw_capture_start_frame == 0) start();
+	else framesBeforeStart = draw_capture_start_frame - 1;
+}
+
+void DrawCapture::toggle()
+{
+	if (draw_capture_path.empty() || draw_capture_frames == 0) return;
+
+	if (isCapturing())
+	{
+		stop();
+		return;
+	}
+
+	// Start with a whole frame
+	framesBeforeStart = 0;
+
+	show_popup_msg(TEXTCOLOR_LIGHT_BLUE, "Recording %u frames of draw calls", draw_capture_frames);
+}
+
+void DrawCapture::recordTexture(struct texture_set *texture_set, uint32_t palette_index, uint32_t width, uint32_t height, uint32_t format, void *image_data)
+{
+	if (!isCapturing()) return;
+
+	// Only raw BGRA uploads carry pixels, other formats are recorded without data
+	writer.texture({ textureId(texture_set), palette_index, width, height, format, format == RendererTextureType::BGRA ? (const uint32_t *)image_data : nullptr });
+}
+
+void DrawCapture::recordPalette(struct texture_set *texture_set, uint32_t dest_offset, uint32_t entries, void *source)
+{
+	if (!isCapturing()) return;
+
+	writer.palette({ textureId(texture_set), dest_offset, entries, (const uint32_t *)source });
+}
+
+void DrawCapture::recordDraw(uint32_t primitivetype, uint32_t vertextype, struct nvertex *vertices, uint32_t vertexcount, WORD *indices, uint32_t count, uint32_t clip, uint32_t mipmap)
+{
+	if (!isCapturing()) return;
+
+	draw_capture_draw draw = {
+		primitivetype, vertextype, vertexcount, count, clip, mipmap,
+		{
+			textureId(current_state.texture_set),
+			current_state.blend_mode,
+			{ current_state.viewport[0], current_state.viewport[1], current_state.viewport[2], current_state.viewport[3] },
+			current_state.fb_texture,
+			current_state.wireframe,
+			current_state.texture_filter,
+			current_state.cullface,
+			current_state.nocull,
+			current_state.depthtest,
+			current_state.depthmask,
+			current_state.shademode,
+			current_state.alphatest,
+			current_state.alphafunc,
+			current_state.alpharef
+		},
+		(const draw_capture_vertex *)vertices,
+		(const uint16_t *)indices
+	};
+
+	memcpy(draw.state.world_view_matrix, current_state.world_view_matrix.m, sizeof(draw.state.world_view_matrix));
+	memcpy(draw.state.d3dprojection_matrix, current_state.d3dprojection_matrix.m, sizeof(draw.state.d3dprojection_matrix));
+
+	writer.draw(draw);
+}
+
+void DrawCapture::recordFlip()
+{
+	if (isCapturing())
+	{
+		writer.flip(frame_counter);
+
+		if (--remainingFrames == 0) stop();
+	}
+	else if (framesBeforeStart >= 0 && framesBeforeStart-- == 0)
+	{
+		start();
+	}
+}
+
+void DrawCapture::forgetTexture(struct texture_set *texture_set)
+{
+	textureIds.erase(texture_set);
+}
@@ -0,0 +1,60 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <unordered_map>
+
+#include "common.h"
+#include "gl.h"
+#include "draw_capture_format.h"
+
+// Records the calls the game makes to the driver to draw_capture_path, see misc/FFNx.toml and draw_capture_format.h
+class DrawCapture
+{
+private:
+	DrawCaptureWriter writer;
+	uint32_t remainingFrames = 0;
+	// Frames left before the recording starts, -1 when no recording is planned
+	int32_t framesBeforeStart = -1;
+	std::unordered_map<struct texture_set *, uint32_t> textureIds;
+	uint32_t nextTextureId = 1;
+
+	uint32_t textureId(struct texture_set *texture_set);
+	void start();
+	void stop();
+
+public:
+	void init();
+	// Starts recording at the next frame, or stops the recording in progress
+	void toggle();
+	bool isCapturing() const { return writer.isOpen(); }
+
+	void recordTexture(struct texture_set *texture_set, uint32_t palette_index, uint32_t width, uint32_t height, uint32_t format, void *image_data);
+	void recordPalette(struct texture_set *texture_set, uint32_t dest_offset, uint32_t entries, void *source);
+	void recordDraw(uint32_t primitivetype, uint32_t vertextype, struct nvertex *vertices, uint32_t vertexcount, WORD *indices, uint32_t count, uint32_t clip, uint32_t mipmap);
+	void recordFlip();
+	// The texture_set address can be reused by the next texture, which must get a new id
+	void forgetTexture(struct texture_set *texture_set);
+};
+
+extern DrawCapture drawCapture;
@@ -0,0 +1,278 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "draw_capture_format.h"
+
+#include <string.h>
+
+// DrawCaptureWriter
+
+DrawCaptureWriter::~DrawCaptureWriter()
+{
+	close();
+}
+
+void DrawCaptureWriter::writeRecord(uint32_t type, uint32_t size)
+{
+	write(&type, sizeof(type));
+	write(&size, sizeof(size));
+}
+
+void DrawCaptureWriter::write(const void *data, uint32_t size)
+{
+	if (size > 0) fwrite(data, 1, size, file);
+}
+
+bool DrawCaptureWriter::open(const char *path, uint32_t ff8)
+{
+	close();
+
+	file = fopen(path, "wb");
+
+	if (file == nullptr) return false;
+
+	uint32_t header[] = { DRAW_CAPTURE_MAGIC, DRAW_CAPTURE_VERSION, ff8 };
+	write(header, sizeof(header));
+
+	return true;
+}
+
+void DrawCaptureWriter::close()
+{
+	if (file != nullptr) fclose(file);
+
+	file = nullptr;
+}
+
+void DrawCaptureWriter::texture(const draw_capture_texture &texture)
+{
+	uint32_t dataSize = texture.pixels != nullptr ? texture.width * texture.height * 4 : 0;
+	uint32_t fields[] = { texture.texture_id, texture.palette_index, texture.width, texture.height, texture.format };
+
+	writeRecord(DRAW_CAPTURE_TEXTURE, sizeof(fields) + dataSize);
+	write(fields, sizeof(fields));
+	write(texture.pixels, dataSize);
+}
+
+void DrawCaptureWriter::palette(const draw_capture_palette &palette)
+{
+	uint32_t dataSize = palette.data != nullptr ? palette.entries * sizeof(uint32_t) : 0;
+	uint32_t fields[] = { palette.texture_id, palette.dest_offset, palette.entries };
+
+	writeRecord(DRAW_CAPTURE_PALETTE, sizeof(fields) + dataSize);
+	write(fields, sizeof(fields));
+	write(palette.data, dataSize);
+}
+
+void DrawCaptureWriter::draw(const draw_capture_draw &draw)
+{
+	uint32_t fields[] = { draw.primitivetype, draw.vertextype, draw.vertexcount, draw.count, draw.clip, draw.mipmap };
+	uint32_t verticesSize = draw.vertexcount * sizeof(draw_capture_vertex), indicesSize = draw.count * sizeof(uint16_t);
+
+	writeRecord(DRAW_CAPTURE_DRAW, sizeof(fields) + sizeof(draw.state) + verticesSize + indicesSize);
+	write(fields, sizeof(fields));
+	write(&draw.state, sizeof(draw.state));
+	write(draw.vertices, verticesSize);
+	write(draw.indices, indicesSize);
+}
+
+void DrawCaptureWriter::flip(uint32_t frame_counter)
+{
+	writeRecord(DRAW_CAPTURE_FLIP, sizeof(frame_counter));
+	write(&frame_counter, sizeof(frame_counter));
+}
+
+// DrawCaptureReader
+
+bool DrawCaptureReader::open(const char *path, std::string &error)
+{
+	FILE *file = fopen(path, "rb");
+
+	if (file == nullptr)
+	{
+		error = std::string("cannot open ") + path;
+		return false;
+	}
+
+	std::vector<uint8_t> trace;
+	uint8_t chunk[64 * 1024];
+	size_t read;
+
+	while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) trace.insert(trace.end(), chunk, chunk + read);
+
+	fclose(file);
+
+	return load(std::move(trace), error);
+}
+
+bool DrawCaptureReader::load(std::vector<uint8_t> trace, std::string &error)
+{
+	uint32_t header[3];
+
+	data = std::move(trace);
+
+	if (data.size() < sizeof(header))
+	{
+		error = "truncated header";
+		return false;
+	}
+
+	memcpy(header, data.data(), sizeof(header));
+
+	if (header[0] != DRAW_CAPTURE_MAGIC)
+	{
+		error = "not a draw capture";
+		return false;
+	}
+
+	if (header[1] != DRAW_CAPTURE_VERSION)
+	{
+		error = "unsupported version " + std::to_string(header[1]);
+		return false;
+	}
+
+	ff8 = header[2];
+
+	rewind();
+
+	return true;
+}
+
+void DrawCaptureReader::rewind()
+{
+	offset = 3 * sizeof(uint32_t);
+}
+
+const uint8_t *DrawCaptureReader::aligned(const uint8_t *payload, size_t size)
+{
+	if ((uintptr_t(payload) & (sizeof(uint32_t) - 1)) == 0) return payload;
+
+	scratch.resize((size + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+	memcpy(scratch.data(), payload, size);
+
+	return (const uint8_t *)scratch.data();
+}
+
+bool DrawCaptureReader::next(Record &record, std::string &error)
+{
+	while (offset + 2 * sizeof(uint32_t) <= data.size())
+	{
+		uint32_t type, size;
+
+		memcpy(&type, data.data() + offset, sizeof(type));
+		memcpy(&size, data.data() + offset + sizeof(type), sizeof(size));
+
+		const uint8_t *payload = data.data() + offset + 2 * sizeof(uint32_t);
+
+		if (size > data.size() - offset - 2 * sizeof(uint32_t))
+		{
+			error = "truncated record at offset " + std::to_string(offset);
+			return false;
+		}
+
+		offset += 2 * sizeof(uint32_t) + size;
+
+		switch (type)
+		{
+		case DRAW_CAPTURE_TEXTURE:
+		{
+			uint32_t fields[5];
+
+			if (size < sizeof(fields)) break;
+
+			memcpy(fields, payload, sizeof(fields));
+
+			record.type = DRAW_CAPTURE_TEXTURE;
+			record.texture = { fields[0], fields[1], fields[2], fields[3], fields[4], nullptr };
+
+			if (size == sizeof(fields)) return true;
+			if (uint64_t(size - sizeof(fields)) != uint64_t(fields[2]) * fields[3] * 4) break;
+
+			record.texture.pixels = (const uint32_t *)aligned(payload + sizeof(fields), size - sizeof(fields));
+
+			return true;
+		}
+		case DRAW_CAPTURE_PALETTE:
+		{
+			uint32_t fields[3];
+
+			if (size < sizeof(fields)) break;
+
+			memcpy(fields, payload, sizeof(fields));
+
+			record.type = DRAW_CAPTURE_PALETTE;
+			record.palette = { fields[0], fields[1], fields[2], nullptr };
+
+			if (size == sizeof(fields)) return true;
+			if (uint64_t(size - sizeof(fields)) != uint64_t(fields[2]) * 4) break;
+
+			record.palette.data = (const uint32_t *)aligned(payload + sizeof(fields), size - sizeof(fields));
+
+			return true;
+		}
+		case DRAW_CAPTURE_DRAW:
+		{
+			uint32_t fields[6];
+
+			if (size < sizeof(fields) + sizeof(draw_capture_state)) break;
+
+			memcpy(fields, payload, sizeof(fields));
+
+			uint64_t expected = sizeof(fields) + sizeof(draw_capture_state) + uint64_t(fields[2]) * sizeof(draw_capture_vertex) + uint64_t(fields[3]) * sizeof(uint16_t);
+
+			if (size != expected) break;
+
+			record.type = DRAW_CAPTURE_DRAW;
+			record.draw.primitivetype = fields[0];
+			record.draw.vertextype = fields[1];
+			record.draw.vertexcount = fields[2];
+			record.draw.count = fields[3];
+			record.draw.clip = fields[4];
+			record.draw.mipmap = fields[5];
+			memcpy(&record.draw.state, payload + sizeof(fields), sizeof(draw_capture_state));
+
+			const uint8_t *buffers = aligned(payload + sizeof(fields) + sizeof(draw_capture_state), size - sizeof(fields) - sizeof(draw_capture_state));
+
+			record.draw.vertices = (const draw_capture_vertex *)buffers;
+			record.draw.indices = (const uint16_t *)(buffers + fields[2] * sizeof(draw_capture_vertex));
+
+			return true;
+		}
+		case DRAW_CAPTURE_FLIP:
+			if (size != sizeof(uint32_t)) break;
+
+			record.type = DRAW_CAPTURE_FLIP;
+			memcpy(&record.frame_counter, payload, sizeof(uint32_t));
+
+			return true;
+		default:
+			// Records added by a later version of the same format
+			continue;
+		}
+
+		error = "malformed record of type " + std::to_string(type) + " at offset " + std::to_string(offset - size - 2 * sizeof(uint32_t));
+		return false;
+	}
+
+	if (offset != data.size()) error = "truncated record at offset " + std::to_string(offset);
+
+	return false;
+}
@@ -0,0 +1,162 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Binary trace of the calls the game makes to the driver, written by DrawCapture and read by the replay tool in tests/
+//
+// File layout: DRAW_CAPTURE_MAGIC, uint32_t version, uint32_t ff8, then records
+// Record layout: uint32_t type, uint32_t payload size, payload
+// Textures are identified by an id assigned in order of appearance, 0 means no texture
+#define DRAW_CAPTURE_MAGIC 0x50414358 // "XCAP"
+#define DRAW_CAPTURE_VERSION 2
+
+enum DrawCaptureRecordType
+{
+	DRAW_CAPTURE_TEXTURE = 1, // texture id, palette_index, width, height, format, pixels
+	DRAW_CAPTURE_PALETTE,     // texture id, dest_offset, entries, BGRA entries
+	DRAW_CAPTURE_DRAW,        // primitivetype, vertextype, vertexcount, count, clip, mipmap, draw_capture_state, vertices, indices
+	DRAW_CAPTURE_FLIP         // frame_counter
+};
+
+// Render state of a draw, without the pointers and renderer handles of driver_state
+struct draw_capture_state
+{
+	uint32_t texture_id;
+	uint32_t blend_mode;
+	uint32_t viewport[4];
+	uint32_t fb_texture;
+	uint32_t wireframe;
+	uint32_t texture_filter;
+	uint32_t cullface;
+	uint32_t nocull;
+	uint32_t depthtest;
+	uint32_t depthmask;
+	uint32_t shademode;
+	uint32_t alphatest;
+	uint32_t alphafunc;
+	uint32_t alpharef;
+	float world_view_matrix[16];
+	float d3dprojection_matrix[16];
+};
+
+// Same layout as struct nvertex
+struct draw_capture_vertex
+{
+	float x, y, z;
+	float w;
+	uint32_t color;
+	uint32_t specular;
+	float u, v;
+};
+
+struct draw_capture_texture
+{
+	uint32_t texture_id;
+	uint32_t palette_index;
+	uint32_t width;
+	uint32_t height;
+	uint32_t format;
+	// width * height BGRA pixels for raw BGRA uploads, nullptr otherwise
+	const uint32_t *pixels;
+};
+
+struct draw_capture_palette
+{
+	uint32_t texture_id;
+	uint32_t dest_offset;
+	uint32_t entries;
+	// BGRA entries, nullptr when the game cleared the palette
+	const uint32_t *data;
+};
+
+struct draw_capture_draw
+{
+	uint32_t primitivetype;
+	uint32_t vertextype;
+	uint32_t vertexcount;
+	uint32_t count;
+	uint32_t clip;
+	uint32_t mipmap;
+	draw_capture_state state;
+	const draw_capture_vertex *vertices;
+	const uint16_t *indices;
+};
+
+class DrawCaptureWriter
+{
+	FILE *file = nullptr;
+
+	void writeRecord(uint32_t type, uint32_t size);
+	void write(const void *data, uint32_t size);
+
+public:
+	~DrawCaptureWriter();
+
+	bool open(const char *path, uint32_t ff8);
+	void close();
+	bool isOpen() const { return file != nullptr; }
+
+	void texture(const draw_capture_texture &texture);
+	void palette(const draw_capture_palette &palette);
+	void draw(const draw_capture_draw &draw);
+	void flip(uint32_t frame_counter);
+};
+
+// Whole trace in memory, records point into it
+class DrawCaptureReader
+{
+	std::vector<uint8_t> data;
+	size_t offset = 0;
+	uint32_t ff8 = 0;
+	// Records follow each other without padding, odd index counts leave the next payloads unaligned
+	std::vector<uint32_t> scratch;
+
+	const uint8_t *aligned(const uint8_t *payload, size_t size);
+
+public:
+	struct Record
+	{
+		DrawCaptureRecordType type;
+		union
+		{
+			draw_capture_texture texture;
+			draw_capture_palette palette;
+			draw_capture_draw draw;
+			uint32_t frame_counter;
+		};
+	};
+
+	bool open(const char *path, std::string &error);
+	bool load(std::vector<uint8_t> trace, std::string &error);
+	void rewind();
+	bool isFF8() const { return ff8 != 0; }
+	size_t size() const { return data.size(); }
+
+	// Fills record with the next record, valid until the next call.
+	// False at the end of the trace, or on a malformed record and error is then set.
+	bool next(Record &record, std::string &error);
+};
@@ -19,6 +19,8 @@
 //    GNU General Public License for more details.                          //
 /****************************************************************************/
 
+#include <algorithm>
+
 #include "renderer.h"
 
 #include "fake_dd.h"
@@ -232,6 +234,12 @@ struct d3d2device *_fake_d3d2device = &fake_d3d2device;
 uint8_t* fake_dd_surface_buffer = nullptr;
 
 uint32_t movie_texture = 0;
+uint32_t movie_texture_width = 0;
+uint32_t movie_texture_height = 0;
+
+// union of the rectangles locked since the last unlock
+RECT fake_dd_dirty_rect = {};
+bool fake_dd_dirty = false;
 
 uint32_t __stdcall fake_dd_blit_fast(struct ddsurface **me, uint32_t unknown1, uint32_t unknown2, struct ddsurface **source, LPRECT src_rect, uint32_t unknown3)
 {
@@ -284,7 +292,24 @@ uint32_t __stdcall fake_ddsurface_lock(struct ddsurface **me, LPRECT dest, LPDDS
 
 	if (fake_dd_surface_buffer == nullptr) fake_dd_surface_buffer = (uint8_t*)driver_calloc(game_width * game_height, 4);
 
-	sd->lpSurface = fake_dd_surface_buffer;
+	// a null rectangle locks the whole surface
+	RECT rect = { 0, 0, LONG(game_width), LONG(game_height) };
+
+	if (dest != nullptr)
+	{
+		rect.left = std::clamp<LONG>(dest->left, 0, game_width);
+		rect.top = std::clamp<LONG>(dest->top, 0, game_height);
+		rect.right = std::clamp<LONG>(dest->right, rect.left, game_width);
+		rect.bottom = std::clamp<LONG>(dest->bottom, rect.top, game_height);
+	}
+
+	if (fake_dd_dirty) UnionRect(&fake_dd_dirty_rect, &fake_dd_dirty_rect, &rect);
+	else fake_dd_dirty_rect = rect;
+
+	fake_dd_dirty = true;
+
+	// like DirectDraw, the pointer is at the top left corner of the locked rectangle
+	sd->lpSurface = fake_dd_surface_buffer + rect.top * game_width * 4 + rect.left * 4;
 	sd->dwFlags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PITCH | DDSD_PIXELFORMAT | DDSD_LPSURFACE;
 
 	sd->dwWidth = game_width;
@@ -305,14 +330,36 @@ uint32_t __stdcall fake_ddsurface_unlock(struct ddsurface **me, LPRECT dest)
 {
 	if(trace_all || trace_fake_dx) ffnx_trace("unlock\n");
 
-	if (movie_texture) newRenderer.deleteTexture(movie_texture);
+	if (!movie_texture || movie_texture_width != game_width || movie_texture_height != game_height)
+	{
+		if (movie_texture) newRenderer.deleteTexture(movie_texture);
+
+		movie_texture = newRenderer.createTexture(
+			fake_dd_surface_buffer,
+			game_width,
+			game_height,
+			game_width * 4
+		);
+		movie_texture_width = game_width;
+		movie_texture_height = game_height;
+
+		stats.surface_bytes_uploaded += game_width * game_height * 4;
+	}
+	// only upload what has been locked since the last unlock
+	else if (fake_dd_dirty)
+	{
+		stats.surface_bytes_uploaded += newRenderer.updateTexture(
+			movie_texture,
+			fake_dd_surface_buffer,
+			fake_dd_dirty_rect.left,
+			fake_dd_dirty_rect.top,
+			fake_dd_dirty_rect.right - fake_dd_dirty_rect.left,
+			fake_dd_dirty_rect.bottom - fake_dd_dirty_rect.top,
+			game_width * 4
+		);
+	}
 
-	movie_texture = newRenderer.createTexture(
-		fake_dd_surface_buffer,
-		game_width,
-		game_height,
-		game_width * 4
-	);
+	fake_dd_dirty = false;
 
 	newRenderer.useTexture(movie_texture);
 
@@ -28,6 +28,7 @@
 #include <span>
 
 #include "common.h"
+#include "ff7/lgp.h"
 
 #define FF7_MAX_NUM_MODEL_ENTITIES 32
 
@@ -1296,37 +1297,6 @@ struct ff7_hrc_polygon_data
 };
 #pragma pack(pop)
 
-struct lgp_toc_entry
-{
-	char name[16];
-	uint32_t offset;
-	WORD unknown1;
-	WORD conflict;
-};
-
-struct lookup_table_entry
-{
-	unsigned short toc_offset;
-	unsigned short num_files;
-};
-
-struct conflict_entry
-{
-	char name[128];
-	unsigned short toc_index;
-};
-
-struct conflict_list
-{
-	uint32_t num_conflicts;
-	struct conflict_entry *conflict_entries;
-};
-
-struct lgp_folders
-{
-	struct conflict_list conflicts[1000];
-};
-
 struct hpmp_bar
 {
 	WORD x;
@@ -19,24 +19,305 @@
 //    GNU General Public License for more details.                          //
 /****************************************************************************/
 
+#include <algorithm>
+#include <filesystem>
+#include <future>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <io.h>
+#include <shlwapi.h>
+
 #include "../../globals.h"
+#include "../../common.h"
 #include "../../log.h"
 #include "../../achievement.h"
+#include "../../atomic_file.h"
 
 #include "defs.h"
 
 namespace ff7::battle
 {
+	// Files read by the magic effect loader for an action, learned the first time the action is loaded and kept across sessions
+	struct magic_prefetch_manifest
+	{
+		// archive path => ranges read through the mapped LGP view
+		std::map<std::string, std::vector<std::pair<uint32_t, uint32_t>>> archives;
+		// direct mode files and external textures
+		std::vector<std::string> files;
+	};
+
+	std::unordered_map<uint32_t, magic_prefetch_manifest> magic_prefetch_manifests;
+	std::unordered_map<uint32_t, std::string> magic_prefetch_archive_paths;
+	magic_prefetch_manifest *magic_prefetch_recording = nullptr;
+	uint32_t magic_prefetch_last_key = 0;
+	std::future<void> magic_prefetch_task;
+	bool magic_prefetch_loaded = false;
+
+	uint32_t magic_prefetch_key()
+	{
+		return (ff7_externals.battle_actor_data->command_index << 16) | (ff7_externals.battle_actor_data->action_index & 0xFFFF);
+	}
+
+	// Read everything the loader will need so it comes from the system file cache instead of the disk
+	void magic_prefetch_run(magic_prefetch_manifest manifest)
+	{
+		std::vector<char> buffer(64 * 1024);
+
+		auto read = [&buffer](FILE *fd, uint32_t size) {
+			while (size > 0)
+			{
+				size_t chunk = fread(buffer.data(), 1, std::min<size_t>(size, buffer.size()), fd);
+
+				if (chunk == 0) break;
+
+				size -= chunk;
+			}
+		};
+
+		for (const auto &[path, ranges] : manifest.archives)
+		{
+			FILE *fd = fopen(path.c_str(), "rb");
+
+			if (!fd) continue;
+
+			for (const auto &[offset, size] : ranges)
+			{
+				fseek(fd, offset, SEEK_SET);
+				read(fd, size);
+			}
+
+			fclose(fd);
+		}
+
+		for (const std::string &path : manifest.files)
+		{
+			FILE *fd = fopen(path.c_str(), "rb");
+
+			if (!fd) continue;
+
+			read(fd, UINT32_MAX);
+			fclose(fd);
+		}
+	}
+
+	// First line of the manifest file, files with another one are rebuilt from scratch
+	constexpr char magic_prefetch_header[] = "FFNx magic_prefetch 1";
+
+	// Written next to FFNx.log and crash.dmp
+	void magic_prefetch_manifest_path(char *out, size_t size)
+	{
+		if (steam_edition) get_userdata_path(out, size, false);
+		else strncpy(out, basedir, size - 1);
+		PathAppendA(out, "magic_prefetch.txt");
+	}
+
+	// -1 when the file is missing
+	int64_t magic_prefetch_file_size(const std::string &path)
+	{
+		std::error_code ec;
+		uintmax_t size = std::filesystem::file_size(path, ec);
+
+		return ec ? -1 : int64_t(size);
+	}
+
+	// Manifests learned in earlier sessions, so the first cast of an action in this session is warmed up too.
+	// After the header, one line per file read with its size when recorded: "S <size> <path>",
+	// then one line per entry: "A <key> <offset> <size> <archive>" or "F <key> <file>".
+	// A file moved, resized or replaced since drops every manifest, they are learned again.
+	void magic_prefetch_load()
+	{
+		magic_prefetch_loaded = true;
+
+		char path[MAX_PATH]{ 0 };
+		magic_prefetch_manifest_path(path, sizeof(path));
+
+		FILE *fd = fopen(path, "r");
+
+		if (!fd) return;
+
+		char line[MAX_PATH + 64];
+		std::set<std::string> checked;
+		bool valid = fgets(line, sizeof(line), fd) != nullptr;
+
+		if (valid)
+		{
+			line[strcspn(line, "\r\n")] = 0;
+			valid = strcmp(line, magic_prefetch_header) == 0;
+		}
+
+		while (valid && fgets(line, sizeof(line), fd))
+		{
+			line[strcspn(line, "\r\n")] = 0;
+
+			uint32_t key, offset, size;
+			long long file_size;
+			int pos = 0;
+
+			if (sscanf(line, "S %lld %n", &file_size, &pos) == 1 && pos > 0 && line[pos])
+			{
+				valid = magic_prefetch_file_size(line + pos) == file_size;
+				checked.emplace(line + pos);
+			}
+			else if (sscanf(line, "A %u %u %u %n", &key, &offset, &size, &pos) == 3 && pos > 0 && checked.contains(line + pos)) magic_prefetch_manifests[key].archives[line + pos].emplace_back(offset, size);
+			else if (sscanf(line, "F %u %n", &key, &pos) == 1 && pos > 0 && checked.contains(line + pos)) magic_prefetch_manifests[key].files.emplace_back(line + pos);
+		}
+
+		fclose(fd);
+
+		if (!valid)
+		{
+			magic_prefetch_manifests.clear();
+
+			if (trace_all) ffnx_trace("%s: %s is outdated, it will be rebuilt\n", __func__, path);
+
+			return;
+		}
+
+		if (trace_all) ffnx_trace("%s: %u manifests loaded from %s\n", __func__, magic_prefetch_manifests.size(), path);
+	}
+
+	// Rewrites every manifest known so far, so the file only ever holds one entry per action
+	void magic_prefetch_save()
+	{
+		char path[MAX_PATH]{ 0 };
+		magic_prefetch_manifest_path(path, sizeof(path));
+
+		std::map<std::string, int64_t> sizes;
+
+		for (const auto &[key, manifest] : magic_prefetch_manifests)
+		{
+			for (const auto &[archive, ranges] : manifest.archives) sizes.emplace(archive, -1);
+			for (const std::string &file : manifest.files) sizes.emplace(file, -1);
+		}
+
+		for (auto &[file, size] : sizes) size = magic_prefetch_file_size(file);
+
+		std::string error;
+
+		bool saved = atomic_write_file(path, [&sizes](const std::string &tempPath) {
+			FILE *fd = fopen(tempPath.c_str(), "w");
+
+			if (!fd) return false;
+
+			fprintf(fd, "%s\n", magic_prefetch_header);
+
+			for (const auto &[file, size] : sizes)
+			{
+				if (size >= 0) fprintf(fd, "S %lld %s\n", (long long)size, file.c_str());
+			}
+
+			for (const auto &[key, manifest] : magic_prefetch_manifests)
+			{
+				for (const auto &[archive, ranges] : manifest.archives)
+				{
+					for (const auto &[offset, size] : ranges) fprintf(fd, "A %u %u %u %s\n", key, offset, size, archive.c_str());
+				}
+
+				for (const std::string &file : manifest.files) fprintf(fd, "F %u %s\n", key, file.c_str());
+			}
+
+			bool ok = !ferror(fd);
+
+			return fclose(fd) == 0 && ok;
+		}, error);
+
+		if (!saved) ffnx_error("%s: %s\n", __func__, error.c_str());
+	}
+
+	void magic_prefetch_record_lgp(uint32_t lgp_num, uint32_t offset, uint32_t size)
+	{
+		if (!magic_prefetch_recording || size == 0) return;
+
+		auto path = magic_prefetch_archive_paths.find(lgp_num);
+
+		if (path == magic_prefetch_archive_paths.end())
+		{
+			char name[MAX_PATH]{ 0 };
+			HANDLE file = (HANDLE)_get_osfhandle(_fileno(ff7_externals.lgp_fds[lgp_num]));
+			DWORD length = file != INVALID_HANDLE_VALUE ? GetFinalPathNameByHandleA(file, name, sizeof(name), FILE_NAME_NORMALIZED) : 0;
+
+			path = magic_prefetch_archive_paths.emplace(lgp_num, length > 0 && length < sizeof(name) ? name : "").first;
+		}
+
+		if (path->second.empty()) return;
+
+		auto &ranges = magic_prefetch_recording->archives[path->second];
+
+		if (!ranges.empty() && ranges.back().first + ranges.back().second == offset) ranges.back().second += size;
+		else ranges.emplace_back(offset, size);
+	}
+
+	void magic_prefetch_record_file(const char *path)
+	{
+		if (!magic_prefetch_recording) return;
+
+		std::vector<std::string> &files = magic_prefetch_recording->files;
+
+		if (std::find(files.begin(), files.end(), path) == files.end()) files.emplace_back(path);
+	}
+
+	void magic_prefetch_update()
+	{
+		if (!magic_prefetch_loaded) magic_prefetch_load();
+
+		uint32_t key = magic_prefetch_key();
+
+		if (key == magic_prefetch_last_key) return;
+
+		auto it = magic_prefetch_manifests.find(key);
+
+		if (it == magic_prefetch_manifests.end()) return;
+
+		// Never queue behind a prefetch still running, try again next frame instead
+		if (magic_prefetch_task.valid() && magic_prefetch_task.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+
+		if (trace_all) ffnx_trace("%s: command=%u action=%u\n", __func__, key >> 16, key & 0xFFFF);
+
+		magic_prefetch_task = std::async(std::launch::async, magic_prefetch_run, it->second);
+		magic_prefetch_last_key = key;
+	}
+
 	void magic_thread_start(void (*func)())
 	{
 		ff7_externals.destroy_magic_effects();
 
+		magic_prefetch_manifest manifest;
+		uint32_t key = magic_prefetch_key();
+
+#ifdef PROFILE
+		time_t magicLoadStart;
+		qpc_get_time(&magicLoadStart);
+#endif
+
 		/*
 		* Original function creates a separate thread but the code is not thread
 		* safe in any way! Luckily modern PCs are fast enough to load magic
-		* effects synchronously.
+		* effects synchronously, files already read once are warmed up in the
+		* background by magic_prefetch_update as soon as the action is chosen.
 		*/
+		magic_prefetch_recording = &manifest;
 		func();
+		magic_prefetch_recording = nullptr;
+
+#ifdef PROFILE
+		time_t magicLoadEnd;
+		qpc_get_time(&magicLoadEnd);
+		profile_magic_load = magicLoadEnd - magicLoadStart;
+#endif
+
+		if (!manifest.archives.empty() || !manifest.files.empty())
+		{
+			if (!magic_prefetch_loaded) magic_prefetch_load();
+
+			bool learned = !magic_prefetch_manifests.contains(key);
+
+			magic_prefetch_manifests[key] = std::move(manifest);
+
+			if (learned) magic_prefetch_save();
+		}
 	}
 
 	void load_battle_stage(int param_1, int battle_location_id, int **param_3){
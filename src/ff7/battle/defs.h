@@ -35,6 +35,9 @@ namespace ff7::battle
 
     // Battle
     void magic_thread_start(void (*func)());
+    void magic_prefetch_update();
+    void magic_prefetch_record_lgp(uint32_t lgp_num, uint32_t offset, uint32_t size);
+    void magic_prefetch_record_file(const char *path);
     void load_battle_stage(int param_1, int battle_location_id, int **param_3);
     void battle_sub_5C7F94(int param_1, int param_2);
     void display_battle_action_text_sub_6D71FA(short command_id, short action_id);
@@ -130,11 +130,6 @@ namespace ff7::battle
         this->textureCallIdx = 0;
     }
 
-    uint64_t InterpolationEffectDecorator::getCantorHash(uint32_t x, uint32_t y)
-    {
-        return ((x + y) * (x + y + 1)) / 2 + y;
-    }
-
     void InterpolationEffectDecorator::callEffectFunction(uint32_t function)
     {
         byte wasPaused = *this->isBattlePaused;
@@ -142,7 +137,7 @@ namespace ff7::battle
 
         if(this->frameCounter % this->frequency == 0)
         {
-            this->previousFrameDataMap.clear();
+            this->previousFrameData.clear();
             this->_doInterpolation = false;
             ((void(*)())function)();
             this->textureNumCalls = this->textureCallIdx;
@@ -160,17 +155,18 @@ namespace ff7::battle
 
     void InterpolationEffectDecorator::saveInterpolationData(interpolationable_data &&currData, uint32_t returnAddress)
     {
-        uint64_t hash = this->getCantorHash(returnAddress, this->textureCallIdx);
-        this->previousFrameDataMap[hash] = std::move(currData);
+        uint64_t hash = getCantorHash(returnAddress, this->textureCallIdx);
+        this->previousFrameData.insert(hash, std::move(currData));
     }
 
     void InterpolationEffectDecorator::interpolateRotationMatrix(rotation_matrix* nextRotationMatrix, uint32_t returnAddress)
     {
-        uint64_t hash = this->getCantorHash(returnAddress, this->textureCallIdx);
-        if(this->previousFrameDataMap.contains(hash))
+        uint64_t hash = getCantorHash(returnAddress, this->textureCallIdx);
+        const interpolationable_data *previousData = this->previousFrameData.find(hash);
+        if(previousData)
         {
             int interpolationStep = this->frameCounter % this->frequency;
-            const rotation_matrix &previousMatrix = this->previousFrameDataMap[hash].rot_matrix;
+            const rotation_matrix &previousMatrix = previousData->rot_matrix;
             for(int i = 0; i < 3; i++)
                 for(int j = 0; j < 3; j++)
                     nextRotationMatrix->r3_sub_matrix[i][j] = interpolateValue(previousMatrix.r3_sub_matrix[i][j],nextRotationMatrix->r3_sub_matrix[i][j], interpolationStep, this->frequency);
@@ -182,11 +178,12 @@ namespace ff7::battle
 
     void InterpolationEffectDecorator::interpolateMaterialContext(material_anim_ctx &nextMaterialCtx, uint32_t returnAddress)
     {
-        uint64_t hash = this->getCantorHash(returnAddress, this->textureCallIdx);
-        if(this->previousFrameDataMap.contains(hash))
+        uint64_t hash = getCantorHash(returnAddress, this->textureCallIdx);
+        const interpolationable_data *previousData = this->previousFrameData.find(hash);
+        if(previousData)
         {
             int interpolationStep = this->frameCounter % this->frequency;
-            const material_anim_ctx &previousMaterialCtx = this->previousFrameDataMap[hash].material_ctx;
+            const material_anim_ctx &previousMaterialCtx = previousData->material_ctx;
             nextMaterialCtx.transparency = interpolateValue(previousMaterialCtx.transparency, nextMaterialCtx.transparency, interpolationStep, this->frequency);
             nextMaterialCtx.field_8 = interpolateValue(previousMaterialCtx.field_8, nextMaterialCtx.field_8, interpolationStep, this->frequency);
         }
@@ -194,11 +191,12 @@ namespace ff7::battle
 
     void InterpolationEffectDecorator::interpolateColor(color_ui8 *nextColor, uint32_t returnAddress)
     {
-        uint64_t hash = this->getCantorHash(returnAddress, this->textureCallIdx);
-        if(this->previousFrameDataMap.contains(hash))
+        uint64_t hash = getCantorHash(returnAddress, this->textureCallIdx);
+        const interpolationable_data *previousData = this->previousFrameData.find(hash);
+        if(previousData)
         {
             int interpolationStep = this->frameCounter % this->frequency;
-            const color_ui8 previousColor = this->previousFrameDataMap[hash].color;
+            const color_ui8 previousColor = previousData->color;
             nextColor->b = interpolateValue(previousColor.b, nextColor->b, interpolationStep, this->frequency);
             nextColor->g = interpolateValue(previousColor.g, nextColor->g, interpolationStep, this->frequency);
             nextColor->r = interpolateValue(previousColor.r, nextColor->r, interpolationStep, this->frequency);
@@ -208,11 +206,12 @@ namespace ff7::battle
 
     void InterpolationEffectDecorator::interpolatePalette(palette_extra &nextPalette, uint32_t returnAddress)
     {
-        uint64_t hash = this->getCantorHash(returnAddress, this->textureCallIdx);
-        if(this->previousFrameDataMap.contains(hash))
+        uint64_t hash = getCantorHash(returnAddress, this->textureCallIdx);
+        const interpolationable_data *previousData = this->previousFrameData.find(hash);
+        if(previousData)
         {
             int interpolationStep = this->frameCounter % this->frequency;
-            const palette_extra &previousPalette = this->previousFrameDataMap[hash].palette;
+            const palette_extra &previousPalette = previousData->palette;
             nextPalette.x_offset = interpolateValue(previousPalette.x_offset, nextPalette.x_offset, interpolationStep, this->frequency);
             nextPalette.y_offset = interpolateValue(previousPalette.y_offset, nextPalette.y_offset, interpolationStep, this->frequency);
             nextPalette.z_offset = interpolateValue(previousPalette.z_offset, nextPalette.z_offset, interpolationStep, this->frequency);
@@ -24,9 +24,10 @@
 #pragma once
 
 #include "../../ff7.h"
+#include "interpolation_table.h"
 
 #include <set>
-#include <unordered_map>
+#include <vector>
 #include <memory>
 
 namespace ff7::battle
@@ -113,7 +114,7 @@ namespace ff7::battle
     class InterpolationEffectDecorator: public PauseEffectDecorator
     {
     protected:
-        std::unordered_map<uint64_t, interpolationable_data> previousFrameDataMap;
+        InterpolationDataTable<interpolationable_data> previousFrameData;
         int textureCallIdx;
         int textureNumCalls;
         bool _doInterpolation;
@@ -121,7 +122,6 @@ namespace ff7::battle
     public:
         InterpolationEffectDecorator(int frequency, byte* isBattlePausedExt);
         void callEffectFunction(uint32_t function) override;
-        uint64_t getCantorHash(uint32_t x, uint32_t y);
 
         inline bool doInterpolation(){return _doInterpolation;}
         inline void addTextureIndex(){textureCallIdx++;}
@@ -0,0 +1,138 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace ff7::battle
+{
+    // Key used by the interpolation decorators: Cantor pairing of the caller return address and the call index
+    inline uint64_t getCantorHash(uint32_t x, uint32_t y)
+    {
+        return ((x + y) * (x + y + 1)) / 2 + y;
+    }
+
+    // Open addressing table that keeps its storage between interpolation cycles.
+    // Clearing only bumps the generation counter, so slots stamped with an older generation are considered empty.
+    template<typename T>
+    class InterpolationDataTable
+    {
+    private:
+        struct slot
+        {
+            uint64_t key;
+            uint32_t generation;
+            T data;
+        };
+
+        std::vector<slot> slots;
+        size_t mask;
+        size_t count = 0;
+        uint32_t generation = 1;
+
+        static size_t hashKey(uint64_t key)
+        {
+            // Cantor hashes of nearby return addresses are clustered, spread them before masking
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdULL;
+            key ^= key >> 33;
+            return size_t(key);
+        }
+
+        slot& findSlot(uint64_t key)
+        {
+            size_t idx = hashKey(key) & this->mask;
+
+            while (this->slots[idx].generation == this->generation && this->slots[idx].key != key)
+                idx = (idx + 1) & this->mask;
+
+            return this->slots[idx];
+        }
+
+        void grow()
+        {
+            std::vector<slot> oldSlots = std::move(this->slots);
+
+            this->slots.clear();
+            this->slots.resize(oldSlots.size() * 2);
+            this->mask = this->slots.size() - 1;
+
+            for (slot &oldSlot : oldSlots)
+            {
+                if (oldSlot.generation != this->generation) continue;
+
+                slot &newSlot = this->findSlot(oldSlot.key);
+                newSlot = std::move(oldSlot);
+            }
+        }
+
+    public:
+        InterpolationDataTable(size_t initialCapacity = 256)
+        {
+            size_t capacity = 16;
+            while (capacity < initialCapacity) capacity <<= 1;
+
+            this->slots.resize(capacity);
+            this->mask = capacity - 1;
+        }
+
+        void clear()
+        {
+            this->count = 0;
+            this->generation++;
+
+            // On wrap around stale stamps could match again, reset them all once
+            if (this->generation == 0)
+            {
+                for (slot &s : this->slots) s.generation = 0;
+                this->generation = 1;
+            }
+        }
+
+        T* find(uint64_t key)
+        {
+            slot &s = this->findSlot(key);
+
+            return s.generation == this->generation ? &s.data : nullptr;
+        }
+
+        void insert(uint64_t key, T &&data)
+        {
+            // Keep the load factor under 50% so probe chains stay short
+            if ((this->count + 1) * 2 > this->slots.size()) this->grow();
+
+            slot &s = this->findSlot(key);
+            if (s.generation != this->generation)
+            {
+                s.key = key;
+                s.generation = this->generation;
+                this->count++;
+            }
+            s.data = std::move(data);
+        }
+
+        inline size_t size() const {return count;}
+        inline size_t capacity() const {return slots.size();}
+    };
+}
@@ -136,3 +136,5 @@ void field_text_box_window_paging_631945_jp(short);
 void field_text_box_window_opening_6317A9_jp(short);
 int sub_6F54A2_jp(byte *a1);
 void name_input_jp_install();
+void ff7_multibyte_tuning_flip();
+void ff7_multibyte_tuning_shutdown();
@@ -31,6 +31,7 @@
 #include "defs.h"
 #include "utils.h"
 #include "camera.h"
+#include "layer_tiles.h"
 
 #include <functional>
 
@@ -38,6 +39,17 @@ namespace ff7::field
 {
     constexpr float MIN_STEP_INVERSE = 10.f;
 
+    static FieldLayerTiles<field_tile> field_layers_tiles[4];
+
+    FieldLayerTiles<field_tile>& field_layer_get_tiles(int layer, field_tile* tiles, uint32_t* palette_sort, uint32_t tiles_num)
+    {
+        FieldLayerTiles<field_tile>& layer_tiles = field_layers_tiles[layer - 1];
+
+        layer_tiles.update(layer, *ff7_externals.field_id, tiles, palette_sort, tiles_num);
+
+        return layer_tiles;
+    }
+
     // ##################################################################
     // ----------------- DRAW GRAPHICS RELATED --------------------------
     // ##################################################################
@@ -65,15 +77,20 @@ namespace ff7::field
         if(*ff7_externals.field_special_y_offset > 0 && bg_position.y <= 6)
             initial_pos.y -= field_bg_multiplier * (*ff7_externals.field_special_y_offset);
 
-        for(int i = 0; i < *ff7_externals.field_layer1_tiles_num; i++)
+        auto& layer_tiles = field_layer_get_tiles(1, layer1_tiles, *ff7_externals.field_layer1_palette_sort, *ff7_externals.field_layer1_tiles_num);
+
+        for(const auto& page : layer_tiles.pages())
         {
-            uint32_t tile_index = (*ff7_externals.field_layer1_palette_sort)[i];
-            layer1_tiles[tile_index].field_1044 = 1;
+            for(const auto& entry : page.entries)
+            {
+                field_tile& tile = *entry.tile;
 
-            tile_position.x = initial_pos.x + field_bg_multiplier * layer1_tiles[tile_index].x;
-            tile_position.y = initial_pos.y + field_bg_multiplier * layer1_tiles[tile_index].y;
-            ff7_externals.add_page_tile(tile_position.x, tile_position.y, 0.9997, layer1_tiles[tile_index].u,
-                                        layer1_tiles[tile_index].v, layer1_tiles[tile_index].palette_index, layer1_tiles[tile_index].page);
+                tile.field_1044 = 1;
+
+                tile_position.x = initial_pos.x + field_bg_multiplier * entry.x;
+                tile_position.y = initial_pos.y + field_bg_multiplier * entry.y;
+                ff7_externals.add_page_tile(tile_position.x, tile_position.y, 0.9997, tile.u, tile.v, tile.palette_index, layer_tiles.tilePage(page, tile));
+            }
         }
     }
 
@@ -99,27 +116,26 @@ namespace ff7::field
         if(*ff7_externals.field_special_y_offset > 0 && bg_position.y <= 8)
             initial_pos.y -= (*ff7_externals.field_special_y_offset) * field_bg_multiplier;
 
-        for(int i = 0; i < *ff7_externals.field_layer2_tiles_num; i++)
-        {
-            uint32_t tile_index = (*ff7_externals.field_layer2_palette_sort)[i];
-            vector2<float> tile_position;
+        auto& layer_tiles = field_layer_get_tiles(2, layer2_tiles, *ff7_externals.field_layer2_palette_sort, *ff7_externals.field_layer2_tiles_num);
 
-            char anim_group = layer2_tiles[tile_index].anim_group;
-            if(anim_group && !(ff7_externals.modules_global_object->background_sprite_layer[anim_group] & layer2_tiles[tile_index].anim_bitmask))
-                continue;
+        for(const auto& page : layer_tiles.pages())
+        {
+            for(const auto& entry : page.entries)
+            {
+                vector2<float> tile_position;
 
-            layer2_tiles[tile_index].field_1040 = 1;
+                if(entry.anim_group && !(ff7_externals.modules_global_object->background_sprite_layer[entry.anim_group] & entry.anim_bitmask))
+                    continue;
 
-            tile_position.x = layer2_tiles[tile_index].x * field_bg_multiplier + initial_pos.x;
-            tile_position.y = layer2_tiles[tile_index].y * field_bg_multiplier + initial_pos.y;
+                field_tile& tile = *entry.tile;
 
-            uint32_t page = (layer2_tiles[tile_index].use_fx_page) ? layer2_tiles[tile_index].fx_page : layer2_tiles[tile_index].page;
+                tile.field_1040 = 1;
 
-            if(layer2_tiles[tile_index].use_fx_page && layer2_tiles[tile_index].blend_mode == 2) page += 14;
-            if(layer2_tiles[tile_index].use_fx_page && layer2_tiles[tile_index].blend_mode == 3) page += 18;
+                tile_position.x = entry.x * field_bg_multiplier + initial_pos.x;
+                tile_position.y = entry.y * field_bg_multiplier + initial_pos.y;
 
-            ff7_externals.add_page_tile(tile_position.x, tile_position.y, layer2_tiles[tile_index].z, layer2_tiles[tile_index].u,
-                                        layer2_tiles[tile_index].v, layer2_tiles[tile_index].palette_index, page);
+                ff7_externals.add_page_tile(tile_position.x, tile_position.y, tile.z, tile.u, tile.v, tile.palette_index, layer_tiles.tilePage(page, tile));
+            }
         }
     }
 
@@ -176,30 +192,29 @@ namespace ff7::field
         const int top_offset = 256 + (enable_uncrop ? 8 : 0);
         const int bottom_offset = enable_uncrop ? 8 : 0;
 
-        for(int i = 0; i < *ff7_externals.field_layer3_tiles_num; i++)
+        auto& layer_tiles = field_layer_get_tiles(3, layer3_tiles, *ff7_externals.field_layer3_palette_sort, *ff7_externals.field_layer3_tiles_num);
+
+        for(const auto& page : layer_tiles.pages())
         {
-            uint32_t tile_index = (*ff7_externals.field_layer3_palette_sort)[i];
-            vector2<float> tile_position = {
-                static_cast<float>(layer3_tiles[tile_index].x),
-                static_cast<float>(layer3_tiles[tile_index].y)
-            };
+            for(const auto& entry : page.entries)
+            {
+                vector2<float> tile_position = { entry.x, entry.y };
 
-            field_layer3_shift_tile_position(&tile_position, &bg_position, layer3_width, layer3_height);
+                field_layer3_shift_tile_position(&tile_position, &bg_position, layer3_width, layer3_height);
 
-            char anim_group = layer3_tiles[tile_index].anim_group;
-            if(tile_position.x <= bg_position.x - left_offset || tile_position.x >= bg_position.x + right_offset ||
-                tile_position.y <= bg_position.y - top_offset || tile_position.y >= bg_position.y + bottom_offset ||
-                (anim_group && !(ff7_externals.modules_global_object->background_sprite_layer[anim_group] & layer3_tiles[tile_index].anim_bitmask)))
-                continue;
+                if(tile_position.x <= bg_position.x - left_offset || tile_position.x >= bg_position.x + right_offset ||
+                    tile_position.y <= bg_position.y - top_offset || tile_position.y >= bg_position.y + bottom_offset ||
+                    (entry.anim_group && !(ff7_externals.modules_global_object->background_sprite_layer[entry.anim_group] & entry.anim_bitmask)))
+                    continue;
 
-            layer3_tiles[tile_index].field_1040 = 1;
-            tile_position.x = tile_position.x * field_bg_multiplier + initial_pos.x;
-            tile_position.y = tile_position.y * field_bg_multiplier + initial_pos.y;
+                field_tile& tile = *entry.tile;
 
-            uint32_t page = (layer3_tiles[tile_index].use_fx_page) ? layer3_tiles[tile_index].fx_page : layer3_tiles[tile_index].page;
+                tile.field_1040 = 1;
+                tile_position.x = tile_position.x * field_bg_multiplier + initial_pos.x;
+                tile_position.y = tile_position.y * field_bg_multiplier + initial_pos.y;
 
-            ff7_externals.add_page_tile(tile_position.x, tile_position.y, z_value, layer3_tiles[tile_index].u,
-                                        layer3_tiles[tile_index].v, layer3_tiles[tile_index].palette_index, page);
+                ff7_externals.add_page_tile(tile_position.x, tile_position.y, z_value, tile.u, tile.v, tile.palette_index, layer_tiles.tilePage(page, tile));
+            }
         }
 
         if(widescreen_enabled || enable_uncrop)
@@ -216,30 +231,30 @@ namespace ff7::field
 
             for(vector2<int> tile_offset: tile_offsets)
             {
-                for(int i = 0; i < *ff7_externals.field_layer3_tiles_num; i++)
+                for(const auto& page : layer_tiles.pages())
                 {
-                    uint32_t tile_index = (*ff7_externals.field_layer3_palette_sort)[i];
-                    vector2<float> tile_position = {
-                        static_cast<float>(layer3_tiles[tile_index].x + tile_offset.x),
-                        static_cast<float>(layer3_tiles[tile_index].y + tile_offset.y)
-                    };
+                    for(const auto& entry : page.entries)
+                    {
+                        vector2<float> tile_position = {
+                            entry.x + tile_offset.x,
+                            entry.y + tile_offset.y
+                        };
 
-                    field_layer3_shift_tile_position(&tile_position, &bg_position, layer3_width, layer3_height);
+                        field_layer3_shift_tile_position(&tile_position, &bg_position, layer3_width, layer3_height);
 
-                    char anim_group = layer3_tiles[tile_index].anim_group;
-                    if(tile_position.x <= bg_position.x - left_offset || tile_position.x >= bg_position.x + right_offset ||
-                        tile_position.y <= bg_position.y - top_offset || tile_position.y >= bg_position.y + bottom_offset ||
-                        (anim_group && !(ff7_externals.modules_global_object->background_sprite_layer[anim_group] & layer3_tiles[tile_index].anim_bitmask)))
-                        continue;
+                        if(tile_position.x <= bg_position.x - left_offset || tile_position.x >= bg_position.x + right_offset ||
+                            tile_position.y <= bg_position.y - top_offset || tile_position.y >= bg_position.y + bottom_offset ||
+                            (entry.anim_group && !(ff7_externals.modules_global_object->background_sprite_layer[entry.anim_group] & entry.anim_bitmask)))
+                            continue;
 
-                    layer3_tiles[tile_index].field_1040 = 1;
-                    tile_position.x = tile_position.x * field_bg_multiplier + initial_pos.x;
-                    tile_position.y = tile_position.y * field_bg_multiplier + initial_pos.y;
+                        field_tile& tile = *entry.tile;
 
-                    uint32_t page = (layer3_tiles[tile_index].use_fx_page) ? layer3_tiles[tile_index].fx_page : layer3_tiles[tile_index].page;
+                        tile.field_1040 = 1;
+                        tile_position.x = tile_position.x * field_bg_multiplier + initial_pos.x;
+                        tile_position.y = tile_position.y * field_bg_multiplier + initial_pos.y;
 
-                    ff7_externals.add_page_tile(tile_position.x, tile_position.y, z_value, layer3_tiles[tile_index].u,
-                                                layer3_tiles[tile_index].v, layer3_tiles[tile_index].palette_index, page);
+                        ff7_externals.add_page_tile(tile_position.x, tile_position.y, z_value, tile.u, tile.v, tile.palette_index, layer_tiles.tilePage(page, tile));
+                    }
                 }
             }
         }
@@ -298,31 +313,29 @@ namespace ff7::field
             const int top_offset = 256 + (enable_uncrop ? 8 : 0);
             const int bottom_offset = enable_uncrop ? 8 : 0;
 
-            for(int i = 0; i < *ff7_externals.field_layer4_tiles_num; i++)
+            auto& layer_tiles = field_layer_get_tiles(4, layer4_tiles, *ff7_externals.field_layer4_palette_sort, *ff7_externals.field_layer4_tiles_num);
+
+            for(const auto& page : layer_tiles.pages())
             {
-                uint32_t tile_index = (*ff7_externals.field_layer4_palette_sort)[i];
-                vector2<float> tile_position = {
-                    static_cast<float>(layer4_tiles[tile_index].x),
-                    static_cast<float>(layer4_tiles[tile_index].y)
-                };
+                for(const auto& entry : page.entries)
+                {
+                    vector2<float> tile_position = { entry.x, entry.y };
 
-                field_layer4_shift_tile_position(&tile_position, &bg_position, layer4_width, layer4_height);
+                    field_layer4_shift_tile_position(&tile_position, &bg_position, layer4_width, layer4_height);
 
-                char anim_group = layer4_tiles[tile_index].anim_group;
-                if(tile_position.x <= bg_position.x - left_offset || tile_position.x >= bg_position.x + right_offset ||
-                    tile_position.y <= bg_position.y - top_offset || tile_position.y >= bg_position.y + bottom_offset ||
-                    (anim_group && !(ff7_externals.modules_global_object->background_sprite_layer[anim_group] & layer4_tiles[tile_index].anim_bitmask)))
-                    continue;
+                    if(tile_position.x <= bg_position.x - left_offset || tile_position.x >= bg_position.x + right_offset ||
+                        tile_position.y <= bg_position.y - top_offset || tile_position.y >= bg_position.y + bottom_offset ||
+                        (entry.anim_group && !(ff7_externals.modules_global_object->background_sprite_layer[entry.anim_group] & entry.anim_bitmask)))
+                        continue;
 
-                layer4_tiles[tile_index].field_1040 = 1;
-                tile_position.x = tile_position.x * field_bg_multiplier + initial_pos.x;
-                tile_position.y = tile_position.y * field_bg_multiplier + initial_pos.y;
+                    field_tile& tile = *entry.tile;
 
-                if(!*ff7_externals.field_layer_CFF1D8 || layer4_tiles[tile_index].palette_index != (*ff7_externals.field_palette_D00088) + 1)
-                {
-                    uint32_t page = (layer4_tiles[tile_index].use_fx_page) ? layer4_tiles[tile_index].fx_page : layer4_tiles[tile_index].page;
-                    ff7_externals.add_page_tile(tile_position.x, tile_position.y, z_value, layer4_tiles[tile_index].u,
-                                                layer4_tiles[tile_index].v, layer4_tiles[tile_index].palette_index, page);
+                    tile.field_1040 = 1;
+                    tile_position.x = tile_position.x * field_bg_multiplier + initial_pos.x;
+                    tile_position.y = tile_position.y * field_bg_multiplier + initial_pos.y;
+
+                    if(!*ff7_externals.field_layer_CFF1D8 || tile.palette_index != (*ff7_externals.field_palette_D00088) + 1)
+                        ff7_externals.add_page_tile(tile_position.x, tile_position.y, z_value, tile.u, tile.v, tile.palette_index, layer_tiles.tilePage(page, tile));
                 }
             }
 
@@ -338,31 +351,30 @@ namespace ff7::field
                     tile_offsets.push_back(vector2<int>{layer4_width / 2, layer4_height / 2});
                 }
                 for(vector2<int> tile_offset: tile_offsets){
-                    for(int i = 0; i < *ff7_externals.field_layer4_tiles_num; i++)
+                    for(const auto& page : layer_tiles.pages())
                     {
-                        uint32_t tile_index = (*ff7_externals.field_layer4_palette_sort)[i];
-                        vector2<float> tile_position = {
-                            static_cast<float>(layer4_tiles[tile_index].x + tile_offset.x),
-                            static_cast<float>(layer4_tiles[tile_index].y + tile_offset.y)
-                        };
+                        for(const auto& entry : page.entries)
+                        {
+                            vector2<float> tile_position = {
+                                entry.x + tile_offset.x,
+                                entry.y + tile_offset.y
+                            };
 
-                        field_layer4_shift_tile_position(&tile_position, &bg_position, layer4_width, layer4_height);
+                            field_layer4_shift_tile_position(&tile_position, &bg_position, layer4_width, layer4_height);
 
-                        char anim_group = layer4_tiles[tile_index].anim_group;
-                        if(tile_position.x <= bg_position.x - left_offset || tile_position.x >= bg_position.x + right_offset ||
-                            tile_position.y <= bg_position.y - top_offset || tile_position.y >= bg_position.y + bottom_offset ||
-                            (anim_group && !(ff7_externals.modules_global_object->background_sprite_layer[anim_group] & layer4_tiles[tile_index].anim_bitmask)))
-                            continue;
+                            if(tile_position.x <= bg_position.x - left_offset || tile_position.x >= bg_position.x + right_offset ||
+                                tile_position.y <= bg_position.y - top_offset || tile_position.y >= bg_position.y + bottom_offset ||
+                                (entry.anim_group && !(ff7_externals.modules_global_object->background_sprite_layer[entry.anim_group] & entry.anim_bitmask)))
+                                continue;
 
-                        layer4_tiles[tile_index].field_1040 = 1;
-                        tile_position.x = tile_position.x * field_bg_multiplier + initial_pos.x;
-                        tile_position.y = tile_position.y * field_bg_multiplier + initial_pos.y;
+                            field_tile& tile = *entry.tile;
 
-                        if(!*ff7_externals.field_layer_CFF1D8 || layer4_tiles[tile_index].palette_index != (*ff7_externals.field_palette_D00088) + 1)
-                        {
-                            uint32_t page = (layer4_tiles[tile_index].use_fx_page) ? layer4_tiles[tile_index].fx_page : layer4_tiles[tile_index].page;
-                            ff7_externals.add_page_tile(tile_position.x, tile_position.y, z_value, layer4_tiles[tile_index].u,
-                                                        layer4_tiles[tile_index].v, layer4_tiles[tile_index].palette_index, page);
+                            tile.field_1040 = 1;
+                            tile_position.x = tile_position.x * field_bg_multiplier + initial_pos.x;
+                            tile_position.y = tile_position.y * field_bg_multiplier + initial_pos.y;
+
+                            if(!*ff7_externals.field_layer_CFF1D8 || tile.palette_index != (*ff7_externals.field_palette_D00088) + 1)
+                                ff7_externals.add_page_tile(tile_position.x, tile_position.y, z_value, tile.u, tile.v, tile.palette_index, layer_tiles.tilePage(page, tile));
                         }
                     }
                 }
@@ -0,0 +1,144 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//    Copyright (C) 2023 Cosmos                                             //
+//    Copyright (C) 2023 Tang-Tang Zhou                                     //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace ff7::field
+{
+    // Texture page a tile of the given background layer is drawn on
+    template<typename Tile>
+    uint32_t field_layer_tile_page(int layer, const Tile& tile)
+    {
+        if(layer == 1) return tile.page;
+
+        uint32_t page = tile.use_fx_page ? tile.fx_page : tile.page;
+
+        if(layer == 2 && tile.use_fx_page && tile.blend_mode == 2) page += 14;
+        if(layer == 2 && tile.use_fx_page && tile.blend_mode == 3) page += 18;
+
+        return page;
+    }
+
+    // Tiles of a background layer split per texture page, built once per field.
+    // Every page is a vertex buffer of its own in the game, so only the order of the tiles within a page matters:
+    // each page keeps the palette sort order, and the layer is drawn one page after the other.
+    // Position and animation group are kept per tile. Depth, UV, palette and page are read from the game tiles when
+    // drawing, the game may change them while the field is loaded.
+    template<typename Tile>
+    class FieldLayerTiles
+    {
+    public:
+        struct Entry
+        {
+            Tile* tile;
+            float x;
+            float y;
+            char anim_group;
+            char anim_bitmask;
+        };
+
+        struct Page
+        {
+            uint32_t page;
+            std::vector<Entry> entries;
+        };
+
+        // Rebuilds the pages when the field or its tile table changed, or when a tile was drawn on another page
+        void update(int layer, uint32_t field_id, Tile* tiles, const uint32_t* palette_sort, uint32_t tiles_num)
+        {
+            if(stale || this->layer != layer || this->field_id != field_id || this->tiles != tiles || this->palette_sort != palette_sort || this->tiles_num != tiles_num)
+            {
+                this->layer = layer;
+                this->field_id = field_id;
+                this->tiles = tiles;
+                this->palette_sort = palette_sort;
+                this->tiles_num = tiles_num;
+                build();
+            }
+        }
+
+        const std::vector<Page>& pages() const { return pageList; }
+
+        // Page to draw a tile of the given page on. A tile the game moved to another page is drawn there right away,
+        // and gets its place in the palette order of that page at the next update.
+        uint32_t tilePage(const Page& page, const Tile& tile)
+        {
+            uint32_t page_id = field_layer_tile_page(layer, tile);
+
+            if(page_id != page.page) stale = true;
+
+            return page_id;
+        }
+
+        uint32_t rebuilds() const { return rebuildCount; }
+
+    private:
+        int layer = 0;
+        uint32_t field_id = UINT32_MAX;
+        Tile* tiles = nullptr;
+        const uint32_t* palette_sort = nullptr;
+        uint32_t tiles_num = 0;
+        bool stale = false;
+        uint32_t rebuildCount = 0;
+        std::vector<Page> pageList;
+
+        void build()
+        {
+            // Buffers are kept, a field has a few dozen pages at most
+            for(Page& page : pageList) page.entries.clear();
+
+            for(uint32_t i = 0; i < tiles_num; i++)
+            {
+                Tile& tile = tiles[palette_sort[i]];
+                uint32_t page_id = field_layer_tile_page(layer, tile);
+                Page* page = nullptr;
+
+                for(Page& candidate : pageList)
+                {
+                    if(candidate.page == page_id)
+                    {
+                        page = &candidate;
+                        break;
+                    }
+                }
+
+                if(page == nullptr)
+                {
+                    pageList.push_back(Page{ page_id });
+                    page = &pageList.back();
+                }
+
+                page->entries.push_back(Entry{ &tile, float(tile.x), float(tile.y), tile.anim_group, tile.anim_bitmask });
+            }
+
+            // Pages left over from the previous field
+            std::erase_if(pageList, [](const Page& page) { return page.entries.empty(); });
+
+            stale = false;
+            rebuildCount++;
+        }
+    };
+}
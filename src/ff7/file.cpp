@@ -22,10 +22,15 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <io.h>
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <unordered_set>
 
 #include "../ff7.h"
 #include "../log.h"
 #include "../redirect.h"
+#include "battle/defs.h"
 
 FILE *open_lgp_file(char *filename, uint32_t mode)
 {
@@ -42,12 +47,16 @@ FILE *open_lgp_file(char *filename, uint32_t mode)
 	return fopen(_filename, "rb");
 }
 
+void lgp_unmap_archive(FILE *fd);
+
 void close_lgp_file(FILE *fd)
 {
 	if(!fd) return;
 
 	if(trace_all || trace_files) ffnx_trace("closing lgp file\n");
 
+	lgp_unmap_archive(fd);
+
 	fclose(fd);
 }
 
@@ -95,110 +104,229 @@ char lgp_current_dir[256];
 
 uint32_t use_files_array = true;
 
-int lgp_lookup_value(unsigned char c)
+// Size of the window mapped for each archive, bounds the address space used by the archives
+#define LGP_VIEW_SIZE (4 * 1024 * 1024)
+
+// Memory mapped window and TOC index of an LGP archive opened by the game
+struct lgp_archive
 {
-	c = tolower(c);
+	FILE *fd;
+	HANDLE mapping;
+	const char *view;
+	uint32_t view_offset;
+	uint32_t view_size;
+	uint32_t size;
+	uint32_t position;
+	FILE *indexed_fd;
+	struct lgp_toc_index toc_index;
+};
 
-	if(c == '.') return -1;
+struct lgp_archive lgp_archives[sizeof(lgp_names) / sizeof(*lgp_names)];
+
+// Every file in the direct mode path, relative lowercase paths with forward slashes
+std::unordered_set<std::string> direct_mode_files;
+bool direct_mode_files_scanned = false;
+
+void lgp_scan_direct_mode()
+{
+	std::filesystem::path root = std::filesystem::path(basedir) / direct_mode_path;
+	std::error_code ec;
 
-	if(c < 'a' && c >= '0' && c <= '9') c += 'a' - '0';
+	direct_mode_files_scanned = true;
 
-	if(c == '_') c = 'k';
-	if(c == '-') c = 'l';
+	for(auto it = std::filesystem::recursive_directory_iterator(root, std::filesystem::directory_options::skip_permission_denied | std::filesystem::directory_options::follow_directory_symlink, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+	{
+		if(it->is_regular_file(ec)) direct_mode_files.insert(lgp_make_key(it->path().lexically_relative(root).generic_string().c_str()));
+	}
 
-	return c - 'a';
+	if(trace_all || trace_direct) ffnx_trace("%s: %u files found in %s\n", __func__, direct_mode_files.size(), root.string().c_str());
 }
 
-uint32_t lgp_chdir(char *path)
+// open a file relative to the direct mode path, without touching the disk when it does not exist
+FILE *lgp_open_direct_file(char *out, size_t size, const char *relative_path)
 {
-	while(path[0] == '/' || path[0] == '\\') path++;
+	if(!direct_mode_files_scanned) lgp_scan_direct_mode();
 
-	uint32_t len = strlen(path);
+	_snprintf(out, size, "%s/%s/%s", basedir, direct_mode_path.c_str(), relative_path);
 
-	while(len > 0 && (path[len - 1] == '/' || path[len - 1] == '\\')) len--;
+	if(!direct_mode_files.contains(lgp_make_key(relative_path))) return 0;
 
-	memcpy(lgp_current_dir, path, len);
-	lgp_current_dir[len] = 0;
+	return fopen(out, "rb");
+}
 
-	return true;
+void lgp_release_archive(struct lgp_archive *archive)
+{
+	if(archive->view) UnmapViewOfFile(archive->view);
+	if(archive->mapping) CloseHandle(archive->mapping);
+
+	archive->fd = 0;
+	archive->mapping = 0;
+	archive->view = 0;
+	archive->view_offset = 0;
+	archive->view_size = 0;
+	archive->size = 0;
+	archive->position = 0;
 }
 
-// original LGP open file logic, unchanged except for the LGP Tools safety net
-uint32_t original_lgp_open_file(char *filename, uint32_t lgp_num, struct lgp_file *ret)
+void lgp_unmap_archive(FILE *fd)
 {
-	uint32_t lookup_value1 = lgp_lookup_value(filename[0]);
-	uint32_t lookup_value2 = lgp_lookup_value(filename[1]) + 1;
-	struct lookup_table_entry *lookup_table = ff7_externals.lgp_lookup_tables[lgp_num];
-	uint32_t toc_offset = lookup_table[lookup_value1 * 30 + lookup_value2].toc_offset;
-	uint32_t i;
-
-	// did we find anything in the lookup table?
-	if(toc_offset)
+	for(struct lgp_archive &archive : lgp_archives)
 	{
-		uint32_t num_files = lookup_table[lookup_value1 * 30 + lookup_value2].num_files;
+		if(archive.fd != fd && archive.indexed_fd != fd) continue;
 
-		// look for our file
-		for(i = 0; i < num_files; i++)
-		{
-			struct lgp_toc_entry *toc_entry = &ff7_externals.lgp_tocs[lgp_num * 2][toc_offset + i - 1];
+		lgp_release_archive(&archive);
+		archive.indexed_fd = 0;
+		archive.toc_index.clear();
+	}
+}
 
-			if(!_stricmp(toc_entry->name, filename))
-			{
-				if(!toc_entry->conflict)
-				{
-					// this is the only file with this name, we're done here
-					ret->is_lgp_offset = true;
-					ret->offset = toc_entry->offset;
-					return true;
-				}
-				else
-				{
-					struct conflict_list *conflict = &ff7_externals.lgp_folders[lgp_num].conflicts[toc_entry->conflict - 1];
-					struct conflict_entry *conflict_entries = conflict->conflict_entries;
-					uint32_t num_conflicts = conflict->num_conflicts;
-
-					// there are multiple files with this name, look for our
-					// current directory in the conflict table
-					for(i = 0; i < num_conflicts; i++)
-					{
-						if(!_stricmp(conflict_entries[i].name, lgp_current_dir))
-						{
-							struct lgp_toc_entry *toc_entry = &ff7_externals.lgp_tocs[lgp_num * 2][conflict_entries[i].toc_index];
-
-							// file name and directory matches, this is our file
-							ret->is_lgp_offset = true;
-							ret->offset = toc_entry->offset;
-							ret->resolved_conflict = true;
-							return true;
-						}
-					}
+// create a file mapping of the archive so reads do not need any syscall, returns 0 if the archive cannot be mapped
+struct lgp_archive *lgp_map_archive(uint32_t lgp_num)
+{
+	FILE *fd = ff7_externals.lgp_fds[lgp_num];
+	struct lgp_archive *archive = &lgp_archives[lgp_num];
 
-					break;
-				}
-			}
-		}
-	}
+	if(!fd) return 0;
 
-	// one last chance, the lookup table might have been broken by LGP Tools,
-	// search through the entire archive
-	for(i = 0; i < ((uint32_t *)ff7_externals.lgp_tocs)[lgp_num * 2 + 1]; i++)
+	if(archive->fd != fd)
 	{
-		struct lgp_toc_entry *toc_entry = &ff7_externals.lgp_tocs[lgp_num * 2][i];
+		lgp_release_archive(archive);
+
+		archive->fd = fd;
 
-		if(!_stricmp(toc_entry->name, filename))
+		HANDLE file = (HANDLE)_get_osfhandle(_fileno(fd));
+		LARGE_INTEGER size;
+
+		if(file != INVALID_HANDLE_VALUE && GetFileSizeEx(file, &size) && size.HighPart == 0 && size.LowPart > 0)
 		{
-			ffnx_glitch("broken LGP file (%s), don't use LGP Tools!\n", lgp_names[lgp_num]);
+			archive->mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
 
-			if(!toc_entry->conflict)
-			{
-				ret->is_lgp_offset = true;
-				ret->offset = toc_entry->offset;
-				return true;
-			}
+			if(archive->mapping) archive->size = size.LowPart;
 		}
+
+		if(!archive->mapping) ffnx_warning("%s: cannot map %s archive in memory, fallback to file reads\n", __func__, lgp_names[lgp_num]);
+	}
+
+	return archive->mapping ? archive : 0;
+}
+
+// pointer to size bytes at offset, moving the mapped window if needed, returns 0 when the range does not fit in a window
+const char *lgp_archive_view(struct lgp_archive *archive, uint32_t offset, uint32_t size)
+{
+	static uint32_t granularity = 0;
+
+	if(offset >= archive->view_offset && offset + size <= archive->view_offset + archive->view_size) return archive->view + (offset - archive->view_offset);
+
+	if(!granularity)
+	{
+		SYSTEM_INFO info;
+
+		GetSystemInfo(&info);
+		granularity = info.dwAllocationGranularity;
 	}
 
-	return false;
+	uint32_t view_offset = offset - offset % granularity;
+
+	if(offset - view_offset + size > LGP_VIEW_SIZE) return 0;
+
+	if(archive->view) UnmapViewOfFile(archive->view);
+
+	archive->view_offset = view_offset;
+	archive->view_size = std::min<uint32_t>(LGP_VIEW_SIZE, archive->size - view_offset);
+	archive->view = (const char *)MapViewOfFile(archive->mapping, FILE_MAP_READ, 0, view_offset, archive->view_size);
+
+	if(!archive->view)
+	{
+		archive->view_offset = 0;
+		archive->view_size = 0;
+
+		return 0;
+	}
+
+	return archive->view + (offset - view_offset);
+}
+
+// read from the current position of the LGP archive
+uint32_t lgp_read_archive(uint32_t lgp_num, char *dest, uint32_t size)
+{
+	struct lgp_archive *archive = lgp_map_archive(lgp_num);
+
+	if(!archive)
+	{
+		size = fread(dest, 1, size, ff7_externals.lgp_fds[lgp_num]);
+		stats.file_read_bytes += size;
+		return size;
+	}
+
+	size = std::min(size, archive->position < archive->size ? archive->size - archive->position : 0);
+
+	if(!size) return 0;
+
+	ff7::battle::magic_prefetch_record_lgp(lgp_num, archive->position, size);
+
+	const char *source = lgp_archive_view(archive, archive->position, size);
+
+	if(source) memcpy(dest, source, size);
+	else
+	{
+		// larger than a window
+		fseek(archive->fd, archive->position, SEEK_SET);
+		size = fread(dest, 1, size, archive->fd);
+	}
+
+	stats.file_read_bytes += size;
+	archive->position += size;
+
+	return size;
+}
+
+// parse the TOC of the archive once, loaded by the game
+struct lgp_archive *lgp_index_archive(uint32_t lgp_num)
+{
+	struct lgp_archive *archive = &lgp_archives[lgp_num];
+
+	if(archive->indexed_fd == ff7_externals.lgp_fds[lgp_num] && !archive->toc_index.first.empty()) return archive;
+
+	uint32_t num_files = ((uint32_t *)ff7_externals.lgp_tocs)[lgp_num * 2 + 1];
+
+	archive->indexed_fd = ff7_externals.lgp_fds[lgp_num];
+	archive->toc_index.build(ff7_externals.lgp_tocs[lgp_num * 2], num_files);
+
+	if(trace_all || trace_files) ffnx_trace("%s: %s indexed with %u files\n", __func__, lgp_names[lgp_num], num_files);
+
+	return archive;
+}
+
+uint32_t lgp_chdir(char *path)
+{
+	while(path[0] == '/' || path[0] == '\\') path++;
+
+	uint32_t len = strlen(path);
+
+	while(len > 0 && (path[len - 1] == '/' || path[len - 1] == '\\')) len--;
+
+	memcpy(lgp_current_dir, path, len);
+	lgp_current_dir[len] = 0;
+
+	return true;
+}
+
+// original LGP open file logic, using the TOC index instead of scanning the lookup table
+uint32_t original_lgp_open_file(char *filename, uint32_t lgp_num, struct lgp_file *ret)
+{
+	struct lgp_archive *archive = lgp_index_archive(lgp_num);
+	struct lgp_lookup lookup = lgp_find_file(archive->toc_index, filename, ff7_externals.lgp_tocs[lgp_num * 2],
+		ff7_externals.lgp_lookup_tables[lgp_num], ff7_externals.lgp_folders[lgp_num].conflicts, lgp_current_dir);
+
+	if(lookup.broken_lookup_table) ffnx_glitch("broken LGP file (%s), don't use LGP Tools!\n", lgp_names[lgp_num]);
+
+	if(lookup.toc_index < 0) return false;
+
+	ret->is_lgp_offset = true;
+	ret->offset = ff7_externals.lgp_tocs[lgp_num * 2][lookup.toc_index].offset;
+	ret->resolved_conflict = lookup.resolved_conflict;
+
+	return true;
 }
 
 // new LGP open file logic with modpath and direct mode support
@@ -206,6 +334,9 @@ struct lgp_file *lgp_open_file(char *filename, uint32_t lgp_num)
 {
 	struct lgp_file *ret = (lgp_file*)external_calloc(sizeof(*ret), 1);
 	char tmp[512 + sizeof(basedir)];
+
+	stats.file_opens++;
+	char relative_path[512];
 	char _fname[_MAX_FNAME];
 	char *fname = _fname;
 	char ext[_MAX_EXT];
@@ -215,13 +346,13 @@ struct lgp_file *lgp_open_file(char *filename, uint32_t lgp_num)
 
 	if(!direct_mode_path.empty())
 	{
-		_snprintf(tmp, sizeof(tmp), "%s/%s/%s/%s%s", basedir, direct_mode_path.c_str(), lgp_names[lgp_num], fname, ext);
-		ret->fd = fopen(tmp, "rb");
+		_snprintf(relative_path, sizeof(relative_path), "%s/%s%s", lgp_names[lgp_num], fname, ext);
+		ret->fd = lgp_open_direct_file(tmp, sizeof(tmp), relative_path);
 
 		if(!ret->fd)
 		{
-			_snprintf(tmp, sizeof(tmp), "%s/%s/%s.lgp/%s%s", basedir, direct_mode_path.c_str(), lgp_names[lgp_num], fname, ext);
-			ret->fd = fopen(tmp, "rb");
+			_snprintf(relative_path, sizeof(relative_path), "%s.lgp/%s%s", lgp_names[lgp_num], fname, ext);
+			ret->fd = lgp_open_direct_file(tmp, sizeof(tmp), relative_path);
 		}
 
 		// Try to load special language named lgp files
@@ -232,23 +363,26 @@ struct lgp_file *lgp_open_file(char *filename, uint32_t lgp_num)
 				case 5: // world
 				case 15: // cr
 				case 16: // disc
-					_snprintf(tmp, sizeof(tmp), "%s/%s/%s_us.lgp/%s%s", basedir, direct_mode_path.c_str(), lgp_names[lgp_num], fname, ext);
+					_snprintf(relative_path, sizeof(relative_path), "%s_us.lgp/%s%s", lgp_names[lgp_num], fname, ext);
+					ret->fd = lgp_open_direct_file(tmp, sizeof(tmp), relative_path);
 					break;
 				case 8: // high
 				case 10: // snowboard
-					_snprintf(tmp, sizeof(tmp), "%s/%s/%s-us.lgp/%s%s", basedir, direct_mode_path.c_str(), lgp_names[lgp_num], fname, ext);
+					_snprintf(relative_path, sizeof(relative_path), "%s-us.lgp/%s%s", lgp_names[lgp_num], fname, ext);
+					ret->fd = lgp_open_direct_file(tmp, sizeof(tmp), relative_path);
 					break;
 			}
-			ret->fd = fopen(tmp, "rb");
 		}
 
 		if(!ret->fd)
 		{
-			_snprintf(tmp, sizeof(tmp), "%s/%s/%s/%s/%s%s", basedir, direct_mode_path.c_str(), lgp_names[lgp_num], lgp_current_dir, fname, ext);
-			ret->fd = fopen(tmp, "rb");
+			_snprintf(relative_path, sizeof(relative_path), "%s/%s/%s%s", lgp_names[lgp_num], lgp_current_dir, fname, ext);
+			ret->fd = lgp_open_direct_file(tmp, sizeof(tmp), relative_path);
 			if(ret->fd) ret->resolved_conflict = true;
 		}
 
+		if(ret->fd) ff7::battle::magic_prefetch_record_file(tmp);
+
 		if(ret->fd && (trace_all || trace_direct)) ffnx_trace("lgp_open_file: %i, %s (%s) [%s] = 0x%x\n", lgp_num, filename, lgp_current_dir, tmp, ret);
 	}
 
@@ -295,7 +429,10 @@ uint32_t lgp_seek_file(uint32_t offset, uint32_t lgp_num)
 {
 	if(!ff7_externals.lgp_fds[lgp_num]) return false;
 
-	fseek(ff7_externals.lgp_fds[lgp_num], offset, SEEK_SET);
+	struct lgp_archive *archive = lgp_map_archive(lgp_num);
+
+	if(archive) archive->position = offset;
+	else fseek(ff7_externals.lgp_fds[lgp_num], offset, SEEK_SET);
 
 	return true;
 }
@@ -305,9 +442,12 @@ uint32_t lgp_read(uint32_t lgp_num, char *dest, uint32_t size)
 {
 	if(!ff7_externals.lgp_fds[lgp_num]) return 0;
 
-	if(last->is_lgp_offset) return fread(dest, 1, size, ff7_externals.lgp_fds[lgp_num]);
+	if(last->is_lgp_offset) return lgp_read_archive(lgp_num, dest, size);
 
-	return fread(dest, 1, size, last->fd);
+	size = fread(dest, 1, size, last->fd);
+	stats.file_read_bytes += size;
+
+	return size;
 }
 
 // read from LGP file by LGP file descriptor
@@ -318,10 +458,13 @@ uint32_t lgp_read_file(struct lgp_file *file, uint32_t lgp_num, char *dest, uint
 	if(file->is_lgp_offset)
 	{
 		lgp_seek_file(file->offset + 24, lgp_num);
-		return fread(dest, 1, size, ff7_externals.lgp_fds[lgp_num]);
+		return lgp_read_archive(lgp_num, dest, size);
 	}
 
-	return fread(dest, 1, size, file->fd);
+	size = fread(dest, 1, size, file->fd);
+	stats.file_read_bytes += size;
+
+	return size;
 }
 
 // retrieve the size of a file within the LGP archive
@@ -329,10 +472,10 @@ uint32_t lgp_get_filesize(struct lgp_file *file, uint32_t lgp_num)
 {
 	if(file->is_lgp_offset)
 	{
-		uint32_t size;
+		uint32_t size = 0;
 
 		lgp_seek_file(file->offset + 20, lgp_num);
-		fread(&size, 4, 1, ff7_externals.lgp_fds[lgp_num]);
+		lgp_read_archive(lgp_num, (char *)&size, 4);
 		return size;
 	}
 	else
@@ -371,6 +514,8 @@ struct ff7_file *open_file(struct file_context *file_context, char *filename)
 
 	if (!ret) return 0;
 
+	stats.file_opens++;
+
 	if(trace_all || trace_files)
 	{
 		if(file_context->use_lgp) ffnx_trace("open %s (LGP:%s)\n", filename, lgp_names[file_context->lgp_num]);
@@ -458,6 +603,7 @@ uint32_t __read_file(uint32_t count, void *buffer, struct ff7_file *file)
 	if(file->context.use_lgp) return lgp_read(file->context.lgp_num, (char*)buffer, count);
 
 	ret = fread(buffer, 1, count, file->fd->fd);
+	stats.file_read_bytes += ret;
 
 	if(ferror(file->fd->fd))
 	{
@@ -480,6 +626,7 @@ uint32_t read_file(uint32_t count, void *buffer, struct ff7_file *file)
 	if(file->context.use_lgp) return lgp_read(file->context.lgp_num, (char*)buffer, count);
 
 	ret = fread(buffer, 1, count, file->fd->fd);
+	stats.file_read_bytes += ret;
 
 	if(ret != count)
 	{
@@ -647,9 +794,10 @@ int ff7_read_field_file(char* path)
 
 	for (int n = 0; n < FF7_FIELD_NUM_SECTIONS; n++)
 	{
-		_snprintf(chunk_file, sizeof(chunk_file), "%s/%s/%s.lgp/%s.chunk.%i", basedir, direct_mode_path.c_str(), lgp_names[1], filepath, n+1);
+		char chunk_relative_path[512];
+		_snprintf(chunk_relative_path, sizeof(chunk_relative_path), "%s.lgp/%s.chunk.%i", lgp_names[1], filepath, n+1);
 
-		if ((fd = fopen(chunk_file, "rb")) != NULL)
+		if ((fd = lgp_open_direct_file(chunk_file, sizeof(chunk_file), chunk_relative_path)) != NULL)
 		{
 			fseek(fd, 0L, SEEK_END);
 			ff7_field_file_chunked[n].size = ftell(fd);
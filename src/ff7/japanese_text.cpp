@@ -17,7 +17,14 @@
 #include "../ff7.h"
 #include "../patch.h"
 #include "../redirect.h"
+#include "multibyte_layout.h"
 #include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 static void multibyte_load_widths();
 
@@ -426,9 +433,7 @@ int charWidthData[6][256] =
     }
 };
 
-// multibyte (EN) advance: table value IS the advance in screen units (max 31 covers wide Arabic);
-// JP keeps the original half-width semantics (32px texel cells -> 16 units).
-static inline float z_half_width(int w) { return ff7_japanese_edition ? std::ceil(0.5f * (float)w) : (float)w; }
+static inline float z_half_width(int w) { return multibyte_advance_width(w, ff7_japanese_edition); }
 
 // ff7_multibyte_font: override the hardcoded width table from <basedir>/multibyte_widths.bin
 // (6*256 bytes, one per font sheet/code, same (pad<<5|width) packing as window.bin member 3),
@@ -445,39 +450,30 @@ static bool multibyte_resolve_path(const char *name, char *out, size_t out_size)
   return redirect_path_with_override(in, out, out_size) != 1;
 }
 
-static void multibyte_load_widths()
+// Tuning files as read from disk, handed over from the watcher thread to the render thread
+struct multibyte_tuning
+{
+  int widths[6][256];
+  bool has_widths = false;
+  int linestep_q = 0;
+};
+
+static std::mutex multibyte_tuning_mutex;
+static multibyte_tuning multibyte_tuning_pending;
+static std::atomic<bool> multibyte_tuning_dirty = false;
+
+static void multibyte_read_tuning(multibyte_tuning &tuning)
 {
-  // Hot-reload: re-read the widths file whenever its mtime changes (checked at most 1x/sec),
-  // so letter advances can be tuned live while the game runs (width_gui.py writes the file).
-  static bool tried = false;
-  static long long last_mtime = -1;
-  static DWORD last_check = 0;
-  if (!ff7_multibyte_font) return;
-  DWORD now = GetTickCount();
-  if (tried && (now - last_check) < 1000) return;
-  last_check = now;
   char path[MAX_PATH]{ 0 };
-  // line step re-read every 1s tick — must NOT sit behind the widths mtime gate,
-  // or moving only the spacing slider never reaches it
   multibyte_resolve_path("multibyte_linestep.bin", path, sizeof(path));
   FILE *lf = fopen(path, "rb");
   if (lf)
   {
     unsigned char lb[2]; size_t ln = fread(lb, 1, 2, lf);
-    int q = (ln == 2) ? (lb[0] | (lb[1] << 8)) : (ln == 1 ? lb[0] * 4 : 0);  // 1-byte legacy = whole px
-    if (q >= 80 && q <= 160 && q != multibyte_field_linestep_q)
-      multibyte_field_linestep_q = q;
+    tuning.linestep_q = (ln == 2) ? (lb[0] | (lb[1] << 8)) : (ln == 1 ? lb[0] * 4 : 0);  // 1-byte legacy = whole px
     fclose(lf);
   }
   multibyte_resolve_path("multibyte_widths.bin", path, sizeof(path));
-  struct _stat64 st;
-  bool first = !tried;
-  if (_stat64(path, &st) == 0)
-  {
-    if (tried && (long long)st.st_mtime == last_mtime) return;
-    last_mtime = (long long)st.st_mtime;
-  }
-  tried = true;
   FILE *f = fopen(path, "rb");
   if (!f) return;
   unsigned char buf[6 * 256];
@@ -485,18 +481,104 @@ static void multibyte_load_widths()
   {
     for (int i = 0; i < 6; i++)
       for (int j = 0; j < 256; j++)
-        charWidthData[i][j] = buf[i * 256 + j];
+        tuning.widths[i][j] = buf[i * 256 + j];
+    tuning.has_widths = true;
   }
   else ffnx_error("ff7_multibyte_font: %s wrong size (need 1536 bytes)\n", path);
   fclose(f);
-  if (!first) return;
+}
+
+static void multibyte_apply_tuning(const multibyte_tuning &tuning)
+{
+  if (tuning.linestep_q >= 80 && tuning.linestep_q <= 160)
+    multibyte_field_linestep_q = tuning.linestep_q;
+  if (tuning.has_widths)
+    memcpy(charWidthData, tuning.widths, sizeof(charWidthData));
+}
+
+static std::thread multibyte_watch_thread;
+static HANDLE multibyte_watch_stop = NULL;
+
+// Hot-reload: width_gui.py rewrites the tuning files while the game runs. Watch their folders on a
+// background thread and re-read them only when something changed there, the draw loop never touches the disk.
+// The stop event is always the first handle so shutdown wins over a pending change.
+static void multibyte_watch_tuning(std::vector<HANDLE> handles)
+{
+  while (true)
+  {
+    DWORD ret = WaitForMultipleObjects(handles.size(), handles.data(), FALSE, INFINITE);
+    if (ret == WAIT_OBJECT_0 || ret >= WAIT_OBJECT_0 + handles.size()) break;
+    if (WaitForSingleObject(handles[0], 50) == WAIT_OBJECT_0) break;   // let the writer finish before reading
+    for (size_t i = 1; i < handles.size(); i++) FindNextChangeNotification(handles[i]);
+    multibyte_tuning tuning;
+    multibyte_read_tuning(tuning);
+    {
+      std::lock_guard<std::mutex> lock(multibyte_tuning_mutex);
+      multibyte_tuning_pending = tuning;
+    }
+    multibyte_tuning_dirty = true;
+  }
+  for (size_t i = 1; i < handles.size(); i++) FindCloseChangeNotification(handles[i]);
+}
+
+// Called once per frame from common_flip, so a reload never changes the tables in the middle of a text box
+void ff7_multibyte_tuning_flip()
+{
+  if (multibyte_tuning_dirty.exchange(false))
+  {
+    std::lock_guard<std::mutex> lock(multibyte_tuning_mutex);
+    multibyte_apply_tuning(multibyte_tuning_pending);
+  }
+}
+
+void ff7_multibyte_tuning_shutdown()
+{
+  if (multibyte_watch_stop == NULL) return;
+  SetEvent(multibyte_watch_stop);
+  if (multibyte_watch_thread.joinable()) multibyte_watch_thread.join();
+  CloseHandle(multibyte_watch_stop);
+  multibyte_watch_stop = NULL;
+}
+
+static void multibyte_load_widths()
+{
+  static bool tried = false;
+  if (!ff7_multibyte_font || tried) return;
+  tried = true;
+  multibyte_tuning tuning;
+  multibyte_read_tuning(tuning);
+  multibyte_apply_tuning(tuning);
+  char path[MAX_PATH]{ 0 };
   multibyte_resolve_path("multibyte_iconmask.bin", path, sizeof(path));
-  f = fopen(path, "rb");
+  FILE *f = fopen(path, "rb");
   if (f)
   {
     fread(multibyte_icon_mask, 1, 256, f);
     fclose(f);
   }
+  std::vector<std::string> folders;
+  for (const char *name : { "multibyte_linestep.bin", "multibyte_widths.bin" })
+  {
+    multibyte_resolve_path(name, path, sizeof(path));
+    std::string folder = std::filesystem::path(path).parent_path().string();
+    if (folder.empty()) folder = ".";
+    if (std::find(folders.begin(), folders.end(), folder) == folders.end()) folders.push_back(folder);
+  }
+  multibyte_watch_stop = CreateEventA(NULL, TRUE, FALSE, NULL);
+  if (multibyte_watch_stop == NULL) return;
+  std::vector<HANDLE> handles{ multibyte_watch_stop };
+  for (const std::string &folder : folders)
+  {
+    HANDLE watch = FindFirstChangeNotificationA(folder.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+    if (watch != INVALID_HANDLE_VALUE) handles.push_back(watch);
+  }
+  if (handles.size() == 1)
+  {
+    CloseHandle(multibyte_watch_stop);
+    multibyte_watch_stop = NULL;
+    return;
+  }
+  multibyte_watch_thread = std::thread(multibyte_watch_tuning, handles);
 }
 
 bgra_byte get_character_color(int n_shapes)
@@ -541,7 +623,7 @@ __int16 field_submit_draw_text_640x480_6E706D_jp(
         byte *buffer_text,
         float z_value)
 {
-  multibyte_load_widths();   // hot-reload here too: dialogs must respond to live width tuning
+  multibyte_load_widths();
   int _lsq_acc = 0;   // quarter-px remainder for fractional line stepping
   float scaleFactor = ff7_japanese_edition ? 1.25f : 1.0f;  // JP upscales 1.25x; multibyte (EN) draws native 1.0x
   int special_character_do_draw; // eax
@@ -1113,8 +1195,6 @@ void field_draw_text_boxes_and_text_graphics_object_6ECA68_jp()
 
 int common_submit_draw_char_from_buffer_6F564E_jp(int x, int vertex_y, int n_shapes, unsigned __int16 letter, float z_value)
 {
-  multibyte_load_widths();   // 1s-gated hot-reload for live width tuning
-
   // FIXME: this function can draw characters with different scaling, dependent on what sorta text is being printed.
   // But it needs to know what the source of hte text that was put into the buffer was to work this out, and that info is NOT passed as a parameter
   // will need to hook the function that loads texts to the buffer and set a global based on where in memory the original text is.
@@ -1126,252 +1206,74 @@ int common_submit_draw_char_from_buffer_6F564E_jp(int x, int vertex_y, int n_sha
   graphics_vertex* top_right; // [esp+20h] [ebp-48h]
   graphics_vertex* bottom_left; // [esp+24h] [ebp-44h]
   graphics_vertex* top_left; // [esp+28h] [ebp-40h]
-  float vertex_u_width; // [esp+34h] [ebp-34h]
-  float vertex_v; // [esp+38h] [ebp-30h]
-  float vertex_u; // [esp+40h] [ebp-28h]
-  unsigned __int16 character; // [esp+44h] [ebp-24h]
   ff7_graphics_object* character_graphics_object; // [esp+48h] [ebp-20h]
-  __int16 offset_text_spacing; // [esp+4Ch] [ebp-1Ch]
-  __int16 vertex_width; // [esp+50h] [ebp-18h]
-  __int16 image_u; // [esp+54h] [ebp-14h]
-  __int16 offset_image_v; // [esp+58h] [ebp-10h]
-  __int16 image_v; // [esp+58h] [ebp-10h]
-  __int16 offset_image_u; // [esp+5Ch] [ebp-Ch]
-  unsigned __int16* p_letter; // [esp+60h] [ebp-8h]
-  float image_u_width; // [esp+64h] [ebp-4h]
+  __int16 vertex_width = 16; // [esp+50h] [ebp-18h]
   int vertex_x; // [esp+70h] [ebp+8h]
+  multibyte_glyph glyph;
 
-  int charWidth = 16;
-  int leftPadding = 0;
+  if (!multibyte_layout_glyph(letter, charWidthData, ff7_multibyte_font, glyph)) return x;
+
+  bool heart = glyph.sheet < 0;
 
-  p_letter = &letter;
-  offset_image_u = 0; // initialise to zero
-  offset_image_v = 0;
-  switch ((byte)letter)
+  if (heart)
+    character_graphics_object = *ff7_externals.menu_win_d_blend_4_graphics_object_DC0FD4;
+  else
   {
-  case 0xD9: // heart
-    // The heart redirect is a JP-edition feature. In multibyte mode this byte is a normal
-    // jafont_1 glyph cell — translations may map real glyphs here (e.g. Arabic medial qaf).
-    if (!ff7_multibyte_font)
-    {
-      character_graphics_object = *ff7_externals.menu_win_d_blend_4_graphics_object_DC0FD4;
-      offset_image_u = 144; // heart is here
-      offset_image_v = 208; // heart is here
-      charWidth = 0x1f;     // max width
-      leftPadding = 0;
-      goto LABEL_9;
-    }
-    character_graphics_object = ff7_externals.menu_jafont_1_graphics_object;
-    charWidth = charWidthData[0][*p_letter] & 0x1F;
-    leftPadding = charWidthData[0][*p_letter] >> 5;
-    break;
-  case 0xF8:
-    return x;
-  case 0xFA:
-    p_letter = (unsigned __int16*)((byte*)&letter + 1);
-    character_graphics_object = ff7_externals.menu_jafont_2_graphics_object;
-    charWidth = charWidthData[1][*p_letter] & 0x1F;
-    leftPadding = charWidthData[1][*p_letter] >> 5;
-    //offset_image_v = 132;
-    //offset_text_spacing = 231;
-    goto LABEL_9;
-  case 0xFB:
-    p_letter = (unsigned __int16*)((byte*)&letter + 1);
-    character_graphics_object = ff7_externals.menu_jafont_3_graphics_object;
-    charWidth = charWidthData[2][*p_letter] & 0x1F;
-    leftPadding = charWidthData[2][*p_letter] >> 5;
-    //offset_image_v = 0;
-    //offset_text_spacing = 441;
-    goto LABEL_9;
-  case 0xFC:
-    p_letter = (unsigned __int16*)((byte*)&letter + 1);
-    character_graphics_object = ff7_externals.menu_jafont_4_graphics_object;
-    charWidth = charWidthData[3][*p_letter] & 0x1F;
-    leftPadding = charWidthData[3][*p_letter] >> 5;
-    //offset_image_v = 132;
-    //offset_text_spacing = 672;
-    goto LABEL_9;
-  case 0xFD:
-    p_letter = (unsigned __int16*)((byte*)&letter + 1);
-    character_graphics_object = ff7_externals.menu_jafont_5_graphics_object;
-    charWidth = charWidthData[4][*p_letter] & 0x1F;
-    leftPadding = charWidthData[4][*p_letter] >> 5;
-    //offset_image_v = 132;
-    //offset_text_spacing = 882;
-    goto LABEL_9;
-  case 0xFE:
-    p_letter = (unsigned __int16*)((byte*)&letter + 1);
-    character_graphics_object = ff7_externals.menu_jafont_6_graphics_object;
-    charWidth = charWidthData[5][*p_letter] & 0x1F;
-    leftPadding = charWidthData[5][*p_letter] >> 5;
-    //offset_image_v = 132;
-    //offset_text_spacing = 1092;
-    goto LABEL_9;
-  default:
-    character_graphics_object = ff7_externals.menu_jafont_1_graphics_object;
-    charWidth = charWidthData[0][*p_letter] & 0x1F;
-    leftPadding = charWidthData[0][*p_letter] >> 5;
-    break;
+    ff7_graphics_object* jafont_graphics_objects[6] = {
+      ff7_externals.menu_jafont_1_graphics_object,
+      ff7_externals.menu_jafont_2_graphics_object,
+      ff7_externals.menu_jafont_3_graphics_object,
+      ff7_externals.menu_jafont_4_graphics_object,
+      ff7_externals.menu_jafont_5_graphics_object,
+      ff7_externals.menu_jafont_6_graphics_object,
+    };
+    character_graphics_object = jafont_graphics_objects[glyph.sheet];
   }
 
-  switch ((byte)letter)
+  vertex_x = x + glyph.left_padding;
+  if (ff7_externals.g_get_do_render_menu_6CDBF2() && common_externals.draw_graphics_object(1, (struct graphics_object*)character_graphics_object))
   {
-    /*case 0xF8:
-      return x;
-    case 0xFA:
-      p_letter = (unsigned __int16 *)((char *)&letter + 1);
-      offset_image_v = 132;
-      offset_text_spacing = 231;
-      goto LABEL_9;
-    case 0xFB:
-      p_letter = (unsigned __int16 *)((char *)&letter + 1);
-      offset_image_v = 0;
-      offset_text_spacing = 441;
-      goto LABEL_9;
-    case 0xFC:
-      p_letter = (unsigned __int16 *)((char *)&letter + 1);
-      offset_image_v = 132;
-      offset_text_spacing = 672;
-      goto LABEL_9;
-    case 0xFD:
-      p_letter = (unsigned __int16 *)((char *)&letter + 1);
-      offset_image_v = 132;
-      offset_text_spacing = 882;
-      goto LABEL_9;
-    case 0xFE:
-      p_letter = (unsigned __int16 *)((char *)&letter + 1);
-      offset_image_v = 132;
-      offset_text_spacing = 1092;
-      goto LABEL_9;*/
-  default:
-    offset_text_spacing = 0;
-    offset_image_v = 0;
-  LABEL_9:
-    letter = *(byte*)p_letter;
-    //character = *(byte *)p_letter;
-    //if ( *(byte *)p_letter == 0xD2 || *(byte *)p_letter == 0xD3 )
-    //  character -= 0x4E;
-    if (offset_image_u == 0) // only do this if we idn't set stuff above for the heart.
-    {
-      offset_image_u = 32 * (letter % 16);
-      image_v = 32 * (letter / 16) + offset_image_v;
-      image_u = 32 * (letter % 16);
-      if (offset_image_u <= 480)
-      {
-        //image_u = 24 * (character % 21);
-        if (offset_image_u == 480)
-        {
-          image_u_width = 32.0;
-          vertex_width = 16;
-        }
-        else
-        {
-          image_u_width = 32.0;
-          vertex_width = 16;
-        }
-        //character_graphics_object = *ff7_externals.menu_font_a_graphics_object_DC100C;
-      }
-      else
-      {
-        //image_u = offset_image_u - 256;
-        image_u_width = 32.0;
-        vertex_width = 16;
-        //character_graphics_object = *ff7_externals.menu_font_b_graphics_object_DC1010;
-      }
-    }
-    else
-    {
-      image_u_width = 16.0;  // heart. 
-      vertex_width = 16;
-      image_u = offset_image_u; // exactly equal to offset set above
-      image_v = offset_image_v;
-    }
-    /*if ( *ff7_externals.dword_DC12DC )
-      vertex_x = (__int64)((double)((int)*(unsigned __int8 *)(*ff7_externals.g_text_spacing_DB958C + offset_text_spacing + letter) >> 5)
-                         * 1.6666666)
-               + x;
-    else*/
-    vertex_x = x + leftPadding;//2 * ((int)*(unsigned __int8 *)(*ff7_externals.g_text_spacing_DB958C + offset_text_spacing + letter) >> 5);
-    if (ff7_externals.g_get_do_render_menu_6CDBF2() && common_externals.draw_graphics_object(1, (struct graphics_object*)character_graphics_object))
-    {
-      auto color = get_character_color(n_shapes);
-      if (offset_image_u == 144) // heart
-      {
-        {
-          color = get_character_color(7); // suppose dto be white
-        }
-      }
-      vertex_u = (double)image_u / 512.0f;
-      if (offset_image_u == 144) // heart
-      {
-        vertex_u = (double)vertex_u * 2.0f; // image half as big
-      }
-      vertex_v = (double)image_v / 512.0f;
-      if (offset_image_u == 144) // heart
-      {
-        vertex_v = (double)vertex_v * 2.0f; // image half as big
-      }
-      vertex_u_width = image_u_width / 512.0f;
-      if (offset_image_u == 144) // heart
-      {
-        vertex_u_width = (double)vertex_u_width * 2.0f; // image half as big
-      }
-      top_left = character_graphics_object->vertex_transform;
-      top_left->position.x = (float)vertex_x + xPosFudge;
-      top_left->position.y = (float)vertex_y + yPosFudge;
-      top_left->position.z = z_value;
-      top_left->position.w = 1.0;
-      top_left->color = color;
-      top_left->alpha_mask = 0xFF000000;
-      if (offset_image_u == 144) // heart
-        top_left->alpha_mask = -16777216;
-      top_left->u = vertex_u;
-      top_left->v = vertex_v;
-      bottom_left = character_graphics_object->vertex_transform + 1;
-      bottom_left->position.x = (float)vertex_x + xPosFudge;
-      bottom_left->position.y = (double)vertex_y + 16.0 * scaleFactor + yPosFudge;
-      bottom_left->position.z = z_value;
-      bottom_left->position.w = 1.0;
-      bottom_left->color = color;
-      bottom_left->alpha_mask = 0xFF000000;
-      if (offset_image_u == 144) // heart
-        bottom_left->alpha_mask = -16777216;
-      bottom_left->u = vertex_u;
-      bottom_left->v = vertex_v + 32.0f / 512.0f;
-      top_right = character_graphics_object->vertex_transform + 2;
-      top_right->position.x = (double)vertex_x + (double)vertex_width * scaleFactor + xPosFudge;
-      top_right->position.y = (float)vertex_y + yPosFudge;
-      top_right->position.z = z_value;
-      top_right->position.w = 1.0;
-      top_right->color = color;
-      top_right->alpha_mask = 0xFF000000;
-      if (offset_image_u == 144) // heart
-        top_right->alpha_mask = -16777216;
-      top_right->u = vertex_u + vertex_u_width;
-      top_right->v = vertex_v;
-      bottom_right = character_graphics_object->vertex_transform + 3;
-      bottom_right->position.x = (double)vertex_x + (double)vertex_width * scaleFactor + xPosFudge;
-      bottom_right->position.y = (double)vertex_y + 16.0 * scaleFactor + yPosFudge;
-      bottom_right->position.z = z_value;
-      bottom_right->position.w = 1.0;
-      bottom_right->color = color;
-      bottom_right->alpha_mask = -16777216;
-      bottom_right->u = vertex_u + vertex_u_width;
-      bottom_right->v = vertex_v + 32.0f / 512.0f;
-      *(byte*)character_graphics_object->curr_total_n_shape = 2 * n_shapes;
-      character_graphics_object->field_7C = 2 * n_shapes;
-      if (offset_image_u == 144) // heart
-      {
-        *(byte*)character_graphics_object->curr_total_n_shape = 7;
-        character_graphics_object->field_7C = 7;
-      }
-    }
-    /*if ( *ff7_externals.dword_DC12DC )                       // Return next x position: basically text spacing
-      return vertex_x + std::ceil(0.5f * charWidth) * 1.6666666;//(__int64)((double)(*(byte *)(*ff7_externals.g_text_spacing_DB958C + offset_text_spacing + letter) & 0x1F) * 1.6666666)
-           //+ vertex_x;
-    else*/
-    return vertex_x + std::ceil(z_half_width(charWidth) * scaleFactor);// 2 * (*(byte *)(*ff7_externals.g_text_spacing_DB958C + offset_text_spacing + letter) & 0x1F);
+    auto color = get_character_color(heart ? 7 : n_shapes); // heart is supposed to be white
+    top_left = character_graphics_object->vertex_transform;
+    top_left->position.x = (float)vertex_x + xPosFudge;
+    top_left->position.y = (float)vertex_y + yPosFudge;
+    top_left->position.z = z_value;
+    top_left->position.w = 1.0;
+    top_left->color = color;
+    top_left->alpha_mask = 0xFF000000;
+    top_left->u = glyph.u;
+    top_left->v = glyph.v;
+    bottom_left = character_graphics_object->vertex_transform + 1;
+    bottom_left->position.x = (float)vertex_x + xPosFudge;
+    bottom_left->position.y = (double)vertex_y + 16.0 * scaleFactor + yPosFudge;
+    bottom_left->position.z = z_value;
+    bottom_left->position.w = 1.0;
+    bottom_left->color = color;
+    bottom_left->alpha_mask = 0xFF000000;
+    bottom_left->u = glyph.u;
+    bottom_left->v = glyph.v + 32.0f / 512.0f;
+    top_right = character_graphics_object->vertex_transform + 2;
+    top_right->position.x = (double)vertex_x + (double)vertex_width * scaleFactor + xPosFudge;
+    top_right->position.y = (float)vertex_y + yPosFudge;
+    top_right->position.z = z_value;
+    top_right->position.w = 1.0;
+    top_right->color = color;
+    top_right->alpha_mask = 0xFF000000;
+    top_right->u = glyph.u + glyph.u_width;
+    top_right->v = glyph.v;
+    bottom_right = character_graphics_object->vertex_transform + 3;
+    bottom_right->position.x = (double)vertex_x + (double)vertex_width * scaleFactor + xPosFudge;
+    bottom_right->position.y = (double)vertex_y + 16.0 * scaleFactor + yPosFudge;
+    bottom_right->position.z = z_value;
+    bottom_right->position.w = 1.0;
+    bottom_right->color = color;
+    bottom_right->alpha_mask = -16777216;
+    bottom_right->u = glyph.u + glyph.u_width;
+    bottom_right->v = glyph.v + 32.0f / 512.0f;
+    *(byte*)character_graphics_object->curr_total_n_shape = heart ? 7 : 2 * n_shapes;
+    character_graphics_object->field_7C = heart ? 7 : 2 * n_shapes;
   }
+  return vertex_x + std::ceil(z_half_width(glyph.width) * scaleFactor);
 }
 
 void menu_draw_everything_6CC9D3_jp()
@@ -0,0 +1,151 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "lgp.h"
+
+#include <ctype.h>
+#include <string.h>
+#include <algorithm>
+
+std::string lgp_make_key(const char *path)
+{
+	std::string key(path);
+
+	std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+	std::replace(key.begin(), key.end(), '\\', '/');
+
+	return key;
+}
+
+int lgp_lookup_value(unsigned char c)
+{
+	c = tolower(c);
+
+	if(c == '.') return -1;
+
+	if(c < 'a' && c >= '0' && c <= '9') c += 'a' - '0';
+
+	if(c == '_') c = 'k';
+	if(c == '-') c = 'l';
+
+	return c - 'a';
+}
+
+static bool lgp_name_equals(const char *a, const char *b)
+{
+	while(*a && tolower((unsigned char)*a) == tolower((unsigned char)*b))
+	{
+		a++;
+		b++;
+	}
+
+	return tolower((unsigned char)*a) == tolower((unsigned char)*b);
+}
+
+void lgp_toc_index::build(const struct lgp_toc_entry *toc, uint32_t num_files)
+{
+	std::unordered_map<std::string, uint32_t> last;
+
+	first.clear();
+	first.reserve(num_files);
+	next.assign(num_files, UINT32_MAX);
+	last.reserve(num_files);
+
+	for(uint32_t i = 0; i < num_files; i++)
+	{
+		// TOC names are not always null terminated
+		std::string key = lgp_make_key(std::string(toc[i].name, strnlen(toc[i].name, sizeof(toc[i].name))).c_str());
+		auto inserted = last.try_emplace(key, i);
+
+		if(inserted.second) first.emplace(std::move(key), i);
+		else
+		{
+			next[inserted.first->second] = i;
+			inserted.first->second = i;
+		}
+	}
+}
+
+void lgp_toc_index::clear()
+{
+	first.clear();
+	next.clear();
+}
+
+struct lgp_lookup lgp_find_file(const struct lgp_toc_index &index, const char *filename, const struct lgp_toc_entry *toc,
+	const struct lookup_table_entry *lookup_table, const struct conflict_list *conflicts, const char *current_dir)
+{
+	struct lgp_lookup ret = { -1, false, false };
+	auto it = index.first.find(lgp_make_key(filename));
+
+	if(it == index.first.end()) return ret;
+
+	uint32_t lookup_value1 = lgp_lookup_value(filename[0]);
+	uint32_t lookup_value2 = lgp_lookup_value(filename[1]) + 1;
+	uint32_t toc_offset = lookup_table[lookup_value1 * 30 + lookup_value2].toc_offset;
+	uint32_t num_files = lookup_table[lookup_value1 * 30 + lookup_value2].num_files;
+
+	// first entry with this name reachable from the lookup table
+	uint32_t toc_index = it->second;
+
+	while(toc_offset && toc_index != UINT32_MAX && toc_index < toc_offset - 1) toc_index = index.next[toc_index];
+
+	if(toc_offset && toc_index != UINT32_MAX && toc_index < toc_offset - 1 + num_files)
+	{
+		const struct lgp_toc_entry *toc_entry = &toc[toc_index];
+
+		if(!toc_entry->conflict)
+		{
+			// this is the only file with this name, we're done here
+			ret.toc_index = toc_index;
+			return ret;
+		}
+
+		const struct conflict_list *conflict = &conflicts[toc_entry->conflict - 1];
+
+		// there are multiple files with this name, look for our
+		// current directory in the conflict table
+		for(uint32_t i = 0; i < conflict->num_conflicts; i++)
+		{
+			if(lgp_name_equals(conflict->conflict_entries[i].name, current_dir))
+			{
+				// file name and directory matches, this is our file
+				ret.toc_index = conflict->conflict_entries[i].toc_index;
+				ret.resolved_conflict = true;
+				return ret;
+			}
+		}
+	}
+
+	// one last chance, the lookup table might have been broken by LGP Tools
+	ret.broken_lookup_table = true;
+
+	for(toc_index = it->second; toc_index != UINT32_MAX; toc_index = index.next[toc_index])
+	{
+		if(!toc[toc_index].conflict)
+		{
+			ret.toc_index = toc_index;
+			break;
+		}
+	}
+
+	return ret;
+}
@@ -0,0 +1,86 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct lgp_toc_entry
+{
+	char name[16];
+	uint32_t offset;
+	uint16_t unknown1;
+	uint16_t conflict;
+};
+
+struct lookup_table_entry
+{
+	unsigned short toc_offset;
+	unsigned short num_files;
+};
+
+struct conflict_entry
+{
+	char name[128];
+	unsigned short toc_index;
+};
+
+struct conflict_list
+{
+	uint32_t num_conflicts;
+	struct conflict_entry *conflict_entries;
+};
+
+struct lgp_folders
+{
+	struct conflict_list conflicts[1000];
+};
+
+// Lowercase path with forward slashes
+std::string lgp_make_key(const char *path);
+int lgp_lookup_value(unsigned char c);
+
+// TOC of an LGP archive indexed by name, built once instead of scanning the TOC on every open
+struct lgp_toc_index
+{
+	// lowercase name => first TOC entry with this name
+	std::unordered_map<std::string, uint32_t> first;
+	// next TOC entry with the same name, or UINT32_MAX
+	std::vector<uint32_t> next;
+
+	void build(const struct lgp_toc_entry *toc, uint32_t num_files);
+	void clear();
+};
+
+struct lgp_lookup
+{
+	int32_t toc_index; // -1 when not found
+	bool resolved_conflict;
+	bool broken_lookup_table; // Found only by searching the whole archive
+};
+
+// Same result as the original open file logic of the game: the lookup table bucket first,
+// the conflict table for names in several directories, then the whole archive
+struct lgp_lookup lgp_find_file(const struct lgp_toc_index &index, const char *filename, const struct lgp_toc_entry *toc,
+	const struct lookup_table_entry *lookup_table, const struct conflict_list *conflicts, const char *current_dir);
@@ -672,7 +672,6 @@ void* ff7_menu_sub_6F5C0C(uint32_t param1, uint32_t param2, uint8_t param3, uint
 void ff7_limit_fps()
 {
 	static time_t last_gametime;
-	time_t gametime;
 	double framerate = 30.0f;
 
 	struct ff7_game_obj *game_object = (ff7_game_obj *)common_externals.get_game_object();
@@ -751,10 +750,7 @@ void ff7_limit_fps()
 	framerate *= gamehacks.getCurrentSpeedhack();
 	double frame_time = game_object->countspersecond / framerate;
 
-	do qpc_get_time(&gametime);
-	while (gametime > last_gametime && qpc_diff_time(&gametime, &last_gametime, nullptr) < frame_time);
-
-	last_gametime = gametime;
+	last_gametime = qpc_wait_frame(last_gametime, frame_time);
 }
 
 void ff7_handle_ambient_playback()
@@ -0,0 +1,49 @@
+/****************************************************************************/
+//    Copyright (C) 2024 Cosmos                                             //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "multibyte_layout.h"
+
+bool multibyte_layout_glyph(uint16_t letter, const int widths[6][256], bool multibyte_font, multibyte_glyph &glyph)
+{
+  uint8_t lead = letter & 0xFF;
+
+  if (lead == 0xF8) return false;
+
+  // The heart is a JP-edition feature, drawn from the 256x256 window texture. In multibyte mode this byte
+  // is a normal jafont_1 glyph cell, translations may map real glyphs here (e.g. Arabic medial qaf).
+  if (lead == 0xD9 && !multibyte_font)
+  {
+    glyph.sheet = -1;
+    glyph.code = lead;
+    glyph.width = 0x1F;
+    glyph.left_padding = 0;
+    glyph.u = 144 / 256.0f;
+    glyph.v = 208 / 256.0f;
+    glyph.u_width = 16.0f / 256.0f;
+
+    return true;
+  }
+
+  glyph.sheet = lead >= 0xFA && lead <= 0xFE ? lead - 0xF9 : 0;
+  glyph.code = glyph.sheet > 0 ? letter >> 8 : lead;
+  glyph.width = widths[glyph.sheet][glyph.code] & 0x1F;
+  glyph.left_padding = widths[glyph.sheet][glyph.code] >> 5;
+  // 16x16 cells of 32 texels in a 512x512 sheet
+  glyph.u = 32 * (glyph.code % 16) / 512.0f;
+  glyph.v = 32 * (glyph.code / 16) / 512.0f;
+  glyph.u_width = 32.0f / 512.0f;
+
+  return true;
+}
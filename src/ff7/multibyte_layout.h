@@ -0,0 +1,41 @@
+/****************************************************************************/
+//    Copyright (C) 2024 Cosmos                                             //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <cmath>
+
+// Where a character of the menu text buffer is drawn from, with its metrics from the width table
+struct multibyte_glyph
+{
+  int sheet;          // jafont_1..6 as 0..5, -1 for the heart of the JP edition
+  uint8_t code;       // cell in the sheet
+  int width;          // advance as stored in the width table
+  int left_padding;
+  float u, v;         // top left corner in texture coordinates
+  float u_width;
+};
+
+// multibyte (EN) advance: table value IS the advance in screen units (max 31 covers wide Arabic);
+// JP keeps the original half-width semantics (32px texel cells -> 16 units).
+inline float multibyte_advance_width(int width, bool half_width)
+{
+  return half_width ? std::ceil(0.5f * (float)width) : (float)width;
+}
+
+// Resolves a letter as passed to common_submit_draw_char_from_buffer_6F564E: 0xFA-0xFE in the low byte select
+// jafont_2-6 for the code in the high byte, anything else is a jafont_1 code. Returns false when nothing is drawn.
+bool multibyte_layout_glyph(uint16_t letter, const int widths[6][256], bool multibyte_font, multibyte_glyph &glyph);
@@ -0,0 +1,123 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2023 myst6re                                            //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "draw_image.h"
+
+#include <emmintrin.h>
+#include <string.h>
+#include <vector>
+
+void draw_image(
+	const uint32_t *sourceRgba, int sourceRgbaW, uint8_t sourceScale,
+	uint32_t *targetRgba, int targetRgbaW, uint8_t targetScale,
+	int sourceX, int sourceY, int sourceW, int sourceH,
+	int targetX, int targetY)
+{
+	if (targetScale < sourceScale)
+	{
+		return;
+	}
+
+	sourceRgbaW *= sourceScale;
+	targetRgbaW *= targetScale;
+	const uint8_t scaleRatio = targetScale / sourceScale;
+	const int rowW = sourceW * targetScale, rowH = sourceH * targetScale;
+
+	if (rowW <= 0 || rowH <= 0)
+	{
+		return;
+	}
+
+	// Source column of every target column, computed once per draw
+	static std::vector<int> sourceColumns;
+	const bool isContiguous = targetScale == sourceScale;
+
+	if (!isContiguous)
+	{
+		sourceColumns.resize(rowW);
+
+		for (int col = 0; col < rowW; ++col)
+		{
+			sourceColumns[col] = (sourceX + col / targetScale) * sourceScale + (col % targetScale) / scaleRatio;
+		}
+	}
+
+	uint32_t *targetRow = targetRgba + targetX * targetScale + targetY * targetScale * targetRgbaW;
+	const uint32_t *previousTargetRow = nullptr;
+	int previousSourceRow = -1;
+
+	for (int row = 0; row < rowH; ++row, targetRow += targetRgbaW)
+	{
+		const int sourceRow = (sourceY + row / targetScale) * sourceScale + (row % targetScale) / scaleRatio;
+
+		// Upscaled rows are identical, no need to convert them again
+		if (sourceRow == previousSourceRow)
+		{
+			memcpy(targetRow, previousTargetRow, rowW * sizeof(uint32_t));
+
+			continue;
+		}
+
+		const uint32_t *sourceLine = sourceRgba + sourceRow * sourceRgbaW;
+
+		if (isContiguous)
+		{
+			draw_image_convert_row(sourceLine + sourceX * sourceScale, targetRow, rowW);
+		}
+		else
+		{
+			for (int col = 0; col < rowW; ++col)
+			{
+				targetRow[col] = sourceLine[sourceColumns[col]];
+			}
+
+			draw_image_convert_row(targetRow, targetRow, rowW);
+		}
+
+		previousSourceRow = sourceRow;
+		previousTargetRow = targetRow;
+	}
+}
+
+void draw_image_convert_row(const uint32_t *source, uint32_t *target, int count)
+{
+	// Keep the color and halve the alpha to match the PSX semi-transparency bit
+	const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF),
+		alphaValue = _mm_set1_epi32(0x7F000000),
+		signFlip = _mm_set1_epi32(int(0x80000000)),
+		threshold = _mm_set1_epi32(int(0x7EFFFFFF ^ 0x80000000));
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i color = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+		// Unsigned color >= 0x7F000000
+		__m128i isOpaque = _mm_cmpgt_epi32(_mm_xor_si128(color, signFlip), threshold);
+		color = _mm_or_si128(_mm_and_si128(color, colorMask), _mm_and_si128(isOpaque, alphaValue));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(target + i), color);
+	}
+
+	for (; i < count; ++i)
+	{
+		uint32_t color = source[i], alpha = color & 0xFF000000;
+		target[i] = (color & 0xFFFFFF) | (alpha >= 0x7F000000 ? 0x7F000000 : 0);
+	}
+}
@@ -0,0 +1,36 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2023 myst6re                                            //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+// Copies a (sourceX, sourceY, sourceW, sourceH) rectangle of an image upscaled sourceScale times
+// into an image upscaled targetScale times, with the alpha converted to the PSX semi-transparency bit.
+// Coordinates and widths are in original (unscaled) pixels, targetScale must be a multiple of sourceScale.
+void draw_image(
+	const uint32_t *sourceRgba, int sourceRgbaW, uint8_t sourceScale,
+	uint32_t *targetRgba, int targetRgbaW, uint8_t targetScale,
+	int sourceX, int sourceY, int sourceW, int sourceH,
+	int targetX, int targetY
+);
+// Keeps the color and halves the alpha of count pixels, source and target can be the same
+void draw_image_convert_row(const uint32_t *source, uint32_t *target, int count);
@@ -21,6 +21,8 @@
 /****************************************************************************/
 
 #include "file.h"
+#include "fl_index.h"
+#include "lzs.h"
 #include "utils.h"
 #include "../ff8.h"
 #include "../log.h"
@@ -29,13 +31,47 @@
 #include <fcntl.h>
 #include <io.h>
 #include <lz4.h>
+#include <xxhash.h>
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Maximum size of the decompressed entries kept in memory
+constexpr size_t UNCOMPRESSED_CACHE_BUDGET = 64 * 1024 * 1024;
 
 char next_direct_file[MAX_PATH] = "";
 bool last_fopen_is_redirected = false;
 uint32_t last_compression_type = 0;
+size_t last_source_size = 0;
 size_t last_compressed_size = 0;
 size_t last_uncompressed_size = 0;
 
+// fl paths of an archive, indexed to avoid scanning the whole list on every search
+struct ff8_archive_index
+{
+	const ff8_file_fl *fl_infos;
+	const char *filenames_data;
+	int file_count;
+	ff8_fl_index ids;
+};
+
+std::unordered_map<const ff8_file_container *, ff8_archive_index> archive_indexes;
+
+// Decompressed entries, indexed by the hash of their compressed data
+struct ff8_uncompressed_entry
+{
+	std::vector<uint8_t> data;
+	std::list<uint64_t>::iterator lru;
+};
+
+std::unordered_map<uint64_t, ff8_uncompressed_entry> uncompressed_cache;
+std::list<uint64_t> uncompressed_cache_lru;
+size_t uncompressed_cache_size = 0;
+std::mutex uncompressed_cache_mutex;
+
 size_t get_fl_prefix_size(bool with_lang = true)
 {
 	return 2 + strlen(with_lang ? ff8_externals.archive_path_prefix : "\\FF8\\Data\\");
@@ -145,10 +181,56 @@ ff8_file_container *ff8_fs_archive_open_temp(char *fl_path, char *fs_path, char
 	return ff8_externals.archive_open(fl_path, fs_path, fi_path);
 }
 
+const ff8_archive_index &ff8_fs_archive_get_index(const ff8_file_container *file_container)
+{
+	ff8_archive_index &index = archive_indexes[file_container];
+
+	if (index.fl_infos == file_container->fl_infos && index.filenames_data == file_container->fl_infos->filenames_data && index.file_count == file_container->fl_infos->file_count)
+	{
+		return index;
+	}
+
+	size_t prefix_size = get_fl_prefix_size();
+
+	index.fl_infos = file_container->fl_infos;
+	index.filenames_data = file_container->fl_infos->filenames_data;
+	index.file_count = file_container->fl_infos->file_count;
+	index.ids.clear();
+	index.ids.reserve(index.file_count);
+
+	for (int id = 0; id < index.file_count; ++id)
+	{
+		index.ids.add(id, ff8_externals.fs_archive_get_fl_filepath(id, file_container->fl_infos), prefix_size);
+	}
+
+	if (trace_all || trace_files) ffnx_trace("%s: %d files indexed\n", __func__, index.file_count);
+
+	return index;
+}
+
 int ff8_fs_archive_search_filename2(const char *fullpath, ff8_file_fi_infos *fi_infos_for_the_path, const ff8_file_container *file_container)
 {
 	if (trace_all || trace_files) ffnx_trace("%s: Looking in archive for %s\n", __func__, fullpath);
 
+	if (file_container != nullptr && file_container->fl_infos != nullptr && file_container->fi_infos != nullptr)
+	{
+		const ff8_archive_index &index = ff8_fs_archive_get_index(file_container);
+		bool other_language = false;
+		// Also looks up without the language in the path
+		int id = index.ids.find(fullpath, get_fl_prefix_size(), &other_language);
+
+		if (id >= 0)
+		{
+			*fi_infos_for_the_path = file_container->fi_infos[id];
+
+			if (other_language && (trace_all || trace_files)) ffnx_trace("%s: found archive file in another language\n", __func__);
+
+			return 1;
+		}
+
+		return ff8_externals.ff8_fs_archive_search_filename2(fullpath, fi_infos_for_the_path, file_container);
+	}
+
 	int ret = ff8_externals.ff8_fs_archive_search_filename2(fullpath, fi_infos_for_the_path, file_container);
 
 	if (ret != 1 && file_container != nullptr)
@@ -198,6 +280,8 @@ void ff8_fs_archive_free_file_container_sub_archive(ff8_file_container *file_con
 
 	*next_direct_file = '\0';
 
+	archive_indexes.erase(file_container);
+
 	return ff8_externals.free_file_container(file_container);
 }
 
@@ -212,6 +296,7 @@ uint8_t *ff8_fs_archive_malloc_source_data(size_t size, char *source_code_path,
 {
 	if (trace_all || trace_files) ffnx_trace("%s size=%d\n", __func__, size);
 
+	last_source_size = size;
 	last_compressed_size = size - 12;
 
 	return (uint8_t *)common_externals.assert_malloc(size, source_code_path, line);
@@ -221,10 +306,10 @@ uint8_t *ff8_fs_archive_malloc_target_data(size_t size, char *source_code_path,
 {
 	if (trace_all || trace_files) ffnx_trace("%s size=%d\n", __func__, size);
 
+	last_uncompressed_size = size;
+
 	if (last_compression_type == 2) // LZ4 compression
 	{
-		last_uncompressed_size = size;
-
 		size += 10;
 	}
 
@@ -235,6 +320,23 @@ void ff8_fs_archive_uncompress_data(const uint8_t *source_data, uint8_t *target_
 {
 	if (trace_all || trace_files) ffnx_trace("%s\n", __func__);
 
+	const uint64_t hash = XXH3_64bits_withSeed(source_data, last_source_size, last_compression_type);
+
+	{
+		std::lock_guard<std::mutex> lock(uncompressed_cache_mutex);
+		auto it = uncompressed_cache.find(hash);
+
+		if (it != uncompressed_cache.end() && it->second.data.size() == last_uncompressed_size)
+		{
+			if (trace_all || trace_files) ffnx_trace("%s: cache hit\n", __func__);
+
+			memcpy(target_data, it->second.data.data(), last_uncompressed_size);
+			uncompressed_cache_lru.splice(uncompressed_cache_lru.begin(), uncompressed_cache_lru, it->second.lru);
+
+			return;
+		}
+	}
+
 	if (last_compression_type == 2) // LZ4 compression
 	{
 		if (trace_all || trace_files) ffnx_trace("%s LZ4 compression detected\n", __func__);
@@ -257,7 +359,35 @@ void ff8_fs_archive_uncompress_data(const uint8_t *source_data, uint8_t *target_
 	}
 	else
 	{
-		((void(*)(const uint8_t*, uint8_t*))ff8_externals.lzs_uncompress)(source_data, target_data);
+		// Compressed size followed by the LZS stream
+		size_t compressed_size = last_source_size > 4 ? std::min<size_t>(*(const uint32_t *)source_data, last_source_size - 4) : 0;
+
+		ff8_fs_lzs_uncompress(source_data + 4, compressed_size, target_data, last_uncompressed_size);
+	}
+
+	if (last_uncompressed_size > UNCOMPRESSED_CACHE_BUDGET / 4)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(uncompressed_cache_mutex);
+
+	while (!uncompressed_cache_lru.empty() && uncompressed_cache_size + last_uncompressed_size > UNCOMPRESSED_CACHE_BUDGET)
+	{
+		auto it = uncompressed_cache.find(uncompressed_cache_lru.back());
+		uncompressed_cache_size -= it->second.data.size();
+		uncompressed_cache.erase(it);
+		uncompressed_cache_lru.pop_back();
+	}
+
+	auto inserted = uncompressed_cache.try_emplace(hash);
+
+	if (inserted.second)
+	{
+		inserted.first->second.data.assign(target_data, target_data + last_uncompressed_size);
+		uncompressed_cache_lru.push_front(hash);
+		inserted.first->second.lru = uncompressed_cache_lru.begin();
+		uncompressed_cache_size += last_uncompressed_size;
 	}
 }
 
@@ -284,6 +414,8 @@ int ff8_open(const char *fileName, int oflag, ...)
 
 	if (trace_all || trace_files) ffnx_trace("%s: %s oflag=%X pmode=%X\n", __func__, fileName, oflag, pmode);
 
+	stats.file_opens++;
+
 	if (next_direct_file && *next_direct_file != '\0')
 	{
 		if (trace_all || trace_direct) ffnx_info("Direct file using %s\n", next_direct_file);
@@ -311,6 +443,8 @@ FILE *ff8_fopen(const char *fileName, const char *mode)
 {
 	if (trace_all || trace_files) ffnx_trace("%s: %s mode=%s\n", __func__, fileName, mode);
 
+	stats.file_opens++;
+
 	const int shflag = _SH_DENYNO;
 
 	if (next_direct_file && *next_direct_file != '\0')
@@ -0,0 +1,95 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2023 myst6re                                            //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//    Copyright (C) 2023 Tang-Tang Zhou                                     //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "fl_index.h"
+
+#include <ctype.h>
+#include <algorithm>
+
+std::string ff8_fl_make_key(const char *path)
+{
+	std::string key(path);
+
+	std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+	std::replace(key.begin(), key.end(), '/', '\\');
+
+	return key;
+}
+
+void ff8_fl_index::clear()
+{
+	ids.clear();
+	ids_without_lang.clear();
+}
+
+void ff8_fl_index::reserve(int file_count)
+{
+	ids.reserve(file_count);
+	ids_without_lang.reserve(file_count);
+}
+
+void ff8_fl_index::add(int id, const char *path, size_t prefix_size)
+{
+	std::string key = ff8_fl_make_key(path);
+
+	if (key.size() >= prefix_size)
+	{
+		ids_without_lang.try_emplace(key.substr(prefix_size), id);
+	}
+
+	ids.try_emplace(std::move(key), id);
+}
+
+int ff8_fl_index::find(const char *path, size_t prefix_size, bool *other_language) const
+{
+	std::string key = ff8_fl_make_key(path);
+	auto it = ids.find(key);
+
+	if (other_language != nullptr)
+	{
+		*other_language = false;
+	}
+
+	if (it != ids.end())
+	{
+		return it->second;
+	}
+
+	if (key.size() < prefix_size)
+	{
+		return -1;
+	}
+
+	it = ids_without_lang.find(key.substr(prefix_size));
+
+	if (it == ids_without_lang.end())
+	{
+		return -1;
+	}
+
+	if (other_language != nullptr)
+	{
+		*other_language = true;
+	}
+
+	return it->second;
+}
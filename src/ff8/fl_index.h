@@ -0,0 +1,46 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2023 myst6re                                            //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//    Copyright (C) 2023 Tang-Tang Zhou                                     //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+// Lowercase path with backslashes, as found in fl files
+std::string ff8_fl_make_key(const char *path);
+
+// fl paths of an archive, indexed to avoid scanning the whole list on every search
+struct ff8_fl_index
+{
+	std::unordered_map<std::string, int> ids;
+	// Same paths without the language prefix, to find files from another language
+	std::unordered_map<std::string, int> ids_without_lang;
+
+	void clear();
+	void reserve(int file_count);
+	// The first id added with a path wins, like a scan of the fl list
+	void add(int id, const char *path, size_t prefix_size);
+	// Returns -1 when not found
+	int find(const char *path, size_t prefix_size, bool *other_language = nullptr) const;
+};
@@ -0,0 +1,63 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2023 myst6re                                            //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//    Copyright (C) 2023 Tang-Tang Zhou                                     //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "lzs.h"
+
+size_t ff8_fs_lzs_uncompress(const uint8_t *source, size_t source_size, uint8_t *target, size_t target_size)
+{
+	const uint8_t *source_end = source + source_size;
+	size_t pos = 0;
+
+	while (source < source_end && pos < target_size)
+	{
+		uint8_t flags = *source++;
+
+		for (int bit = 0; bit < 8 && source < source_end && pos < target_size; ++bit, flags >>= 1)
+		{
+			if (flags & 1)
+			{
+				target[pos++] = *source++;
+
+				continue;
+			}
+
+			if (source + 1 >= source_end)
+			{
+				return pos;
+			}
+
+			const int offset = source[0] | ((source[1] & 0xF0) << 4), length = (source[1] & 0x0F) + 3;
+			source += 2;
+
+			// Window offset to a position in the output, before the output start the window is zeroes
+			ptrdiff_t ref = ptrdiff_t(pos) - ((ptrdiff_t(pos) + 0xFEE - offset) & 0xFFF);
+			if (ref == ptrdiff_t(pos)) ref -= 0x1000;
+
+			for (int i = 0; i < length && pos < target_size; ++i, ++ref)
+			{
+				target[pos++] = ref < 0 ? 0 : target[ref];
+			}
+		}
+	}
+
+	return pos;
+}
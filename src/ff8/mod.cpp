@@ -20,16 +20,23 @@
 //    GNU General Public License for more details.                          //
 /****************************************************************************/
 
+#include <xxhash.h>
+
 #include "../image/image.h"
 #include "../log.h"
 #include "../renderer.h"
 #include "../utils.h"
 
 #include "mod.h"
+#include "draw_image.h"
 #include "file.h"
 
+// Maximum size of the palette images which can be evicted
+constexpr uint32_t MOD_IMAGES_BUDGET = 512 * 1024 * 1024;
 
 bx::DefaultAllocator TextureImage::defaultAllocator;
+std::unordered_set<TextureModStandard *> TextureModStandard::_instances;
+uint32_t TextureModStandard::_residentSize = 0;
 
 TextureImage::TextureImage() :
 	_image(nullptr), _scale(1)
@@ -241,41 +248,6 @@ bool ModdedTexture::findExternalTexture(const char *name, char *filename, uint8_
 	return false;
 }
 
-void ModdedTexture::drawImage(
-	const uint32_t *sourceRgba, int sourceRgbaW, uint8_t sourceScale,
-	uint32_t *targetRgba, int targetRgbaW, uint8_t targetScale,
-	int sourceX, int sourceY, int sourceW, int sourceH,
-	int targetX, int targetY)
-{
-	if (targetScale < sourceScale)
-	{
-		return;
-	}
-
-	sourceRgbaW *= sourceScale;
-	targetRgbaW *= targetScale;
-	const uint8_t scaleRatio = targetScale / sourceScale;
-
-	for (int y = 0; y < sourceH; ++y)
-	{
-		for (int x = 0; x < sourceW; ++x)
-		{
-			const uint32_t *sourceRgbaCur = sourceRgba + (sourceX + x) * sourceScale + (sourceY + y) * sourceScale * sourceRgbaW;
-			uint32_t *targetRgbaCur = targetRgba + (targetX + x) * targetScale + (targetY + y) * targetScale * targetRgbaW;
-
-			for (int yPix = 0; yPix < targetScale; ++yPix)
-			{
-				for (int xPix = 0; xPix < targetScale; ++xPix)
-				{
-					uint32_t color = *(sourceRgbaCur + xPix / scaleRatio + yPix / scaleRatio * sourceRgbaW),
-						alpha = color & 0xFF000000;
-					*(targetRgbaCur + xPix + yPix * targetRgbaW) = (color & 0xFFFFFF) | (alpha >= 0x7F000000 ? 0x7F000000 : 0);
-				}
-			}
-		}
-	}
-}
-
 void ModdedTexture::copyRect(
 	const uint32_t *sourceRgba, int sourceRgbaW, uint32_t *targetRgba, int targetRgbaW, uint8_t scale, Tim::Bpp depth,
 	int sourceXBpp2, int sourceY, int sourceWBpp2, int sourceH, int targetXBpp2, int targetY)
@@ -298,12 +270,16 @@ void ModdedTexture::copyRect(
 	}
 }
 
+TextureModStandard::TextureModStandard(const TexturePacker::IdentifiedTexture &originalTexture) :
+	ModdedTexture(originalTexture), _internalLodScale(1), _currentPalette(-1), _isPinned(false), _imageLoads(0)
+{
+	_instances.insert(this);
+}
+
 TextureModStandard::~TextureModStandard()
 {
-	for (std::pair<uint8_t, TextureImage> image: _textures)
-	{
-		image.second.destroyImage();
-	}
+	_instances.erase(this);
+	updateResidencyStats();
 }
 
 bool TextureModStandard::createImages(int paletteCount, int internalLodScale)
@@ -315,6 +291,8 @@ bool TextureModStandard::createImages(int paletteCount, int internalLodScale)
 	int modCount = std::max(paletteCount, 1);
 	char filename[MAX_PATH] = {}, *extension = nullptr, found_extension[16] = {};
 
+	_internalLodScale = internalLodScale;
+
 	for (int paletteId = 0; paletteId < modCount; ++paletteId) {
 		if (!findExternalTexture(originalTexture().name().c_str(), filename, paletteId, true, extension, found_extension))
 		{
@@ -324,16 +302,196 @@ bool TextureModStandard::createImages(int paletteCount, int internalLodScale)
 		// Force the same extension for every palettes to reduce file existence checks
 		extension = found_extension;
 
-		TextureImage externalTexture;
-		if (!externalTexture.createImage(filename, originalTexture().texture().pixelW(), originalTexture().texture().h(), internalLodScale))
+		_textures[paletteId] = PaletteImage{filename, nullptr, 0, 0};
+	}
+
+	// The first image is always resident: it validates the mod and is used as fallback
+	while (!_textures.empty() && !loadImage(_textures.begin()->second))
+	{
+		_textures.erase(_textures.begin());
+	}
+
+	updateResidencyStats();
+
+	return !_textures.empty();
+}
+
+bool TextureModStandard::loadImage(PaletteImage &paletteImage) const
+{
+	if (paletteImage.image != nullptr)
+	{
+		return true;
+	}
+
+	// Palettes using the same file share the same image, without reading it again
+	if (shareImage(paletteImage, [&](const PaletteImage &other) { return other.filename == paletteImage.filename; }))
+	{
+		return true;
+	}
+
+	TextureImage *decoded = new TextureImage();
+
+	if (!decoded->createImage(paletteImage.filename.c_str(), originalTexture().texture().pixelW(), originalTexture().texture().h(), _internalLodScale))
+	{
+		delete decoded;
+
+		return false;
+	}
+
+	stats.mod_image_loads++;
+	_imageLoads++;
+
+	// Different files can still decode to the same pixels
+	const bimg::ImageMip &mip = decoded->mip();
+	paletteImage.contentHash = XXH3_64bits(mip.m_data, mip.m_size);
+
+	if (shareImage(paletteImage, [&](const PaletteImage &other) { return other.contentHash == paletteImage.contentHash && other.image->size() == decoded->size(); }))
+	{
+		decoded->destroyImage();
+		delete decoded;
+
+		return true;
+	}
+
+	evictImages(decoded->size());
+
+	_residentSize += decoded->size();
+	stats.mod_images_size += decoded->size();
+	stats.mod_images++;
+
+	paletteImage.image = std::shared_ptr<TextureImage>(decoded, [](TextureImage *image) {
+		_residentSize -= image->size();
+		stats.mod_images_size -= image->size();
+		stats.mod_images--;
+		image->destroyImage();
+		delete image;
+	});
+
+	updateResidencyStats();
+
+	if (trace_all || trace_vram) ffnx_trace("TextureModStandard::%s: %s loaded (%u loads for %s)\n", __func__, paletteImage.filename.c_str(), _imageLoads, originalTexture().name().c_str());
+
+	return true;
+}
+
+bool TextureModStandard::shareImage(PaletteImage &paletteImage, const std::function<bool(const PaletteImage &)> &isSame) const
+{
+	for (const std::pair<const uint8_t, PaletteImage> &pair: _textures)
+	{
+		if (&pair.second != &paletteImage && pair.second.image != nullptr && isSame(pair.second))
 		{
-			continue;
+			if (trace_all || trace_vram) ffnx_trace("TextureModStandard::%s: %s shares the image of %s\n", __func__, paletteImage.filename.c_str(), pair.second.filename.c_str());
+
+			paletteImage.image = pair.second.image;
+			updateResidencyStats();
+
+			return true;
 		}
+	}
+
+	return false;
+}
+
+void TextureModStandard::updateResidencyStats()
+{
+	std::vector<mod_texture_stats> perTexture;
+
+	stats.mod_textures = uint32_t(_instances.size());
+	stats.mod_palettes = 0;
+	stats.mod_palettes_resident = 0;
+
+	for (const TextureModStandard *instance: _instances)
+	{
+		mod_texture_stats textureStats = {};
+		std::unordered_set<const TextureImage *> images;
 
-		_textures[paletteId] = externalTexture;
+		strncpy(textureStats.name, instance->originalTexture().name().c_str(), sizeof(textureStats.name) - 1);
+		textureStats.palettes = uint32_t(instance->_textures.size());
+		textureStats.image_loads = instance->_imageLoads;
+
+		for (const std::pair<const uint8_t, PaletteImage> &pair: instance->_textures)
+		{
+			if (pair.second.image != nullptr)
+			{
+				textureStats.palettes_resident++;
+
+				// Palettes sharing an image count it once
+				if (images.insert(pair.second.image.get()).second)
+				{
+					textureStats.images_size += pair.second.image->size();
+				}
+			}
+		}
+
+		stats.mod_palettes += textureStats.palettes;
+		stats.mod_palettes_resident += textureStats.palettes_resident;
+		perTexture.push_back(textureStats);
 	}
 
-	return !_textures.empty();
+	stats.mod_texture_stats_count = std::min(uint32_t(perTexture.size()), uint32_t(MOD_TEXTURE_STATS_COUNT));
+	std::partial_sort(perTexture.begin(), perTexture.begin() + stats.mod_texture_stats_count, perTexture.end(), [](const mod_texture_stats &a, const mod_texture_stats &b) {
+		return a.images_size > b.images_size;
+	});
+	std::copy_n(perTexture.begin(), stats.mod_texture_stats_count, stats.mod_texture_stats);
+}
+
+void TextureModStandard::loadAllImages() const
+{
+	_isPinned = true;
+
+	for (auto it = _textures.begin(); it != _textures.end();)
+	{
+		if (loadImage(it->second))
+		{
+			++it;
+		}
+		else
+		{
+			it = _textures.erase(it);
+		}
+	}
+
+	updateResidencyStats();
+}
+
+void TextureModStandard::evictImages(uint32_t neededSize)
+{
+	while (_residentSize + neededSize > MOD_IMAGES_BUDGET)
+	{
+		PaletteImage *oldest = nullptr;
+
+		for (TextureModStandard *instance: _instances)
+		{
+			if (instance->_isPinned || instance->_textures.empty())
+			{
+				continue;
+			}
+
+			const std::shared_ptr<TextureImage> &firstImage = instance->_textures.begin()->second.image;
+
+			// Skip the first image, which is always resident
+			for (auto it = std::next(instance->_textures.begin()); it != instance->_textures.end(); ++it)
+			{
+				PaletteImage &paletteImage = it->second;
+
+				if (paletteImage.image != nullptr && paletteImage.image != firstImage && paletteImage.lastUsed != frame_counter
+					&& (oldest == nullptr || paletteImage.lastUsed < oldest->lastUsed))
+				{
+					oldest = &paletteImage;
+				}
+			}
+		}
+
+		if (oldest == nullptr)
+		{
+			break;
+		}
+
+		if (trace_all || trace_vram) ffnx_trace("TextureModStandard::%s: evict %s\n", __func__, oldest->filename.c_str());
+
+		oldest->image = nullptr;
+		updateResidencyStats();
+	}
 }
 
 uint8_t TextureModStandard::computePaletteId(int vramPalXBpp2, int vramPalY) const
@@ -362,10 +520,20 @@ const TextureImage &TextureModStandard::textureImage(uint8_t paletteId) const
 	{
 		if (trace_all || trace_vram) ffnx_warning("TextureModStandard::%s cannot find image for paletteId=%d, fallback to the first one\n", __func__, paletteId);
 
-		return _textures.begin()->second; // Use the first image
+		it = _textures.begin(); // Use the first image
+	}
+	else if (!loadImage(it->second))
+	{
+		if (trace_all || trace_vram) ffnx_warning("TextureModStandard::%s cannot load image for paletteId=%d, fallback to the first one\n", __func__, paletteId);
+
+		_textures.erase(it);
+		updateResidencyStats();
+		it = _textures.begin();
 	}
 
-	return it->second;
+	it->second.lastUsed = frame_counter;
+
+	return *it->second.image;
 }
 
 uint8_t TextureModStandard::scale(int vramPalXBpp2, int vramPalY) const
@@ -403,7 +571,7 @@ TexturePacker::TextureTypes TextureModStandard::drawToImage(
 	const TextureImage &image = textureImage(paletteId);
 	const bimg::ImageMip &mip = image.mip();
 
-	drawImage(
+	draw_image(
 		reinterpret_cast<const uint32_t *>(mip.m_data), mip.m_width / image.scale(), image.scale(),
 		targetRgba, targetW, targetScale,
 		sourceX, sourceY, width, height,
@@ -416,14 +584,25 @@ TexturePacker::TextureTypes TextureModStandard::drawToImage(
 void TextureModStandard::copyRect(int sourceXBpp2, int sourceY, int sourceWBpp2, int sourceH, int targetXBpp2, int targetY)
 {
 	const TexturePacker::TextureInfos &texture = originalTexture().texture();
+	std::unordered_set<const TextureImage *> copiedImages;
+
+	loadAllImages();
 
-	for (const std::pair<uint8_t, TextureImage> &image: _textures)
+	for (const std::pair<const uint8_t, PaletteImage> &pair: _textures)
 	{
-		const bimg::ImageMip &mip = image.second.mip();
+		const TextureImage &image = *pair.second.image;
+
+		// Shared images must be modified only once
+		if (!copiedImages.insert(&image).second)
+		{
+			continue;
+		}
+
+		const bimg::ImageMip &mip = image.mip();
 		ModdedTexture::copyRect(
 			reinterpret_cast<const uint32_t *>(mip.m_data), mip.m_width,
 			const_cast<uint32_t *>(reinterpret_cast<const uint32_t *>(mip.m_data)), mip.m_width,
-			image.second.scale(), texture.bpp(),
+			image.scale(), texture.bpp(),
 			sourceXBpp2 - texture.x(), sourceY - texture.y(), sourceWBpp2, sourceH,
 			targetXBpp2 - texture.x(), targetY - texture.y()
 		);
@@ -441,21 +620,30 @@ void TextureModStandard::copyRect(
 		return;
 	}
 
-	for (const std::pair<uint8_t, TextureImage> &image: _textures)
+	loadAllImages();
+	targetTexture.loadAllImages();
+
+	for (const std::pair<const uint8_t, PaletteImage> &pair: _textures)
 	{
-		for (const std::pair<uint8_t, TextureImage> &targetImage: targetTexture._textures)
+		const TextureImage &image = *pair.second.image;
+		std::unordered_set<const TextureImage *> copiedImages;
+
+		for (const std::pair<const uint8_t, PaletteImage> &targetPair: targetTexture._textures)
 		{
-			const bimg::ImageMip &mip = image.second.mip();
-			const bimg::ImageMip &targetMip = targetImage.second.mip();
+			const TextureImage &targetImage = *targetPair.second.image;
 
-			if (image.second.scale() != targetImage.second.scale()) {
+			// Shared images must be modified only once
+			if (image.scale() != targetImage.scale() || !copiedImages.insert(&targetImage).second) {
 				continue;
 			}
 
+			const bimg::ImageMip &mip = image.mip();
+			const bimg::ImageMip &targetMip = targetImage.mip();
+
 			ModdedTexture::copyRect(
 				reinterpret_cast<const uint32_t *>(mip.m_data), mip.m_width,
 				const_cast<uint32_t *>(reinterpret_cast<const uint32_t *>(targetMip.m_data)), targetMip.m_width,
-				image.second.scale(), tex.bpp(),
+				image.scale(), tex.bpp(),
 				sourceXBpp2 - tex.x(), sourceY - tex.y(), sourceWBpp2, sourceH,
 				targetXBpp2 - targetTex.x(), targetY - targetTex.y()
 			);
@@ -592,7 +780,7 @@ TexturePacker::TextureTypes TextureBackground::drawToImage(
 
 			const int col = tileId % _colsCount, row = tileId / _colsCount;
 
-			drawImage(
+			draw_image(
 				imgData, imgWidth, imgScale,
 				targetRgba, targetW, targetScale,
 				col * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE,
@@ -648,7 +836,7 @@ TexturePacker::TextureTypes TextureRawImage::drawToImage(
 		return TexturePacker::NoTexture;
 	}
 
-	drawImage(
+	draw_image(
 		_image, _width / _scale, _scale,
 		targetRgba, targetW, targetScale,
 		sourceX, sourceY, width, height,
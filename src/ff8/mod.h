@@ -22,9 +22,13 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
+#include <memory>
+#include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <bimg/bimg.h>
 #include <bx/allocator.h>
 
@@ -45,6 +49,9 @@ public:
 	inline bool hasImage() const {
 		return _image != nullptr;
 	}
+	inline uint32_t size() const {
+		return _image != nullptr ? _image->m_size : 0;
+	}
 	inline const bimg::ImageMip &mip() const {
 		return _mip;
 	}
@@ -82,12 +89,6 @@ public:
 	) const=0;
 	static bool findExternalTexture(const char *name, char *outFilename, uint8_t palette_index, bool hasPal, const char *extension = nullptr, char *foundExtension = nullptr);
 protected:
-	static void drawImage(
-		const uint32_t *sourceRgba, int sourceRgbaW, uint8_t sourceScale,
-		uint32_t *targetRgba, int targetRgbaW, uint8_t targetScale,
-		int sourceX, int sourceY, int sourceW, int sourceH,
-		int targetX, int targetY
-	);
 	static void copyRect(
 		const uint32_t *sourceRgba, int sourceRgbaW, uint32_t *targetRgba, int targetRgbaW, uint8_t scale, Tim::Bpp depth,
 		int sourceXBpp2, int sourceY, int sourceWBpp2, int sourceH,
@@ -103,7 +104,7 @@ private:
 
 class TextureModStandard : public ModdedTexture {
 public:
-	TextureModStandard(const TexturePacker::IdentifiedTexture &originalTexture) : ModdedTexture(originalTexture), _currentPalette(-1) {}
+	TextureModStandard(const TexturePacker::IdentifiedTexture &originalTexture);
 	TextureModStandard(const TextureModStandard &other) = delete;
 	~TextureModStandard();
 	inline bool canCopyRect() const override {
@@ -123,11 +124,30 @@ public:
 	// Set to -1 to unforce
 	void forceCurrentPalette(int8_t currentPalette);
 private:
+	// Palette images are decoded on first use, and can be evicted when they are not modified
+	struct PaletteImage {
+		std::string filename;
+		std::shared_ptr<TextureImage> image; // nullptr when not resident
+		uint64_t contentHash; // Hash of the decoded pixels, 0 when never decoded
+		uint32_t lastUsed;
+	};
 	bool createImage(const char *name, int paletteId = -1, const char *extension = nullptr, char *foundExtension = nullptr);
 	uint8_t computePaletteId(int vramPalXBpp2, int vramPalY) const;
 	const TextureImage &textureImage(uint8_t paletteId) const;
-	std::map<uint8_t, TextureImage> _textures; // Index: paletteId or current texture
+	bool loadImage(PaletteImage &paletteImage) const;
+	bool shareImage(PaletteImage &paletteImage, const std::function<bool(const PaletteImage &)> &isSame) const;
+	void loadAllImages() const;
+	static void evictImages(uint32_t neededSize);
+	static void updateResidencyStats();
+	// Loaded lazily and evicted from const drawing methods
+	mutable std::map<uint8_t, PaletteImage> _textures; // Index: paletteId or current texture
+	int _internalLodScale;
 	int8_t _currentPalette;
+	// Images modified by copyRect cannot be reloaded from the disk
+	mutable bool _isPinned;
+	mutable uint32_t _imageLoads;
+	static std::unordered_set<TextureModStandard *> _instances;
+	static uint32_t _residentSize;
 };
 
 class TextureBackground : public ModdedTexture {
@@ -19,7 +19,7 @@
 //    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
 //    GNU General Public License for more details.                          //
 /****************************************************************************/
-#include <set>
+#include <algorithm>
 
 #include "texture_packer.h"
 #include "../saveload.h"
@@ -58,18 +58,13 @@ void scale_up_image_data(const uint32_t *source, uint32_t *target, uint32_t w, u
 	}
 }
 
-TexturePacker::TexturePacker() :
-	_vramTextureIds(VRAM_WIDTH * VRAM_HEIGHT, INVALID_TEXTURE)
+TexturePacker::TexturePacker()
 {
 }
 
 void TexturePacker::cleanVramTextureIds(const TextureInfos &texture)
 {
-	for (int prevY = 0; prevY < texture.h(); ++prevY)
-	{
-		int clearKey = texture.x() + (texture.y() + prevY) * VRAM_WIDTH;
-		std::fill_n(_vramTextureIds.begin() + clearKey, texture.w(), INVALID_TEXTURE);
-	}
+	_vramOwnership.set(INVALID_TEXTURE, texture.x(), texture.y(), texture.w(), texture.h());
 }
 
 void TexturePacker::cleanTextures(ModdedTextureId previousTextureId, int xBpp2, int y, int wBpp2, int h)
@@ -123,28 +118,18 @@ void TexturePacker::setVramTextureId(ModdedTextureId textureId, int xBpp2, int y
 {
 	if (trace_all || trace_vram) ffnx_trace("%s: textureId=0x%X xBpp2=%d y=%d wBpp2=%d h=%d clearOldTexture=%d\n", __func__, textureId, xBpp2, y, wBpp2, h, clearOldTexture);
 
-	for (int i = 0; i < h; ++i)
+	if (clearOldTexture)
 	{
-		int vramY = y + i;
+		std::vector<ModdedTextureId> previousTextureIds;
+		_vramOwnership.collect(xBpp2, y, wBpp2, h, previousTextureIds);
 
-		for (int j = 0; j < wBpp2; ++j)
+		for (ModdedTextureId previousTextureId: previousTextureIds)
 		{
-			int vramX = xBpp2 + j;
-			int key = vramX + vramY * VRAM_WIDTH;
-
-			if (clearOldTexture)
-			{
-				ModdedTextureId previousTextureId = _vramTextureIds.at(key);
-
-				if (previousTextureId != INVALID_TEXTURE)
-				{
-					cleanTextures(previousTextureId, xBpp2, y, wBpp2, h);
-				}
-			}
-
-			_vramTextureIds[key] = textureId;
+			cleanTextures(previousTextureId, xBpp2, y, wBpp2, h);
 		}
 	}
+
+	_vramOwnership.set(textureId, xBpp2, y, wBpp2, h);
 }
 
 bool TexturePacker::setTexture(const char *name, const TextureInfos &texture, const TextureInfos &palette, int textureCount, bool clearOldTexture)
@@ -217,7 +202,7 @@ bool TexturePacker::setTextureRedirection(const char *name, const TextureInfos &
 		oldTexture.x(), oldTexture.y(), oldTexture.w(), oldTexture.h(),
 		newTexture.x(), newTexture.y(), newTexture.w(), newTexture.h());
 
-	ModdedTextureId textureId = _vramTextureIds.at(oldTexture.x() + oldTexture.y() * VRAM_WIDTH);
+	ModdedTextureId textureId = _vramOwnership.get(oldTexture.x(), oldTexture.y());
 
 	if (textureId == INVALID_TEXTURE)
 	{
@@ -296,8 +281,8 @@ void TexturePacker::animateTextureByCopy(int sourceXBpp2, int sourceY, int sourc
 		return;
 	}
 
-	ModdedTextureId textureId = _vramTextureIds.at(sourceXBpp2 + sourceY * VRAM_WIDTH),
-		textureIdTarget = _vramTextureIds.at(targetXBpp2 + targetY * VRAM_WIDTH);
+	ModdedTextureId textureId = _vramOwnership.get(sourceXBpp2, sourceY),
+		textureIdTarget = _vramOwnership.get(targetXBpp2, targetY);
 	if (textureId == INVALID_TEXTURE)
 	{
 		if (trace_all || trace_vram) ffnx_warning("TexturePacker::%s pos=(%d, %d) source not found\n", __func__, sourceXBpp2, sourceY);
@@ -374,7 +359,7 @@ void TexturePacker::animateTextureByCopy(int sourceXBpp2, int sourceY, int sourc
 
 void TexturePacker::setCurrentAnimationFrame(int xBpp2, int y, int8_t frameId)
 {
-	ModdedTextureId textureId = _vramTextureIds.at(xBpp2 + y * VRAM_WIDTH);
+	ModdedTextureId textureId = _vramOwnership.get(xBpp2, y);
 	if (textureId == INVALID_TEXTURE)
 	{
 		return;
@@ -408,7 +393,7 @@ void TexturePacker::clearTextures()
 {
 	if (trace_all || trace_vram) ffnx_trace("TexturePacker::%s\n", __func__);
 
-	std::fill_n(_vramTextureIds.begin(), _vramTextureIds.size(), INVALID_TEXTURE);
+	_vramOwnership.clear();
 
 	for (const std::pair<ModdedTextureId, const IdentifiedTexture &> &texture: _textures) {
 		if (texture.second.mod() != nullptr) {
@@ -418,9 +403,9 @@ void TexturePacker::clearTextures()
 	_textures.clear();
 }
 
-std::list<TexturePacker::IdentifiedTexture> TexturePacker::matchTextures(const TiledTex &tiledTex, bool withModsOnly, bool withAnimatedOnly) const
+std::vector<const TexturePacker::IdentifiedTexture *> TexturePacker::matchTextures(const TiledTex &tiledTex, bool withModsOnly, bool withAnimatedOnly) const
 {
-	std::list<IdentifiedTexture> ret;
+	std::vector<const IdentifiedTexture *> ret;
 
 	if (_textures.empty())
 	{
@@ -433,39 +418,19 @@ std::list<TexturePacker::IdentifiedTexture> TexturePacker::matchTextures(const T
 		return ret;
 	}
 
-	std::set<ModdedTextureId> textureIds;
+	std::vector<ModdedTextureId> textureIds;
 
 	if (trace_all || trace_vram) ffnx_trace("TexturePacker::%s looking for %s textures at (%d, %d, %d, %d, bpp=%d) in VRAM\n", __func__, withModsOnly ? "modded" : (withAnimatedOnly ? "animated" : "all"), tiledTex.x(), tiledTex.y(), tiledTex.w(), tiledTex.h(), tiledTex.bpp());
 
-	for (int y = 0; y < tiledTex.h(); ++y)
-	{
-		int vramY = tiledTex.y() + y;
-
-		if (vramY >= VRAM_HEIGHT)
-		{
-			break;
-		}
+	_vramOwnership.collect(tiledTex.x(), tiledTex.y(), tiledTex.w(), tiledTex.h(), textureIds);
 
-		for (int x = 0; x < tiledTex.w(); ++x)
+	for (const ModdedTextureId &textureId: textureIds)
+	{
+		if (textureIdIspalette(textureId))
 		{
-			int vramX = tiledTex.x() + x;
-
-			if (vramX >= VRAM_WIDTH)
-			{
-				break;
-			}
-
-			ModdedTextureId textureId = _vramTextureIds.at(vramX + vramY * VRAM_WIDTH);
-
-			if (textureId != INVALID_TEXTURE && !textureIdIspalette(textureId))
-			{
-				textureIds.insert(textureId);
-			}
+			continue;
 		}
-	}
 
-	for (const ModdedTextureId &textureId: textureIds)
-	{
 		auto it = _textures.find(textureId);
 
 		if (it == _textures.end())
@@ -518,7 +483,7 @@ std::list<TexturePacker::IdentifiedTexture> TexturePacker::matchTextures(const T
 
 		if (trace_all || trace_vram) ffnx_trace("TexturePacker::%s matches %s rect=(%d, %d, %d, %d)\n", __func__, texture.printableName(), texture.texture().x(), texture.texture().y(), texture.texture().w(), texture.texture().h());
 
-		ret.push_back(texture);
+		ret.push_back(&texture);
 	}
 
 	return ret;
@@ -564,7 +529,7 @@ uint32_t TexturePacker::composeTextures(
 		return 0;
 	}
 
-	std::list<IdentifiedTexture> textures = matchTextures(tiledTex, true);
+	std::vector<const IdentifiedTexture *> textures = matchTextures(tiledTex, true);
 
 	if (textures.empty())
 	{
@@ -576,9 +541,9 @@ uint32_t TexturePacker::composeTextures(
 	TextureInfos palette = tiledTex.palette(palIndex);
 	uint8_t scale = 0;
 
-	for (const IdentifiedTexture &tex: textures)
+	for (const IdentifiedTexture *tex: textures)
 	{
-		for (const std::pair<ModdedTextureId, const IdentifiedTexture &> &pair: tex.redirections())
+		for (const std::pair<ModdedTextureId, const IdentifiedTexture &> &pair: tex->redirections())
 		{
 			if (pair.second.mod() != nullptr)
 			{
@@ -586,9 +551,9 @@ uint32_t TexturePacker::composeTextures(
 			}
 		}
 
-		if (tex.mod() != nullptr)
+		if (tex->mod() != nullptr)
 		{
-			scale = std::max(scale, tex.mod()->scale(palette.x(), palette.y()));
+			scale = std::max(scale, tex->mod()->scale(palette.x(), palette.y()));
 		}
 	}
 
@@ -645,14 +610,14 @@ uint32_t TexturePacker::composeTextures(
 	return 0;
 }
 
-TexturePacker::TextureTypes TexturePacker::drawTextures(const std::list<IdentifiedTexture> &textures, const TiledTex &tiledTex, const TextureInfos &palette, uint32_t *target, int targetW, int targetH, uint8_t scale) const
+TexturePacker::TextureTypes TexturePacker::drawTextures(const std::vector<const IdentifiedTexture *> &textures, const TiledTex &tiledTex, const TextureInfos &palette, uint32_t *target, int targetW, int targetH, uint8_t scale) const
 {
 	TextureTypes drawnTextureTypes = NoTexture;
 	int x = tiledTex.pixelX(), y = tiledTex.y();
 
-	for (const IdentifiedTexture &texture: textures)
+	for (const IdentifiedTexture *texture: textures)
 	{
-		for (const std::pair<ModdedTextureId, const IdentifiedTexture &> &pair: texture.redirections())
+		for (const std::pair<ModdedTextureId, const IdentifiedTexture &> &pair: texture->redirections())
 		{
 			if (pair.second.mod() != nullptr && pair.second.mod()->isInternal())
 			{
@@ -666,10 +631,10 @@ TexturePacker::TextureTypes TexturePacker::drawTextures(const std::list<Identifi
 			}
 		}
 
-		if (texture.mod() != nullptr)
+		if (texture->mod() != nullptr)
 		{
-			TextureTypes textureType = texture.mod()->drawToImage(
-				texture.texture().pixelX() - x, texture.texture().y() - y,
+			TextureTypes textureType = texture->mod()->drawToImage(
+				texture->texture().pixelX() - x, texture->texture().y() - y,
 				target, targetW, targetH, scale, tiledTex.bpp(),
 				palette.x(), palette.y()
 			);
@@ -677,7 +642,7 @@ TexturePacker::TextureTypes TexturePacker::drawTextures(const std::list<Identifi
 			drawnTextureTypes = TextureTypes(int(drawnTextureTypes) | int(textureType));
 		}
 
-		for (const std::pair<ModdedTextureId, const IdentifiedTexture &> &pair: texture.redirections())
+		for (const std::pair<ModdedTextureId, const IdentifiedTexture &> &pair: texture->redirections())
 		{
 			if (pair.second.mod() != nullptr && !pair.second.mod()->isInternal())
 			{
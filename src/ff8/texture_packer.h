@@ -31,13 +31,9 @@
 #include "../ff8.h"
 #include "../image/tim.h"
 #include "field/background.h"
+#include "vram_ownership.h"
 
-typedef uint32_t ModdedTextureId;
-
-constexpr int VRAM_WIDTH = 1024;
-constexpr int VRAM_HEIGHT = 512;
 constexpr int VRAM_DEPTH = 2;
-constexpr ModdedTextureId INVALID_TEXTURE = ModdedTextureId(0xFFFFFFFF);
 constexpr int MAX_SCALE = 128;
 constexpr int FF8_BASE_RESOLUTION_X = 320;
 
@@ -163,8 +159,8 @@ public:
 	void setCurrentAnimationFrame(int xBpp2, int y, int8_t frameId);
 	void clearTiledTexs();
 	void clearTextures();
-	// Returns the textures matching the tiledTex
-	std::list<IdentifiedTexture> matchTextures(const TiledTex &tiledTex, bool withModsOnly = false, bool withAnimatedOnly = false) const;
+	// Returns the textures matching the tiledTex, pointers are valid until the next texture change
+	std::vector<const IdentifiedTexture *> matchTextures(const TiledTex &tiledTex, bool withModsOnly = false, bool withAnimatedOnly = false) const;
 	const TiledTex &registerTiledTex(const uint8_t *texData, int xBpp2, int y, int pixelW, int h, Tim::Bpp sourceBpp, int palX = -1, int palY = -1);
 	void registerPaletteWrite(const uint8_t *texData, int palIndex, int palX, int palY);
 	TiledTex getTiledTex(const uint8_t *texData) const;
@@ -194,14 +190,14 @@ private:
 
 	void setVramTextureId(ModdedTextureId textureId, int x, int y, int w, int h, bool clearOldTexture = true);
 	uint8_t getMaxScale(const TiledTex &tiledTex) const;
-	TextureTypes drawTextures(const std::list<IdentifiedTexture> &textures, const TiledTex &tiledTex, const TextureInfos &palette, uint32_t *target, int w, int h, uint8_t scale) const;
+	TextureTypes drawTextures(const std::vector<const IdentifiedTexture *> &textures, const TiledTex &tiledTex, const TextureInfos &palette, uint32_t *target, int w, int h, uint8_t scale) const;
 	void cleanVramTextureIds(const TextureInfos &texture);
 	void cleanTextures(ModdedTextureId textureId, int xBpp2, int y, int wBpp2, int h);
 
 	// Link between texture data pointer sent to the graphic driver and VRAM coordinates
 	std::unordered_map<const uint8_t *, TiledTex> _tiledTexs;
 	// Keep track of where textures are uploaded to the VRAM
-	std::vector<ModdedTextureId> _vramTextureIds; // ModdedTextureId[VRAM_WIDTH * VRAM_HEIGHT]
+	VramOwnership _vramOwnership;
 	// List of uploaded textures to the VRAM
 	std::unordered_map<ModdedTextureId, IdentifiedTexture> _textures;
 };
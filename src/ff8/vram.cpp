@@ -429,33 +429,33 @@ void set_tex_name(const TexturePacker::TiledTex &tiledTex, ff8_tex_header *tex_h
 	int file_count = 0;
 	int start_vram_id = 0;
 
-	for (const TexturePacker::IdentifiedTexture &tex: textures)
+	for (const TexturePacker::IdentifiedTexture *tex: textures)
 	{
-		if (tex.isValid())
+		if (tex->isValid())
 		{
 			if (file_count == 0)
 			{
-				filename.append(tex.name());
-				start_vram_id = tex.texture().vramId();
+				filename.append(tex->name());
+				start_vram_id = tex->texture().vramId();
 			}
 			else
 			{
-				size_t index = tex.name().find_last_of('/');
+				size_t index = tex->name().find_last_of('/');
 				if (index < 0)
 				{
-					filename.append(tex.name());
+					filename.append(tex->name());
 				}
 				else
 				{
-					filename.append(tex.name().substr(index + 1));
+					filename.append(tex->name().substr(index + 1));
 				}
 			}
 			filename.append("_");
 			// Add current frame info
-			if (tex.currentAnimationFrame() >= 0)
+			if (tex->currentAnimationFrame() >= 0)
 			{
 				filename.append("f");
-				filename.append(std::to_string(tex.currentAnimationFrame()));
+				filename.append(std::to_string(tex->currentAnimationFrame()));
 				filename.append("_");
 			}
 			file_count += 1;
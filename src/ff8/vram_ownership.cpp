@@ -0,0 +1,114 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2023 myst6re                                            //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "vram_ownership.h"
+
+#include <algorithm>
+
+void VramOwnership::set(ModdedTextureId textureId, int xBpp2, int y, int wBpp2, int h)
+{
+	// Clip to the VRAM
+	wBpp2 = std::min(xBpp2 + wBpp2, VRAM_WIDTH) - std::max(xBpp2, 0);
+	h = std::min(y + h, VRAM_HEIGHT) - std::max(y, 0);
+	xBpp2 = std::max(xBpp2, 0);
+	y = std::max(y, 0);
+
+	if (wBpp2 <= 0 || h <= 0)
+	{
+		return;
+	}
+
+	// Remove the new rectangle from the existing ones, keeping up to 4 pieces around it
+	_pieces.clear();
+
+	for (auto it = _rects.begin(); it != _rects.end();)
+	{
+		const Rect o = *it;
+
+		if (!o.intersects(xBpp2, y, wBpp2, h))
+		{
+			++it;
+			continue;
+		}
+
+		const int top = std::max(o.y, y), bottom = std::min(o.y + o.h, y + h);
+
+		if (o.y < y)
+		{
+			_pieces.push_back(Rect{o.textureId, o.x, o.y, o.w, y - o.y});
+		}
+		if (o.y + o.h > y + h)
+		{
+			_pieces.push_back(Rect{o.textureId, o.x, y + h, o.w, o.y + o.h - (y + h)});
+		}
+		if (o.x < xBpp2)
+		{
+			_pieces.push_back(Rect{o.textureId, o.x, top, xBpp2 - o.x, bottom - top});
+		}
+		if (o.x + o.w > xBpp2 + wBpp2)
+		{
+			_pieces.push_back(Rect{o.textureId, xBpp2 + wBpp2, top, o.x + o.w - (xBpp2 + wBpp2), bottom - top});
+		}
+
+		// Order does not matter since rectangles never overlap
+		*it = _rects.back();
+		_rects.pop_back();
+	}
+
+	_rects.insert(_rects.end(), _pieces.begin(), _pieces.end());
+
+	if (textureId != INVALID_TEXTURE)
+	{
+		_rects.push_back(Rect{textureId, xBpp2, y, wBpp2, h});
+	}
+}
+
+ModdedTextureId VramOwnership::get(int xBpp2, int y) const
+{
+	for (const Rect &o: _rects)
+	{
+		if (o.intersects(xBpp2, y, 1, 1))
+		{
+			return o.textureId;
+		}
+	}
+
+	return INVALID_TEXTURE;
+}
+
+void VramOwnership::collect(int xBpp2, int y, int wBpp2, int h, std::vector<ModdedTextureId> &textureIds) const
+{
+	for (const Rect &o: _rects)
+	{
+		if (o.intersects(xBpp2, y, wBpp2, h))
+		{
+			textureIds.push_back(o.textureId);
+		}
+	}
+
+	std::sort(textureIds.begin(), textureIds.end());
+	textureIds.erase(std::unique(textureIds.begin(), textureIds.end()), textureIds.end());
+}
+
+void VramOwnership::clear()
+{
+	_rects.clear();
+}
@@ -0,0 +1,56 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2023 myst6re                                            //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+typedef uint32_t ModdedTextureId;
+
+constexpr int VRAM_WIDTH = 1024;
+constexpr int VRAM_HEIGHT = 512;
+constexpr ModdedTextureId INVALID_TEXTURE = ModdedTextureId(0xFFFFFFFF);
+
+// Which texture owns each VRAM pixel, stored as non-overlapping rectangles (x and w in 16-bit units)
+class VramOwnership {
+public:
+	// Gives the rectangle to textureId, or frees it with INVALID_TEXTURE
+	void set(ModdedTextureId textureId, int xBpp2, int y, int wBpp2, int h);
+	ModdedTextureId get(int xBpp2, int y) const;
+	// Appends the sorted and unique owners of the rectangle
+	void collect(int xBpp2, int y, int wBpp2, int h, std::vector<ModdedTextureId> &textureIds) const;
+	void clear();
+	inline size_t rectCount() const {
+		return _rects.size();
+	}
+private:
+	struct Rect {
+		ModdedTextureId textureId;
+		int x, y, w, h;
+		inline bool intersects(int xBpp2, int y, int wBpp2, int h) const {
+			return xBpp2 < this->x + this->w && this->x < xBpp2 + wBpp2 && y < this->y + this->h && this->y < y + h;
+		}
+	};
+
+	std::vector<Rect> _rects, _pieces;
+};
@@ -19,6 +19,11 @@
 //    GNU General Public License for more details.                          //
 /****************************************************************************/
 
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include <xxhash.h>
+
 #include "globals.h"
 #include "common.h"
 #include "ff8.h"
@@ -203,35 +208,103 @@ error:
 	return 0;
 }
 
-#define TEXRELOAD_BUFFER_SIZE 64
+// rows covered by each hash of a reloaded image, only the changed blocks are uploaded when possible
+#define TEXTURE_RELOAD_BLOCK_ROWS 16
 
-struct
+struct texture_reload_state
 {
-	char *image_data;
+	std::vector<XXH64_hash_t> block_hashes;
 	uint32_t size;
-	struct ff8_texture_set *texture_set;
-} reload_buffer[TEXRELOAD_BUFFER_SIZE] = {};
-uint32_t reload_buffer_index = 0;
+	// texture created mutable by the last full reload, 0 when it cannot be updated in place
+	uint32_t texture;
+	uint32_t palette_index;
+};
+
+// content of the image data the last time each texture set was reloaded
+std::unordered_map<struct ff8_texture_set *, texture_reload_state> reload_states;
+
+// upload the blocks whose hash changed to the existing texture, returns false if the texture has to be reloaded
+bool texture_reload_blocks(struct ff8_texture_set *texture_set, const TexturePacker::TiledTex &tiledTex, texture_reload_state &state, const std::vector<XXH64_hash_t> &block_hashes)
+{
+	VOBJ(tex_header, tex_header, texture_set->tex_header);
+	uint32_t palette_index = VREF(tex_header, palette_index);
+	uint32_t height = VREF(tex_header, tex_format.height);
+	uint32_t uploaded = 0;
+
+	if(state.texture == 0 || state.palette_index != palette_index || state.block_hashes.size() != block_hashes.size()) return false;
+
+	// the texture set may have switched to another palette since the last load
+	if(VREF(tex_header, palettes) > 0 && texture_set->palette_index != uint32_t(-1) && (texture_set->palette_index & 0x1FFF) != palette_index) return false;
+
+	// mods and missing VRAM palettes are only handled by a full load
+	if(tiledTex.isValid())
+	{
+		if(tiledTex.bpp() != Tim::Bpp16 && !tiledTex.palette(palette_index / 2).isValid()) return false;
+		if(!texturePacker.matchTextures(tiledTex, true, false).empty()) return false;
+	}
+
+	for(uint32_t block = 0; block < block_hashes.size();)
+	{
+		if(state.block_hashes[block] == block_hashes[block])
+		{
+			block++;
+			continue;
+		}
+
+		// upload consecutive changed blocks together
+		uint32_t first_block = block;
+
+		while(block < block_hashes.size() && state.block_hashes[block] != block_hashes[block]) block++;
+
+		uint32_t first_row = first_block * TEXTURE_RELOAD_BLOCK_ROWS;
+		uint32_t rows = std::min(block * TEXTURE_RELOAD_BLOCK_ROWS, height) - first_row;
+		uint32_t size = common_update_texture_rows((struct texture_set *)texture_set, state.texture, first_row, rows);
+
+		if(size == 0) return false;
+
+		uploaded += size;
+	}
+
+	state.block_hashes = block_hashes;
+
+	stats.texture_reloads++;
+	stats.texture_reload_bytes_uploaded += uploaded;
+
+	if(trace_all || trace_vram) ffnx_trace("%s: 0x%X %u bytes uploaded image_data=0x%X\n", __func__, texture_set, uploaded, VREF(tex_header, image_data));
+
+	return true;
+}
 
 // this function is wedged into the middle of a function designed to reload a Direct3D texture
 // when the image data changes
 void texture_reload_hack(struct texture_page *texture_page, struct ff8_texture_set *texture_set)
 {
-	uint32_t i;
-	uint32_t size;
+	uint32_t size, row_size, height;
 	VOBJ(tex_header, tex_header, texture_set->tex_header);
+	static std::vector<XXH64_hash_t> block_hashes;
 
-	size = VREF(tex_header, tex_format.width) * VREF(tex_header, tex_format.height) * VREF(tex_header, tex_format.bytesperpixel);
+	row_size = VREF(tex_header, tex_format.width) * VREF(tex_header, tex_format.bytesperpixel);
+	height = VREF(tex_header, tex_format.height);
+	size = row_size * height;
 
-	// a circular buffer holds the last TEXRELOAD_BUFFER_SIZE textures that went through here
-	// and their respective image data so that we can see if anything actually changed and avoid
-	// unnecessary texture reloads
-	for(i = 0; i < TEXRELOAD_BUFFER_SIZE; i++)
+	// the hashes of the image data from the last reload of this texture set tell us if anything
+	// actually changed so we can avoid unnecessary texture reloads, and which rows to upload
+	block_hashes.resize((height + TEXTURE_RELOAD_BLOCK_ROWS - 1) / TEXTURE_RELOAD_BLOCK_ROWS);
+
+	for(uint32_t block = 0; block < block_hashes.size(); block++)
 	{
-		if(reload_buffer[i].texture_set == texture_set && reload_buffer[i].size == size && memcmp(reload_buffer[i].image_data, VREF(tex_header, image_data), size) == 0)
-		{
-			return;
-		}
+		uint32_t first_row = block * TEXTURE_RELOAD_BLOCK_ROWS;
+
+		block_hashes[block] = XXH3_64bits(VREF(tex_header, image_data) + first_row * row_size, (std::min(first_row + TEXTURE_RELOAD_BLOCK_ROWS, height) - first_row) * row_size);
+	}
+
+	auto it = reload_states.find(texture_set);
+
+	stats.texture_reload_bytes_compared += size;
+
+	if(it != reload_states.end() && it->second.size == size && it->second.block_hashes == block_hashes)
+	{
+		return;
 	}
 
 	TexturePacker::TiledTex tiledTex = texturePacker.getTiledTex(VREF(tex_header, image_data));
@@ -244,7 +317,7 @@ void texture_reload_hack(struct texture_page *texture_page, struct ff8_texture_s
 	}
 
 	if (texBpp != Tim::Bpp16) {
-		const std::list<TexturePacker::IdentifiedTexture> &textures = texturePacker.matchTextures(tiledTex, false, true);
+		const std::vector<const TexturePacker::IdentifiedTexture *> textures = texturePacker.matchTextures(tiledTex, false, true);
 
 		if (textures.empty()) {
 			if(trace_all || trace_vram) ffnx_trace("%s: ignore reload because no animated texture matches the current texture set 0x%X (bpp vram=%d, bpp tex=%d, source bpp tex=%d) image_data=0x%X\n", __func__, texture_set, tiledTex.bpp(), VREF(tex_header, tex_format.bytesperpixel), texBpp, VREF(tex_header, image_data));
@@ -253,23 +326,30 @@ void texture_reload_hack(struct texture_page *texture_page, struct ff8_texture_s
 		}
 	}
 
+	if(it != reload_states.end() && it->second.size == size && texture_reload_blocks(texture_set, tiledTex, it->second, block_hashes))
+	{
+		return;
+	}
+
+	upload_mutable_textures = true;
+	last_mutable_texture = 0;
+
 	common_unload_texture((struct texture_set *)texture_set);
 	common_load_texture((struct texture_set *)texture_set, texture_set->tex_header, texture_set->texture_format);
 
-	reload_buffer[reload_buffer_index].texture_set = texture_set;
-	if (reload_buffer[reload_buffer_index].image_data != nullptr && reload_buffer[reload_buffer_index].size != size) {
-		driver_free(reload_buffer[reload_buffer_index].image_data);
-		reload_buffer[reload_buffer_index].image_data = nullptr;
-	}
-	if (reload_buffer[reload_buffer_index].image_data == nullptr) {
-		reload_buffer[reload_buffer_index].image_data = (char*)driver_malloc(size);
-	}
-	memcpy(reload_buffer[reload_buffer_index].image_data, VREF(tex_header, image_data), size);
-	reload_buffer[reload_buffer_index].size = size;
-	reload_buffer_index = (reload_buffer_index + 1) % TEXRELOAD_BUFFER_SIZE;
+	upload_mutable_textures = false;
+
+	uint32_t palette_index = VREF(tex_header, palette_index);
+	bool is_mutable = last_mutable_texture != 0 && texture_set->ogl.gl_set && palette_index < texture_set->ogl.gl_set->textures && texture_set->texturehandle[palette_index] == last_mutable_texture;
+
+	reload_states[texture_set] = texture_reload_state{ block_hashes, size, is_mutable ? last_mutable_texture : 0, palette_index };
 
 	stats.texture_reloads++;
 
+	// what reached the GPU: the converted texture, or the external one
+	if(texture_set->ogl.external) stats.texture_reload_bytes_uploaded += texture_set->ogl.width * texture_set->ogl.height * 4;
+	else stats.texture_reload_bytes_uploaded += VREF(tex_header, tex_format.width) * height * 4;
+
 	if(trace_all || trace_vram) ffnx_trace("texture_reload_hack: 0x%X (bpp=%d, sourceBpp=%d) image_data=0x%X\n", texture_set, VREF(tex_header, tex_format.bytesperpixel), texBpp, VREF(tex_header, image_data));
 }
 
@@ -289,10 +369,16 @@ void texture_reload_hack2(struct texture_page *texture_page, uint32_t unknown1,
 
 void ff8_unload_texture(struct ff8_texture_set *texture_set)
 {
-	uint32_t i;
-
 	// remove any references to this texture
-	for(i = 0; i < TEXRELOAD_BUFFER_SIZE; i++) if(reload_buffer[i].texture_set == texture_set) reload_buffer[i].texture_set = 0;
+	reload_states.erase(texture_set);
+}
+
+void ff8_texture_handles_changed(struct ff8_texture_set *texture_set)
+{
+	// the texture may have been deleted, and its handle reused by another one
+	auto it = reload_states.find(texture_set);
+
+	if(it != reload_states.end()) it->second.texture = 0;
 }
 
 void swirl_sub_56D390(uint32_t x, uint32_t y, uint32_t w, uint32_t h)
@@ -1517,10 +1603,7 @@ int ff8_limit_fps()
 	framerate *= gamehacks.getCurrentSpeedhack();
 	double frame_time = game_object->countspersecond / framerate;
 
-	do qpc_get_time(&gametime);
-	while (gametime > last_gametime && qpc_diff_time(&gametime, &last_gametime, nullptr) < frame_time);
-
-	last_gametime = gametime;
+	last_gametime = qpc_wait_frame(last_gametime, frame_time);
 
 	return 0;
 }
@@ -0,0 +1,60 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include "frame_pacer.h"
+
+void FramePacer::init(double frequency)
+{
+	this->frequency = frequency;
+
+	spinTime = frequency * 0.002;
+	minSpinTime = frequency * 0.0005;
+	maxSpinTime = frequency * 0.004;
+	errorMean = 0.0;
+	errorJitter = 0.0;
+	lastError = 0.0;
+}
+
+double FramePacer::sleepTime(double remaining) const
+{
+	return remaining > spinTime ? remaining - spinTime : 0.0;
+}
+
+void FramePacer::wokeUp(double sleepTime, double slept)
+{
+	// react quickly to late wake ups, relax slowly when the timer behaves
+	double target = (slept - sleepTime) * 1.5;
+
+	if (target > spinTime) spinTime = target;
+	else spinTime = spinTime * 0.95 + target * 0.05;
+
+	spinTime = std::clamp(spinTime, minSpinTime, maxSpinTime);
+}
+
+void FramePacer::frameDone(double error)
+{
+	lastError = error;
+	errorMean = errorMean * 0.95 + error * 0.05;
+	errorJitter = errorJitter * 0.95 + std::abs(error - errorMean) * 0.05;
+}
@@ -0,0 +1,53 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+// Deadline and spin slice logic of the frame limiters, without any OS call
+// All durations are in timer counts, the caller does the sleeping and the spinning
+class FramePacer
+{
+private:
+	double frequency = 0.0;
+	double spinTime = 0.0;
+	double minSpinTime = 0.0;
+	double maxSpinTime = 0.0;
+	double errorMean = 0.0;
+	double errorJitter = 0.0;
+	double lastError = 0.0;
+
+public:
+	// frequency: timer counts per second
+	void init(double frequency);
+
+	// How long to sleep before spinning until the deadline, 0 to only spin
+	double sleepTime(double remaining) const;
+	// Calibrate the spin slice on how long the sleep really took
+	void wokeUp(double sleepTime, double slept);
+	// error: how late the frame ended after its deadline
+	void frameDone(double error);
+
+	double spin() const { return spinTime; }
+	double error() const { return lastError; }
+	// Mean absolute deviation of the recent deadline errors
+	double jitter() const { return errorJitter; }
+	double toMicroseconds(double counts) const { return frequency > 0.0 ? counts * 1000000.0 / frequency : 0.0; }
+};
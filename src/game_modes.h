@@ -0,0 +1,48 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+// Driver modes, shared by both games through the mode tables of ff7_data.h and ff8_data.h
+enum game_modes
+{
+	MODE_FIELD = 0,
+	MODE_BATTLE,
+	MODE_WORLDMAP,
+	MODE_MENU,
+	MODE_HIGHWAY,
+	MODE_CHOCOBO,
+	MODE_SNOWBOARD,
+	MODE_CONDOR,
+	MODE_SUBMARINE,
+	MODE_COASTER,
+	MODE_CDCHECK,
+	MODE_EXIT,
+	MODE_SWIRL,
+	MODE_GAMEOVER,
+	MODE_ENDINGMOVIE,
+	MODE_CREDITS,
+	MODE_INTRO,
+	MODE_CARDGAME,
+	MODE_UNKNOWN,
+	MODE_AFTER_BATTLE,
+	MODE_MAIN_MENU,
+};
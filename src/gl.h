@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "common.h"
+#include "gl/draw_policy.h"
 
 #define VERTEX 1
 #define LVERTEX 2
@@ -107,6 +108,7 @@ struct gl_texture_set
 	uint32_t force_filter;
 	uint32_t force_zsort;
 	uint32_t disable_lighting;
+	uint32_t draw_policy;
 	uint32_t default_texture_id;
 	// ANIMATED TEXTURES
 	uint32_t is_animated;
@@ -123,6 +125,9 @@ extern uint32_t current_program;
 
 extern int max_texture_size;
 
+extern uint32_t upload_mutable_textures;
+extern uint32_t last_mutable_texture;
+
 typedef void (*draw_field_shadow_callback)(void);
 
 void gl_draw_movie_quad(uint32_t width, uint32_t height);
@@ -140,11 +145,13 @@ uint32_t gl_defer_world_external_mesh();
 uint32_t gl_defer_cloud_external_mesh();
 void gl_draw_deferred(draw_field_shadow_callback shadow_callback);
 struct boundingbox calculateSceneAabb();
+bool calculateShadowCasterBounds(struct matrix *lightViewMatrix, struct boundingbox *casterBounds);
 void gl_draw_sorted_deferred();
 void gl_check_deferred(struct texture_set *texture_set);
 void gl_cleanup_deferred();
+uint32_t gl_texture_set_policy(struct tex_header *tex_header);
 uint32_t gl_special_case(uint32_t primitivetype, uint32_t vertextype, struct nvertex *vertices, uint32_t vertexcount, WORD *indices, uint32_t count, struct graphics_object *graphics_object, uint32_t clip, uint32_t mipmap);
-void gl_calculate_normals(std::vector<vector3<float>>* normals, struct indexed_primitive* ip, struct polygon_data *polydata, struct light_data* lightdata);
+vector3<float>* gl_calculate_normals(struct indexed_primitive* ip, struct polygon_data *polydata, struct light_data* lightdata);
 void gl_draw_without_lighting(struct indexed_primitive* ip, struct polygon_data *polydata, struct light_data* lightdata, uint32_t clip);
 void gl_draw_with_lighting(struct indexed_primitive *ip, struct polygon_data *polydata, struct light_data* lightdata, uint32_t clip);
 void gl_draw_indexed_primitive(uint32_t, uint32_t, struct nvertex *, struct vector3<float>* normals, uint32_t, WORD *, uint32_t, struct graphics_object *, struct boundingbox* boundingbox, struct light_data* lightdata, uint32_t clip, uint32_t mipmap);
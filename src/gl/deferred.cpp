@@ -779,6 +779,73 @@ struct boundingbox calculateSceneAabb()
 	return sceneAabb;
 }
 
+// bounds of the shadow casting deferred draws in light view space
+// returns false when some casters have no bounding box, the light frustum can't be fitted then
+bool calculateShadowCasterBounds(struct matrix *lightViewMatrix, struct boundingbox *casterBounds)
+{
+	bool hasCasters = false;
+
+	casterBounds->min_x = FLT_MAX;
+	casterBounds->min_y = FLT_MAX;
+	casterBounds->min_z = FLT_MAX;
+	casterBounds->max_x = -FLT_MAX;
+	casterBounds->max_y = -FLT_MAX;
+	casterBounds->max_z = -FLT_MAX;
+
+	for (int i = 0; i < num_deferred; ++i)
+	{
+		switch (deferred_draws[i].draw_call_type)
+		{
+			case DCT_EXTERNAL_MESH:
+			case DCT_WORLD_EXTERNAL_MESH:
+			case DCT_CLOUD_EXTERNAL_MESH:
+				return false;
+			case DCT_DRAW:
+				break;
+			default:
+				continue;
+		}
+
+		if (deferred_draws[i].vertices == nullptr || deferred_draws[i].vertextype == TLVERTEX || deferred_draws[i].normals == nullptr)
+		{
+			continue;
+		}
+
+		struct boundingbox* bb = deferred_draws[i].boundingbox;
+		if (bb == nullptr) return false;
+
+		vector3<float> corners[8] = { {bb->min_x, bb->min_y, bb->min_z},
+								   {bb->min_x, bb->min_y, bb->max_z},
+								   {bb->min_x, bb->max_y, bb->min_z},
+								   {bb->min_x, bb->max_y, bb->max_z},
+								   {bb->max_x, bb->min_y, bb->min_z},
+								   {bb->max_x, bb->min_y, bb->max_z},
+								   {bb->max_x, bb->max_y, bb->min_z},
+								   {bb->max_x, bb->max_y, bb->max_z} };
+
+		struct matrix worldLightViewMatrix;
+		multiply_matrix(&deferred_draws[i].state.world_view_matrix, lightViewMatrix, &worldLightViewMatrix);
+
+		for (int j = 0; j < 8; ++j)
+		{
+			vector3<float> cornerLightSpace;
+			transform_point(&worldLightViewMatrix, &corners[j], &cornerLightSpace);
+
+			casterBounds->min_x = std::min(casterBounds->min_x, cornerLightSpace.x);
+			casterBounds->min_y = std::min(casterBounds->min_y, cornerLightSpace.y);
+			casterBounds->min_z = std::min(casterBounds->min_z, cornerLightSpace.z);
+
+			casterBounds->max_x = std::max(casterBounds->max_x, cornerLightSpace.x);
+			casterBounds->max_y = std::max(casterBounds->max_y, cornerLightSpace.y);
+			casterBounds->max_z = std::max(casterBounds->max_z, cornerLightSpace.z);
+		}
+
+		hasCasters = true;
+	}
+
+	return hasCasters;
+}
+
 // draw all the layers we've accumulated in the correct order and reset queue
 void gl_draw_sorted_deferred()
 {
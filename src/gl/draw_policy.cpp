@@ -0,0 +1,116 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "draw_policy.h"
+
+#include <ctype.h>
+#include <string.h>
+
+uint32_t gl_texture_name_policy(bool ff8, const char *pc_name)
+{
+	// prefix compared by the original special case, menu/btl_win_c_ without its last character
+	static const char window_border[] = "menu/btl_win_c";
+	uint32_t policy = 0;
+
+	if(ff8 || pc_name == nullptr) return policy;
+
+	for(size_t i = 0; i < sizeof(window_border) - 1; i++)
+	{
+		if(tolower((unsigned char)pc_name[i]) != window_border[i]) return policy;
+	}
+
+	// avoid filtering window borders
+	policy |= GL_TEXTURE_POLICY_WINDOW_BORDER;
+
+	return policy;
+}
+
+uint32_t gl_mode_policy(bool ff8, uint32_t mode, bool worldmap_internal_highres_textures)
+{
+	uint32_t policy = 0;
+
+	// z-sort by default in menu, unnecessary sorting will be avoided by defer logic
+	if(mode == MODE_MENU || mode == MODE_MAIN_MENU) policy |= GL_MODE_POLICY_ZSORT;
+
+	if(ff8)
+	{
+		// Force disabling filter for ff8 worldmap
+		if(mode == MODE_WORLDMAP) policy |= GL_MODE_POLICY_NO_FILTER_EXTERNAL | (worldmap_internal_highres_textures ? GL_MODE_POLICY_NO_FILTER_INTERNAL : 0);
+
+		return policy;
+	}
+
+	policy |= GL_MODE_POLICY_DEFER;
+
+	// Force disabling filter for ff7 minigames internal textures
+	if(mode == MODE_SUBMARINE || mode == MODE_COASTER) policy |= GL_MODE_POLICY_NO_FILTER_INTERNAL;
+
+	// modpath textures rendered in 3D should always be filtered, and in menu always
+	policy |= GL_MODE_POLICY_FILTER_EXTERNAL_3D;
+	if(mode == MODE_MENU || mode == MODE_MAIN_MENU) policy |= GL_MODE_POLICY_FILTER_EXTERNAL;
+
+	// z-sort select menu elements everywhere
+	policy |= GL_MODE_POLICY_ZSORT_OBJECTS;
+
+	// always z-sort vanilla messages, and fix timer messages when window is normal
+	if(mode == MODE_FIELD) policy |= GL_MODE_POLICY_ZSORT_WINDOWS;
+
+	// z-sort some GUI elements in battle (necessary for ESUI)
+	if(mode == MODE_BATTLE) policy |= GL_MODE_POLICY_ZSORT_BATTLE_BARS;
+
+	return policy;
+}
+
+gl_draw_policy_result gl_draw_policy(const gl_draw_policy_input &input)
+{
+	const uint32_t policy = input.mode_policy;
+	gl_draw_policy_result result = { input.texture_filter, false, false };
+
+	if((policy & GL_MODE_POLICY_NO_FILTER_INTERNAL) && !input.external) result.texture_filter = false;
+	if((policy & GL_MODE_POLICY_NO_FILTER_EXTERNAL) && input.external) result.texture_filter = false;
+
+	// some modpath textures have filtering or z-sort forced on
+	if(input.force_filter && input.external) result.texture_filter = true;
+	if(input.force_zsort && input.external) result.defer = true;
+
+	if(policy & GL_MODE_POLICY_ZSORT) result.defer = true;
+
+	if((policy & GL_MODE_POLICY_FILTER_EXTERNAL_3D) && !input.tlvertex && input.external) result.texture_filter = true;
+	if((policy & GL_MODE_POLICY_FILTER_EXTERNAL) && input.external) result.texture_filter = true;
+
+	// avoid filtering window borders
+	if((input.texture_policy & GL_TEXTURE_POLICY_WINDOW_BORDER) && input.palette_index == 0) result.texture_filter = false;
+
+	if((policy & GL_MODE_POLICY_ZSORT_OBJECTS) && (input.objects & (GL_DRAW_OBJECT_MENU_FADE | GL_DRAW_OBJECT_BLEND_WINDOW_BG))) result.defer = true;
+	if((policy & GL_MODE_POLICY_ZSORT_WINDOWS) && (input.objects & (GL_DRAW_OBJECT_WINDOW_BG | GL_DRAW_OBJECT_BATTLE_WINDOW))) result.force_defer = true;
+	if((policy & GL_MODE_POLICY_ZSORT_BATTLE_BARS) && (input.objects & GL_DRAW_OBJECT_BATTLE_BAR)) result.defer = true;
+
+	if(!(policy & GL_MODE_POLICY_DEFER))
+	{
+		result.defer = false;
+		result.force_defer = false;
+	}
+
+	// If we use internal texture and the game asks for filtering, we only enabled it if enable_bilinear is set
+	if(!result.defer && !result.force_defer && !input.external && result.texture_filter && !input.enable_bilinear) result.texture_filter = false;
+
+	return result;
+}
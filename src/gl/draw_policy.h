@@ -0,0 +1,81 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "../game_modes.h"
+
+// Decisions of gl_special_case that only depend on the texture, taken once per load by gl_texture_set_policy
+enum GLTextureSetPolicy
+{
+	GL_TEXTURE_POLICY_WINDOW_BORDER = 1 << 0, // never filtered with the first palette
+};
+
+// Decisions of gl_special_case that only depend on the game and its mode, taken when the mode changes
+enum GLModePolicy
+{
+	GL_MODE_POLICY_NO_FILTER_INTERNAL = 1 << 0, // internal textures are never filtered
+	GL_MODE_POLICY_NO_FILTER_EXTERNAL = 1 << 1, // external textures are never filtered
+	GL_MODE_POLICY_FILTER_EXTERNAL    = 1 << 2, // external textures are always filtered
+	GL_MODE_POLICY_FILTER_EXTERNAL_3D = 1 << 3, // external textures are always filtered outside of 2D draws
+	GL_MODE_POLICY_ZSORT              = 1 << 4, // every draw is z-sorted
+	GL_MODE_POLICY_ZSORT_OBJECTS      = 1 << 5, // draws of the menu objects below can be z-sorted
+	GL_MODE_POLICY_ZSORT_WINDOWS      = 1 << 6, // message and battle windows are always z-sorted
+	GL_MODE_POLICY_ZSORT_BATTLE_BARS  = 1 << 7, // limit and barrier bars are z-sorted
+	GL_MODE_POLICY_DEFER              = 1 << 8, // z-sorted draws are deferred, never the case in FF8
+};
+
+// Graphics objects of the FF7 menu drawn with a special case, as a mask of those the drawn object is
+enum GLDrawObject
+{
+	GL_DRAW_OBJECT_MENU_FADE       = 1 << 0,
+	GL_DRAW_OBJECT_BLEND_WINDOW_BG = 1 << 1,
+	GL_DRAW_OBJECT_WINDOW_BG       = 1 << 2,
+	GL_DRAW_OBJECT_BATTLE_WINDOW   = 1 << 3, // btl_win_a to btl_win_d and _btl_win
+	GL_DRAW_OBJECT_BATTLE_BAR      = 1 << 4, // limit and barrier bars, limit box
+};
+
+struct gl_draw_policy_input
+{
+	uint32_t mode_policy;    // gl_mode_policy
+	uint32_t texture_policy; // GLTextureSetPolicy of the texture set, 0 without texture
+	bool external;           // external texture
+	bool force_filter;       // modpath texture with filtering forced on
+	bool force_zsort;        // modpath texture with z-sort forced on
+	uint32_t palette_index;
+	bool tlvertex;           // 2D draw
+	uint32_t objects;        // GLDrawObject mask
+	bool texture_filter;     // filtering asked by the game
+	bool enable_bilinear;
+};
+
+struct gl_draw_policy_result
+{
+	bool texture_filter;
+	bool defer;
+	bool force_defer;
+};
+
+uint32_t gl_texture_name_policy(bool ff8, const char *pc_name);
+uint32_t gl_mode_policy(bool ff8, uint32_t mode, bool worldmap_internal_highres_textures);
+gl_draw_policy_result gl_draw_policy(const gl_draw_policy_input &input);
@@ -23,6 +23,8 @@
 #include <stdio.h>
 #include <math.h>
 #include <algorithm>
+#include <unordered_map>
+#include <xxhash.h>
 
 #include "../renderer.h"
 #include "../cfg.h"
@@ -30,6 +32,9 @@
 #include "../macro.h"
 #include "../log.h"
 #include "../matrix.h"
+#include "../lighting.h"
+#include "../draw_capture.h"
+#include "normals.h"
 
 #include "../ff7/widescreen.h"
 #include "external_mesh.h"
@@ -194,63 +199,41 @@ void gl_load_state(struct driver_state *src, bool bind_textures)
 	gl_set_d3dprojection_matrix(&src->d3dprojection_matrix);
 }
 
-void gl_calculate_normals(std::vector<vector3<float>>* pNormals, struct indexed_primitive* ip, struct polygon_data *polydata, struct light_data* lightdata)
-{
-	bool has_model_data = false;
-	static vector3<float> zero = { 0.0f, 0.0f, 0.0f };
-	auto& normals = *pNormals;
-
-	normals.resize(ip->vertexcount);
-	std::fill(normals.begin(), normals.end(), zero);
+static std::unordered_map<struct indexed_primitive*, normals_cache_entry> normals_cache;
+static const size_t normals_cache_max_entries = 4096;
 
+vector3<float>* gl_calculate_normals(struct indexed_primitive* ip, struct polygon_data *polydata, struct light_data* lightdata)
+{
 	// User wants to attempt to load model data
 	if (!prefer_lighting_cpu_calculations)
 	{
 		// If models do provide normal data, use it
 		if (polydata->normaldata != NULL)
 		{
+			static std::vector<vector3<float>> normals;
+
+			normals.resize(ip->vertexcount);
+
 			for (uint32_t idx = 0; idx < ip->vertexcount; idx++)
 			{
 				normals[idx] = polydata->has_normindextable ? polydata->normaldata[polydata->normindextabledata[idx]] : polydata->normaldata[idx];
 			}
 
-			has_model_data = true;
+			return normals.data();
 		}
 	}
 
 	// If the previous code was not able to fetch the model normal data, we have to calculate it on the CPU
-	if (!has_model_data)
-	{
-		vector3<float> e12, e13, triNormal;
-
-		// Calculate vertex normals by averaging adjacent triangle normals
-		// Vertex normals are calculated here because battle models dont seem to include normals
-		for (uint32_t idx = 0; idx < ip->indexcount; idx+=3)
-		{
-			e12 = e13 = triNormal = zero;
-
-			int vId0 = ip->indices[idx];
-			int vId1 = ip->indices[idx + 1];
-			int vId2 = ip->indices[idx + 2];
-
-			auto v1 = &ip->vertices[vId0]._;
-			auto v2 = &ip->vertices[vId1]._;
-			auto v3 = &ip->vertices[vId2]._;
+	// Vertex normals are calculated here because battle models dont seem to include normals
+	// The result is cached per primitive and only regenerated when its vertex positions or indices change
+	if (normals_cache.size() >= normals_cache_max_entries && !normals_cache.contains(ip)) normals_cache.clear();
 
-			subtract_vector(v2, v1, &e12);
-			subtract_vector(v3, v1, &e13);
-			cross_product(&e13, &e12, &triNormal);
+	normals_cache_entry &entry = normals_cache[ip];
+	uint64_t indices_hash = XXH3_64bits(ip->indices, ip->indexcount * sizeof(*ip->indices));
 
-			add_vector(&normals[vId0], &triNormal, &normals[vId0]);
-			add_vector(&normals[vId1], &triNormal, &normals[vId1]);
-			add_vector(&normals[vId2], &triNormal, &normals[vId2]);
-		}
+	gl_update_normals(entry, polydata, ip->indices, ip->indexcount, indices_hash, &ip->vertices[0]._, sizeof(*ip->vertices), ip->vertexcount);
 
-		for (uint32_t idx = 0; idx < ip->vertexcount; idx++)
-		{
-			normalize_vector(&normals[idx]);
-		}
-	}
+	return entry.normals.data();
 }
 
 void gl_draw_without_lighting(struct indexed_primitive* ip, struct polygon_data *polydata, struct light_data* lightdata, uint32_t clip)
@@ -262,11 +245,10 @@ void gl_draw_without_lighting(struct indexed_primitive* ip, struct polygon_data
 		return;
 	}
 	
-	static std::vector<vector3<float>> normals;
 	if (!ff8 && lightdata != nullptr && game_lighting != GAME_LIGHTING_ORIGINAL)
 	{
-		gl_calculate_normals(&normals, ip, polydata, lightdata);
-		gl_draw_indexed_primitive(ip->primitivetype, ip->vertextype, ip->vertices, normals.data(), ip->vertexcount, ip->indices, ip->indexcount, 0, 0, lightdata, clip, true);
+		vector3<float>* normals = gl_calculate_normals(ip, polydata, lightdata);
+		gl_draw_indexed_primitive(ip->primitivetype, ip->vertextype, ip->vertices, normals, ip->vertexcount, ip->indices, ip->indexcount, 0, 0, lightdata, clip, true);
 	} else gl_draw_indexed_primitive(ip->primitivetype, ip->vertextype, ip->vertices, nullptr, ip->vertexcount, ip->indices, ip->indexcount, 0, 0, lightdata, clip, true);
 }
 
@@ -280,11 +262,10 @@ void gl_draw_with_lighting(struct indexed_primitive *ip, struct polygon_data *po
 		return;
 	}
 
-	static std::vector<vector3<float>> normals;
 	if (!ff8)
 	{
-		gl_calculate_normals(&normals, ip, polydata, lightdata);
-		gl_draw_indexed_primitive(ip->primitivetype, ip->vertextype, ip->vertices, normals.data(), ip->vertexcount, ip->indices, ip->indexcount, 0, polydata->boundingboxdata, lightdata, clip, true);
+		vector3<float>* normals = gl_calculate_normals(ip, polydata, lightdata);
+		gl_draw_indexed_primitive(ip->primitivetype, ip->vertextype, ip->vertices, normals, ip->vertexcount, ip->indices, ip->indexcount, 0, polydata->boundingboxdata, lightdata, clip, true);
 	}
 	else gl_draw_indexed_primitive(ip->primitivetype, ip->vertextype, ip->vertices, nullptr, ip->vertexcount, ip->indices, ip->indexcount, 0, polydata->boundingboxdata, lightdata, clip, true);
 }
@@ -365,6 +346,9 @@ void gl_draw_indexed_primitive(uint32_t primitivetype, uint32_t vertextype, stru
 	newRenderer.bindIndexBuffer(indices, count);
 	newRenderer.setPrimitiveType(RendererPrimitiveType(primitivetype));
 
+	// Recorded at submission: deferred and sorted draws come back here when they are replayed
+	drawCapture.recordDraw(primitivetype, vertextype, vertices, vertexcount, indices, count, clip, mipmap);
+
 	if(!ff8 && lightdata != nullptr && normals != nullptr && game_lighting != GAME_LIGHTING_ORIGINAL)
 	{
 		newRenderer.setGameLightData(lightdata);
@@ -372,12 +356,22 @@ void gl_draw_indexed_primitive(uint32_t primitivetype, uint32_t vertextype, stru
 
 	if (!ff8 && enable_lighting && normals != nullptr && isLightingEnabledTexture)
 	{
-		newRenderer.drawToShadowMap();
-		newRenderer.drawWithLighting(true, true);
+		// Skip the shadow pass for casters outside of the light frustum
+		if (lighting.isInShadowFrustum(boundingbox, &current_state.world_view_matrix))
+		{
+			newRenderer.drawToShadowMap();
+			newRenderer.drawWithLighting(true, true);
+		}
+		else
+		{
+			stats.shadow_culled++;
+			newRenderer.drawWithLighting();
+		}
 	}
 	else newRenderer.draw();
 
 	stats.vertex_count += count;
+	stats.draw_calls++;
 
 	current_state.texture_filter = saved_texture_filter;
 }
@@ -0,0 +1,111 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "normals.h"
+
+#include <math.h>
+#include <string.h>
+#include <xmmintrin.h>
+
+// Same operations and summation order as the original scalar code, so the results are bit identical
+static void gl_generate_normals(normals_cache_entry &entry, const uint16_t *indices)
+{
+	const vector3<float> *pos = entry.positions.data();
+	vector3<float> *normals = entry.normals.data();
+	uint32_t facecount = entry.indexcount / 3;
+	uint32_t vertexcount = entry.normals.size();
+	uint32_t vertex = 0;
+
+	alignas(16) float out[3][4];
+
+	memset(normals, 0, vertexcount * sizeof(*normals));
+
+	for (uint32_t face = 0; face < facecount; face++)
+	{
+		const vector3<float> &v1 = pos[indices[face * 3]], &v2 = pos[indices[face * 3 + 1]], &v3 = pos[indices[face * 3 + 2]];
+		vector3<float> e12 = { v2.x - v1.x, v2.y - v1.y, v2.z - v1.z };
+		vector3<float> e13 = { v3.x - v1.x, v3.y - v1.y, v3.z - v1.z };
+		vector3<float> n = { e13.y * e12.z - e13.z * e12.y, e13.z * e12.x - e13.x * e12.z, e13.x * e12.y - e13.y * e12.x };
+
+		for (uint32_t corner = 0; corner < 3; corner++)
+		{
+			vector3<float> &sum = normals[indices[face * 3 + corner]];
+			sum.x += n.x;
+			sum.y += n.y;
+			sum.z += n.z;
+		}
+	}
+
+	for (; vertex + 4 <= vertexcount; vertex += 4)
+	{
+		__m128 x = _mm_setr_ps(normals[vertex].x, normals[vertex + 1].x, normals[vertex + 2].x, normals[vertex + 3].x);
+		__m128 y = _mm_setr_ps(normals[vertex].y, normals[vertex + 1].y, normals[vertex + 2].y, normals[vertex + 3].y);
+		__m128 z = _mm_setr_ps(normals[vertex].z, normals[vertex + 1].z, normals[vertex + 2].z, normals[vertex + 3].z);
+		__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+
+		_mm_store_ps(out[0], _mm_div_ps(x, length));
+		_mm_store_ps(out[1], _mm_div_ps(y, length));
+		_mm_store_ps(out[2], _mm_div_ps(z, length));
+
+		for (int lane = 0; lane < 4; lane++) normals[vertex + lane] = { out[0][lane], out[1][lane], out[2][lane] };
+	}
+
+	for (; vertex < vertexcount; vertex++)
+	{
+		vector3<float> &n = normals[vertex];
+		float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+
+		n = { n.x / length, n.y / length, n.z / length };
+	}
+}
+
+bool gl_update_normals(normals_cache_entry &entry, const void *owner, const uint16_t *indices, uint32_t indexcount, uint64_t indices_hash, const vector3<float> *positions, size_t stride, uint32_t vertexcount)
+{
+	bool topology_changed = entry.owner != owner || entry.indexcount != indexcount || entry.indices_hash != indices_hash || entry.normals.size() != vertexcount;
+	bool positions_changed = topology_changed;
+
+	if (topology_changed)
+	{
+		entry.owner = owner;
+		entry.indexcount = indexcount;
+		entry.indices_hash = indices_hash;
+		entry.positions.resize(vertexcount);
+		entry.normals.resize(vertexcount);
+	}
+
+	const uint8_t *position = (const uint8_t *)positions;
+	vector3<float> *cached = entry.positions.data();
+	uint32_t idx = 0;
+
+	// Compare only until the first difference, then copy the rest
+	if (!positions_changed)
+	{
+		while (idx < vertexcount && memcmp(&cached[idx], position + idx * stride, sizeof(*cached)) == 0) idx++;
+
+		positions_changed = idx < vertexcount;
+	}
+
+	for (; idx < vertexcount; idx++) memcpy(&cached[idx], position + idx * stride, sizeof(*cached));
+
+	if (positions_changed) gl_generate_normals(entry, indices);
+
+	return positions_changed;
+}
@@ -0,0 +1,45 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "../matrix.h"
+
+// Vertex normals generated from a triangle list, for models that do not provide any.
+// Kept per primitive and only regenerated when the indices or the vertex positions change.
+struct normals_cache_entry
+{
+	const void *owner = nullptr;
+	uint32_t indexcount = 0;
+	uint64_t indices_hash = 0;
+	// Last vertex positions the normals were generated from
+	std::vector<vector3<float>> positions;
+	std::vector<vector3<float>> normals;
+};
+
+// Positions are read with a byte stride, so vertex arrays can be passed as they are.
+// owner and indices_hash identify the topology, the caller picks them (polygon data and a hash of the indices).
+// Returns true when the normals in entry.normals had to be generated again.
+bool gl_update_normals(normals_cache_entry &entry, const void *owner, const uint16_t *indices, uint32_t indexcount, uint64_t indices_hash, const vector3<float> *positions, size_t stride, uint32_t vertexcount);
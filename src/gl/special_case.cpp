@@ -32,117 +32,107 @@
 
 #define SAFE_GFXOBJ_CHECK(X, Y) ((X) && (X) == (struct graphics_object *)(Y))
 
+// texture dependent part of the special cases, computed when the texture is loaded instead of on every draw
+uint32_t gl_texture_set_policy(struct tex_header *tex_header)
+{
+	VOBJ(tex_header, tex_header, tex_header);
+
+	if(!VPTR(tex_header) || (uint32_t)VREF(tex_header, file.pc_name) <= 32) return 0;
+
+	return gl_texture_name_policy(ff8, VREF(tex_header, file.pc_name));
+}
+
+// menu objects the drawn object is, for the special cases of gl_draw_policy
+static uint32_t gl_draw_objects(struct graphics_object *graphics_object)
+{
+	uint32_t objects = 0;
+
+	if(ff8 || !graphics_object) return objects;
+
+	if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->menu_fade)) objects |= GL_DRAW_OBJECT_MENU_FADE;
+	if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->blend_window_bg)) objects |= GL_DRAW_OBJECT_BLEND_WINDOW_BG;
+	if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->window_bg)) objects |= GL_DRAW_OBJECT_WINDOW_BG;
+	if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->_btl_win)) objects |= GL_DRAW_OBJECT_BATTLE_WINDOW;
+	if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->btl_win_a)) objects |= GL_DRAW_OBJECT_BATTLE_WINDOW;
+	if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->btl_win_b)) objects |= GL_DRAW_OBJECT_BATTLE_WINDOW;
+	if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->btl_win_c)) objects |= GL_DRAW_OBJECT_BATTLE_WINDOW;
+	if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->btl_win_d)) objects |= GL_DRAW_OBJECT_BATTLE_WINDOW;
+	if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->unknown2)) objects |= GL_DRAW_OBJECT_BATTLE_BAR; // Limit and barrier bar
+	if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->unknown3)) objects |= GL_DRAW_OBJECT_BATTLE_BAR; // Limit and barrier bar
+	if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->unknown5)) objects |= GL_DRAW_OBJECT_BATTLE_BAR; // Limit box
+
+	return objects;
+}
+
 // rendering special cases, returns true if the draw call has been handled in
 // some way and should not be rendered normally
 // it is generally not safe to modify source data directly, a copy should be
 // made and rendered separately
 uint32_t gl_special_case(uint32_t primitivetype, uint32_t vertextype, struct nvertex *vertices, uint32_t vertexcount, WORD *indices, uint32_t count, struct graphics_object *graphics_object, uint32_t clip, uint32_t mipmap)
 {
+	static uint32_t policy_mode = -1;
+	static uint32_t mode_policy = 0;
 	uint32_t mode = getmode_cached()->driver_mode;
 	VOBJ(texture_set, texture_set, current_state.texture_set);
-	uint32_t defer = false, force_defer = false;
 	bool isExternalTexture = current_state.texture_set && VREF(texture_set, ogl.external);
 
-	// Force disabling filter for ff7 minigames internal textures
-	if(!ff8 && (mode == MODE_SUBMARINE || mode == MODE_COASTER) && !isExternalTexture) current_state.texture_filter = false;
-
-	// Force disabling filter for ff8 worldmap
-	if(ff8 && mode == MODE_WORLDMAP && (isExternalTexture || ff8_worldmap_internal_highres_textures)) current_state.texture_filter = false;
-
-	// some modpath textures have filtering forced on
-	if(current_state.texture_set && VREF(texture_set, ogl.gl_set->force_filter) && isExternalTexture) current_state.texture_filter = true;
-
-	// some modpath textures have z-sort forced on
-	if(current_state.texture_set && VREF(texture_set, ogl.gl_set->force_zsort) && isExternalTexture) defer = true;
-
-	// z-sort by default in menu, unnecessary sorting will be avoided by defer logic
-	if(mode == MODE_MENU || mode == MODE_MAIN_MENU) defer = true;
-
-	if(!ff8)
+	if(mode != policy_mode)
 	{
-		// modpath textures rendered in 3D should always be filtered
-		if(vertextype != TLVERTEX && isExternalTexture) current_state.texture_filter = true;
-
-		// modpath textures in menu should always be filtered
-		if((mode == MODE_MENU || mode == MODE_MAIN_MENU) && isExternalTexture) current_state.texture_filter = true;
-
-		if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->buster_tex))
-		{
-			// stretch main menu to fullscreen if it is a modpath texture
-			if(VREF(texture_set, ogl.external) && vertexcount == 4)
-			{
-				float texture_ratio = VREF(texture_set, ogl.width) / (float)VREF(texture_set, ogl.height);
-				bool use_wide_vertices = abs(texture_ratio - 16 / (aspect_ratio == AR_WIDESCREEN_16X10 ? 10.f : 9.f)) <= 0.01 && widescreen_enabled;
-				float x = use_wide_vertices ? wide_viewport_x : 0.0f;
-				float y = 0.0f;
-				float width = use_wide_vertices ? wide_viewport_width : game_width;
-				float height = game_height;
-				vertices[0]._.x = x;
-				vertices[0]._.y = y;
-				vertices[0]._.z = 1.0f;
-				vertices[1]._.x = x;
-				vertices[1]._.y = y + height;
-				vertices[1]._.z = 1.0f;
-				vertices[2]._.x = x + width;
-				vertices[2]._.y = y;
-				vertices[2]._.z = 1.0f;
-				vertices[3]._.x = x + width;
-				vertices[3]._.y = y + height;
-				vertices[3]._.z = 1.0f;
-				vertices[0].u = 0.0f;
-				vertices[0].v = 0.0f;
-				vertices[1].u = 0.0f;
-				vertices[1].v = 1.0f;
-				vertices[2].u = 1.0f;
-				vertices[2].v = 0.0f;
-				vertices[3].u = 1.0f;
-				vertices[3].v = 1.0f;
-			}
-		}
-
-		if(current_state.texture_set && VREF(texture_set, tex_header))
-		{
-			VOBJ(tex_header, tex_header, VREF(texture_set, tex_header));
-
-			if((uint32_t)VREF(tex_header, file.pc_name) > 32)
-			{
-				// avoid filtering window borders
-				if(!_strnicmp(VREF(tex_header, file.pc_name), "menu/btl_win_c_", strlen("menu/btl_win_c_") - 1) && VREF(texture_set, palette_index) == 0) current_state.texture_filter = false;
-			}
-		}
-
-		// z-sort select menu elements everywhere
-		if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->menu_fade)) defer = true;
-		if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->blend_window_bg)) defer = true;
-
-		if(mode == MODE_FIELD)
-		{
-			// always z-sort vanilla messages
-			if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->window_bg)) force_defer = true;
-
-			// fix timer messages when window is normal
-			if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->_btl_win)) force_defer = true;
-			if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->btl_win_a)) force_defer = true;
-			if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->btl_win_b)) force_defer = true;
-			if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->btl_win_c)) force_defer = true;
-			if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->btl_win_d)) force_defer = true;
-		}
+		mode_policy = gl_mode_policy(ff8, mode, ff8_worldmap_internal_highres_textures);
+		policy_mode = mode;
+	}
 
-		if(mode == MODE_BATTLE)
+	if(!ff8 && SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->buster_tex))
+	{
+		// stretch main menu to fullscreen if it is a modpath texture
+		if(VREF(texture_set, ogl.external) && vertexcount == 4)
 		{
-			// z-sort some GUI elements in battle
-			if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->unknown2)) defer = true; // Limit and barrier bar (necessary for ESUI)
-			if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->unknown3)) defer = true; // Limit and barrier bar (necessary for ESUI)
-			if(SAFE_GFXOBJ_CHECK(graphics_object, ff7_externals.menu_objects->unknown5)) defer = true; // Limit box (necessary for ESUI)
+			float texture_ratio = VREF(texture_set, ogl.width) / (float)VREF(texture_set, ogl.height);
+			bool use_wide_vertices = abs(texture_ratio - 16 / (aspect_ratio == AR_WIDESCREEN_16X10 ? 10.f : 9.f)) <= 0.01 && widescreen_enabled;
+			float x = use_wide_vertices ? wide_viewport_x : 0.0f;
+			float y = 0.0f;
+			float width = use_wide_vertices ? wide_viewport_width : game_width;
+			float height = game_height;
+			vertices[0]._.x = x;
+			vertices[0]._.y = y;
+			vertices[0]._.z = 1.0f;
+			vertices[1]._.x = x;
+			vertices[1]._.y = y + height;
+			vertices[1]._.z = 1.0f;
+			vertices[2]._.x = x + width;
+			vertices[2]._.y = y;
+			vertices[2]._.z = 1.0f;
+			vertices[3]._.x = x + width;
+			vertices[3]._.y = y + height;
+			vertices[3]._.z = 1.0f;
+			vertices[0].u = 0.0f;
+			vertices[0].v = 0.0f;
+			vertices[1].u = 0.0f;
+			vertices[1].v = 1.0f;
+			vertices[2].u = 1.0f;
+			vertices[2].v = 0.0f;
+			vertices[3].u = 1.0f;
+			vertices[3].v = 1.0f;
 		}
 	}
 
-	if((defer || force_defer) && !ff8) return gl_defer_sorted_draw(primitivetype, vertextype, vertices, vertexcount, indices, count, clip, mipmap, force_defer);
-
-	// If we use internal texture and the game asks for filtering, we only enabled it if enable_bilinear is set
-	if (!isExternalTexture && current_state.texture_filter && !enable_bilinear) {
-		current_state.texture_filter = false;
-	}
+	gl_draw_policy_input input = {
+		mode_policy,
+		current_state.texture_set ? VREF(texture_set, ogl.gl_set->draw_policy) : 0,
+		isExternalTexture,
+		current_state.texture_set && VREF(texture_set, ogl.gl_set->force_filter),
+		current_state.texture_set && VREF(texture_set, ogl.gl_set->force_zsort),
+		current_state.texture_set ? VREF(texture_set, palette_index) : 0,
+		vertextype == TLVERTEX,
+		gl_draw_objects(graphics_object),
+		bool(current_state.texture_filter),
+		enable_bilinear
+	};
+	gl_draw_policy_result result = gl_draw_policy(input);
+
+	current_state.texture_filter = result.texture_filter;
+
+	if(result.defer || result.force_defer) return gl_defer_sorted_draw(primitivetype, vertextype, vertices, vertexcount, indices, count, clip, mipmap, result.force_defer);
 
 	return false;
 }
@@ -24,6 +24,11 @@
 #include "../log.h"
 #include "../gl.h"
 #include "../macro.h"
+#include "../draw_capture.h"
+
+// textures uploaded while this is set can be updated in place later, see texture_reload_hack
+uint32_t upload_mutable_textures = false;
+uint32_t last_mutable_texture = 0;
 
 // check to make sure we can actually load a given texture
 bool gl_check_texture_dimensions(uint32_t width, uint32_t height, char *source)
@@ -71,14 +76,21 @@ void gl_upload_texture(struct texture_set *texture_set, uint32_t palette_index,
 
 	gl_check_texture_dimensions(w, h, "unknown");
 
+	drawCapture.recordTexture(texture_set, palette_index, w, h, format, image_data);
+
 	uint32_t newTexture = newRenderer.createTexture(
 		(uint8_t*)image_data,
 		w,
 		h,
-		0,
+		upload_mutable_textures && format == RendererTextureType::BGRA ? w * 4 : 0,
 		RendererTextureType(format)
 	);
 
+	if (upload_mutable_textures && format == RendererTextureType::BGRA) last_mutable_texture = newTexture;
+
+	stats.texture_uploads++;
+	stats.texture_upload_bytes += w * h * (format == RendererTextureType::BGRA ? 4 : 2);
+
 	gl_replace_texture(
 		texture_set,
 		palette_index,
@@ -31,265 +31,115 @@ Hext hextPatcher;
 
 // PRIVATE
 
-int Hext::getAddress(std::string token)
+static int readPointer(int address)
 {
-    int ret;
-
-    std::vector<std::string> sparts = split(token, "[+-]+");
-    std::vector<int> iparts;
-
-    if (ends_with(sparts[0], "^"))
-    {
-        std::stringstream ss;
-        int *ptr = (int*)(std::stoi(sparts[0].substr(0, sparts[0].length() - 1), nullptr, 16) + inGlobalOffset);
-        ss << std::hex << *ptr;
-        sparts[0] = ss.str();
-    }
-
-    for (auto &part : sparts)
-    {
-        iparts.push_back(
-            std::stoi(part, nullptr, 16)
-        );
-    }
-
-    ret = iparts[0];
-
-    if (contains(token, "+"))
-    {
-        ret += iparts[1];
-    }
-    else if (contains(token, "-"))
-    {
-        ret -= iparts[1];
-    }
-
-    return ret + inGlobalOffset;
+    return *(int*)address;
 }
 
-std::vector<char> Hext::getBytes(std::string token)
+void Hext::compile(std::string filename, CompiledFile &compiledFile)
 {
-    std::vector<char> ret;
+    std::string line;
+    std::ifstream ifs(filename);
+    std::vector<std::string> lines;
 
-    if (contains(token, ":"))
+    while (std::getline(ifs, line))
     {
-        std::vector<std::string> parts = split(token, "[:]+");
-        int count = std::stoi(parts[1], nullptr, 0);
-        while (count > 0)
-        {
-            ret.push_back(std::stoi(parts[0], nullptr, 16));
-            count--;
-        }
+        if (!line.empty()) lines.push_back(line);
     }
-    else
-    {
-        std::vector<std::string> bytes = split(token, "[\\s,\\t]+");
 
-        for (auto byte : bytes)
-        {
-            ret.push_back(std::stoi(byte, nullptr, 16));
-        }
-    }
+    ifs.close();
 
-    return ret;
-}
+    compiler.compile(lines, compiledFile.program);
 
-bool Hext::hasCheckpoint(std::string token)
-{
-    if (starts_with(token, "!"))
+    for (const std::string &error : compiledFile.program.errors)
     {
-        return true;
+        ffnx_error("Hext: %s: %s\n", filename.c_str(), error.c_str());
     }
-
-    return false;
 }
 
-bool Hext::parseCheckpoint(std::string token, std::string checkpoint)
+Hext::CompiledFile &Hext::getCompiledFile(std::string filename)
 {
-    if (starts_with(token, "!"))
-    {
-        if (contains(token, checkpoint))
-        {
-            return true;
-        }
-    }
-
-    return false;
-}
+    std::error_code ec;
+    std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(filename, ec);
+    auto it = compiledFiles.find(filename);
 
-bool Hext::parseCommands(std::string token)
-{
-    if (starts_with(token, "<<"))
+    if (it == compiledFiles.end() || it->second.lastWriteTime != lastWriteTime)
     {
-        replaceOnce(token, "<<", "");
+        CompiledFile &compiledFile = compiledFiles[filename];
 
-        trim(token);
+        compile(filename, compiledFile);
+        compiledFile.lastWriteTime = lastWriteTime;
 
-        ffnx_trace("%s\n", token.data());
+        if (trace_all) ffnx_trace("Compiled Hext patch: %s (%d instructions, %d delayed)\n", filename.c_str(), compiledFile.program.instructions.size(), compiledFile.program.delayedInstructions.size());
 
-        return true;
+        return compiledFile;
     }
 
-    return false;
+    return it->second;
 }
 
-bool Hext::parseComment(std::string token)
+void Hext::execute(const std::vector<HextCompiler::Instruction> &instructions)
 {
-    if (isMultilineComment)
-    {
-        if (ends_with(token, "}}")) isMultilineComment = false;
-        return true;
-    }
+    DWORD dummy;
 
-    if (starts_with(token, "{{"))
+    for (const HextCompiler::Instruction &instruction : instructions)
     {
-        isMultilineComment = true;
-        return true;
+        switch (instruction.type)
+        {
+        case HextCompiler::Instruction::Command:
+            ffnx_trace("%s\n", instruction.addressToken.data());
+            break;
+        case HextCompiler::Instruction::MemoryPermission:
+            VirtualProtect((LPVOID)HextCompiler::resolveAddress(instruction, readPointer), instruction.length, PAGE_EXECUTE_READWRITE, &dummy);
+            break;
+        case HextCompiler::Instruction::MemoryPatch:
+            memcpy_code(HextCompiler::resolveAddress(instruction, readPointer), (void *)instruction.bytes.data(), instruction.bytes.size());
+            break;
+        }
     }
-
-    if (starts_with(token, "#")) return true;
-    if (starts_with(token, "{")) return true;
-    if (starts_with(token, ".")) return true;
-
-    return false;
 }
 
-bool Hext::parseGlobalOffset(std::string token)
+const std::vector<std::string> &Hext::getFilenames()
 {
-    if (starts_with(token, "+"))
-    {
-        inGlobalOffset = std::stoi(token.substr(1), nullptr, 16);
+    std::error_code ec;
+    std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(hext_patching_path, ec);
 
-        return true;
-    }
-    else if (starts_with(token, "-"))
-    {
-        inGlobalOffset = -std::stoi(token.substr(1), nullptr, 16);
-
-        return true;
-    }
-
-    return false;
-}
-
-bool Hext::parseMemoryPermission(std::string token)
-{
-    if (contains(token, ":"))
+    // Adding, removing or renaming a file updates the directory modification time
+    if (ec || lastWriteTime != filenamesLastWriteTime)
     {
-        DWORD dummy;
+        filenames.clear();
 
-        std::vector<std::string> parts = split(token, "[:]+");
-        int addr = getAddress(parts[0]);
-        int length = std::stoi(parts[1], nullptr, 16);
-
-        VirtualProtect((LPVOID)addr, length, PAGE_EXECUTE_READWRITE, &dummy);
-
-        return true;
-    }
-
-    return false;
-}
-
-bool Hext::parseMemoryPatch(std::string token)
-{
-    if (contains(token, "="))
-    {
-        DWORD dummy;
-
-        std::vector<std::string> parts = split(token, "[=]+");
-        int addr = getAddress(parts[0]);
-        std::vector<char> bytes = getBytes(parts[1]);
-
-        memcpy_code(addr, bytes.data(), bytes.size());
+        for (const auto& entry : std::filesystem::directory_iterator(hext_patching_path))
+        {
+            if (entry.is_regular_file()) {
+                filenames.push_back(entry.path().string());
+            }
+        }
 
-        return true;
+        filenamesLastWriteTime = lastWriteTime;
     }
 
-    return false;
+    return filenames;
 }
 
 // PUBLIC
 
 void Hext::apply(std::string filename)
 {
-    std::string line;
-    std::ifstream ifs(filename);
-
-    while (std::getline(ifs, line))
-    {
-        if (line.empty()) continue;
-
-        // Check if delayed, if so it should not be applied
-        if (hasCheckpoint(line)) {
-            ifs.close();
-            return;
-        }
-
-        // Check if is a comment
-        if (parseComment(line)) continue;
-
-        // Check if is a command
-        if (parseCommands(line)) continue;
-
-        // Check if is a global offset
-        if (parseGlobalOffset(line)) continue;
-
-        // Check if is a memory permission range
-        if (parseMemoryPermission(line)) continue;
-
-        // Check if is a memory patch instruction
-        if (parseMemoryPatch(line)) continue;
-    }
-
-    ifs.close();
+    execute(getCompiledFile(filename).program.instructions);
 
     ffnx_trace("Applied Hext patch: %s\n", filename.c_str());
 }
 
 void Hext::applyDelayed(std::string filename, std::string checkpoint)
 {
-    std::string line;
-    std::ifstream ifs(filename);
+    const CompiledFile &compiledFile = getCompiledFile(filename);
 
-    bool matchCheckpoint = false;
-
-    while (std::getline(ifs, line))
-    {
-        if (line.empty()) continue;
-
-        // Check if is a comment
-        if (parseComment(line)) continue;
-
-        // Check if is a delayed patch.
-        if (parseCheckpoint(line, checkpoint)) {
-            matchCheckpoint = true;
-
-            continue;
-        }
-
-        if (matchCheckpoint)
-        {
-            // Check if is a command
-            if (parseCommands(line)) continue;
+    if (compiledFile.program.checkpoint.empty() || !contains(compiledFile.program.checkpoint, checkpoint)) return;
 
-            // Check if is a global offset
-            if (parseGlobalOffset(line)) continue;
+    execute(compiledFile.program.delayedInstructions);
 
-            // Check if is a memory permission range
-            if (parseMemoryPermission(line)) continue;
-
-            // Check if is a memory patch instruction
-            if (parseMemoryPatch(line)) continue;
-        }
-        else
-        {
-            break;
-        }
-    }
-
-    ifs.close();
-
-    if (matchCheckpoint) ffnx_trace("Applied delayed Hext patch: %s\n", filename.c_str());
+    ffnx_trace("Applied delayed Hext patch: %s\n", filename.c_str());
 }
 
 void Hext::applyAll(std::string checkpoint)
@@ -298,24 +148,16 @@ void Hext::applyAll(std::string checkpoint)
     {
         if (!checkpoint.empty())
         {
-            for (const auto& entry : std::filesystem::directory_iterator(hext_patching_path))
+            for (const std::string &filename : getFilenames())
             {
-                if (entry.is_regular_file()) {
-                    applyDelayed(entry.path().string(), checkpoint);
-                }
-
-                inGlobalOffset = 0;
+                applyDelayed(filename, checkpoint);
             }
         }
         else
         {
-            for (const auto& entry : std::filesystem::directory_iterator(hext_patching_path))
+            for (const std::string &filename : getFilenames())
             {
-                if (entry.is_regular_file()) {
-                    apply(entry.path().string());
-                }
-
-                inGlobalOffset = 0;
+                apply(filename);
             }
         }
     }
@@ -30,24 +30,30 @@
 
 #pragma once
 
+#include <filesystem>
+#include <map>
 #include <string>
 #include <vector>
 
+#include "hext_compiler.h"
+
 class Hext {
 private:
-	int inGlobalOffset;
-	bool isMultilineComment = false;
-
-	int getAddress(std::string token);
-	std::vector<char> getBytes(std::string token);
-
-	bool hasCheckpoint(std::string token);
-	bool parseCheckpoint(std::string token, std::string checkpoint);
-	bool parseCommands(std::string token);
-	bool parseComment(std::string token);
-	bool parseGlobalOffset(std::string token);
-	bool parseMemoryPermission(std::string token);
-	bool parseMemoryPatch(std::string token);
+	// A Hext file parsed once, replayed on every apply until the file changes
+	struct CompiledFile {
+		std::filesystem::file_time_type lastWriteTime;
+		HextCompiler::Program program;
+	};
+
+	HextCompiler compiler;
+	std::map<std::string, CompiledFile> compiledFiles;
+	std::vector<std::string> filenames;
+	std::filesystem::file_time_type filenamesLastWriteTime;
+
+	void compile(std::string filename, CompiledFile &compiledFile);
+	CompiledFile &getCompiledFile(std::string filename);
+	void execute(const std::vector<HextCompiler::Instruction> &instructions);
+	const std::vector<std::string> &getFilenames();
 
 public:
 	void apply(std::string filename);
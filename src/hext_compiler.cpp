@@ -0,0 +1,298 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "hext_compiler.h"
+#include "utils.h"
+#include <sstream>
+#include <stdexcept>
+
+int HextCompiler::getAddress(std::string token, int globalOffset, const PointerReader &readPointer)
+{
+    int ret;
+
+    std::vector<std::string> sparts = split(token, "[+-]+");
+    std::vector<int> iparts;
+
+    if (ends_with(sparts[0], "^"))
+    {
+        if (!readPointer) throw std::invalid_argument("pointer outside of the game");
+
+        std::stringstream ss;
+        ss << std::hex << readPointer(std::stoi(sparts[0].substr(0, sparts[0].length() - 1), nullptr, 16) + globalOffset);
+        sparts[0] = ss.str();
+    }
+
+    for (auto &part : sparts)
+    {
+        iparts.push_back(
+            std::stoi(part, nullptr, 16)
+        );
+    }
+
+    ret = iparts[0];
+
+    if (iparts.size() > 2 || (iparts.size() < 2 && (contains(token, "+") || contains(token, "-")))) throw std::invalid_argument("bad address");
+
+    if (contains(token, "+"))
+    {
+        ret += iparts[1];
+    }
+    else if (contains(token, "-"))
+    {
+        ret -= iparts[1];
+    }
+
+    return ret + globalOffset;
+}
+
+int HextCompiler::resolveAddress(const Instruction &instruction, const PointerReader &readPointer)
+{
+    if (instruction.addressToken.empty())
+    {
+        return instruction.address;
+    }
+
+    return getAddress(instruction.addressToken, instruction.globalOffset, readPointer);
+}
+
+std::vector<char> HextCompiler::getBytes(std::string token)
+{
+    std::vector<char> ret;
+
+    if (contains(token, ":"))
+    {
+        std::vector<std::string> parts = split(token, "[:]+");
+        if (parts.size() != 2) throw std::invalid_argument("bad repeat");
+        int count = std::stoi(parts[1], nullptr, 0);
+        while (count > 0)
+        {
+            ret.push_back(std::stoi(parts[0], nullptr, 16));
+            count--;
+        }
+    }
+    else
+    {
+        std::vector<std::string> bytes = split(token, "[\\s,\\t]+");
+
+        for (auto byte : bytes)
+        {
+            ret.push_back(std::stoi(byte, nullptr, 16));
+        }
+    }
+
+    return ret;
+}
+
+HextCompiler::Instruction HextCompiler::makeAddressInstruction(Instruction::Type type, std::string token)
+{
+    Instruction instruction = Instruction();
+
+    instruction.type = type;
+
+    // Pointers are dereferenced when the patch is applied
+    if (contains(token, "^"))
+    {
+        instruction.addressToken = token;
+        instruction.globalOffset = inGlobalOffset;
+    }
+    else
+    {
+        instruction.address = getAddress(token, inGlobalOffset);
+    }
+
+    return instruction;
+}
+
+bool HextCompiler::hasCheckpoint(std::string token)
+{
+    if (starts_with(token, "!"))
+    {
+        return true;
+    }
+
+    return false;
+}
+
+bool HextCompiler::parseCommands(std::string token, std::vector<Instruction> &instructions)
+{
+    if (starts_with(token, "<<"))
+    {
+        replaceOnce(token, "<<", "");
+
+        trim(token);
+
+        Instruction instruction = Instruction();
+        instruction.type = Instruction::Command;
+        instruction.addressToken = token;
+        instructions.push_back(instruction);
+
+        return true;
+    }
+
+    return false;
+}
+
+bool HextCompiler::parseComment(std::string token)
+{
+    if (isMultilineComment)
+    {
+        if (ends_with(token, "}}")) isMultilineComment = false;
+        return true;
+    }
+
+    if (starts_with(token, "{{"))
+    {
+        isMultilineComment = true;
+        return true;
+    }
+
+    if (starts_with(token, "#")) return true;
+    if (starts_with(token, "{")) return true;
+    if (starts_with(token, ".")) return true;
+
+    return false;
+}
+
+bool HextCompiler::parseGlobalOffset(std::string token)
+{
+    if (starts_with(token, "+"))
+    {
+        inGlobalOffset = std::stoi(token.substr(1), nullptr, 16);
+
+        return true;
+    }
+    else if (starts_with(token, "-"))
+    {
+        inGlobalOffset = -std::stoi(token.substr(1), nullptr, 16);
+
+        return true;
+    }
+
+    return false;
+}
+
+bool HextCompiler::parseMemoryPermission(std::string token, std::vector<Instruction> &instructions)
+{
+    // Patches may repeat a byte with ":" too
+    if (contains(token, ":") && !contains(token, "="))
+    {
+        std::vector<std::string> parts = split(token, "[:]+");
+        if (parts.size() != 2) throw std::invalid_argument("bad range");
+        Instruction instruction = makeAddressInstruction(Instruction::MemoryPermission, parts[0]);
+        instruction.length = std::stoi(parts[1], nullptr, 16);
+        instructions.push_back(instruction);
+
+        return true;
+    }
+
+    return false;
+}
+
+bool HextCompiler::parseMemoryPatch(std::string token, std::vector<Instruction> &instructions)
+{
+    if (contains(token, "="))
+    {
+        std::vector<std::string> parts = split(token, "[=]+");
+        if (parts.size() != 2) throw std::invalid_argument("bad patch");
+        Instruction instruction = makeAddressInstruction(Instruction::MemoryPatch, parts[0]);
+        instruction.bytes = getBytes(parts[1]);
+        instructions.push_back(instruction);
+
+        return true;
+    }
+
+    return false;
+}
+
+bool HextCompiler::parseInstruction(std::string token, std::vector<Instruction> &instructions, std::vector<std::string> &errors)
+{
+    try
+    {
+        // Check if is a command
+        if (parseCommands(token, instructions)) return true;
+
+        // Check if is a global offset
+        if (parseGlobalOffset(token)) return true;
+
+        // Check if is a memory permission range
+        if (parseMemoryPermission(token, instructions)) return true;
+
+        // Check if is a memory patch instruction
+        if (parseMemoryPatch(token, instructions)) return true;
+    }
+    catch (const std::exception &e)
+    {
+        errors.push_back("cannot parse \"" + token + "\" (" + e.what() + ")");
+    }
+
+    return false;
+}
+
+void HextCompiler::compile(const std::vector<std::string> &lines, Program &program)
+{
+    program.instructions.clear();
+    program.checkpoint.clear();
+    program.delayedInstructions.clear();
+    program.errors.clear();
+
+    // Patches applied right away, until the first checkpoint
+    isMultilineComment = false;
+    inGlobalOffset = 0;
+
+    for (const std::string &token : lines)
+    {
+        if (token.empty()) continue;
+
+        if (hasCheckpoint(token)) break;
+
+        if (parseComment(token)) continue;
+
+        parseInstruction(token, program.instructions, program.errors);
+    }
+
+    // Delayed patches, the file has to start with a checkpoint
+    isMultilineComment = false;
+    inGlobalOffset = 0;
+
+    for (const std::string &token : lines)
+    {
+        if (token.empty()) continue;
+
+        if (parseComment(token)) continue;
+
+        if (program.checkpoint.empty())
+        {
+            if (!hasCheckpoint(token)) break;
+
+            program.checkpoint = token;
+
+            continue;
+        }
+
+        // Other checkpoints do nothing
+        if (hasCheckpoint(token)) continue;
+
+        parseInstruction(token, program.delayedInstructions, program.errors);
+    }
+
+    isMultilineComment = false;
+    inGlobalOffset = 0;
+}
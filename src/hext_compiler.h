@@ -0,0 +1,78 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Hext parser, turns the lines of a Hext file into instructions without touching the game memory
+class HextCompiler {
+public:
+	struct Instruction {
+		enum Type {
+			Command,
+			MemoryPermission,
+			MemoryPatch
+		};
+		Type type;
+		// Command text, or address token when it has to be resolved at apply time (pointers)
+		std::string addressToken;
+		int globalOffset;
+		int address;
+		int length;
+		std::vector<char> bytes;
+	};
+
+	// Patches applied right away, and patches applied at the checkpoint the file starts with
+	struct Program {
+		std::vector<Instruction> instructions;
+		std::string checkpoint;
+		std::vector<Instruction> delayedInstructions;
+		// Lines which cannot be parsed, with the reason
+		std::vector<std::string> errors;
+	};
+
+	// Reads the pointed value when a token dereferences a pointer (address^)
+	typedef std::function<int(int address)> PointerReader;
+
+	void compile(const std::vector<std::string> &lines, Program &program);
+
+	static int getAddress(std::string token, int globalOffset, const PointerReader &readPointer = PointerReader());
+	// Address of an instruction, pointers are dereferenced with readPointer
+	static int resolveAddress(const Instruction &instruction, const PointerReader &readPointer);
+
+private:
+	int inGlobalOffset = 0;
+	bool isMultilineComment = false;
+
+	std::vector<char> getBytes(std::string token);
+	Instruction makeAddressInstruction(Instruction::Type type, std::string token);
+
+	bool hasCheckpoint(std::string token);
+	bool parseCommands(std::string token, std::vector<Instruction> &instructions);
+	bool parseComment(std::string token);
+	bool parseGlobalOffset(std::string token);
+	bool parseMemoryPermission(std::string token, std::vector<Instruction> &instructions);
+	bool parseMemoryPatch(std::string token, std::vector<Instruction> &instructions);
+	bool parseInstruction(std::string token, std::vector<Instruction> &instructions, std::vector<std::string> &errors);
+};
@@ -27,10 +27,16 @@
 #include "macro.h"
 #include "cfg.h"
 #include "utils.h"
+#include "image/image.h"
 #include <fstream>
 
+// IBL textures not used by the current scene are kept around up to this size
+#define IBL_CACHE_BUDGET (256 * 1024 * 1024)
+
 Lighting lighting;
 
+static bx::DefaultAllocator iblAllocator;
+
 std::string Lighting::getConfigGroup()
 {
 	const struct game_mode *mode = getmode_cached();
@@ -199,8 +205,37 @@ void Lighting::updateLightMatrices(const vector3<float>& center)
 	// Light view matrix
 	bx::mtxLookAt(lightingState.lightViewMatrix, eye, at, up);
 
+	float left = -area, right = area, bottom = -area, top = area;
+
+	// Fit the light frustum to the shadow casters so the shadow map texels are not spread over empty space
+	// The depth range is left untouched as receivers behind the casters still need to be covered
+	struct matrix lightViewMatrix;
+	struct boundingbox casterBounds;
+	::memcpy(&lightViewMatrix.m[0][0], lightingState.lightViewMatrix, sizeof(lightViewMatrix.m));
+
+	if (calculateShadowCasterBounds(&lightViewMatrix, &casterBounds))
+	{
+		// The extent grows in fixed steps to keep the shadow stable while casters move
+		float step = area / 16.0f;
+		float halfSize = 0.5f * std::max(casterBounds.max_x - casterBounds.min_x, casterBounds.max_y - casterBounds.min_y);
+		float extent = std::ceil(halfSize / step) * step + step;
+
+		if (extent < area)
+		{
+			// Snap the center to whole shadow map texels to avoid shimmering edges
+			float texelSize = 2.0f * extent / getShadowMapResolution();
+			float centerX = std::floor(0.5f * (casterBounds.min_x + casterBounds.max_x) / texelSize) * texelSize;
+			float centerY = std::floor(0.5f * (casterBounds.min_y + casterBounds.max_y) / texelSize) * texelSize;
+
+			left = centerX - extent;
+			right = centerX + extent;
+			bottom = centerY - extent;
+			top = centerY + extent;
+		}
+	}
+
 	// Light projection matrix
-	bx::mtxOrtho(lightingState.lightProjMatrix, -area, area, -area, area,
+	bx::mtxOrtho(lightingState.lightProjMatrix, left, right, bottom, top,
 							 -nearFarSize, nearFarSize, 0.0f, bgfx::getCaps()->homogeneousDepth);
 
 	// Light view projection matrix
@@ -238,6 +273,45 @@ void Lighting::updateLightMatrices(const vector3<float>& center)
 	bx::mtxInverse(lightingState.lightInvViewProjTexMatrix, lightingState.lightViewProjTexMatrix);
 }
 
+bool Lighting::isInShadowFrustum(struct boundingbox* boundingbox, struct matrix* worldViewMatrix)
+{
+	if (boundingbox == nullptr) return true;
+
+	struct matrix lightViewProjMatrix;
+	struct matrix worldLightViewProjMatrix;
+	::memcpy(&lightViewProjMatrix.m[0][0], lightingState.lightViewProjMatrix, sizeof(lightViewProjMatrix.m));
+	multiply_matrix(worldViewMatrix, &lightViewProjMatrix, &worldLightViewProjMatrix);
+
+	vector3<float> corners[8] = { {boundingbox->min_x, boundingbox->min_y, boundingbox->min_z},
+							   {boundingbox->min_x, boundingbox->min_y, boundingbox->max_z},
+							   {boundingbox->min_x, boundingbox->max_y, boundingbox->min_z},
+							   {boundingbox->min_x, boundingbox->max_y, boundingbox->max_z},
+							   {boundingbox->max_x, boundingbox->min_y, boundingbox->min_z},
+							   {boundingbox->max_x, boundingbox->min_y, boundingbox->max_z},
+							   {boundingbox->max_x, boundingbox->max_y, boundingbox->min_z},
+							   {boundingbox->max_x, boundingbox->max_y, boundingbox->max_z} };
+
+	// The light projection is orthographic, so clip space is reached without a perspective divide
+	vector3<float> min = { FLT_MAX, FLT_MAX, FLT_MAX };
+	vector3<float> max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (int i = 0; i < 8; ++i)
+	{
+		vector3<float> cornerClipSpace;
+		transform_point(&worldLightViewProjMatrix, &corners[i], &cornerClipSpace);
+
+		min.x = std::min(min.x, cornerClipSpace.x);
+		min.y = std::min(min.y, cornerClipSpace.y);
+		min.z = std::min(min.z, cornerClipSpace.z);
+		max.x = std::max(max.x, cornerClipSpace.x);
+		max.y = std::max(max.y, cornerClipSpace.y);
+		max.z = std::max(max.z, cornerClipSpace.z);
+	}
+
+	float nearZ = bgfx::getCaps()->homogeneousDepth ? -1.0f : 0.0f;
+
+	return max.x >= -1.0f && min.x <= 1.0f && max.y >= -1.0f && min.y <= 1.0f && max.z >= nearZ && min.z <= 1.0f;
+}
+
 void Lighting::ff7_load_ibl()
 {
 	struct game_mode *mode = getmode_cached();
@@ -258,8 +332,7 @@ void Lighting::ff7_load_ibl()
 			sprintf(specularFullpath, "%s/%s/ibl/%s_s.dds", basedir, external_lighting_path.c_str(), filename);
 			sprintf(diffuseFullpath, "%s/%s/ibl/%s_d.dds", basedir, external_lighting_path.c_str(), filename);
 
-			newRenderer.prepareSpecularIbl(specularFullpath);
-			newRenderer.prepareDiffuseIbl(diffuseFullpath);
+			requestIbl(specularFullpath, diffuseFullpath);
 		}
 		break;
 	case MODE_FIELD:
@@ -271,8 +344,7 @@ void Lighting::ff7_load_ibl()
 			sprintf(specularFullpath, "%s/%s/ibl/%s_s.dds", basedir, external_lighting_path.c_str(), filename);
 			sprintf(diffuseFullpath, "%s/%s/ibl/%s_d.dds", basedir, external_lighting_path.c_str(), filename);
 
-			newRenderer.prepareSpecularIbl(specularFullpath);
-			newRenderer.prepareDiffuseIbl(diffuseFullpath);
+			requestIbl(specularFullpath, diffuseFullpath);
 		}
 		break;
 	default:
@@ -280,14 +352,138 @@ void Lighting::ff7_load_ibl()
 	}
 
 	prev_mode = mode->driver_mode;
+
+	updateIblCache();
+}
+
+void Lighting::requestIbl(const char* specularPath, const char* diffusePath)
+{
+	// A newer scene supersedes an environment that has not finished loading yet
+	if (isIblPending)
+	{
+		releaseIbl(pendingIblSpecular);
+		releaseIbl(pendingIblDiffuse);
+	}
+
+	pendingIblSpecular = specularPath;
+	pendingIblDiffuse = diffusePath;
+
+	acquireIbl(pendingIblSpecular);
+	acquireIbl(pendingIblDiffuse);
+
+	isIblPending = true;
+	qpc_get_time(&iblLoadStart);
+}
+
+void Lighting::acquireIbl(const std::string& path)
+{
+	auto [it, isNew] = iblCache.try_emplace(path);
+	iblCacheEntry &entry = it->second;
+
+	if (isNew)
+	{
+		// Read and decode on a worker thread, the texture itself is created on the render thread once it is done
+		entry.decoded = std::async(std::launch::async, [path]() {
+			return loadImageContainer(&iblAllocator, path.c_str());
+		});
+	}
+
+	entry.refCount++;
+	entry.lastUsed = ++iblCacheTick;
+}
+
+void Lighting::releaseIbl(const std::string& path)
+{
+	auto it = iblCache.find(path);
+
+	if (it != iblCache.end() && it->second.refCount > 0) it->second.refCount--;
+}
+
+void Lighting::finishIblDecoding(const std::string& path, iblCacheEntry& entry)
+{
+	if (entry.isLoaded || !entry.decoded.valid() || entry.decoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	{
+		return;
+	}
+
+	bimg::ImageContainer* img = entry.decoded.get();
+
+	if (img != nullptr)
+	{
+		uint32_t width, height;
+
+		entry.size = img->m_size;
+		entry.handle = newRenderer.createTextureHandle(img, const_cast<char*>(path.c_str()), &width, &height, &entry.mipCount, false);
+		if (!entry.handle.idx) entry.handle = BGFX_INVALID_HANDLE;
+	}
+
+	entry.isLoaded = true;
 }
 
-void Lighting::ff7_create_walkmesh(std::vector<struct walkmeshEdge> &edges)
+void Lighting::updateIblCache()
+{
+	uint64_t residentSize = 0;
+
+	for (auto &[path, entry] : iblCache)
+	{
+		finishIblDecoding(path, entry);
+		residentSize += entry.size;
+	}
+
+	// Keep rendering with the previous environment until both textures of the new one are ready
+	if (isIblPending && iblCache[pendingIblSpecular].isLoaded && iblCache[pendingIblDiffuse].isLoaded)
+	{
+		const iblCacheEntry &specular = iblCache[pendingIblSpecular];
+		const iblCacheEntry &diffuse = iblCache[pendingIblDiffuse];
+
+		newRenderer.setSpecularIbl(specular.handle);
+		newRenderer.setDiffuseIbl(diffuse.handle);
+		setIblMipCount(specular.mipCount);
+
+		if (!currentIblSpecular.empty())
+		{
+			releaseIbl(currentIblSpecular);
+			releaseIbl(currentIblDiffuse);
+		}
+
+		currentIblSpecular = pendingIblSpecular;
+		currentIblDiffuse = pendingIblDiffuse;
+		isIblPending = false;
+
+#ifdef PROFILE
+		time_t iblLoadEnd;
+		qpc_get_time(&iblLoadEnd);
+		profile_ibl_load = iblLoadEnd - iblLoadStart;
+#endif
+	}
+
+	// Evict the least recently requested environments nobody uses once over budget
+	while (residentSize > IBL_CACHE_BUDGET)
+	{
+		auto lru = iblCache.end();
+
+		for (auto it = iblCache.begin(); it != iblCache.end(); ++it)
+		{
+			if (it->second.refCount == 0 && it->second.isLoaded && it->second.size > 0 && (lru == iblCache.end() || it->second.lastUsed < lru->second.lastUsed))
+			{
+				lru = it;
+			}
+		}
+
+		if (lru == iblCache.end()) break;
+
+		if (bgfx::isValid(lru->second.handle)) bgfx::destroy(lru->second.handle);
+		residentSize -= lru->second.size;
+		iblCache.erase(lru);
+	}
+}
+
+bool Lighting::ff7_create_walkmesh(struct fieldWalkmesh &walkmesh)
 {
 	byte *level_data = *ff7_externals.field_level_data_pointer;
 	if (!level_data)
 	{
-		return;
+		return false;
 	}
 
 	uint32_t walkmesh_offset = *(uint32_t *)(level_data + 0x16);
@@ -313,13 +509,13 @@ void Lighting::ff7_create_walkmesh(std::vector<struct walkmeshEdge> &edges)
 			vertex.u = 0.0;
 			vertex.v = 0.0;
 
-			walkMeshVertices.push_back(vertex);
-			walkMeshIndices.push_back(walkMeshIndices.size());
+			walkmesh.vertices.push_back(vertex);
+			walkmesh.indices.push_back(walkmesh.indices.size());
 		}
 
-		int vId0 = walkMeshVertices.size() - 3;
-		int vId1 = walkMeshVertices.size() - 3 + 1;
-		int vId2 = walkMeshVertices.size() - 3 + 2;
+		int vId0 = walkmesh.vertices.size() - 3;
+		int vId1 = walkmesh.vertices.size() - 3 + 1;
+		int vId2 = walkmesh.vertices.size() - 3 + 2;
 		walkmeshEdge e0;
 		e0.v0 = vId0;
 		e0.v1 = vId1;
@@ -344,92 +540,146 @@ void Lighting::ff7_create_walkmesh(std::vector<struct walkmeshEdge> &edges)
 		e2.nextEdge = -1;
 		e2.isBorder = false;
 		e2.perpDir = {0.0f, 0.0f, 0.0f};
-		edges.push_back(e0);
-		edges.push_back(e1);
-		edges.push_back(e2);
+		walkmesh.edges.push_back(e0);
+		walkmesh.edges.push_back(e1);
+		walkmesh.edges.push_back(e2);
 	}
+
+	return true;
 }
 
 // creates the field walkmesh for rendering
 void Lighting::createFieldWalkmesh(float extrudeSize)
 {
-	static WORD last_field_id = 0;
+	WORD field_id = *ff7_externals.field_id;
 
-	if (*ff7_externals.field_id == last_field_id)
+	if (currentWalkmesh != nullptr && currentWalkmeshFieldId == field_id && currentWalkmesh->extrudeSize == extrudeSize)
 	{
 		return;
 	}
 
-	walkMeshVertices.clear();
-	walkMeshIndices.clear();
+	auto [it, isNew] = fieldWalkmeshCache.try_emplace(field_id);
+	fieldWalkmesh &walkmesh = it->second;
 
-	std::vector<struct walkmeshEdge> edges;
+	if (isNew)
+	{
+		// Get the walkmesh triangles and edges
+		if (!ff7_create_walkmesh(walkmesh))
+		{
+			fieldWalkmeshCache.erase(it);
+			currentWalkmesh = nullptr;
+			return;
+		}
+
+		// Detect triangle edges that are external borders of the walkmesh
+		// Border edges will be use to extrude a small area where field shadows will fade out
+		// This is done to prevent sharp discontinuities at the walkmesh borders
+		extractWalkmeshBorderData(walkmesh);
+
+		// Extract previous and next adjacent border edges
+		// Calculate extrude direction for each border edge
+		createWalkmeshBorderExtrusionData(walkmesh);
+
+		walkmesh.numTriangleVertices = walkmesh.vertices.size();
+	}
+
+	if (walkmesh.extrudeSize != extrudeSize)
+	{
+		walkmesh.vertices.resize(walkmesh.numTriangleVertices);
+		walkmesh.indices.resize(walkmesh.numTriangleVertices);
+
+		// Create triangles for the border extrusion
+		createWalkmeshBorder(walkmesh, extrudeSize);
+
+		walkmesh.extrudeSize = extrudeSize;
+	}
+
+	uploadWalkmesh(walkmesh);
 
-	// Get the walkmesh triangles and edges
-	ff7_create_walkmesh(edges);
+	currentWalkmesh = &walkmesh;
+	currentWalkmeshFieldId = field_id;
+}
 
-	// Detect triangle edges that are external borders of the walkmesh
-	// Border edges will be use to extrude a small area where field shadows will fade out
-	// This is done to prevent sharp discontinuities at the walkmesh borders
-	extractWalkmeshBorderData(edges);
+void Lighting::uploadWalkmesh(struct fieldWalkmesh &walkmesh)
+{
+	if (bgfx::isValid(walkMeshVertexBufferHandle)) bgfx::destroy(walkMeshVertexBufferHandle);
+	if (bgfx::isValid(walkMeshIndexBufferHandle)) bgfx::destroy(walkMeshIndexBufferHandle);
 
-	// Extract previous and next adjacent border edges
-	// Calculate extrude direction for each border edge
-	createWalkmeshBorderExtrusionData(edges);
+	walkMeshVertexBufferHandle = BGFX_INVALID_HANDLE;
+	walkMeshIndexBufferHandle = BGFX_INVALID_HANDLE;
 
-	// Create triangles for the border extrusion
-	createWalkmeshBorder(edges, extrudeSize);
+	if (walkmesh.vertices.empty()) return;
 
-	last_field_id = *ff7_externals.field_id;
+	// The walkmesh does not change until the next field, keep it in static GPU buffers
+	walkMeshVertexBufferHandle = newRenderer.createStaticVertexBuffer(walkmesh.vertices.data(), walkmesh.vertices.size());
+	walkMeshIndexBufferHandle = newRenderer.createStaticIndexBuffer(walkmesh.indices.data(), walkmesh.indices.size());
 }
 
-void Lighting::extractWalkmeshBorderData(std::vector<struct walkmeshEdge> &edges)
+bool Lighting::bindWalkmesh()
 {
-	int numEdges = edges.size();
-	for (int i = 0; i < numEdges; ++i)
+	if (!bgfx::isValid(walkMeshVertexBufferHandle) || !bgfx::isValid(walkMeshIndexBufferHandle)) return false;
+
+	bgfx::setVertexBuffer(0, walkMeshVertexBufferHandle);
+	bgfx::setIndexBuffer(walkMeshIndexBufferHandle);
+
+	return true;
+}
+
+// Walkmesh vertices come from 16-bit integer coordinates, so positions can be matched exactly through their packed value
+static uint64_t getWalkmeshPositionKey(const vector3<float> &pos)
+{
+	return uint64_t(uint16_t(int16_t(pos.x))) | (uint64_t(uint16_t(int16_t(pos.y))) << 16) | (uint64_t(uint16_t(int16_t(pos.z))) << 32);
+}
+
+struct walkmeshEdgeKeyHash
+{
+	size_t operator()(const std::pair<uint64_t, uint64_t> &key) const
 	{
-		auto &e = edges[i];
-		vector3<float> pos0 = walkMeshVertices[e.v0]._;
-		vector3<float> pos1 = walkMeshVertices[e.v1]._;
+		return std::hash<uint64_t>()(key.first * 31 + key.second);
+	}
+};
 
-		bool isBorder = true;
-		for (int j = 0; j < numEdges; ++j)
-		{
-			if (j == i)
-			{
-				continue;
-			}
+void Lighting::extractWalkmeshBorderData(struct fieldWalkmesh &walkmesh)
+{
+	auto &edges = walkmesh.edges;
+	int numEdges = edges.size();
 
-			auto &other_e = edges[j];
-			vector3<float> other_pos0 = walkMeshVertices[other_e.v0]._;
-			vector3<float> other_pos1 = walkMeshVertices[other_e.v1]._;
+	// An edge is not a border when another edge shares its end points, in either direction
+	std::unordered_map<std::pair<uint64_t, uint64_t>, int, walkmeshEdgeKeyHash> edgeCount;
+	edgeCount.reserve(numEdges);
 
-			float errorMargin = 0.001f;
-			if (std::abs(pos0.x - other_pos0.x) < errorMargin && std::abs(pos0.y - other_pos0.y) < errorMargin && std::abs(pos0.z - other_pos0.z) < errorMargin &&
-					std::abs(pos1.x - other_pos1.x) < errorMargin && std::abs(pos1.y - other_pos1.y) < errorMargin && std::abs(pos1.z - other_pos1.z) < errorMargin)
-			{
-				isBorder = false;
-			}
+	for (auto &e : edges)
+	{
+		edgeCount[{getWalkmeshPositionKey(walkmesh.vertices[e.v0]._), getWalkmeshPositionKey(walkmesh.vertices[e.v1]._)}]++;
+	}
 
-			if (std::abs(pos1.x - other_pos0.x) < errorMargin && std::abs(pos1.y - other_pos0.y) < errorMargin && std::abs(pos1.z - other_pos0.z) < errorMargin &&
-					std::abs(pos0.x - other_pos1.x) < errorMargin && std::abs(pos0.y - other_pos1.y) < errorMargin && std::abs(pos0.z - other_pos1.z) < errorMargin)
-			{
-				isBorder = false;
-			}
-		}
-		e.isBorder = isBorder;
+	for (auto &e : edges)
+	{
+		uint64_t key0 = getWalkmeshPositionKey(walkmesh.vertices[e.v0]._);
+		uint64_t key1 = getWalkmeshPositionKey(walkmesh.vertices[e.v1]._);
 
-		if (isBorder)
+		bool hasSameEdge = edgeCount[{key0, key1}] > 1;
+		bool hasOppositeEdge = false;
+
+		if (key0 != key1)
 		{
-			auto &v0 = walkMeshVertices[e.v0];
-			auto &v1 = walkMeshVertices[e.v1];
+			auto opposite = edgeCount.find({key1, key0});
+			hasOppositeEdge = opposite != edgeCount.end();
 		}
+
+		e.isBorder = !hasSameEdge && !hasOppositeEdge;
 	}
 }
 
-void Lighting::createWalkmeshBorderExtrusionData(std::vector<struct walkmeshEdge> &edges)
+void Lighting::createWalkmeshBorderExtrusionData(struct fieldWalkmesh &walkmesh)
 {
+	auto &edges = walkmesh.edges;
 	int numEdges = edges.size();
+
+	// Border edges touching each vertex position, in ascending edge order
+	std::unordered_map<uint64_t, std::vector<int>> borderEdgesAtPosition;
+	int numBorderEdges = 0;
+
 	for (int i = 0; i < numEdges; ++i)
 	{
 		auto &e = edges[i];
@@ -438,81 +688,83 @@ void Lighting::createWalkmeshBorderExtrusionData(std::vector<struct walkmeshEdge
 			continue;
 		}
 
-		vector3<float> pos0 = walkMeshVertices[e.v0]._;
-		vector3<float> pos1 = walkMeshVertices[e.v1]._;
+		uint64_t key0 = getWalkmeshPositionKey(walkmesh.vertices[e.v0]._);
+		uint64_t key1 = getWalkmeshPositionKey(walkmesh.vertices[e.v1]._);
+
+		borderEdgesAtPosition[key0].push_back(i);
+		if (key1 != key0) borderEdgesAtPosition[key1].push_back(i);
+
+		numBorderEdges++;
+	}
 
-		for (int j = 0; j < numEdges; ++j)
+	// When several border edges share a vertex the last one wins
+	auto findLastAdjacentEdge = [&](uint64_t key, int self) {
+		const std::vector<int> &adjacent = borderEdgesAtPosition[key];
+
+		for (auto it = adjacent.rbegin(); it != adjacent.rend(); ++it)
 		{
-			if (j == i)
-			{
-				continue;
-			}
+			if (*it != self) return *it;
+		}
 
-			auto &other_e = edges[j];
-			if (!other_e.isBorder)
-			{
-				continue;
-			}
+		return -1;
+	};
+
+	for (int i = 0; i < numEdges; ++i)
+	{
+		auto &e = edges[i];
+		if (!e.isBorder || numBorderEdges < 2)
+		{
+			continue;
+		}
 
-			vector3<float> other_pos0 = walkMeshVertices[other_e.v0]._;
-			vector3<float> other_pos1 = walkMeshVertices[other_e.v1]._;
+		vector3<float> pos0 = walkmesh.vertices[e.v0]._;
+		vector3<float> pos1 = walkmesh.vertices[e.v1]._;
+		vector3<float> ovPos = walkmesh.vertices[e.ov]._;
 
-			float errorMargin = 0.1f;
-			;
-			if ((std::abs(pos0.x - other_pos0.x) < errorMargin && std::abs(pos0.y - other_pos0.y) < errorMargin && std::abs(pos0.z - other_pos0.z) < errorMargin) ||
-					(std::abs(pos0.x - other_pos1.x) < errorMargin && std::abs(pos0.y - other_pos1.y) < errorMargin && std::abs(pos0.z - other_pos1.z) < errorMargin))
-			{
-				e.prevEdge = j;
-			}
+		int prevEdge = findLastAdjacentEdge(getWalkmeshPositionKey(pos0), i);
+		int nextEdge = findLastAdjacentEdge(getWalkmeshPositionKey(pos1), i);
 
-			if ((std::abs(pos1.x - other_pos0.x) < errorMargin && std::abs(pos1.y - other_pos0.y) < errorMargin && std::abs(pos1.z - other_pos0.z) < errorMargin) ||
-					(std::abs(pos1.x - other_pos1.x) < errorMargin && std::abs(pos1.y - other_pos1.y) < errorMargin && std::abs(pos1.z - other_pos1.z) < errorMargin))
-			{
-				e.nextEdge = j;
-			}
+		if (prevEdge != -1) e.prevEdge = prevEdge;
+		if (nextEdge != -1) e.nextEdge = nextEdge;
 
-			vector3<float> pos0 = walkMeshVertices[e.v0]._;
-			vector3<float> pos1 = walkMeshVertices[e.v1]._;
-			vector3<float> ovPos = walkMeshVertices[e.ov]._;
-
-			vector3<float> triCenter;
-			add_vector(&pos0, &pos1, &triCenter);
-			add_vector(&triCenter, &ovPos, &triCenter);
-			divide_vector(&triCenter, 2.0f, &triCenter);
-
-			vector3<float> edgeDir0;
-			subtract_vector(&pos1, &pos0, &edgeDir0);
-			normalize_vector(&edgeDir0);
-			vector3<float> edgeDir1;
-			subtract_vector(&ovPos, &pos0, &edgeDir1);
-			normalize_vector(&edgeDir1);
-			vector3<float> normal;
-			cross_product(&edgeDir0, &edgeDir1, &normal);
-
-			vector3<float> perpDir;
-			cross_product(&edgeDir0, &normal, &perpDir);
-			normalize_vector(&perpDir);
-
-			vector3<float> ovDir0;
-			subtract_vector(&pos0, &ovPos, &ovDir0);
-			normalize_vector(&ovDir0);
-
-			vector3<float> ovDir1;
-			subtract_vector(&pos1, &ovPos, &ovDir1);
-			normalize_vector(&ovDir1);
-
-			if (dot_product(&ovDir0, &perpDir) < 0.0)
-			{
-				multiply_vector(&perpDir, -1.0f, &perpDir);
-			}
+		vector3<float> triCenter;
+		add_vector(&pos0, &pos1, &triCenter);
+		add_vector(&triCenter, &ovPos, &triCenter);
+		divide_vector(&triCenter, 2.0f, &triCenter);
 
-			e.perpDir = perpDir;
+		vector3<float> edgeDir0;
+		subtract_vector(&pos1, &pos0, &edgeDir0);
+		normalize_vector(&edgeDir0);
+		vector3<float> edgeDir1;
+		subtract_vector(&ovPos, &pos0, &edgeDir1);
+		normalize_vector(&edgeDir1);
+		vector3<float> normal;
+		cross_product(&edgeDir0, &edgeDir1, &normal);
+
+		vector3<float> perpDir;
+		cross_product(&edgeDir0, &normal, &perpDir);
+		normalize_vector(&perpDir);
+
+		vector3<float> ovDir0;
+		subtract_vector(&pos0, &ovPos, &ovDir0);
+		normalize_vector(&ovDir0);
+
+		vector3<float> ovDir1;
+		subtract_vector(&pos1, &ovPos, &ovDir1);
+		normalize_vector(&ovDir1);
+
+		if (dot_product(&ovDir0, &perpDir) < 0.0)
+		{
+			multiply_vector(&perpDir, -1.0f, &perpDir);
 		}
+
+		e.perpDir = perpDir;
 	}
 }
 
-void Lighting::createWalkmeshBorder(std::vector<struct walkmeshEdge> &edges, float extrudeSize)
+void Lighting::createWalkmeshBorder(struct fieldWalkmesh &walkmesh, float extrudeSize)
 {
+	auto &edges = walkmesh.edges;
 	int numEdges = edges.size();
 	for (int i = 0; i < numEdges; ++i)
 	{
@@ -522,8 +774,8 @@ void Lighting::createWalkmeshBorder(std::vector<struct walkmeshEdge> &edges, flo
 			continue;
 		}
 
-		vector3<float> pos0 = walkMeshVertices[e.v0]._;
-		vector3<float> pos1 = walkMeshVertices[e.v1]._;
+		vector3<float> pos0 = walkmesh.vertices[e.v0]._;
+		vector3<float> pos1 = walkmesh.vertices[e.v1]._;
 
 		if (e.prevEdge == -1 || e.nextEdge == -1)
 			continue;
@@ -559,8 +811,8 @@ void Lighting::createWalkmeshBorder(std::vector<struct walkmeshEdge> &edges, flo
 			v0.color.g = 0x00;
 			v0.color.b = 0x00;
 			v0.color.a = 0xff;
-			walkMeshVertices.push_back(v0);
-			walkMeshIndices.push_back(walkMeshIndices.size());
+			walkmesh.vertices.push_back(v0);
+			walkmesh.indices.push_back(walkmesh.indices.size());
 
 			struct nvertex v1;
 			v1._.x = pos0.x;
@@ -572,8 +824,8 @@ void Lighting::createWalkmeshBorder(std::vector<struct walkmeshEdge> &edges, flo
 			v1.color.b = 0x00;
 			v1.color.a = 0xff;
 
-			walkMeshVertices.push_back(v1);
-			walkMeshIndices.push_back(walkMeshIndices.size());
+			walkmesh.vertices.push_back(v1);
+			walkmesh.indices.push_back(walkmesh.indices.size());
 
 			struct nvertex v2;
 			v2._.x = extrudePos0.x;
@@ -585,8 +837,8 @@ void Lighting::createWalkmeshBorder(std::vector<struct walkmeshEdge> &edges, flo
 			v2.color.b = 0x00;
 			v2.color.a = 0x00;
 
-			walkMeshVertices.push_back(v2);
-			walkMeshIndices.push_back(walkMeshIndices.size());
+			walkmesh.vertices.push_back(v2);
+			walkmesh.indices.push_back(walkmesh.indices.size());
 		}
 
 		// Extrude triangle 1
@@ -610,8 +862,8 @@ void Lighting::createWalkmeshBorder(std::vector<struct walkmeshEdge> &edges, flo
 			v0.color.b = 0x00;
 			v0.color.a = 0x00;
 
-			walkMeshVertices.push_back(v0);
-			walkMeshIndices.push_back(walkMeshIndices.size());
+			walkmesh.vertices.push_back(v0);
+			walkmesh.indices.push_back(walkmesh.indices.size());
 
 			struct nvertex v1;
 			v1._.x = pos1.x;
@@ -623,8 +875,8 @@ void Lighting::createWalkmeshBorder(std::vector<struct walkmeshEdge> &edges, flo
 			v1.color.b = 0x00;
 			v1.color.a = 0xff;
 
-			walkMeshVertices.push_back(v1);
-			walkMeshIndices.push_back(walkMeshIndices.size());
+			walkmesh.vertices.push_back(v1);
+			walkmesh.indices.push_back(walkmesh.indices.size());
 
 			struct nvertex v2;
 			v2._.x = extrudePos0.x;
@@ -636,8 +888,8 @@ void Lighting::createWalkmeshBorder(std::vector<struct walkmeshEdge> &edges, flo
 			v2.color.b = 0x00;
 			v2.color.a = 0x00;
 
-			walkMeshVertices.push_back(v2);
-			walkMeshIndices.push_back(walkMeshIndices.size());
+			walkmesh.vertices.push_back(v2);
+			walkmesh.indices.push_back(walkmesh.indices.size());
 		}
 	}
 }
@@ -831,11 +1083,7 @@ void drawFieldShadowCallback()
 {
 	lighting.createFieldWalkmesh(lighting.getWalkmeshExtrudeSize());
 
-	auto walkMeshVertices = lighting.getWalkmeshVertices();
-	auto walkMeshIndices = lighting.getWalkmeshIndices();
-
-	newRenderer.bindVertexBuffer(walkMeshVertices.data(), 0, walkMeshVertices.size());
-	newRenderer.bindIndexBuffer(walkMeshIndices.data(), walkMeshIndices.size());
+	if (!lighting.bindWalkmesh()) return;
 
 	newRenderer.setPrimitiveType();
 	newRenderer.isTLVertex(false);
@@ -1158,12 +1406,16 @@ float Lighting::getWalkmeshPosOffset()
 
 const std::vector<nvertex> &Lighting::getWalkmeshVertices()
 {
-	return walkMeshVertices;
+	static const std::vector<nvertex> empty;
+
+	return currentWalkmesh ? currentWalkmesh->vertices : empty;
 }
 
 const std::vector<WORD> &Lighting::getWalkmeshIndices()
 {
-	return walkMeshIndices;
+	static const std::vector<WORD> empty;
+
+	return currentWalkmesh ? currentWalkmesh->indices : empty;
 }
 
 void Lighting::setHide2dEnabled(bool isEnabled)
@@ -25,7 +25,12 @@
 #include "common_imports.h"
 
 #include <vector>
+#include <string>
+#include <future>
+#include <unordered_map>
 #include <toml++/toml.h>
+#include <bgfx/bgfx.h>
+#include <bimg/bimg.h>
 #include <windows.h>
 
 enum DebugOutput
@@ -52,6 +57,26 @@ struct walkmeshEdge
     vector3<float> perpDir;      // perpendicular direction
 };
 
+struct fieldWalkmesh
+{
+    std::vector<nvertex> vertices;       // walkmesh triangles followed by the border extrusion
+    std::vector<WORD> indices;
+    std::vector<walkmeshEdge> edges;
+    size_t numTriangleVertices = 0;      // vertex count before the border extrusion
+    float extrudeSize = -1.0f;           // extrude size the border was built with
+};
+
+struct iblCacheEntry
+{
+    bgfx::TextureHandle handle = BGFX_INVALID_HANDLE;
+    uint32_t mipCount = 0;
+    uint32_t size = 0;
+    int refCount = 0;
+    uint64_t lastUsed = 0;
+    bool isLoaded = false;                          // decoding finished, handle stays invalid if the file is missing
+    std::future<bimg::ImageContainer*> decoded;
+};
+
 struct LightingState
 {
     float lightViewMatrix[16];
@@ -101,21 +126,39 @@ private:
     char configDevToolsPath[MAX_PATH];
     toml::parse_result config;
 
-    std::vector<nvertex> walkMeshVertices;
-    std::vector<WORD> walkMeshIndices;
+    // Field walkmeshes are cached per field id, only the border extrusion is rebuilt when its size changes
+    std::unordered_map<WORD, fieldWalkmesh> fieldWalkmeshCache;
+    fieldWalkmesh* currentWalkmesh = nullptr;
+    WORD currentWalkmeshFieldId = 0;
+    bgfx::VertexBufferHandle walkMeshVertexBufferHandle = BGFX_INVALID_HANDLE;
+    bgfx::IndexBufferHandle walkMeshIndexBufferHandle = BGFX_INVALID_HANDLE;
 
     auto getConfigEntry(char* key);
 
     void loadConfig();
     void initParamsFromConfig();
 
-    void ff7_load_ibl();
-
-    void ff7_create_walkmesh(std::vector<struct walkmeshEdge>& edges);
+    // IBL textures are kept resident and reference counted per file path
+    std::unordered_map<std::string, iblCacheEntry> iblCache;
+    uint64_t iblCacheTick = 0;
+    std::string currentIblSpecular, currentIblDiffuse;
+    std::string pendingIblSpecular, pendingIblDiffuse;
+    bool isIblPending = false;
+    time_t iblLoadStart = 0;
 
-    void extractWalkmeshBorderData(std::vector<struct walkmeshEdge>& edges);
-    void createWalkmeshBorderExtrusionData(std::vector<struct walkmeshEdge>& edges);
-    void createWalkmeshBorder(std::vector<struct walkmeshEdge>& edges, float extrudeSize);
+    void ff7_load_ibl();
+    void requestIbl(const char* specularPath, const char* diffusePath);
+    void acquireIbl(const std::string& path);
+    void releaseIbl(const std::string& path);
+    void finishIblDecoding(const std::string& path, iblCacheEntry& entry);
+    void updateIblCache();
+
+    bool ff7_create_walkmesh(struct fieldWalkmesh& walkmesh);
+
+    void extractWalkmeshBorderData(struct fieldWalkmesh& walkmesh);
+    void createWalkmeshBorderExtrusionData(struct fieldWalkmesh& walkmesh);
+    void createWalkmeshBorder(struct fieldWalkmesh& walkmesh, float extrudeSize);
+    void uploadWalkmesh(struct fieldWalkmesh& walkmesh);
     struct boundingbox calcFieldSceneAabb(struct boundingbox* sceneAbb);
 
 public:
@@ -124,6 +167,7 @@ public:
     void save();
 
     void updateLightMatrices(const vector3<float>& center);
+    bool isInShadowFrustum(struct boundingbox* boundingbox, struct matrix* worldViewMatrix);
     void draw(struct game_obj* game_object);
 
     const LightingState& getLightingState();
@@ -196,6 +240,7 @@ public:
     float getWalkmeshPosOffset();
     const std::vector<nvertex>& getWalkmeshVertices();
     const std::vector<WORD>& getWalkmeshIndices();
+    bool bindWalkmesh();
 
     // Lighting Debug
     void setHide2dEnabled(bool isEnabled);
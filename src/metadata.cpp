@@ -21,8 +21,10 @@
 
 #include <shlwapi.h>
 #include <chrono>
+#include <vector>
 
 #include "metadata.h"
+#include "atomic_file.h"
 #include "log.h"
 #include "utils.h"
 
@@ -31,95 +33,104 @@ Metadata metadataPatcher;
 // PRIVATE
 void Metadata::loadXml()
 {
+    std::error_code ec;
+    std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(savePath, ec);
+
+    // Keep the document resident, unless someone else touched the file meanwhile
+    if (docLoaded && lastWriteTime == docWriteTime) return;
+
     ffnx_trace("Metadata: loading metadata.xml\n");
 
     // Load Metadata
     doc.load_file(savePath);
+
+    docLoaded = true;
+    docWriteTime = lastWriteTime;
 }
 
 void Metadata::saveXml()
 {
+    std::string error;
+    std::error_code ec;
+
     ffnx_trace("Metadata: saving metadata.xml\n");
 
-    // Save Metadata
-    doc.save_file(savePath);
+    // Save Metadata next to the original, then replace it in one step so a crash never leaves a truncated file
+    if (!atomic_write_file(savePath, [this](const std::string &tempPath) { return doc.save_file(tempPath.c_str()); }, error))
+    {
+        ffnx_error("Metadata: %s\n", error.c_str());
+        return;
+    }
+
+    docWriteTime = std::filesystem::last_write_time(savePath, ec);
 }
 
-void Metadata::calcNow()
+std::string Metadata::calcNow()
 {
     std::chrono::milliseconds nowMS = std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::system_clock::now().time_since_epoch()
     );
 
-    now = std::to_string(nowMS.count());
+    return std::to_string(nowMS.count());
 }
 
-// PUBLIC
-void Metadata::init()
+std::string Metadata::calcSignature(const char *filename)
 {
-    ffnx_trace("Metadata: Initializing manager.\n");
-
-    // Get Save Path
-    get_userdata_path(userPath, sizeof(userPath), true);
-
-    // Get Metadata Path
-    strcpy(savePath, userPath);
-    PathAppendA(savePath, "metadata.xml");
-
-    // Save userID
-    userID.assign(strrchr(userPath, '_') + 1);
-}
-
-void Metadata::updateFF7(uint8_t save)
-{
-    char currentSave[260]{ 0 };
-    BYTE dataBuffer[64 * 1024 + 8]{0};
-    int dataSize = userID.length();
-
-    loadXml();
-
-    // Append save file name
-    strcpy(currentSave, userPath);
-    sprintf(currentSave + strlen(currentSave), R"(\save%02i.ff7)", save);
+    std::vector<BYTE> dataBuffer;
 
     // Hash existing save files
-    if (fileExists(currentSave))
+    if (fileExists(filename))
     {
-        ffnx_trace("Metadata: calculating hash for %s\n", currentSave);
+        ffnx_trace("Metadata: calculating hash for %s\n", filename);
 
-        FILE* file = fopen(currentSave, "rb");
+        FILE* file = fopen(filename, "rb");
 
-        fseek(file, 0, SEEK_END);
-        int fileSize = ftell(file);
-        fseek(file, 0, SEEK_SET);
-        fread(dataBuffer, 1, fileSize, file);
-        fclose(file);
+        if (file)
+        {
+            fseek(file, 0, SEEK_END);
+            int fileSize = ftell(file);
+            fseek(file, 0, SEEK_SET);
+            dataBuffer.resize(fileSize);
+            dataBuffer.resize(fread(dataBuffer.data(), 1, fileSize, file));
+            fclose(file);
+        }
+    }
 
-        memcpy(dataBuffer + fileSize, userID.data(), userID.length());
+    dataBuffer.insert(dataBuffer.end(), userID.begin(), userID.end());
 
-        dataSize += fileSize;
-    }
-    else
-    {
-        memcpy(dataBuffer, userID.data(), userID.length());
-    }
-    std::string md5 = md5_hash(dataBuffer, dataSize);
+    return md5_hash(dataBuffer.data(), dataBuffer.size());
+}
+
+void Metadata::updateSave(const PendingSave &pending)
+{
+    std::string md5 = calcSignature(pending.filename.c_str());
 
     // Update metadata
-    calcNow();
     for (pugi::xml_node gamestatus : doc.children())
     {
-        for (pugi::xml_node savefiles : gamestatus.children())
+        for (pugi::xml_node savefile : gamestatus.children())
         {
-            if (std::atoi(savefiles.attribute("block").value()) == (save+1))
+            bool match = false;
+
+            if (pending.ff8)
+            {
+                match = (strcmp(savefile.attribute("type").value(), "choco") == 0 && pending.slot > 2) ||
+                    (std::atoi(savefile.attribute("num").value()) == pending.save && std::atoi(savefile.attribute("slot").value()) == pending.slot);
+            }
+            else
+            {
+                match = std::atoi(savefile.attribute("block").value()) == (pending.save+1);
+            }
+
+            if (match)
             {
-                ffnx_trace("Metadata: updating timestamp and signature for %s\n", currentSave);
+                ffnx_trace("Metadata: updating timestamp and signature for %s\n", pending.filename.c_str());
 
-                for (pugi::xml_node child : savefiles.children())
+                for (pugi::xml_node child : savefile.children())
                 {
                     if (strcmp(child.name(), "timestamp") == 0)
                     {
-                        child.text().set(now.data());
+                        child.text().set(pending.now.data());
                     }
 
                     if (strcmp(child.name(), "signature") == 0)
@@ -130,79 +141,78 @@ void Metadata::updateFF7(uint8_t save)
             }
         }
     }
+}
+
+void Metadata::enqueue(PendingSave pending)
+{
+    pending.now = calcNow();
+
+    pendingSaves.push(pending.filename, pending);
+}
+
+void Metadata::flush(const CoalescingQueue<std::string, PendingSave>::Batch &batch)
+{
+    loadXml();
+
+    for (const auto &entry : batch) updateSave(entry.second);
 
     // Flush
     saveXml();
 }
 
-void Metadata::updateFF8(uint8_t slot, uint8_t save)
+// PUBLIC
+Metadata::Metadata() :
+    pendingSaves(
+        std::chrono::milliseconds(METADATA_COALESCE_DELAY_MS),
+        std::chrono::milliseconds(METADATA_COALESCE_MAX_DELAY_MS),
+        [this](const CoalescingQueue<std::string, PendingSave>::Batch &batch) { flush(batch); }
+    )
 {
-    char currentSave[260]{ 0 };
-    BYTE dataBuffer[8 * 1024 + 8]{0};
-    int dataSize = userID.length();
+}
 
-    loadXml();
+void Metadata::init()
+{
+    ffnx_trace("Metadata: Initializing manager.\n");
 
-    // Append save file name
-    strcpy(currentSave, userPath);
-    if (slot > 2) {
-        strcpy(currentSave + strlen(currentSave), "\\chocorpg.ff8");
-    } else {
-        sprintf(currentSave + strlen(currentSave), R"(\slot%d_save%02i.ff8)", slot, save);
-    }
+    // Get Save Path
+    get_userdata_path(userPath, sizeof(userPath), true);
 
-    // Hash existing save files
-    if (fileExists(currentSave))
-    {
-        ffnx_trace("Metadata: calculating hash for %s\n", currentSave);
+    // Get Metadata Path
+    strcpy(savePath, userPath);
+    PathAppendA(savePath, "metadata.xml");
 
-        FILE* file = fopen(currentSave, "rb");
+    // Save userID
+    userID.assign(strrchr(userPath, '_') + 1);
+}
 
-        fseek(file, 0, SEEK_END);
-        int fileSize = ftell(file);
-        fseek(file, 0, SEEK_SET);
-        fread(dataBuffer, 1, fileSize, file);
-        fclose(file);
+void Metadata::shutdown()
+{
+    // Pending saves are written before the worker exits
+    pendingSaves.stop();
+}
 
-        memcpy(dataBuffer + fileSize, userID.data(), userID.length());
+void Metadata::updateFF7(uint8_t save)
+{
+    char currentSave[260]{ 0 };
 
-        dataSize += fileSize;
-    }
-    else
-    {
-        memcpy(dataBuffer, userID.data(), userID.length());
-    }
-    std::string md5 = md5_hash(dataBuffer, dataSize);
+    // Append save file name
+    strcpy(currentSave, userPath);
+    sprintf(currentSave + strlen(currentSave), R"(\save%02i.ff7)", save);
 
-    // Update metadata
-    calcNow();
-    for (pugi::xml_node gamestatus : doc.children())
-    {
-        for (pugi::xml_node savefile : gamestatus.children())
-        {
-            if ((
-                strcmp(savefile.attribute("type").value(), "choco") == 0 && slot > 2) ||
-                (std::atoi(savefile.attribute("num").value()) == save && std::atoi(savefile.attribute("slot").value()) == slot)
-            )
-            {
-                ffnx_trace("Metadata: updating timestamp and signature for %s\n", currentSave);
+    enqueue(PendingSave{ currentSave, false, 0, save });
+}
 
-                for (pugi::xml_node child : savefile.children())
-                {
-                    if (strcmp(child.name(), "timestamp") == 0)
-                    {
-                        child.text().set(now.data());
-                    }
+void Metadata::updateFF8(uint8_t slot, uint8_t save)
+{
+    char currentSave[260]{ 0 };
 
-                    if (strcmp(child.name(), "signature") == 0)
-                    {
-                        child.text().set(md5.data());
-                    }
-                }
-            }
-        }
+    // Append save file name
+    strcpy(currentSave, userPath);
+    if (slot > 2) {
+        strcpy(currentSave + strlen(currentSave), "\\chocorpg.ff8");
+    } else {
+        sprintf(currentSave + strlen(currentSave), R"(\slot%d_save%02i.ff8)", slot, save);
     }
 
-    // Flush
-    saveXml();
+    enqueue(PendingSave{ currentSave, true, slot, save });
 }
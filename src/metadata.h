@@ -22,26 +22,56 @@
 #pragma once
 
 #include <io.h>
+#include <filesystem>
+#include <string>
 
 #include <pugiconfig.hpp>
 #include <pugixml.hpp>
 
+#include "coalescing_queue.h"
+
+// Saves done less than this delay apart are written to metadata.xml at once
+#define METADATA_COALESCE_DELAY_MS 250
+// Saves keep coming, write them anyway after this delay
+#define METADATA_COALESCE_MAX_DELAY_MS 2000
+
 class Metadata
 {
 private:
+	struct PendingSave
+	{
+		std::string filename;
+		bool ff8;
+		uint8_t slot;
+		uint8_t save;
+		std::string now;
+	};
+
+	// Only used by the worker thread
 	pugi::xml_document doc;
+	bool docLoaded = false;
+	std::filesystem::file_time_type docWriteTime;
 
-	std::string now;
 	std::string userID;
 	char userPath[260]{ 0 };
 	char savePath[260]{ 0 };
 
-	void calcNow();
+	// Pending saves by file, a newer save of the same file replaces the one still waiting
+	CoalescingQueue<std::string, PendingSave> pendingSaves;
+
+	std::string calcNow();
+	std::string calcSignature(const char *filename);
 	void loadXml();
 	void saveXml();
+	void updateSave(const PendingSave &pending);
+	void enqueue(PendingSave pending);
+	void flush(const CoalescingQueue<std::string, PendingSave>::Batch &batch);
 
 public:
+	Metadata();
+
 	void init();
+	void shutdown();
 	void updateFF7(uint8_t save);
 	void updateFF8(uint8_t slot, uint8_t save);
 };
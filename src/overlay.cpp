@@ -28,6 +28,7 @@
 #include "cfg.h"
 #include "world.h"
 #include "lighting_debug.h"
+#include "performance_debug.h"
 
 #define IMGUI_VIEW_ID 255
 
@@ -315,6 +316,7 @@ void Overlay::drawMainWindow() {
             ImGui::MenuItem("Field Debug", NULL, &field_debug_open);
             if (!ff8) ImGui::MenuItem("Lighting Debug", NULL, &lighting_debug_open);
             if (ff8) ImGui::MenuItem("World Debug", NULL, &world_debug_open);
+            ImGui::MenuItem("Performance", NULL, &performance_debug_open);
             ImGui::EndMenu();
         }
         ImGui::EndMenuBar();
@@ -325,6 +327,9 @@ void Overlay::drawMainWindow() {
 
 void Overlay::draw()
 {
+    INT64 start_time;
+    ::QueryPerformanceCounter((LARGE_INTEGER*)&start_time);
+
     Update();
     ImGui::NewFrame();
 
@@ -340,10 +345,16 @@ void Overlay::draw()
         if (field_debug_open) field_debug(&field_debug_open);
         if (!ff8 && lighting_debug_open) lighting_debug(&lighting_debug_open);
         if (ff8 && world_debug_open) world_debug(&world_debug_open);
+        if (performance_debug_open) performance_debug(&performance_debug_open, ImGui::GetIO().DeltaTime * 1000.0f, overlay_time);
     }
 
     ImGui::Render();
     Render(ImGui::GetDrawData());
+
+    // Cost of the overlay itself, shown on the next frame
+    INT64 end_time;
+    ::QueryPerformanceCounter((LARGE_INTEGER*)&end_time);
+    overlay_time = (float)(end_time - start_time) * 1000.0f / g_TicksPerSecond;
 }
 
 void Overlay::destroy()
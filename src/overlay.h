@@ -41,6 +41,8 @@ private:
 	bool field_debug_open = false;
 	bool lighting_debug_open = false;
 	bool world_debug_open = false;
+	bool performance_debug_open = false;
+	float overlay_time = 0.0f;
 
 	MemoryEditor mem_edit;
 
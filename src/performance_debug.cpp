@@ -0,0 +1,193 @@
+/****************************************************************************/
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "performance_debug.h"
+#include "globals.h"
+#include "common.h"
+
+#include <imgui.h>
+#include <algorithm>
+#include <map>
+#include <string>
+
+#define PERFORMANCE_DEBUG_HISTORY 240
+
+enum PerformanceMetric
+{
+    PERFORMANCE_FRAME_TIME = 0,
+    PERFORMANCE_OVERLAY_TIME,
+    PERFORMANCE_DRAW_CALLS,
+    PERFORMANCE_VERTICES,
+    PERFORMANCE_TEXTURE_UPLOADS,
+    PERFORMANCE_UPLOAD_KB,
+    PERFORMANCE_DEFERRED,
+    PERFORMANCE_AUDIO_VOICES,
+    PERFORMANCE_FILE_OPENS,
+    PERFORMANCE_FILE_READ_KB,
+    PERFORMANCE_METRIC_COUNT
+};
+
+static const char* performance_metric_names[PERFORMANCE_METRIC_COUNT] = {
+    "Frame time (ms)",
+    "Overlay time (ms)",
+    "Draw calls",
+    "Vertices",
+    "Texture uploads",
+    "Upload (KB)",
+    "Zsort layers",
+    "Audio voices",
+    "File opens",
+    "File reads (KB)",
+};
+
+struct PerformanceSample
+{
+    uint32_t mode;
+    float values[PERFORMANCE_METRIC_COUNT];
+};
+
+struct PerformanceModeTotals
+{
+    std::string name;
+    uint32_t frames = 0;
+    float max_frame_time = 0.0f;
+    double totals[PERFORMANCE_METRIC_COUNT] = {};
+};
+
+static PerformanceSample performance_samples[PERFORMANCE_DEBUG_HISTORY];
+static uint32_t performance_sample_count = 0;
+static uint32_t performance_sample_next = 0;
+static std::map<uint32_t, PerformanceModeTotals> performance_mode_totals;
+static int performance_mode_filter = -1;
+
+static void performance_debug_sample(float frameTime, float overlayTime)
+{
+    struct game_mode* mode = getmode_cached();
+    PerformanceSample& sample = performance_samples[performance_sample_next];
+
+    sample.mode = mode->mode;
+    sample.values[PERFORMANCE_FRAME_TIME] = frameTime;
+    sample.values[PERFORMANCE_OVERLAY_TIME] = overlayTime;
+    sample.values[PERFORMANCE_DRAW_CALLS] = stats.draw_calls;
+    sample.values[PERFORMANCE_VERTICES] = stats.vertex_count;
+    sample.values[PERFORMANCE_TEXTURE_UPLOADS] = stats.texture_uploads;
+    sample.values[PERFORMANCE_UPLOAD_KB] = (stats.texture_upload_bytes + stats.surface_bytes_uploaded) / 1024.0f;
+    sample.values[PERFORMANCE_DEFERRED] = stats.deferred;
+    sample.values[PERFORMANCE_AUDIO_VOICES] = stats.audio_voices;
+    sample.values[PERFORMANCE_FILE_OPENS] = stats.file_opens;
+    sample.values[PERFORMANCE_FILE_READ_KB] = stats.file_read_bytes / 1024.0f;
+
+    performance_sample_next = (performance_sample_next + 1) % PERFORMANCE_DEBUG_HISTORY;
+    performance_sample_count = std::min(performance_sample_count + 1, (uint32_t)PERFORMANCE_DEBUG_HISTORY);
+
+    PerformanceModeTotals& totals = performance_mode_totals[sample.mode];
+
+    if (totals.name.empty()) totals.name = mode->name;
+    totals.frames++;
+    totals.max_frame_time = std::max(totals.max_frame_time, frameTime);
+    for (int metric = 0; metric < PERFORMANCE_METRIC_COUNT; metric++) totals.totals[metric] += sample.values[metric];
+}
+
+void performance_debug(bool* isOpen, float frameTime, float overlayTime)
+{
+    // Keep sampling while the window is collapsed, so the graphs have no holes once expanded
+    performance_debug_sample(frameTime, overlayTime);
+
+    if (!ImGui::Begin("Performance", isOpen, ImGuiWindowFlags_::ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        ImGui::End();
+        return;
+    }
+
+    std::string preview = performance_mode_filter < 0 ? "All modes" : performance_mode_totals[performance_mode_filter].name;
+    if (ImGui::BeginCombo("Game mode", preview.c_str()))
+    {
+        if (ImGui::Selectable("All modes", performance_mode_filter < 0)) performance_mode_filter = -1;
+        for (const auto& [mode, totals] : performance_mode_totals)
+        {
+            if (ImGui::Selectable(totals.name.c_str(), performance_mode_filter == (int)mode)) performance_mode_filter = mode;
+        }
+        ImGui::EndCombo();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset"))
+    {
+        performance_sample_count = 0;
+        performance_mode_totals.clear();
+        performance_mode_filter = -1;
+    }
+
+    ImGui::Text("Textures: %u (%u external, %u KB cached)", stats.texture_count, stats.external_textures, stats.ext_cache_size / 1024);
+    ImGui::Text("Resident mod images: %u (%u MB)", stats.mod_images, stats.mod_images_size / (1024 * 1024));
+    ImGui::Text("Resident mod palettes: %u / %u (%u textures)", stats.mod_palettes_resident, stats.mod_palettes, stats.mod_textures);
+    if (stats.mod_texture_stats_count > 0 && ImGui::TreeNode("Largest mod textures"))
+    {
+        for (uint32_t i = 0; i < stats.mod_texture_stats_count; i++)
+        {
+            const mod_texture_stats& texture = stats.mod_texture_stats[i];
+            ImGui::Text("%s: %u / %u palettes, %u KB, %u loads", texture.name, texture.palettes_resident, texture.palettes, texture.images_size / 1024, texture.image_loads);
+        }
+        ImGui::TreePop();
+    }
+    ImGui::Text("Frame pacing: %u us late, %u us jitter, %u us spin", stats.frame_pacing_error, stats.frame_pacing_jitter, stats.frame_pacing_spin);
+    ImGui::Text("Last voice start: %u us", stats.voice_start_latency);
+
+    // Oldest to newest, only the frames spent in the selected mode
+    float values[PERFORMANCE_DEBUG_HISTORY];
+    for (int metric = 0; metric < PERFORMANCE_METRIC_COUNT; metric++)
+    {
+        int count = 0;
+        float max = 0.0f, total = 0.0f;
+
+        for (uint32_t i = 0; i < performance_sample_count; i++)
+        {
+            const PerformanceSample& sample = performance_samples[(performance_sample_next + PERFORMANCE_DEBUG_HISTORY - performance_sample_count + i) % PERFORMANCE_DEBUG_HISTORY];
+
+            if (performance_mode_filter >= 0 && sample.mode != (uint32_t)performance_mode_filter) continue;
+
+            values[count++] = sample.values[metric];
+            max = std::max(max, sample.values[metric]);
+            total += sample.values[metric];
+        }
+
+        char overlay[64];
+        snprintf(overlay, sizeof(overlay), "avg %.2f max %.2f", count ? total / count : 0.0f, max);
+        ImGui::PlotLines(performance_metric_names[metric], values, count, 0, overlay, 0.0f, max > 0.0f ? max * 1.1f : 1.0f, ImVec2(320, 40));
+    }
+
+    if (ImGui::CollapsingHeader("Per game mode") && ImGui::BeginTable("modes", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Mode");
+        ImGui::TableSetupColumn("Frames");
+        ImGui::TableSetupColumn("Avg ms");
+        ImGui::TableSetupColumn("Max ms");
+        ImGui::TableSetupColumn("Avg draws");
+        ImGui::TableSetupColumn("Avg upload KB");
+        ImGui::TableHeadersRow();
+        for (const auto& [mode, totals] : performance_mode_totals)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::Text("%s", totals.name.c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%u", totals.frames);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", totals.totals[PERFORMANCE_FRAME_TIME] / totals.frames);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", totals.max_frame_time);
+            ImGui::TableNextColumn(); ImGui::Text("%.0f", totals.totals[PERFORMANCE_DRAW_CALLS] / totals.frames);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", totals.totals[PERFORMANCE_UPLOAD_KB] / totals.frames);
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
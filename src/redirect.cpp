@@ -22,11 +22,100 @@
 #include <shlwapi.h>
 #include <filesystem>
 #include <io.h>
+#include <mutex>
+#include <string>
+#include <unordered_set>
 #include "log.h"
 #include "utils.h"
 
 #include "redirect.h"
 
+// Files found in the override path, relative lowercase paths with backslashes
+std::unordered_set<std::string> override_files;
+bool override_files_scanned = false;
+HANDLE override_files_watch = INVALID_HANDLE_VALUE;
+std::mutex override_files_mutex;
+
+std::string make_override_key(const char *path)
+{
+	std::string key;
+
+	for (const char *c = path; *c != '\0'; ++c)
+	{
+		char ch = *c == '/' ? '\\' : ::tolower(*c);
+
+		// Skip leading and duplicated separators, like PathAppend does
+		if (ch == '\\' && (key.empty() || key.back() == '\\')) continue;
+
+		key.push_back(ch);
+	}
+
+	// Resolve "." and ".." segments, only when there can be some since most paths have none
+	if (key.starts_with('.') || key.find("\\.") != std::string::npos)
+	{
+		key = std::filesystem::path(key).lexically_normal().string();
+
+		if (key == ".") key.clear();
+	}
+
+	return key;
+}
+
+void scan_override_files()
+{
+	std::filesystem::path root = std::filesystem::path(basedir) / override_path;
+	std::error_code ec;
+
+	override_files.clear();
+
+	const std::filesystem::directory_options options = std::filesystem::directory_options::follow_directory_symlink | std::filesystem::directory_options::skip_permission_denied;
+
+	for (auto it = std::filesystem::recursive_directory_iterator(root, options, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+	{
+		if (it->is_regular_file(ec)) override_files.insert(make_override_key(it->path().lexically_relative(root).string().c_str()));
+	}
+
+	override_files_scanned = true;
+
+	if (trace_all || trace_files) ffnx_trace("%s: %u files found in %s\n", __func__, override_files.size(), root.string().c_str());
+
+	if (override_path_watch && override_files_watch == INVALID_HANDLE_VALUE && dirExists(root.string().c_str()))
+	{
+		override_files_watch = FindFirstChangeNotificationA(root.string().c_str(), TRUE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME);
+	}
+}
+
+void close_override_files_watch()
+{
+	std::lock_guard<std::mutex> lock(override_files_mutex);
+
+	if (override_files_watch != INVALID_HANDLE_VALUE)
+	{
+		FindCloseChangeNotification(override_files_watch);
+		override_files_watch = INVALID_HANDLE_VALUE;
+	}
+}
+
+// Check if a file exists in the override path, without touching the disk
+bool override_file_exists(const char *relative_path)
+{
+	std::lock_guard<std::mutex> lock(override_files_mutex);
+
+	if (!override_files_scanned)
+	{
+		scan_override_files();
+	}
+	else if (override_files_watch != INVALID_HANDLE_VALUE && WaitForSingleObject(override_files_watch, 0) == WAIT_OBJECT_0)
+	{
+		FindNextChangeNotification(override_files_watch);
+		scan_override_files();
+	}
+
+	stats.redirect_probes_avoided++;
+
+	return override_files.contains(make_override_key(relative_path));
+}
+
 int attempt_redirection(const char* in, char* out, size_t size, bool wantsSteamPath)
 {
 	std::string newIn(in);
@@ -167,7 +256,7 @@ int attempt_redirection(const char* in, char* out, size_t size, bool wantsSteamP
 				PathAppendA(out, newIn.data());
 			}
 
-			if (!fileExists(out))
+			if (!override_file_exists(pos != NULL ? pos : (std::string(R"(battle\)") + newIn).c_str()))
 				return -1;
 
 			if (trace_all || trace_files) ffnx_trace("Redirected: %s -> %s\n", newIn.data(), out);
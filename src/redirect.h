@@ -35,3 +35,5 @@ int attempt_redirection(const char* in, char* out, size_t size, bool wantsSteamP
  *  1  if the file was not found but required
  */
 int redirect_path_with_override(const char* in, char* out, size_t out_size);
+// Stop watching the override path for new files
+void close_override_files_watch();
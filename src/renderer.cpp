@@ -1146,25 +1146,15 @@ void Renderer::prepareShadowMap()
     );
 }
 
-void Renderer::prepareSpecularIbl(char* fullpath)
+// IBL textures are owned by the lighting IBL cache, the renderer only binds them
+void Renderer::setSpecularIbl(bgfx::TextureHandle handle)
 {
-    if (bgfx::isValid(specularIblTexture))
-        bgfx::destroy(specularIblTexture);
-
-    uint32_t width, height, mipCount = 0;
-    specularIblTexture = createTextureHandle(fullpath, &width, &height, &mipCount, false);
-    if (!specularIblTexture.idx) specularIblTexture = BGFX_INVALID_HANDLE;
-    lighting.setIblMipCount(mipCount);
+    specularIblTexture = handle;
 }
 
-void Renderer::prepareDiffuseIbl(char* fullpath)
+void Renderer::setDiffuseIbl(bgfx::TextureHandle handle)
 {
-    if (bgfx::isValid(diffuseIblTexture))
-        bgfx::destroy(diffuseIblTexture);
-
-    uint32_t width, height, mipCount = 0;
-    diffuseIblTexture = createTextureHandle(fullpath, &width, &height, &mipCount, false);
-    if (!diffuseIblTexture.idx) diffuseIblTexture = BGFX_INVALID_HANDLE;
+    diffuseIblTexture = handle;
 }
 
 void Renderer::prepareEnvBrdf()
@@ -1657,6 +1647,31 @@ void Renderer::bindIndexBuffer(WORD* inIndex, uint32_t inCount)
     bgfx::setIndexBuffer(indexBufferHandle, currentOffset, inCount);
 };
 
+bgfx::VertexBufferHandle Renderer::createStaticVertexBuffer(struct nvertex* inVertex, uint32_t inCount)
+{
+    const bgfx::Memory* mem = bgfx::alloc(inCount * sizeof(Vertex));
+    Vertex* vertices = (Vertex*)mem->data;
+
+    for (uint32_t idx = 0; idx < inCount; idx++)
+    {
+        vertices[idx] = Vertex();
+        vertices[idx].x = inVertex[idx]._.x;
+        vertices[idx].y = inVertex[idx]._.y;
+        vertices[idx].z = inVertex[idx]._.z;
+        vertices[idx].w = ( ::isinf(inVertex[idx].color.w) ? 1.0f : inVertex[idx].color.w );
+        vertices[idx].bgra = inVertex[idx].color.color;
+        vertices[idx].u = inVertex[idx].u;
+        vertices[idx].v = inVertex[idx].v;
+    }
+
+    return bgfx::createVertexBuffer(mem, vertexLayout);
+};
+
+bgfx::IndexBufferHandle Renderer::createStaticIndexBuffer(WORD* inIndex, uint32_t inCount)
+{
+    return bgfx::createIndexBuffer(bgfx::copy(inIndex, inCount * sizeof(WORD)));
+};
+
 void Renderer::setScissor(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
 {
     scissorOffsetX = getInternalCoordX(x);
@@ -1878,9 +1893,13 @@ bimg::ImageContainer* Renderer::createImageContainer(cmrc::file* file, bimg::Tex
 }
 
 bgfx::TextureHandle Renderer::createTextureHandle(char* filename, uint32_t* width, uint32_t* height, uint32_t* mipCount, bool isSrgb)
+{
+    return createTextureHandle(createImageContainer(filename), filename, width, height, mipCount, isSrgb);
+}
+
+bgfx::TextureHandle Renderer::createTextureHandle(bimg::ImageContainer* img, char* filename, uint32_t* width, uint32_t* height, uint32_t* mipCount, bool isSrgb)
 {
     bgfx::TextureHandle ret = FFNX_RENDERER_INVALID_HANDLE;
-    bimg::ImageContainer* img = createImageContainer(filename);
 
     if (img != nullptr)
     {
@@ -1923,6 +1942,7 @@ bgfx::TextureHandle Renderer::createTextureHandle(char* filename, uint32_t* widt
 
             if (trace_all || trace_renderer) ffnx_trace("Renderer::%s: %u => %ux%u from filename %s\n", __func__, ret.idx, width, height, filename);
         }
+        else bimg::imageFree(img);
     }
 
     return ret;
@@ -2037,6 +2057,22 @@ bool Renderer::saveTexture(const char* filename, uint32_t width, uint32_t height
     return false;
 }
 
+uint32_t Renderer::updateTexture(uint16_t rt, uint8_t* data, uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t pitch)
+{
+    bgfx::TextureHandle handle = { rt };
+
+    if (rt == 0 || !bgfx::isValid(handle) || data == nullptr || width == 0 || height == 0) return 0;
+
+    // Copy the rectangle now, the game is free to write the source again before the frame is submitted
+    const bgfx::Memory* mem = bgfx::copy(data + y * pitch + x * 4, (height - 1) * pitch + width * 4);
+
+    bgfx::updateTexture2D(handle, 0, 0, x, y, width, height, mem, pitch);
+
+    if (trace_all || trace_renderer) ffnx_trace("Renderer::%s: %u => %ux%u at %u,%u\n", __func__, rt, width, height, x, y);
+
+    return width * height * 4;
+};
+
 void Renderer::deleteTexture(uint16_t rt)
 {
     if (rt > 0)
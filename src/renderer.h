@@ -464,8 +464,8 @@ public:
     void reset();
     void prepareFFNxLogo();
     void prepareShadowMap();
-    void prepareSpecularIbl(char* fullpath = nullptr);
-    void prepareDiffuseIbl(char* fullpath = nullptr);
+    void setSpecularIbl(bgfx::TextureHandle handle);
+    void setDiffuseIbl(bgfx::TextureHandle handle);
     void prepareEnvBrdf();
     void prepareGamutLUTs();
     void LoadGamutLUT(GamutLUTIndexType whichLUT);
@@ -492,6 +492,8 @@ public:
 
     void bindVertexBuffer(struct nvertex* inVertex, vector3<float>* normals, uint32_t inCount);
     void bindIndexBuffer(WORD* inIndex, uint32_t inCount);
+    bgfx::VertexBufferHandle createStaticVertexBuffer(struct nvertex* inVertex, uint32_t inCount);
+    bgfx::IndexBufferHandle createStaticIndexBuffer(WORD* inIndex, uint32_t inCount);
 
     bgfx::UniformHandle setUniform(RendererUniform uniform, const void* uniformValue, int arraySize = 1);
     void setCommonUniforms();
@@ -507,9 +509,12 @@ public:
     bimg::ImageContainer* createImageContainer(const char* filename, bimg::TextureFormat::Enum targetFormat = bimg::TextureFormat::Enum::Count);
     bimg::ImageContainer* createImageContainer(cmrc::file* file, bimg::TextureFormat::Enum targetFormat = bimg::TextureFormat::Enum::Count);
     bgfx::TextureHandle createTextureHandle(char* filename, uint32_t* width, uint32_t* height, uint32_t* mipCount, bool isSrgb = true);
+    bgfx::TextureHandle createTextureHandle(bimg::ImageContainer* img, char* filename, uint32_t* width, uint32_t* height, uint32_t* mipCount, bool isSrgb = true);
     bgfx::TextureHandle createTextureHandle(cmrc::file* file, char* filename, uint32_t* width, uint32_t* height, uint32_t* mipCount, bool isSrgb = true);
     uint32_t createTextureLibPng(char* filename, uint32_t* width, uint32_t* height, bool isSrgb = true);
     bool saveTexture(const char* filename, uint32_t width, uint32_t height, const void* data);
+    // Update a rectangle of a BGRA texture created with a stride, returns the amount of bytes uploaded
+    uint32_t updateTexture(uint16_t texId, uint8_t* data, uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t pitch);
     void deleteTexture(uint16_t texId);
     void useTexture(uint16_t texId, uint32_t slot = 0);
     uint32_t createBlitTexture(uint32_t x, uint32_t y, uint32_t width, uint32_t height);
@@ -27,6 +27,7 @@
 #include "log.h"
 #include "gl.h"
 #include "utils.h"
+#include "ff7/battle/defs.h"
 
 #include <xxhash.h>
 
@@ -130,6 +131,8 @@ uint32_t load_texture_helper(char* name, uint32_t* width, uint32_t* height, bool
 	if (ret)
 	{
 		if (trace_all || trace_loaders) ffnx_trace("Using texture: %s (textureId=%d)\n", name, ret);
+
+		if (!ff8) ff7::battle::magic_prefetch_record_file(name);
 	}
 
 	return ret;
@@ -175,7 +175,20 @@ bool play_voice(char* field_name, byte window_id, byte dialog_id, byte page_coun
 			snprintf(name, sizeof(name), "%s/%u", field_name, dialog_id);
 	}
 
-	return nxAudioEngine.playVoice(name, window_id, voice_volume, *common_externals.field_game_moment);
+	bool ret = nxAudioEngine.playVoice(name, window_id, voice_volume, *common_externals.field_game_moment);
+
+	// Decode the next page while this one is being read
+	if (ret && page < 'z')
+	{
+		snprintf(name, sizeof(name), "%s/w%u_%u%c", field_name, window_id, dialog_id, page + 1);
+
+		if (!nxAudioEngine.canPlayVoice(name))
+			snprintf(name, sizeof(name), "%s/%u%c", field_name, dialog_id, page + 1);
+
+		nxAudioEngine.prefetchVoice(name);
+	}
+
+	return ret;
 }
 
 bool play_battle_dialogue_voice(short enemy_id, std::string tokenized_dialogue)
@@ -0,0 +1,107 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "atomic_file.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+namespace
+{
+    // Fresh directory under the temporary path, removed at the end of the test
+    struct scratch_directory
+    {
+        std::filesystem::path path;
+
+        scratch_directory()
+        {
+            path = std::filesystem::temp_directory_path() / ("ffnx_tests_" + std::to_string(std::random_device()()));
+            std::filesystem::create_directories(path);
+        }
+
+        ~scratch_directory()
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(path, ec);
+        }
+    };
+
+    std::string read_file(const std::filesystem::path &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    bool write_file(const std::string &path, const std::string &content)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << content;
+        return bool(file);
+    }
+}
+
+TEST_CASE(atomic_file_replace)
+{
+    scratch_directory dir;
+    std::string target = (dir.path / "metadata.xml").string(), error;
+
+    // Creates, then replaces
+    CHECK(atomic_write_file(target, [](const std::string &temp) { return write_file(temp, "first"); }, error));
+    CHECK(read_file(target) == "first");
+    CHECK(atomic_write_file(target, [](const std::string &temp) { return write_file(temp, "second, longer"); }, error));
+    CHECK(read_file(target) == "second, longer");
+    CHECK(!std::filesystem::exists(target + ".tmp"));
+
+    // A temporary file left by a previous crash is overwritten
+    write_file(target + ".tmp", "truncated garb");
+    CHECK(atomic_write_file(target, [](const std::string &temp) { return write_file(temp, "third"); }, error));
+    CHECK(read_file(target) == "third");
+    CHECK(!std::filesystem::exists(target + ".tmp"));
+}
+
+TEST_CASE(atomic_file_crash)
+{
+    scratch_directory dir;
+    std::string target = (dir.path / "metadata.xml").string(), error;
+
+    write_file(target, "<gamestatus/>");
+
+    // The writer dies halfway: the previous file is untouched and nothing is left behind
+    CHECK(!atomic_write_file(target, [](const std::string &temp) { write_file(temp, "<gamest"); return false; }, error));
+    CHECK(error.find(".tmp") != std::string::npos);
+    CHECK(read_file(target) == "<gamestatus/>");
+    CHECK(!std::filesystem::exists(target + ".tmp"));
+
+    // The target cannot be replaced: reported, and the temporary file is removed
+    std::filesystem::path blocked = dir.path / "blocked";
+    std::filesystem::create_directories(blocked / "child");
+    error.clear();
+    CHECK(!atomic_write_file(blocked.string(), [](const std::string &temp) { return write_file(temp, "data"); }, error));
+    CHECK(!error.empty());
+    CHECK(std::filesystem::is_directory(blocked / "child"));
+    CHECK(!std::filesystem::exists(blocked.string() + ".tmp"));
+}
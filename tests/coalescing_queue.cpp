@@ -0,0 +1,141 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "coalescing_queue.h"
+
+#include <atomic>
+#include <string>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    typedef CoalescingQueue<std::string, int> Queue;
+
+    struct recorder
+    {
+        std::mutex mutex;
+        std::vector<Queue::Batch> batches;
+        std::vector<std::thread::id> threads;
+
+        Queue::Flush flush()
+        {
+            return [this](const Queue::Batch &batch) {
+                std::lock_guard<std::mutex> lock(mutex);
+                batches.push_back(batch);
+                threads.push_back(std::this_thread::get_id());
+            };
+        }
+
+        size_t count()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return batches.size();
+        }
+
+        bool waitFor(size_t expected, std::chrono::milliseconds timeout)
+        {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (count() < expected && std::chrono::steady_clock::now() < deadline) std::this_thread::sleep_for(1ms);
+            return count() >= expected;
+        }
+    };
+}
+
+TEST_CASE(coalescing_queue_debounce)
+{
+    recorder flushed;
+    Queue queue(200ms, 10s, flushed.flush());
+    auto start = std::chrono::steady_clock::now();
+
+    // Each push restarts the wait, so saves made in quick succession end up in one batch
+    for (int i = 0; i < 6; i++)
+    {
+        queue.push(i % 2 ? "slot1" : "slot2", i);
+        std::this_thread::sleep_for(50ms);
+    }
+    CHECK(flushed.count() == 0);
+
+    CHECK(flushed.waitFor(1, 2s));
+    CHECK(std::chrono::steady_clock::now() - start >= 250ms + 200ms);
+    CHECK(flushed.batches[0].size() == 2);
+    // A newer value for a key replaces the pending one
+    CHECK(flushed.batches[0]["slot2"] == 4);
+    CHECK(flushed.batches[0]["slot1"] == 5);
+    CHECK(flushed.threads[0] != std::this_thread::get_id());
+
+    // The next push starts a new batch
+    queue.push("slot1", 6);
+    CHECK(flushed.waitFor(2, 2s));
+    CHECK(flushed.batches[1].size() == 1 && flushed.batches[1]["slot1"] == 6);
+
+    queue.stop();
+    CHECK(flushed.count() == 2);
+}
+
+TEST_CASE(coalescing_queue_max_delay)
+{
+    recorder flushed;
+    Queue queue(200ms, 300ms, flushed.flush());
+
+    // Pushes keep coming faster than the delay, batches are still written every max delay
+    for (int i = 0; i < 20; i++)
+    {
+        queue.push("slot" + std::to_string(i), i);
+        std::this_thread::sleep_for(50ms);
+    }
+    CHECK(flushed.count() >= 2);
+
+    queue.stop();
+
+    size_t total = 0;
+    for (const Queue::Batch &batch : flushed.batches) total += batch.size();
+    CHECK(total == 20);
+}
+
+TEST_CASE(coalescing_queue_stop)
+{
+    recorder flushed;
+    Queue queue(10s, 10s, flushed.flush());
+
+    // Stopping writes what is pending right away instead of waiting for the delay
+    queue.push("slot1", 1);
+    queue.push("slot2", 2);
+    auto start = std::chrono::steady_clock::now();
+    queue.stop();
+    CHECK(std::chrono::steady_clock::now() - start < 5s);
+    CHECK(flushed.count() == 1);
+    CHECK(flushed.batches[0].size() == 2);
+
+    // After stop, pushes are written on the caller thread
+    queue.push("slot1", 3);
+    CHECK(flushed.count() == 2);
+    CHECK(flushed.batches[1]["slot1"] == 3);
+    CHECK(flushed.threads[1] == std::this_thread::get_id());
+
+    // Stopping with nothing pending writes nothing
+    recorder idle;
+    Queue idleQueue(10ms, 10ms, idle.flush());
+    idleQueue.stop();
+    CHECK(idle.count() == 0);
+}
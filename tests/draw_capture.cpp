@@ -0,0 +1,285 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "draw_capture_format.h"
+#include "draw_replay/replay.h"
+#include "draw_replay/synthetic.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+namespace
+{
+    std::vector<uint8_t> read_file(const std::filesystem::path &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    std::filesystem::path temp_trace(const char *name)
+    {
+        return std::filesystem::temp_directory_path() / ("ffnx_tests_" + std::to_string(std::random_device()()) + "_" + name + ".xcap");
+    }
+
+    // Writes a trace with the writer and loads it back in memory
+    template<typename Fn>
+    std::vector<uint8_t> write_trace(uint32_t ff8, Fn fn)
+    {
+        std::filesystem::path path = temp_trace("trace");
+        DrawCaptureWriter writer;
+
+        if (!writer.open(path.string().c_str(), ff8)) return {};
+        fn(writer);
+        writer.close();
+
+        std::vector<uint8_t> data = read_file(path);
+        std::filesystem::remove(path);
+
+        return data;
+    }
+
+    void put_u32(std::vector<uint8_t> &data, uint32_t value)
+    {
+        uint8_t bytes[4];
+        memcpy(bytes, &value, sizeof(value));
+        data.insert(data.end(), bytes, bytes + sizeof(bytes));
+    }
+
+    // Counts the records of a trace, false when it does not read to the end
+    bool count_records(std::vector<uint8_t> data, size_t &count, std::string &error)
+    {
+        DrawCaptureReader reader;
+        DrawCaptureReader::Record record;
+
+        count = 0;
+        error.clear();
+        if (!reader.load(std::move(data), error)) return false;
+        while (reader.next(record, error)) count++;
+
+        return error.empty();
+    }
+}
+
+TEST_CASE(draw_capture_round_trip)
+{
+    uint32_t pixels[4 * 2] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint32_t palette[3] = { 0xFF0000FF, 0xFF00FF00, 0xFFFF0000 };
+    draw_capture_vertex vertices[3] = { { 0, 0, 0, 1, 0xFFFFFFFF, 0, 0, 0 }, { 1, 0, 0, 1, 0xFF00FF00, 0, 1, 0 }, { 0, 1, 0.5f, 1, 0xFF0000FF, 7, 0, 1 } };
+    // Odd index count: every payload after it starts on a misaligned offset
+    uint16_t indices[3] = { 0, 1, 2 };
+    draw_capture_state state;
+
+    memset(&state, 0, sizeof(state));
+    state.texture_id = 1;
+    state.blend_mode = 4;
+    state.world_view_matrix[5] = 2.5f;
+
+    std::vector<uint8_t> data = write_trace(1, [&](DrawCaptureWriter &writer) {
+        writer.draw({ 4, 3, 3, 3, 1, 0, state, vertices, indices });
+        writer.texture({ 1, 2, 4, 2, 0, pixels });
+        writer.palette({ 1, 5, 3, palette });
+        writer.palette({ 1, 0, 16, nullptr });
+        writer.texture({ 2, 0, 8, 8, 0, nullptr });
+        writer.flip(42);
+    });
+
+    DrawCaptureReader reader;
+    DrawCaptureReader::Record record;
+    std::string error;
+
+    CHECK(reader.load(data, error));
+    CHECK(reader.isFF8());
+
+    CHECK(reader.next(record, error) && record.type == DRAW_CAPTURE_DRAW);
+    CHECK(record.draw.primitivetype == 4 && record.draw.vertextype == 3 && record.draw.vertexcount == 3 && record.draw.count == 3 && record.draw.clip == 1);
+    CHECK(record.draw.state.texture_id == 1 && record.draw.state.blend_mode == 4 && record.draw.state.world_view_matrix[5] == 2.5f);
+    CHECK(memcmp(record.draw.vertices, vertices, sizeof(vertices)) == 0);
+    CHECK(memcmp(record.draw.indices, indices, sizeof(indices)) == 0);
+
+    CHECK(reader.next(record, error) && record.type == DRAW_CAPTURE_TEXTURE);
+    CHECK(record.texture.texture_id == 1 && record.texture.palette_index == 2 && record.texture.width == 4 && record.texture.height == 2);
+    CHECK(record.texture.pixels != nullptr && uintptr_t(record.texture.pixels) % alignof(uint32_t) == 0);
+    CHECK(memcmp(record.texture.pixels, pixels, sizeof(pixels)) == 0);
+
+    CHECK(reader.next(record, error) && record.type == DRAW_CAPTURE_PALETTE);
+    CHECK(record.palette.texture_id == 1 && record.palette.dest_offset == 5 && record.palette.entries == 3);
+    CHECK(record.palette.data != nullptr && memcmp(record.palette.data, palette, sizeof(palette)) == 0);
+
+    CHECK(reader.next(record, error) && record.type == DRAW_CAPTURE_PALETTE);
+    CHECK(record.palette.entries == 16 && record.palette.data == nullptr);
+
+    CHECK(reader.next(record, error) && record.type == DRAW_CAPTURE_TEXTURE);
+    CHECK(record.texture.texture_id == 2 && record.texture.pixels == nullptr);
+
+    CHECK(reader.next(record, error) && record.type == DRAW_CAPTURE_FLIP);
+    CHECK(record.frame_counter == 42);
+
+    CHECK(!reader.next(record, error));
+    CHECK(error.empty());
+
+    // Rewinding reads the same records again
+    size_t count = 0;
+    reader.rewind();
+    while (reader.next(record, error)) count++;
+    CHECK(count == 6 && error.empty());
+}
+
+TEST_CASE(draw_capture_malformed)
+{
+    std::vector<uint8_t> data = write_trace(0, [](DrawCaptureWriter &writer) {
+        uint32_t palette[2] = { 1, 2 };
+        writer.palette({ 1, 0, 2, palette });
+        writer.flip(0);
+    });
+    std::string error;
+    size_t count;
+
+    CHECK(count_records(data, count, error) && count == 2);
+
+    // Bad magic, unsupported version, truncated header
+    std::vector<uint8_t> bad = data;
+    bad[0] ^= 0xFF;
+    CHECK(!count_records(bad, count, error) && !error.empty());
+    bad = data;
+    bad[4] = DRAW_CAPTURE_VERSION + 1;
+    CHECK(!count_records(bad, count, error) && error.find("version") != std::string::npos);
+    CHECK(!count_records(std::vector<uint8_t>(data.begin(), data.begin() + 6), count, error) && !error.empty());
+
+    // Every truncation inside the records is reported, never read past the end
+    for (size_t size = 12 + 1; size < data.size(); size++)
+    {
+        if (size == data.size() - 12) continue; // Ends right after the palette record
+
+        CHECK(!count_records(std::vector<uint8_t>(data.begin(), data.begin() + size), count, error));
+        CHECK(error.find("truncated") != std::string::npos);
+    }
+
+    // A palette whose entries do not match its payload size
+    bad = data;
+    bad[12 + 8 + 8] = 200;
+    CHECK(!count_records(bad, count, error) && error.find("malformed") != std::string::npos);
+
+    // A draw whose counts overflow its payload
+    std::vector<uint8_t> draw;
+    put_u32(draw, DRAW_CAPTURE_DRAW);
+    put_u32(draw, 6 * 4 + sizeof(draw_capture_state));
+    for (uint32_t value : { 4u, 1u, 0xFFFFFFFFu, 0xFFFFFFFFu, 0u, 0u }) put_u32(draw, value);
+    draw.resize(draw.size() + sizeof(draw_capture_state));
+    bad.assign(data.begin(), data.begin() + 12);
+    bad.insert(bad.end(), draw.begin(), draw.end());
+    CHECK(!count_records(bad, count, error) && error.find("malformed") != std::string::npos);
+
+    // Unknown record types from a newer writer are skipped
+    bad.assign(data.begin(), data.begin() + 12);
+    put_u32(bad, 99);
+    put_u32(bad, 3);
+    bad.insert(bad.end(), { 1, 2, 3 });
+    bad.insert(bad.end(), data.begin() + 12, data.end());
+    CHECK(count_records(bad, count, error) && count == 2);
+}
+
+// The committed reference traces are the output of the generator, byte for byte
+TEST_CASE(draw_capture_reference_traces)
+{
+    for (const std::string &scene : draw_replay_synthetic_scenes())
+    {
+        std::filesystem::path reference = std::filesystem::path(FFNX_TESTS_TRACES_DIR) / (scene + ".xcap");
+        std::filesystem::path generated = temp_trace(scene.c_str());
+
+        CHECK(draw_replay_synthetic(scene, generated.string().c_str()));
+        std::vector<uint8_t> data = read_file(generated);
+        std::filesystem::remove(generated);
+
+        CHECK(!data.empty());
+        CHECK(data == read_file(reference));
+    }
+}
+
+TEST_CASE(draw_capture_replay)
+{
+    for (const std::string &scene : draw_replay_synthetic_scenes())
+    {
+        DrawCaptureReader reader;
+        DrawReplayBackend backend;
+        draw_replay_stats stats;
+        std::string error;
+
+        CHECK(reader.open((std::filesystem::path(FFNX_TESTS_TRACES_DIR) / (scene + ".xcap")).string().c_str(), error));
+        CHECK(draw_replay(reader, backend, stats, error));
+        CHECK(error.empty());
+        CHECK(stats.frames == 3 && stats.frameNs.size() == 3);
+        CHECK(stats.flips.count == 3);
+        CHECK(stats.draws.count > 0 && stats.vertices > 0 && stats.indices > 0);
+        CHECK(stats.missingTextures == 0);
+        // The last flip leaves nothing behind
+        CHECK(backend.frameVertices().empty() && backend.frameIndices().empty());
+
+        // A second pass over the same reader gives the same counts
+        draw_replay_stats again;
+        CHECK(draw_replay(reader, backend, again, error));
+        CHECK(again.frames == stats.frames && again.vertices == stats.vertices && again.indices == stats.indices);
+    }
+
+    // Draws on textures uploaded before the recording started are counted
+    std::vector<uint8_t> data = write_trace(0, [](DrawCaptureWriter &writer) {
+        draw_capture_state state;
+        draw_capture_vertex vertex = { 0, 0, 0, 1, 0, 0, 0, 0 };
+        uint16_t index = 0;
+
+        memset(&state, 0, sizeof(state));
+        state.texture_id = 7;
+        writer.draw({ 4, 3, 1, 1, 0, 0, state, &vertex, &index });
+        writer.flip(0);
+    });
+    DrawCaptureReader reader;
+    DrawReplayBackend backend;
+    draw_replay_stats stats;
+    std::string error;
+
+    CHECK(reader.load(data, error));
+    CHECK(draw_replay(reader, backend, stats, error));
+    CHECK(stats.missingTextures == 1 && stats.frames == 1);
+}
+
+// CPU time of each phase of the replay over the reference traces
+BENCHMARK(draw_capture)
+{
+    for (const std::string &scene : draw_replay_synthetic_scenes())
+    {
+        DrawCaptureReader reader;
+        DrawReplayBackend backend;
+        draw_replay_stats stats;
+        std::string error;
+        size_t iterations = 20 * ffnx_tests::benchScale();
+        char label[80];
+
+        if (!reader.open((std::filesystem::path(FFNX_TESTS_TRACES_DIR) / (scene + ".xcap")).string().c_str(), error)) continue;
+
+        snprintf(label, sizeof(label), "%s, %zu KB trace", scene.c_str(), reader.size() / 1024);
+        ffnx_tests::bench(label, iterations, [&] { draw_replay(reader, backend, stats, error); });
+        draw_replay_print(scene.c_str(), stats);
+    }
+}
@@ -0,0 +1,142 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "ff8/draw_image.h"
+
+#include <cstring>
+#include <random>
+
+namespace
+{
+    // The per pixel loop ModdedTexture::drawImage used before the row based version, kept as the reference
+    void reference_draw_image(
+        const uint32_t *sourceRgba, int sourceRgbaW, uint8_t sourceScale,
+        uint32_t *targetRgba, int targetRgbaW, uint8_t targetScale,
+        int sourceX, int sourceY, int sourceW, int sourceH,
+        int targetX, int targetY)
+    {
+        if (targetScale < sourceScale)
+        {
+            return;
+        }
+
+        sourceRgbaW *= sourceScale;
+        targetRgbaW *= targetScale;
+        const uint8_t scaleRatio = targetScale / sourceScale;
+
+        for (int y = 0; y < sourceH; ++y)
+        {
+            for (int x = 0; x < sourceW; ++x)
+            {
+                const uint32_t *sourceRgbaCur = sourceRgba + (sourceX + x) * sourceScale + (sourceY + y) * sourceScale * sourceRgbaW;
+                uint32_t *targetRgbaCur = targetRgba + (targetX + x) * targetScale + (targetY + y) * targetScale * targetRgbaW;
+
+                for (int yPix = 0; yPix < targetScale; ++yPix)
+                {
+                    for (int xPix = 0; xPix < targetScale; ++xPix)
+                    {
+                        uint32_t color = *(sourceRgbaCur + xPix / scaleRatio + yPix / scaleRatio * sourceRgbaW), alpha = color & 0xFF000000;
+                        *(targetRgbaCur + xPix + yPix * targetRgbaW) = (color & 0xFFFFFF) | (alpha >= 0x7F000000 ? 0x7F000000 : 0);
+                    }
+                }
+            }
+        }
+    }
+
+    // Random colors with alphas on both sides of the semi-transparency threshold
+    std::vector<uint32_t> make_image(size_t size, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        const uint32_t alphas[] = { 0x00000000, 0x7E000000, 0x7F000000, 0x80000000, 0xFF000000 };
+        std::vector<uint32_t> image(size);
+
+        for (uint32_t &pixel : image) pixel = (rng() & 0xFFFFFF) | (rng() % 3 == 0 ? alphas[rng() % 5] : rng() & 0xFF000000);
+
+        return image;
+    }
+}
+
+TEST_CASE(draw_image_matches_reference)
+{
+    const int imageW = 24, imageH = 12;
+    size_t cases = 0;
+
+    for (uint8_t sourceScale = 1; sourceScale <= 8; ++sourceScale)
+    {
+        // Every ratio, including targets which are not a multiple of the source
+        for (uint8_t targetScale = sourceScale; targetScale <= 8; ++targetScale)
+        {
+            std::vector<uint32_t> source = make_image(size_t(imageW) * sourceScale * imageH * sourceScale, sourceScale * 16 + targetScale);
+
+            // Offsets and widths around the four pixel SIMD blocks so rows start unaligned and end in the scalar tail
+            for (int sourceX = 0; sourceX < 5; ++sourceX)
+            {
+                for (int sourceW = 1; sourceW <= 9; ++sourceW)
+                {
+                    for (int targetX : { 0, 3 })
+                    {
+                        const int sourceY = sourceX % 3, sourceH = 1 + sourceW % 4, targetY = targetX / 2;
+                        const size_t targetSize = size_t(imageW) * targetScale * imageH * targetScale;
+                        std::vector<uint32_t> expected(targetSize, 0xDEADBEEF), actual(targetSize, 0xDEADBEEF);
+
+                        reference_draw_image(source.data(), imageW, sourceScale, expected.data(), imageW, targetScale, sourceX, sourceY, sourceW, sourceH, targetX, targetY);
+                        draw_image(source.data(), imageW, sourceScale, actual.data(), imageW, targetScale, sourceX, sourceY, sourceW, sourceH, targetX, targetY);
+
+                        CHECK(memcmp(expected.data(), actual.data(), targetSize * sizeof(uint32_t)) == 0);
+                        cases++;
+                    }
+                }
+            }
+        }
+    }
+
+    CHECK(cases == 36 * 5 * 9 * 2);
+}
+
+TEST_CASE(draw_image_rejects_downscale)
+{
+    std::vector<uint32_t> source = make_image(16 * 4 * 16 * 4, 1), target(16 * 16, 0xDEADBEEF);
+
+    draw_image(source.data(), 16, 4, target.data(), 16, 2, 0, 0, 16, 16, 0, 0);
+    CHECK(target[0] == 0xDEADBEEF && target.back() == 0xDEADBEEF);
+
+    draw_image(source.data(), 16, 1, target.data(), 16, 1, 0, 0, 0, 16, 0, 0);
+    CHECK(target[0] == 0xDEADBEEF);
+}
+
+TEST_CASE(draw_image_convert_row_in_place)
+{
+    for (int count = 0; count <= 13; ++count)
+    {
+        std::vector<uint32_t> pixels = make_image(count, count), expected(count);
+
+        for (int i = 0; i < count; ++i)
+        {
+            uint32_t alpha = pixels[i] & 0xFF000000;
+            expected[i] = (pixels[i] & 0xFFFFFF) | (alpha >= 0x7F000000 ? 0x7F000000 : 0);
+        }
+
+        draw_image_convert_row(pixels.data(), pixels.data(), count);
+        CHECK(pixels == expected);
+    }
+}
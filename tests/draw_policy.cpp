@@ -0,0 +1,240 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "gl/draw_policy.h"
+
+#include <cctype>
+#include <cstring>
+
+namespace
+{
+    enum { VERTEX = 1, LVERTEX, TLVERTEX };
+
+    // Graphics objects of the FF7 menu, stand-ins for the ff7_externals.menu_objects pointers
+    enum menu_object { NONE, MENU_FADE, BLEND_WINDOW_BG, WINDOW_BG, BTL_WIN, BTL_WIN_A, BTL_WIN_B, BTL_WIN_C, BTL_WIN_D, UNKNOWN2, UNKNOWN3, UNKNOWN5, BUSTER_TEX, OTHER };
+
+    struct draw
+    {
+        bool ff8;
+        uint32_t mode;
+        bool worldmap_highres;
+        bool has_texture;
+        bool external;
+        bool force_filter;
+        bool force_zsort;
+        const char *pc_name;
+        uint32_t palette_index;
+        uint32_t vertextype;
+        menu_object object;
+        bool texture_filter;
+        bool enable_bilinear;
+    };
+
+    struct outcome
+    {
+        bool texture_filter;
+        bool deferred;
+        bool force_defer;
+
+        bool operator==(const outcome &other) const = default;
+    };
+
+    int reference_strnicmp(const char *a, const char *b, size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            int ca = tolower((unsigned char)a[i]), cb = tolower((unsigned char)b[i]);
+            if (ca != cb) return ca - cb;
+            if (ca == 0) return 0;
+        }
+        return 0;
+    }
+
+    // gl_special_case as it was before the policy words, every decision taken on every draw
+    outcome reference_special_case(const draw &d)
+    {
+        uint32_t mode = d.mode;
+        bool texture_filter = d.texture_filter;
+        bool defer = false, force_defer = false;
+        bool isExternalTexture = d.has_texture && d.external;
+        menu_object graphics_object = d.object;
+
+        if(!d.ff8 && (mode == MODE_SUBMARINE || mode == MODE_COASTER) && !isExternalTexture) texture_filter = false;
+        if(d.ff8 && mode == MODE_WORLDMAP && (isExternalTexture || d.worldmap_highres)) texture_filter = false;
+        if(d.has_texture && d.force_filter && isExternalTexture) texture_filter = true;
+        if(d.has_texture && d.force_zsort && isExternalTexture) defer = true;
+        if(mode == MODE_MENU || mode == MODE_MAIN_MENU) defer = true;
+
+        if(!d.ff8)
+        {
+            if(d.vertextype != TLVERTEX && isExternalTexture) texture_filter = true;
+            if((mode == MODE_MENU || mode == MODE_MAIN_MENU) && isExternalTexture) texture_filter = true;
+
+            if(d.has_texture && d.pc_name && !reference_strnicmp(d.pc_name, "menu/btl_win_c_", strlen("menu/btl_win_c_") - 1) && d.palette_index == 0) texture_filter = false;
+
+            if(graphics_object == MENU_FADE) defer = true;
+            if(graphics_object == BLEND_WINDOW_BG) defer = true;
+
+            if(mode == MODE_FIELD)
+            {
+                if(graphics_object == WINDOW_BG) force_defer = true;
+                if(graphics_object == BTL_WIN) force_defer = true;
+                if(graphics_object == BTL_WIN_A) force_defer = true;
+                if(graphics_object == BTL_WIN_B) force_defer = true;
+                if(graphics_object == BTL_WIN_C) force_defer = true;
+                if(graphics_object == BTL_WIN_D) force_defer = true;
+            }
+
+            if(mode == MODE_BATTLE)
+            {
+                if(graphics_object == UNKNOWN2) defer = true;
+                if(graphics_object == UNKNOWN3) defer = true;
+                if(graphics_object == UNKNOWN5) defer = true;
+            }
+        }
+
+        if((defer || force_defer) && !d.ff8) return { texture_filter, true, bool(force_defer) };
+
+        if (!isExternalTexture && texture_filter && !d.enable_bilinear) texture_filter = false;
+
+        return { texture_filter, false, false };
+    }
+
+    uint32_t draw_objects(menu_object object)
+    {
+        switch (object)
+        {
+        case MENU_FADE: return GL_DRAW_OBJECT_MENU_FADE;
+        case BLEND_WINDOW_BG: return GL_DRAW_OBJECT_BLEND_WINDOW_BG;
+        case WINDOW_BG: return GL_DRAW_OBJECT_WINDOW_BG;
+        case BTL_WIN: case BTL_WIN_A: case BTL_WIN_B: case BTL_WIN_C: case BTL_WIN_D: return GL_DRAW_OBJECT_BATTLE_WINDOW;
+        case UNKNOWN2: case UNKNOWN3: case UNKNOWN5: return GL_DRAW_OBJECT_BATTLE_BAR;
+        default: return 0;
+        }
+    }
+
+    // What gl_special_case does now: the texture word from the load, the mode word from the last mode change
+    outcome policy_special_case(const draw &d)
+    {
+        uint32_t texture_policy = d.has_texture ? gl_texture_name_policy(d.ff8, d.pc_name) : 0;
+        gl_draw_policy_input input = {
+            gl_mode_policy(d.ff8, d.mode, d.worldmap_highres),
+            texture_policy,
+            d.has_texture && d.external,
+            d.has_texture && d.force_filter,
+            d.has_texture && d.force_zsort,
+            d.has_texture ? d.palette_index : 0,
+            d.vertextype == TLVERTEX,
+            d.ff8 ? 0 : draw_objects(d.object),
+            d.texture_filter,
+            d.enable_bilinear
+        };
+        gl_draw_policy_result result = gl_draw_policy(input);
+
+        return { result.texture_filter, result.defer || result.force_defer, result.force_defer };
+    }
+
+    draw base_draw(bool ff8, uint32_t mode)
+    {
+        return draw{ ff8, mode, false, true, false, false, false, "field/md1stin_00", 0, TLVERTEX, NONE, true, false };
+    }
+}
+
+// One row per special case of gl_special_case
+TEST_CASE(draw_policy_table)
+{
+    struct row
+    {
+        const char *name;
+        draw input;
+        outcome expected;
+    };
+
+    auto with = [](draw d, auto change) { change(d); return d; };
+
+    const row rows[] = {
+        { "internal texture, filtering needs enable_bilinear", base_draw(false, MODE_FIELD), { false, false, false } },
+        { "internal texture with enable_bilinear", with(base_draw(false, MODE_FIELD), [](draw &d) { d.enable_bilinear = true; }), { true, false, false } },
+        { "ff7 submarine, internal texture never filtered", with(base_draw(false, MODE_SUBMARINE), [](draw &d) { d.enable_bilinear = true; }), { false, false, false } },
+        { "ff7 coaster, internal texture never filtered", with(base_draw(false, MODE_COASTER), [](draw &d) { d.enable_bilinear = true; }), { false, false, false } },
+        { "ff7 coaster, external texture filtered", with(base_draw(false, MODE_COASTER), [](draw &d) { d.external = true; }), { true, false, false } },
+        { "ff8 worldmap, external texture never filtered", with(base_draw(true, MODE_WORLDMAP), [](draw &d) { d.external = true; }), { false, false, false } },
+        { "ff8 worldmap, internal high res texture never filtered", with(base_draw(true, MODE_WORLDMAP), [](draw &d) { d.worldmap_highres = true; d.enable_bilinear = true; }), { false, false, false } },
+        { "ff8 worldmap, internal texture with enable_bilinear", with(base_draw(true, MODE_WORLDMAP), [](draw &d) { d.enable_bilinear = true; }), { true, false, false } },
+        { "forced filtering on an external texture", with(base_draw(true, MODE_WORLDMAP), [](draw &d) { d.external = true; d.force_filter = true; d.texture_filter = false; }), { true, false, false } },
+        { "forced filtering ignored on internal textures", with(base_draw(false, MODE_FIELD), [](draw &d) { d.force_filter = true; d.texture_filter = false; d.enable_bilinear = true; }), { false, false, false } },
+        { "ff7 forced z-sort on an external texture", with(base_draw(false, MODE_FIELD), [](draw &d) { d.external = true; d.force_zsort = true; }), { true, true, false } },
+        { "ff8 never defers", with(base_draw(true, MODE_MENU), [](draw &d) { d.external = true; d.force_zsort = true; }), { true, false, false } },
+        { "ff7 menu z-sorts every draw", base_draw(false, MODE_MENU), { true, true, false } },
+        { "ff7 main menu z-sorts every draw", base_draw(false, MODE_MAIN_MENU), { true, true, false } },
+        { "ff7 external texture in 3D filtered", with(base_draw(false, MODE_BATTLE), [](draw &d) { d.external = true; d.vertextype = VERTEX; d.texture_filter = false; }), { true, false, false } },
+        { "ff7 external texture in 2D keeps the game filter", with(base_draw(false, MODE_BATTLE), [](draw &d) { d.external = true; d.texture_filter = false; }), { false, false, false } },
+        { "ff7 external texture in menu filtered", with(base_draw(false, MODE_MENU), [](draw &d) { d.external = true; d.texture_filter = false; }), { true, true, false } },
+        { "ff7 window border not filtered with palette 0", with(base_draw(false, MODE_MENU), [](draw &d) { d.external = true; d.pc_name = "MENU/BTL_WIN_C_L.TEX"; }), { false, true, false } },
+        { "ff7 window border filtered with another palette", with(base_draw(false, MODE_MENU), [](draw &d) { d.external = true; d.pc_name = "menu/btl_win_c_l"; d.palette_index = 1; }), { true, true, false } },
+        { "ff8 window border name has no effect", with(base_draw(true, MODE_FIELD), [](draw &d) { d.external = true; d.pc_name = "menu/btl_win_c_l"; }), { true, false, false } },
+        { "ff7 menu fade z-sorted everywhere", with(base_draw(false, MODE_WORLDMAP), [](draw &d) { d.object = MENU_FADE; }), { true, true, false } },
+        { "ff7 blended window background z-sorted everywhere", with(base_draw(false, MODE_BATTLE), [](draw &d) { d.object = BLEND_WINDOW_BG; }), { true, true, false } },
+        { "ff7 field message window always z-sorted", with(base_draw(false, MODE_FIELD), [](draw &d) { d.object = WINDOW_BG; }), { true, true, true } },
+        { "ff7 message window outside of fields", with(base_draw(false, MODE_BATTLE), [](draw &d) { d.object = WINDOW_BG; }), { false, false, false } },
+        { "ff7 field timer window", with(base_draw(false, MODE_FIELD), [](draw &d) { d.object = BTL_WIN_C; }), { true, true, true } },
+        { "ff7 battle limit bar z-sorted", with(base_draw(false, MODE_BATTLE), [](draw &d) { d.object = UNKNOWN3; }), { true, true, false } },
+        { "ff7 limit box outside of battles", with(base_draw(false, MODE_FIELD), [](draw &d) { d.object = UNKNOWN5; }), { false, false, false } },
+        { "ff8 menu objects have no effect", with(base_draw(true, MODE_FIELD), [](draw &d) { d.object = WINDOW_BG; }), { false, false, false } },
+        { "no texture", with(base_draw(false, MODE_FIELD), [](draw &d) { d.has_texture = false; d.external = true; d.force_zsort = true; d.pc_name = "menu/btl_win_c_l"; }), { false, false, false } },
+    };
+
+    for (const row &r : rows)
+    {
+        outcome got = policy_special_case(r.input);
+
+        if (!(got == r.expected)) printf("  %s: filter %d deferred %d forced %d\n", r.name, got.texture_filter, got.deferred, got.force_defer);
+        CHECK(got == r.expected);
+        CHECK(reference_special_case(r.input) == r.expected);
+    }
+}
+
+// Every combination of the inputs the special cases read gives the same result as the per draw code
+TEST_CASE(draw_policy_exhaustive)
+{
+    const char *names[] = { nullptr, "", "menu/btl_win_c_l", "MENU/BTL_WIN_C", "menu/btl_win_a_l", "menu/btl_win" };
+    size_t combinations = 0, mismatches = 0;
+
+    for (int ff8 = 0; ff8 < 2; ff8++)
+    for (uint32_t mode = MODE_FIELD; mode <= MODE_MAIN_MENU; mode++)
+    for (int object = NONE; object <= OTHER; object++)
+    for (const char *name : names)
+    for (uint32_t flags = 0; flags < (1 << 10); flags++)
+    {
+        draw d = {
+            bool(ff8), mode, bool(flags & 1), bool(flags & 2), bool(flags & 4), bool(flags & 8), bool(flags & 16),
+            name, (flags & 32) ? 3u : 0u, (flags & 64) ? TLVERTEX : ((flags & 512) ? LVERTEX : VERTEX), menu_object(object), bool(flags & 128), bool(flags & 256)
+        };
+
+        combinations++;
+        if (!(policy_special_case(d) == reference_special_case(d))) mismatches++;
+    }
+
+    CHECK(combinations > 1000000);
+    CHECK(mismatches == 0);
+}
@@ -0,0 +1,183 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "bgfx_backend.h"
+
+bool DrawReplayBgfxBackend::init(uint32_t width, uint32_t height)
+{
+    bgfx::Init init;
+
+    init.type = bgfx::RendererType::Noop;
+    init.resolution.width = width;
+    init.resolution.height = height;
+    init.resolution.reset = BGFX_RESET_NONE;
+
+    if (!bgfx::init(init)) return false;
+
+    // Same layout as Renderer::init
+    vertexLayout
+        .begin()
+        .add(bgfx::Attrib::Position, 4, bgfx::AttribType::Float)
+        .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)
+        .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
+        .add(bgfx::Attrib::Normal, 3, bgfx::AttribType::Float)
+        .add(bgfx::Attrib::Weight, 4, bgfx::AttribType::Float)
+        .add(bgfx::Attrib::Indices, 4, bgfx::AttribType::Uint8, false, true)
+        .end();
+
+    textureSampler = bgfx::createUniform("tex_0", bgfx::UniformType::Sampler);
+
+    bgfx::setViewRect(0, 0, 0, uint16_t(width), uint16_t(height));
+    bgfx::frame();
+
+    return true;
+}
+
+void DrawReplayBgfxBackend::shutdown()
+{
+    destroyTextures();
+
+    if (bgfx::isValid(vertexBuffer)) bgfx::destroy(vertexBuffer);
+    if (bgfx::isValid(indexBuffer)) bgfx::destroy(indexBuffer);
+    if (bgfx::isValid(textureSampler)) bgfx::destroy(textureSampler);
+
+    bgfx::shutdown();
+}
+
+void DrawReplayBgfxBackend::destroyTextures()
+{
+    for (auto &entry : textureHandles) bgfx::destroy(entry.second);
+
+    textureHandles.clear();
+    textureInfos.clear();
+}
+
+void DrawReplayBgfxBackend::begin(bool ff8)
+{
+    DrawReplayBackend::begin(ff8);
+
+    destroyTextures();
+    drawn = false;
+}
+
+void DrawReplayBgfxBackend::texture(const draw_capture_texture &texture)
+{
+    DrawReplayBackend::texture(texture);
+
+    const Texture &source = textures[texture.texture_id];
+    auto it = textureHandles.find(texture.texture_id);
+    bool valid = source.width > 0 && source.height > 0 && source.width <= 0xFFFF && source.height <= 0xFFFF;
+
+    // Uploads of the same size replace the pixels, as Renderer::updateTexture does
+    if (it != textureHandles.end())
+    {
+        const bgfx::TextureInfo &info = textureInfos[texture.texture_id];
+
+        if (valid && info.width == source.width && info.height == source.height)
+        {
+            bgfx::updateTexture2D(it->second, 0, 0, 0, 0, uint16_t(source.width), uint16_t(source.height), bgfx::copy(source.pixels.data(), uint32_t(source.pixels.size() * sizeof(uint32_t))));
+            return;
+        }
+
+        bgfx::destroy(it->second);
+        textureHandles.erase(it);
+    }
+
+    if (!valid) return;
+
+    bgfx::calcTextureSize(textureInfos[texture.texture_id], uint16_t(source.width), uint16_t(source.height), 1, false, false, 1, bgfx::TextureFormat::BGRA8);
+    textureHandles[texture.texture_id] = bgfx::createTexture2D(uint16_t(source.width), uint16_t(source.height), false, 1, bgfx::TextureFormat::BGRA8, BGFX_SAMPLER_NONE, bgfx::copy(source.pixels.data(), uint32_t(source.pixels.size() * sizeof(uint32_t))));
+}
+
+void DrawReplayBgfxBackend::palette(const draw_capture_palette &palette)
+{
+    DrawReplayBackend::palette(palette);
+
+    // A palette write makes the driver convert and upload the texture again
+    auto it = textureHandles.find(palette.texture_id);
+
+    if (it == textureHandles.end()) return;
+
+    const Texture &source = textures[palette.texture_id];
+
+    bgfx::updateTexture2D(it->second, 0, 0, 0, 0, uint16_t(source.width), uint16_t(source.height), bgfx::copy(source.pixels.data(), uint32_t(source.pixels.size() * sizeof(uint32_t))));
+}
+
+void DrawReplayBgfxBackend::draw(const draw_capture_draw &draw)
+{
+    if (!bgfx::isValid(vertexBuffer)) vertexBuffer = bgfx::createDynamicVertexBuffer(draw.vertexcount, vertexLayout, BGFX_BUFFER_ALLOW_RESIZE);
+    if (!bgfx::isValid(indexBuffer)) indexBuffer = bgfx::createDynamicIndexBuffer(draw.count, BGFX_BUFFER_ALLOW_RESIZE);
+
+    DrawReplayBackend::draw(draw);
+
+    bgfx::setVertexBuffer(0, vertexBuffer, firstVertex, draw.vertexcount);
+    bgfx::setIndexBuffer(indexBuffer, firstIndex, draw.count);
+
+    auto it = textureHandles.find(draw.state.texture_id);
+
+    if (it != textureHandles.end()) bgfx::setTexture(0, textureSampler, it->second);
+
+    // Same state bits as Renderer::draw
+    const draw_capture_state &state = draw.state;
+    uint64_t bgfxState = BGFX_STATE_LINEAA | BGFX_STATE_MSAA | BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A;
+
+    if (!state.nocull) bgfxState |= state.cullface ? BGFX_STATE_CULL_CW : BGFX_STATE_CULL_CCW;
+
+    switch (state.blend_mode)
+    {
+    case 0: bgfxState |= BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_INV_SRC_ALPHA); break;
+    case 1: bgfxState |= BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_ONE, BGFX_STATE_BLEND_ONE); break;
+    case 2: bgfxState |= BGFX_STATE_BLEND_EQUATION(BGFX_STATE_BLEND_EQUATION_REVSUB) | BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_ONE, BGFX_STATE_BLEND_ONE); break;
+    case 3: bgfxState |= BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_ONE); break;
+    default: bgfxState |= BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_ONE, BGFX_STATE_BLEND_ZERO); break;
+    }
+
+    if (state.depthtest) bgfxState |= BGFX_STATE_DEPTH_TEST_LEQUAL;
+    if (state.depthmask) bgfxState |= BGFX_STATE_WRITE_Z;
+
+    bgfx::setTransform(state.world_view_matrix);
+    bgfx::setState(bgfxState);
+
+    // No shaders on the Noop renderer, the draw goes through the whole submission path and is dropped by the backend
+    bgfx::submit(0, BGFX_INVALID_HANDLE, 0, BGFX_DISCARD_ALL);
+
+    drawn = true;
+}
+
+void DrawReplayBgfxBackend::flip()
+{
+    if (drawn)
+    {
+        bgfx::update(vertexBuffer, 0, bgfx::copy(vertices.data(), uint32_t(vertices.size() * sizeof(draw_replay_vertex))));
+        bgfx::update(indexBuffer, 0, bgfx::copy(indices.data(), uint32_t(indices.size() * sizeof(uint16_t))));
+    }
+
+    bgfx::frame();
+
+    drawn = false;
+
+    DrawReplayBackend::flip();
+}
+
+void DrawReplayBgfxBackend::end()
+{
+    bgfx::frame();
+}
@@ -0,0 +1,53 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include "replay.h"
+
+#include <bgfx/bgfx.h>
+
+// Drives bgfx on its Noop renderer the way Renderer does: textures created and updated on upload,
+// vertices and indices gathered into dynamic buffers uploaded at the end of the frame, one submit per draw
+class DrawReplayBgfxBackend : public DrawReplayBackend
+{
+public:
+    bool init(uint32_t width, uint32_t height);
+    void shutdown();
+
+    void begin(bool ff8) override;
+    void texture(const draw_capture_texture &texture) override;
+    void palette(const draw_capture_palette &palette) override;
+    void draw(const draw_capture_draw &draw) override;
+    void flip() override;
+    void end() override;
+
+private:
+    bgfx::VertexLayout vertexLayout;
+    bgfx::DynamicVertexBufferHandle vertexBuffer = BGFX_INVALID_HANDLE;
+    bgfx::DynamicIndexBufferHandle indexBuffer = BGFX_INVALID_HANDLE;
+    bgfx::UniformHandle textureSampler = BGFX_INVALID_HANDLE;
+    std::unordered_map<uint32_t, bgfx::TextureHandle> textureHandles;
+    std::unordered_map<uint32_t, bgfx::TextureInfo> textureInfos;
+    bool drawn = false;
+
+    void destroyTextures();
+};
@@ -0,0 +1,131 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "replay.h"
+#include "synthetic.h"
+
+#if defined(FFNX_DRAW_REPLAY_BGFX)
+#include "bgfx_backend.h"
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+// Replays draw capture traces and prints the CPU time spent in each phase of the frames
+//   ffnx_draw_replay [--bgfx] [--repeat N] trace...
+//   ffnx_draw_replay --generate directory
+int main(int argc, char **argv)
+{
+    std::vector<const char *> traces;
+    bool useBgfx = false;
+    int repeat = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--bgfx")) useBgfx = true;
+        else if (!strcmp(argv[i], "--repeat") && i + 1 < argc) repeat = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--generate") && i + 1 < argc)
+        {
+            std::filesystem::path directory = argv[++i];
+
+            for (const std::string &scene : draw_replay_synthetic_scenes())
+            {
+                std::string path = (directory / (scene + ".xcap")).string();
+
+                if (!draw_replay_synthetic(scene, path.c_str()))
+                {
+                    fprintf(stderr, "cannot write %s\n", path.c_str());
+                    return 1;
+                }
+
+                printf("%s\n", path.c_str());
+            }
+
+            return 0;
+        }
+        else traces.push_back(argv[i]);
+    }
+
+    if (traces.empty())
+    {
+        fprintf(stderr, "usage: %s [--bgfx] [--repeat N] trace...\n       %s --generate directory\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    DrawReplayBackend cpuBackend;
+    DrawReplayBackend *backend = &cpuBackend;
+
+#if defined(FFNX_DRAW_REPLAY_BGFX)
+    DrawReplayBgfxBackend bgfxBackend;
+
+    if (useBgfx)
+    {
+        if (!bgfxBackend.init(640, 480))
+        {
+            fprintf(stderr, "cannot initialize bgfx\n");
+            return 1;
+        }
+
+        backend = &bgfxBackend;
+    }
+#else
+    if (useBgfx)
+    {
+        fprintf(stderr, "built without bgfx\n");
+        return 1;
+    }
+#endif
+
+    int ret = 0;
+
+    for (const char *path : traces)
+    {
+        DrawCaptureReader reader;
+        draw_replay_stats stats;
+        std::string error;
+
+        if (!reader.open(path, error))
+        {
+            fprintf(stderr, "%s: %s\n", path, error.c_str());
+            ret = 1;
+            continue;
+        }
+
+        for (int pass = 0; pass < repeat && error.empty(); pass++) draw_replay(reader, *backend, stats, error);
+
+        if (!error.empty())
+        {
+            fprintf(stderr, "%s: %s\n", path, error.c_str());
+            ret = 1;
+        }
+
+        draw_replay_print(path, stats);
+    }
+
+#if defined(FFNX_DRAW_REPLAY_BGFX)
+    if (useBgfx) bgfxBackend.shutdown();
+#endif
+
+    return ret;
+}
@@ -0,0 +1,179 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "replay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+void DrawReplayBackend::begin(bool ff8)
+{
+    this->ff8 = ff8;
+    textures.clear();
+    vertices.clear();
+    indices.clear();
+}
+
+void DrawReplayBackend::texture(const draw_capture_texture &texture)
+{
+    Texture &target = textures[texture.texture_id];
+
+    target.width = texture.width;
+    target.height = texture.height;
+
+    if (texture.pixels != nullptr) target.pixels.assign(texture.pixels, texture.pixels + size_t(texture.width) * texture.height);
+    else target.pixels.assign(size_t(texture.width) * texture.height, 0);
+}
+
+void DrawReplayBackend::palette(const draw_capture_palette &palette)
+{
+    Texture &target = textures[palette.texture_id];
+
+    if (target.palette.size() < size_t(palette.dest_offset) + palette.entries) target.palette.resize(size_t(palette.dest_offset) + palette.entries);
+
+    if (palette.data != nullptr) std::copy(palette.data, palette.data + palette.entries, target.palette.begin() + palette.dest_offset);
+    else std::fill(target.palette.begin() + palette.dest_offset, target.palette.begin() + palette.dest_offset + palette.entries, 0);
+}
+
+void DrawReplayBackend::draw(const draw_capture_draw &draw)
+{
+    firstVertex = uint32_t(vertices.size());
+    firstIndex = uint32_t(indices.size());
+
+    vertices.resize(vertices.size() + draw.vertexcount);
+
+    for (uint32_t idx = 0; idx < draw.vertexcount; idx++)
+    {
+        const draw_capture_vertex &in = draw.vertices[idx];
+        draw_replay_vertex &out = vertices[firstVertex + idx];
+
+        out = draw_replay_vertex();
+        out.x = in.x;
+        out.y = in.y;
+        out.z = in.z;
+        out.w = std::isinf(in.w) ? 1.0f : in.w;
+        out.bgra = in.color;
+        out.u = in.u;
+        out.v = in.v;
+    }
+
+    indices.insert(indices.end(), draw.indices, draw.indices + draw.count);
+
+    const draw_capture_state &state = draw.state;
+    uint64_t packed = uint64_t(state.blend_mode) | uint64_t(state.nocull ? 0 : 1 + state.cullface) << 4 | uint64_t(state.depthtest) << 6
+        | uint64_t(state.depthmask) << 7 | uint64_t(draw.primitivetype) << 8 | uint64_t(state.alphatest) << 12 | uint64_t(state.alphafunc) << 13
+        | uint64_t(state.alpharef) << 16 | uint64_t(state.texture_id) << 32;
+
+    stateHash = stateHash * 31 + packed;
+}
+
+void DrawReplayBackend::flip()
+{
+    vertices.clear();
+    indices.clear();
+}
+
+bool draw_replay(DrawCaptureReader &reader, DrawReplayBackend &backend, draw_replay_stats &stats, std::string &error)
+{
+    typedef std::chrono::steady_clock clock;
+    DrawCaptureReader::Record record;
+    double frameNs = 0.0;
+
+    auto elapsed = [](clock::time_point start) { return std::chrono::duration<double, std::nano>(clock::now() - start).count(); };
+
+    reader.rewind();
+    backend.begin(reader.isFF8());
+
+    while (true)
+    {
+        clock::time_point start = clock::now();
+        bool hasRecord = reader.next(record, error);
+        double ns = elapsed(start);
+
+        stats.read.ns += ns;
+        frameNs += ns;
+
+        if (!hasRecord) break;
+
+        stats.read.count++;
+        start = clock::now();
+
+        draw_replay_phase *phase = nullptr;
+
+        switch (record.type)
+        {
+        case DRAW_CAPTURE_TEXTURE:
+            backend.texture(record.texture);
+            phase = &stats.textures;
+            break;
+        case DRAW_CAPTURE_PALETTE:
+            backend.palette(record.palette);
+            phase = &stats.palettes;
+            break;
+        case DRAW_CAPTURE_DRAW:
+            if (record.draw.state.texture_id != 0 && !backend.hasTexture(record.draw.state.texture_id)) stats.missingTextures++;
+            stats.vertices += record.draw.vertexcount;
+            stats.indices += record.draw.count;
+            backend.draw(record.draw);
+            phase = &stats.draws;
+            break;
+        case DRAW_CAPTURE_FLIP:
+            backend.flip();
+            phase = &stats.flips;
+            break;
+        }
+
+        ns = elapsed(start);
+        phase->ns += ns;
+        phase->count++;
+        frameNs += ns;
+
+        if (record.type == DRAW_CAPTURE_FLIP)
+        {
+            stats.frames++;
+            stats.frameNs.push_back(frameNs);
+            frameNs = 0.0;
+        }
+    }
+
+    backend.end();
+
+    return error.empty();
+}
+
+void draw_replay_print(const char *name, const draw_replay_stats &stats)
+{
+    double worst = stats.frameNs.empty() ? 0.0 : *std::max_element(stats.frameNs.begin(), stats.frameNs.end());
+    size_t frames = std::max<size_t>(stats.frames, 1);
+
+    printf("%s: %zu frames, %zu vertices, %zu indices, %zu draws on missing textures\n", name, stats.frames, stats.vertices, stats.indices, stats.missingTextures);
+    printf("  %-10s %8s %14s %14s\n", "phase", "count", "us/frame", "ns/record");
+
+    for (const auto &phase : { std::make_pair("read", &stats.read), std::make_pair("textures", &stats.textures), std::make_pair("palettes", &stats.palettes), std::make_pair("draws", &stats.draws), std::make_pair("flips", &stats.flips) })
+    {
+        printf("  %-10s %8zu %14.2f %14.1f\n", phase.first, phase.second->count, phase.second->ns / 1000.0 / frames, phase.second->count ? phase.second->ns / phase.second->count : 0.0);
+    }
+
+    printf("  %-10s %8s %14.2f (worst frame %.2f us)\n", "total", "", stats.totalNs() / 1000.0 / frames, worst / 1000.0);
+}
@@ -0,0 +1,99 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include "draw_capture_format.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Replays a draw capture trace (see src/draw_capture_format.h) against a backend and times each phase of the frames
+
+// Renderer vertex, as Renderer::bindVertexBuffer builds it
+struct draw_replay_vertex
+{
+    float x, y, z, w;
+    uint32_t bgra;
+    float u, v;
+    float nx, ny, nz;
+    float bone_weights[4];
+    uint8_t bone_indices[4];
+};
+
+// Does the CPU side work of the renderer without a GPU: textures and palettes kept in memory,
+// vertices and indices converted into the frame buffers, render state packed per draw
+class DrawReplayBackend
+{
+public:
+    virtual ~DrawReplayBackend() {}
+
+    virtual void begin(bool ff8);
+    virtual void texture(const draw_capture_texture &texture);
+    virtual void palette(const draw_capture_palette &palette);
+    virtual void draw(const draw_capture_draw &draw);
+    virtual void flip();
+    virtual void end() {}
+
+    bool hasTexture(uint32_t texture_id) const { return textures.count(texture_id) != 0; }
+    const std::vector<draw_replay_vertex> &frameVertices() const { return vertices; }
+    const std::vector<uint16_t> &frameIndices() const { return indices; }
+
+protected:
+    struct Texture
+    {
+        uint32_t width = 0, height = 0;
+        std::vector<uint32_t> pixels;
+        std::vector<uint32_t> palette;
+    };
+
+    bool ff8 = false;
+    std::unordered_map<uint32_t, Texture> textures;
+    std::vector<draw_replay_vertex> vertices;
+    std::vector<uint16_t> indices;
+    // Offsets of the current draw in the frame buffers
+    uint32_t firstVertex = 0, firstIndex = 0;
+    // Packed state of the last draws, so the work is not optimized away
+    uint64_t stateHash = 0;
+};
+
+struct draw_replay_phase
+{
+    double ns = 0.0;
+    size_t count = 0;
+};
+
+struct draw_replay_stats
+{
+    size_t frames = 0;
+    size_t vertices = 0;
+    size_t indices = 0;
+    // Draws using a texture uploaded before the recording started
+    size_t missingTextures = 0;
+    draw_replay_phase read, textures, palettes, draws, flips;
+    std::vector<double> frameNs;
+
+    double totalNs() const { return read.ns + textures.ns + palettes.ns + draws.ns + flips.ns; }
+};
+
+bool draw_replay(DrawCaptureReader &reader, DrawReplayBackend &backend, draw_replay_stats &stats, std::string &error);
+void draw_replay_print(const char *name, const draw_replay_stats &stats);
@@ -0,0 +1,268 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "synthetic.h"
+
+#include "draw_capture_format.h"
+
+#include <cstring>
+
+namespace
+{
+    // Values of src/gl.h and src/renderer.h, recorded as the game passes them
+    enum { VERTEX = 1, LVERTEX, TLVERTEX };
+    enum { PT_TRIANGLES = 4 };
+    enum { BLEND_AVG = 0, BLEND_ADD, BLEND_SUB, BLEND_25P, BLEND_NONE };
+
+    const uint32_t frameCount = 3;
+
+    // Small xorshift generator, so the traces are the same on every platform
+    struct random_source
+    {
+        uint32_t state;
+
+        uint32_t next()
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+    };
+
+    // Point on the unit circle from a rational parameter, only basic operations so every platform gets the same floats
+    void circle(float t, float &c, float &s)
+    {
+        c = (1.0f - t * t) / (1.0f + t * t);
+        s = 2.0f * t / (1.0f + t * t);
+    }
+
+    std::vector<uint32_t> make_pixels(uint32_t width, uint32_t height, uint32_t seed)
+    {
+        random_source random{ seed };
+        std::vector<uint32_t> pixels(width * height);
+
+        for (uint32_t &pixel : pixels) pixel = 0xFF000000 | (random.next() & 0xFFFFFF);
+
+        return pixels;
+    }
+
+    draw_capture_state make_state(uint32_t texture_id, uint32_t blend_mode, bool depth)
+    {
+        draw_capture_state state;
+
+        memset(&state, 0, sizeof(state));
+        state.texture_id = texture_id;
+        state.blend_mode = blend_mode;
+        state.viewport[2] = 640;
+        state.viewport[3] = 480;
+        state.nocull = 1;
+        state.depthtest = depth;
+        state.depthmask = depth;
+        state.shademode = 1;
+        state.alphatest = 1;
+        state.alpharef = 0;
+
+        for (int i = 0; i < 4; i++)
+        {
+            state.world_view_matrix[i * 5] = 1.0f;
+            state.d3dprojection_matrix[i * 5] = 1.0f;
+        }
+
+        return state;
+    }
+
+    draw_capture_vertex make_vertex(float x, float y, float z, uint32_t color, float u, float v)
+    {
+        return draw_capture_vertex{ x, y, z, 1.0f, color, 0, u, v };
+    }
+
+    // Screen space quads, two triangles each
+    void add_quad(std::vector<draw_capture_vertex> &vertices, std::vector<uint16_t> &indices, float x, float y, float size, float z, uint32_t color, float u, float v, float uvSize)
+    {
+        uint16_t first = uint16_t(vertices.size());
+
+        vertices.push_back(make_vertex(x, y, z, color, u, v));
+        vertices.push_back(make_vertex(x, y + size, z, color, u, v + uvSize));
+        vertices.push_back(make_vertex(x + size, y, z, color, u + uvSize, v));
+        vertices.push_back(make_vertex(x + size, y + size, z, color, u + uvSize, v + uvSize));
+
+        for (uint16_t index : { 0, 1, 2, 1, 3, 2 }) indices.push_back(first + index);
+    }
+
+    void draw(DrawCaptureWriter &writer, uint32_t vertextype, const draw_capture_state &state, const std::vector<draw_capture_vertex> &vertices, const std::vector<uint16_t> &indices)
+    {
+        writer.draw({ PT_TRIANGLES, vertextype, uint32_t(vertices.size()), uint32_t(indices.size()), 0, 0, state, vertices.data(), indices.data() });
+    }
+
+    // Field: layers of background tiles on paletted textures with an animated palette, and a few models
+    void field(DrawCaptureWriter &writer)
+    {
+        for (uint32_t id = 1; id <= 2; id++)
+        {
+            std::vector<uint32_t> pixels = make_pixels(32, 32, id);
+            writer.texture({ id, 0, 32, 32, 0, pixels.data() });
+        }
+
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            std::vector<uint32_t> palette(16);
+            for (uint32_t i = 0; i < 16; i++) palette[i] = 0xFF000000 | ((frame * 16 + i) * 0x010203);
+            writer.palette({ 1, 0, 16, palette.data() });
+
+            for (uint32_t layer = 0; layer < 8; layer++)
+            {
+                std::vector<draw_capture_vertex> vertices;
+                std::vector<uint16_t> indices;
+
+                for (uint32_t tile = 0; tile < 16; tile++)
+                {
+                    add_quad(vertices, indices, float(tile % 4) * 16.0f + layer * 8.0f, float(tile / 4) * 16.0f, 16.0f, 0.1f * layer, 0xFF808080, (tile % 2) * 0.5f, (tile / 8) * 0.5f, 0.5f);
+                }
+
+                draw(writer, TLVERTEX, make_state(1 + layer % 2, layer < 6 ? BLEND_NONE : BLEND_ADD, false), vertices, indices);
+            }
+
+            for (uint32_t model = 0; model < 3; model++)
+            {
+                std::vector<draw_capture_vertex> vertices;
+                std::vector<uint16_t> indices;
+                draw_capture_state state = make_state(0, BLEND_NONE, true);
+
+                state.world_view_matrix[12] = float(model) * 2.0f + frame * 0.1f;
+
+                for (uint32_t i = 0; i < 12; i++)
+                {
+                    float c, s;
+                    circle(float(i) / 3.0f - 2.0f, c, s);
+                    vertices.push_back(make_vertex(c, float(i % 3), s, 0xFF4060A0 + i, 0.0f, 0.0f));
+                }
+                for (uint16_t i = 0; i < 10; i++) for (uint16_t k : { 0, 1, 2 }) indices.push_back(uint16_t((i + k) % 12));
+
+                draw(writer, VERTEX, state, vertices, indices);
+            }
+
+            writer.flip(frame);
+        }
+    }
+
+    // Battle: depth tested meshes moving every frame, with alpha blended effects on top
+    void battle(DrawCaptureWriter &writer)
+    {
+        for (uint32_t id = 1; id <= 2; id++)
+        {
+            std::vector<uint32_t> pixels = make_pixels(32, 32, 10 + id);
+            writer.texture({ id, 0, 32, 32, 0, pixels.data() });
+        }
+
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            for (uint32_t mesh = 0; mesh < 6; mesh++)
+            {
+                std::vector<draw_capture_vertex> vertices;
+                std::vector<uint16_t> indices;
+                draw_capture_state state = make_state(1 + mesh % 2, mesh < 4 ? BLEND_NONE : BLEND_AVG, true);
+                float c, s;
+
+                circle(0.1f * frame + 0.25f * mesh, c, s);
+                state.nocull = 0;
+                state.world_view_matrix[0] = c;
+                state.world_view_matrix[2] = -s;
+                state.world_view_matrix[8] = s;
+                state.world_view_matrix[10] = c;
+                state.world_view_matrix[14] = 5.0f + mesh;
+
+                // Ring of 24 vertices around a pole, 48 triangles
+                for (uint32_t i = 0; i < 24; i++)
+                {
+                    circle(float(i) / 6.0f - 2.0f, c, s);
+                    vertices.push_back(make_vertex(c, float(i % 2), s, 0xFFFFFFFF, float(i) / 24.0f, float(i % 2)));
+                }
+                vertices.push_back(make_vertex(0.0f, 2.0f, 0.0f, 0xFFFFFFFF, 0.5f, 0.0f));
+                vertices.push_back(make_vertex(0.0f, -1.0f, 0.0f, 0xFFFFFFFF, 0.5f, 1.0f));
+                for (uint16_t i = 0; i < 24; i++)
+                {
+                    for (uint16_t index : { uint16_t(24), i, uint16_t((i + 1) % 24), uint16_t(25), uint16_t((i + 1) % 24), i }) indices.push_back(index);
+                }
+
+                draw(writer, VERTEX, state, vertices, indices);
+            }
+
+            std::vector<draw_capture_vertex> vertices;
+            std::vector<uint16_t> indices;
+            for (uint32_t particle = 0; particle < 8; particle++) add_quad(vertices, indices, 100.0f + particle * 20.0f + frame, 200.0f, 12.0f, 0.0f, 0x80FFC040, 0.0f, 0.0f, 1.0f);
+            draw(writer, TLVERTEX, make_state(2, BLEND_ADD, false), vertices, indices);
+
+            writer.flip(frame);
+        }
+    }
+
+    // Menu: many small draws, one per glyph, over blended window boxes
+    void menu(DrawCaptureWriter &writer)
+    {
+        std::vector<uint32_t> pixels = make_pixels(32, 32, 20);
+        writer.texture({ 1, 0, 32, 32, 0, pixels.data() });
+
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            for (uint32_t box = 0; box < 3; box++)
+            {
+                std::vector<draw_capture_vertex> vertices;
+                std::vector<uint16_t> indices;
+                add_quad(vertices, indices, 10.0f + box * 200.0f, 10.0f, 180.0f, 0.0f, 0xC0204080, 0.0f, 0.0f, 0.0f);
+                draw(writer, TLVERTEX, make_state(0, BLEND_AVG, false), vertices, indices);
+            }
+
+            for (uint32_t glyph = 0; glyph < 60; glyph++)
+            {
+                std::vector<draw_capture_vertex> vertices;
+                std::vector<uint16_t> indices;
+                add_quad(vertices, indices, 20.0f + (glyph % 20) * 9.0f, 20.0f + (glyph / 20) * 16.0f, 8.0f, 0.0f, 0xFFFFFFFF, (glyph % 8) * 0.125f, (glyph / 8 % 8) * 0.125f, 0.125f);
+                draw(writer, TLVERTEX, make_state(1, BLEND_NONE, false), vertices, indices);
+            }
+
+            writer.flip(frame);
+        }
+    }
+}
+
+const std::vector<std::string> &draw_replay_synthetic_scenes()
+{
+    static const std::vector<std::string> scenes = { "field", "battle", "menu" };
+
+    return scenes;
+}
+
+bool draw_replay_synthetic(const std::string &scene, const char *path)
+{
+    DrawCaptureWriter writer;
+
+    if (!writer.open(path, 0)) return false;
+
+    if (scene == "field") field(writer);
+    else if (scene == "battle") battle(writer);
+    else if (scene == "menu") menu(writer);
+    else return false;
+
+    writer.close();
+
+    return true;
+}
@@ -0,0 +1,263 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "ff7/field/layer_tiles.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <random>
+
+using ff7::field::FieldLayerTiles;
+
+namespace
+{
+    // Fields of struct field_tile read by the pick tiles functions, at the same distance from each other
+    struct tile
+    {
+        short x;
+        short y;
+        float z;
+        uint16_t field_8[6];
+        float u;
+        float v;
+        char field_1C[24];
+        uint16_t palette_index;
+        uint16_t flags;
+        char anim_group;
+        char anim_bitmask;
+        char field_36[4102];
+        uint32_t use_fx_page;
+        uint32_t field_1040;
+        uint32_t field_1044;
+        char field_1048[12];
+        uint16_t blend_mode;
+        uint16_t page;
+        uint16_t fx_page;
+        uint16_t field_105A;
+    };
+
+    struct submission
+    {
+        float x, y, z, u, v;
+        uint32_t palette_index;
+
+        bool operator==(const submission &other) const = default;
+    };
+
+    // What add_page_tile receives, per page in call order
+    typedef std::map<uint32_t, std::vector<submission>> page_buffers;
+
+    struct tile_set
+    {
+        std::vector<tile> tiles;
+        std::vector<uint32_t> palette_sort;
+    };
+
+    // Tiles of a 1024x512 background on a few pages, some of them in animation groups
+    tile_set make_tile_set(uint32_t count, uint32_t seed)
+    {
+        tile_set set;
+        std::mt19937 rng(seed);
+
+        set.tiles.resize(count);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            tile &t = set.tiles[i];
+
+            t.x = short(rng() % 64) * 16 - 512;
+            t.y = short(rng() % 32) * 16 - 256;
+            t.z = float(rng() % 4096) / 4096.0f;
+            t.u = float(rng() % 16) / 16.0f;
+            t.v = float(rng() % 16) / 16.0f;
+            t.palette_index = rng() % 8;
+            t.anim_group = (rng() % 4 == 0) ? char(1 + rng() % 3) : 0;
+            t.anim_bitmask = char(1 << (rng() % 4));
+            t.page = rng() % 6;
+            t.use_fx_page = rng() % 5 == 0;
+            t.fx_page = 20 + rng() % 4;
+            t.blend_mode = rng() % 4;
+        }
+
+        // The game sorts the tiles by palette
+        for (uint32_t i = 0; i < count; i++) set.palette_sort.push_back(i);
+        std::stable_sort(set.palette_sort.begin(), set.palette_sort.end(), [&](uint32_t a, uint32_t b) { return set.tiles[a].palette_index < set.tiles[b].palette_index; });
+
+        return set;
+    }
+
+    bool visible(const tile &t, int layer, const uint8_t *sprite_layer)
+    {
+        return layer == 1 || !t.anim_group || (sprite_layer[int(t.anim_group)] & t.anim_bitmask);
+    }
+
+    // The pick tiles loop before the tiles were split per page: walk the palette sort table every frame
+    template<typename Submit>
+    void reference_pick(int layer, tile_set &set, float offset_x, float offset_y, const uint8_t *sprite_layer, Submit submit)
+    {
+        for (uint32_t i = 0; i < set.tiles.size(); i++)
+        {
+            tile &t = set.tiles[set.palette_sort[i]];
+
+            if (!visible(t, layer, sprite_layer)) continue;
+
+            t.field_1040 = 1;
+
+            uint32_t page = (layer != 1 && t.use_fx_page) ? t.fx_page : t.page;
+
+            if (layer == 2 && t.use_fx_page && t.blend_mode == 2) page += 14;
+            if (layer == 2 && t.use_fx_page && t.blend_mode == 3) page += 18;
+
+            submit(page, submission{ t.x * 2.0f + offset_x, t.y * 2.0f + offset_y, t.z, t.u, t.v, t.palette_index });
+        }
+    }
+
+    template<typename Submit>
+    void retained_pick(FieldLayerTiles<tile> &layer_tiles, int layer, uint32_t field_id, tile_set &set, float offset_x, float offset_y, const uint8_t *sprite_layer, Submit submit)
+    {
+        layer_tiles.update(layer, field_id, set.tiles.data(), set.palette_sort.data(), uint32_t(set.tiles.size()));
+
+        for (const auto &page : layer_tiles.pages())
+        {
+            for (const auto &entry : page.entries)
+            {
+                if (layer != 1 && entry.anim_group && !(sprite_layer[int(entry.anim_group)] & entry.anim_bitmask)) continue;
+
+                tile &t = *entry.tile;
+
+                t.field_1040 = 1;
+                submit(layer_tiles.tilePage(page, t), submission{ entry.x * 2.0f + offset_x, entry.y * 2.0f + offset_y, t.z, t.u, t.v, t.palette_index });
+            }
+        }
+    }
+
+    page_buffers reference_buffers(int layer, tile_set &set, float offset_x, float offset_y, const uint8_t *sprite_layer)
+    {
+        page_buffers buffers;
+
+        reference_pick(layer, set, offset_x, offset_y, sprite_layer, [&](uint32_t page, const submission &s) { buffers[page].push_back(s); });
+
+        return buffers;
+    }
+
+    page_buffers retained_buffers(FieldLayerTiles<tile> &layer_tiles, int layer, uint32_t field_id, tile_set &set, float offset_x, float offset_y, const uint8_t *sprite_layer)
+    {
+        page_buffers buffers;
+
+        retained_pick(layer_tiles, layer, field_id, set, offset_x, offset_y, sprite_layer, [&](uint32_t page, const submission &s) { buffers[page].push_back(s); });
+
+        return buffers;
+    }
+}
+
+TEST_CASE(field_layer_tiles_geometry)
+{
+    for (int layer = 1; layer <= 4; layer++)
+    {
+        tile_set set = make_tile_set(1500, layer);
+        FieldLayerTiles<tile> layer_tiles;
+        uint8_t sprite_layer[4] = { 0, 0xFF, 0x05, 0x00 };
+
+        // Scrolling and animation groups toggling
+        for (int frame = 0; frame < 16; frame++)
+        {
+            float offset_x = 640.0f - frame * 3.0f, offset_y = 448.0f + frame;
+
+            sprite_layer[1 + frame % 3] ^= uint8_t(1 << (frame % 4));
+
+            CHECK(retained_buffers(layer_tiles, layer, 1, set, offset_x, offset_y, sprite_layer) == reference_buffers(layer, set, offset_x, offset_y, sprite_layer));
+        }
+
+        CHECK(layer_tiles.rebuilds() == 1);
+    }
+}
+
+TEST_CASE(field_layer_tiles_edits)
+{
+    tile_set set = make_tile_set(800, 7);
+    FieldLayerTiles<tile> layer_tiles;
+    uint8_t sprite_layer[4] = { 0, 0xFF, 0xFF, 0xFF };
+
+    CHECK(retained_buffers(layer_tiles, 2, 1, set, 0.0f, 0.0f, sprite_layer) == reference_buffers(2, set, 0.0f, 0.0f, sprite_layer));
+
+    // Depth, UV and palette changed by the game show on the next frame without a rebuild
+    for (uint32_t i = 0; i < set.tiles.size(); i += 7)
+    {
+        set.tiles[i].z += 0.5f;
+        set.tiles[i].u = 0.75f;
+        set.tiles[i].v = 0.25f;
+        set.tiles[i].palette_index ^= 1;
+    }
+    CHECK(retained_buffers(layer_tiles, 2, 1, set, 0.0f, 0.0f, sprite_layer) == reference_buffers(2, set, 0.0f, 0.0f, sprite_layer));
+    CHECK(layer_tiles.rebuilds() == 1);
+
+    // A tile moved to another page, directly or through its effect page, is drawn on its new page right away
+    // and takes its place in the palette order of that page on the next frame
+    auto sorted = [](page_buffers buffers) {
+        for (auto &page : buffers) std::sort(page.second.begin(), page.second.end(), [](const submission &a, const submission &b) { return memcmp(&a, &b, sizeof(a)) < 0; });
+        return buffers;
+    };
+
+    set.tiles[set.palette_sort[400]].page = 5 - set.tiles[set.palette_sort[400]].page % 6;
+    set.tiles[set.palette_sort[400]].use_fx_page = 0;
+    set.tiles[set.palette_sort[10]].use_fx_page = 1;
+    set.tiles[set.palette_sort[10]].blend_mode = 3;
+    set.tiles[set.palette_sort[10]].fx_page = 30;
+    CHECK(sorted(retained_buffers(layer_tiles, 2, 1, set, 0.0f, 0.0f, sprite_layer)) == sorted(reference_buffers(2, set, 0.0f, 0.0f, sprite_layer)));
+    CHECK(layer_tiles.rebuilds() == 1);
+    CHECK(retained_buffers(layer_tiles, 2, 1, set, 0.0f, 0.0f, sprite_layer) == reference_buffers(2, set, 0.0f, 0.0f, sprite_layer));
+    CHECK(layer_tiles.rebuilds() == 2);
+
+    // Another field, then another tile table
+    CHECK(retained_buffers(layer_tiles, 2, 2, set, 0.0f, 0.0f, sprite_layer) == reference_buffers(2, set, 0.0f, 0.0f, sprite_layer));
+    CHECK(layer_tiles.rebuilds() == 3);
+
+    tile_set other = make_tile_set(300, 8);
+    CHECK(retained_buffers(layer_tiles, 2, 2, other, 0.0f, 0.0f, sprite_layer) == reference_buffers(2, other, 0.0f, 0.0f, sprite_layer));
+    CHECK(layer_tiles.rebuilds() == 4);
+
+    // No page is left over from the larger field
+    size_t entries = 0;
+    for (const auto &page : layer_tiles.pages())
+    {
+        CHECK(!page.entries.empty());
+        entries += page.entries.size();
+    }
+    CHECK(entries == other.tiles.size());
+}
+
+// One frame of a large layer, add_page_tile left out
+BENCHMARK(field_layer_tiles)
+{
+    tile_set set = make_tile_set(4000, 3);
+    FieldLayerTiles<tile> layer_tiles;
+    uint8_t sprite_layer[4] = { 0, 0xFF, 0x05, 0x00 };
+    size_t iterations = 20 * ffnx_tests::benchScale();
+
+    float sum = 0.0f;
+    auto submit = [&](uint32_t page, const submission &s) { sum += s.x + s.y + s.z + s.u + s.v + float(page + s.palette_index); };
+
+    ffnx_tests::bench("4000 tiles, palette sort table", iterations, [&] { reference_pick(2, set, 1.0f, 2.0f, sprite_layer, submit); ffnx_tests::keep(sum); });
+    ffnx_tests::bench("4000 tiles, per page", iterations, [&] { retained_pick(layer_tiles, 2, 1, set, 1.0f, 2.0f, sprite_layer, submit); ffnx_tests::keep(sum); });
+}
@@ -0,0 +1,146 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "ff8/fl_index.h"
+
+#include <cstring>
+#include <random>
+#include <strings.h>
+
+namespace
+{
+    const char *prefix = "c:\\ff8\\data\\eng\\";
+    const size_t prefixSize = strlen(prefix);
+
+    // fl list of a field archive: one path per entry, in the language of the game or in another one
+    std::vector<std::string> make_fl(size_t count, uint32_t seed)
+    {
+        static const char *extensions[] = { ".mim", ".map", ".inf", ".ca", ".id", ".jsm", ".msd", ".sym", ".one", ".pmd", ".pmp", ".pvp" };
+        std::mt19937 rng(seed);
+        std::vector<std::string> paths;
+
+        while (paths.size() < count)
+        {
+            std::string field = "bgroom_" + std::to_string(rng() % 400);
+            std::string language = rng() % 5 == 0 ? "fre" : "eng";
+
+            paths.push_back("C:\\FF8\\Data\\" + language + "\\FIELD\\mapdata\\" + field.substr(0, 2) + "\\" + field + "\\" + field + extensions[rng() % 12]);
+        }
+
+        return paths;
+    }
+
+    // Search the game did before the index: the fl list in order, then again without the language
+    int reference_find(const std::vector<std::string> &paths, const char *path)
+    {
+        for (size_t id = 0; id < paths.size(); ++id)
+        {
+            if (!strcasecmp(path, paths[id].c_str())) return int(id);
+        }
+
+        for (size_t id = 0; id < paths.size(); ++id)
+        {
+            if (strlen(path) >= prefixSize && paths[id].size() >= prefixSize && !strcasecmp(path + prefixSize, paths[id].c_str() + prefixSize)) return int(id);
+        }
+
+        return -1;
+    }
+
+    std::vector<std::string> make_queries(const std::vector<std::string> &paths, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<std::string> queries;
+
+        for (size_t i = 0; i < paths.size(); i += 2)
+        {
+            std::string query = paths[rng() % paths.size()];
+
+            // Asked in the language of the game, in upper case, or missing
+            query.replace(12, 3, "eng");
+            if (i % 6 == 2) for (char &c : query) c = toupper(c);
+            if (i % 10 == 4) query += ".bak";
+            queries.push_back(query);
+        }
+
+        queries.push_back("c:\\ff8");
+
+        return queries;
+    }
+}
+
+TEST_CASE(fl_index_matches_scan)
+{
+    for (uint32_t seed = 1; seed <= 3; seed++)
+    {
+        std::vector<std::string> paths = make_fl(3000, seed);
+        ff8_fl_index index;
+
+        index.reserve(int(paths.size()));
+        for (size_t id = 0; id < paths.size(); ++id) index.add(int(id), paths[id].c_str(), prefixSize);
+
+        for (const std::string &query : make_queries(paths, seed))
+        {
+            bool otherLanguage = false;
+            int id = index.find(query.c_str(), prefixSize, &otherLanguage);
+
+            CHECK(id == reference_find(paths, query.c_str()));
+            CHECK(id < 0 || otherLanguage == !!strcasecmp(query.c_str(), paths[id].c_str()));
+        }
+    }
+}
+
+TEST_CASE(fl_index_slashes)
+{
+    ff8_fl_index index;
+
+    index.add(0, "C:\\FF8\\Data\\eng\\FIELD\\a.fs", prefixSize);
+    CHECK(index.find("c:/ff8/data/eng/field/A.FS", prefixSize) == 0);
+    CHECK(index.find("c:/ff8/data/fre/field/a.fs", prefixSize) == 0);
+    CHECK(index.find("c:/ff8/data/fre/field/b.fs", prefixSize) == -1);
+
+    index.clear();
+    CHECK(index.find("c:/ff8/data/eng/field/a.fs", prefixSize) == -1);
+}
+
+// Per search cost on the fl list of field.fs, scanning against the index
+BENCHMARK(fl_index)
+{
+    std::vector<std::string> paths = make_fl(6000, 7);
+    std::vector<std::string> queries = make_queries(paths, 7);
+    ff8_fl_index index;
+    size_t iterations = ffnx_tests::benchScale();
+
+    queries.resize(500);
+
+    ffnx_tests::bench("index build", iterations, [&] {
+        index.clear();
+        index.reserve(int(paths.size()));
+        for (size_t id = 0; id < paths.size(); ++id) index.add(int(id), paths[id].c_str(), prefixSize);
+    });
+    ffnx_tests::bench("fl scan, 500 searches", iterations, [&] {
+        for (const std::string &query : queries) ffnx_tests::keep(reference_find(paths, query.c_str()));
+    });
+    ffnx_tests::bench("index, 500 searches", iterations, [&] {
+        for (const std::string &query : queries) ffnx_tests::keep(index.find(query.c_str(), prefixSize));
+    });
+}
@@ -0,0 +1,206 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <thread>
+
+namespace
+{
+    // Frame loop of qpc_wait_frame on a simulated timer: sleeps wake up late by a fixed amount, spinning ends exactly on time
+    struct simulated_timer
+    {
+        double now = 0.0;
+        double lateness;
+
+        void sleep(double time) { now += time + lateness; }
+    };
+
+    // Returns how many frames ended after their deadline
+    int simulate(FramePacer &pacer, simulated_timer &timer, int frames, double frame_time, double work)
+    {
+        int late = 0;
+        double last = timer.now;
+
+        for (int frame = 0; frame < frames; frame++)
+        {
+            timer.now += work;
+
+            double before = timer.now;
+            double remaining = frame_time - (before - last);
+            double sleep_time = pacer.sleepTime(remaining);
+
+            if (sleep_time > 0.0)
+            {
+                timer.sleep(sleep_time);
+                pacer.wokeUp(sleep_time, timer.now - before);
+            }
+
+            // Spinning
+            timer.now = std::max(timer.now, last + frame_time);
+
+            pacer.frameDone(timer.now - last - frame_time);
+            if (timer.now > last + frame_time) late++;
+            last = timer.now;
+        }
+
+        return late;
+    }
+
+    enum pacing { SpinOnly, SleepOnly, SleepThenSpin };
+
+    // Real frames on this machine: sleep_for stands in for the waitable timer, steady_clock for QueryPerformanceCounter
+    void bench_pacing(const char *label, pacing mode, int frames)
+    {
+        typedef std::chrono::steady_clock clock;
+        const double frame_time = 1000000000.0 / 60.0;
+        FramePacer pacer;
+        double worst = 0.0, total = 0.0;
+
+        pacer.init(1000000000.0);
+
+        auto elapsed = [](clock::time_point from, clock::time_point to) { return std::chrono::duration<double, std::nano>(to - from).count(); };
+
+        std::clock_t cpu_start = std::clock();
+        clock::time_point start = clock::now(), last = start;
+
+        for (int frame = 0; frame < frames; frame++)
+        {
+            clock::time_point before = clock::now();
+            double remaining = frame_time - elapsed(last, before);
+            double sleep_time = mode == SpinOnly ? 0.0 : mode == SleepOnly ? std::max(remaining, 0.0) : pacer.sleepTime(remaining);
+            clock::time_point now;
+
+            if (sleep_time > 0.0)
+            {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(int64_t(sleep_time)));
+                pacer.wokeUp(sleep_time, elapsed(before, clock::now()));
+            }
+
+            do now = clock::now();
+            while (elapsed(last, now) < frame_time);
+
+            double error = elapsed(last, now) - frame_time;
+
+            pacer.frameDone(error);
+            worst = std::max(worst, error);
+            total += error;
+            last = now;
+        }
+
+        double wall = elapsed(start, clock::now());
+        double cpu = double(std::clock() - cpu_start) * 1000000000.0 / CLOCKS_PER_SEC;
+
+        printf("  %-24s late by %7.1f us on average, %8.1f us at worst, jitter %6.1f us, CPU %5.1f%%\n",
+            label, total / frames / 1000.0, worst / 1000.0, pacer.jitter() / 1000.0, 100.0 * cpu / wall);
+    }
+}
+
+TEST_CASE(frame_pacer_spin)
+{
+    FramePacer pacer;
+
+    // Timer counts in microseconds
+    pacer.init(1000000.0);
+    CHECK(pacer.spin() == 2000.0);
+    CHECK(pacer.sleepTime(16000.0) == 14000.0);
+    CHECK(pacer.sleepTime(1500.0) == 0.0);
+
+    // A late wake up grows the slice at once, up to 4 ms
+    pacer.wokeUp(14000.0, 16000.0);
+    CHECK(pacer.spin() == 3000.0);
+    pacer.wokeUp(14000.0, 30000.0);
+    CHECK(pacer.spin() == 4000.0);
+
+    // An accurate timer shrinks it slowly, down to 0.5 ms
+    pacer.wokeUp(12000.0, 12100.0);
+    CHECK(pacer.spin() > 3500.0 && pacer.spin() < 4000.0);
+    for (int i = 0; i < 200; i++) pacer.wokeUp(12000.0, 12100.0);
+    CHECK(pacer.spin() == 500.0);
+    CHECK(std::abs(pacer.toMicroseconds(pacer.spin()) - 500.0) < 0.001);
+}
+
+TEST_CASE(frame_pacer_jitter)
+{
+    FramePacer pacer;
+
+    pacer.init(1000000.0);
+
+    // A constant error has no jitter
+    for (int i = 0; i < 500; i++) pacer.frameDone(50.0);
+    CHECK(pacer.error() == 50.0);
+    CHECK(pacer.jitter() < 1.0);
+
+    // Errors alternating around their mean
+    for (int i = 0; i < 500; i++) pacer.frameDone(i % 2 ? 150.0 : -50.0);
+    CHECK(std::abs(pacer.jitter() - 100.0) < 10.0);
+}
+
+TEST_CASE(frame_pacer_deadlines)
+{
+    const double frame_time = 1000000.0 / 60.0;
+
+    // A timer 1.5 ms late is covered by the slice
+    {
+        FramePacer pacer;
+        simulated_timer timer{ 0.0, 1500.0 };
+
+        pacer.init(1000000.0);
+        CHECK(simulate(pacer, timer, 600, frame_time, 3000.0) == 0);
+        CHECK(pacer.spin() >= 1500.0);
+        CHECK(pacer.jitter() < 1.0);
+    }
+
+    // A timer following a 15.6 ms system tick without timeBeginPeriod cannot be caught up by the 4 ms slice
+    {
+        FramePacer pacer;
+        simulated_timer timer{ 0.0, 15600.0 };
+
+        pacer.init(1000000.0);
+        CHECK(simulate(pacer, timer, 60, frame_time, 3000.0) > 50);
+        CHECK(pacer.spin() == 4000.0);
+    }
+
+    // An exact timer keeps the slice short
+    {
+        FramePacer pacer;
+        simulated_timer timer{ 0.0, 0.0 };
+
+        pacer.init(1000000.0);
+        CHECK(simulate(pacer, timer, 600, frame_time, 3000.0) == 0);
+        CHECK(pacer.spin() == 500.0);
+    }
+}
+
+// Deadline error and CPU time of 60 FPS frames with nothing to draw
+BENCHMARK(frame_pacer)
+{
+    int frames = 30 * ffnx_tests::benchScale();
+
+    bench_pacing("spin only", SpinOnly, frames);
+    bench_pacing("sleep only", SleepOnly, frames);
+    bench_pacing("sleep, then spin", SleepThenSpin, frames);
+}
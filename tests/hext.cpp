@@ -0,0 +1,272 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "hext_compiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+namespace
+{
+    typedef HextCompiler::Instruction Instruction;
+
+    HextCompiler::Program compile(const std::vector<std::string> &lines)
+    {
+        HextCompiler compiler;
+        HextCompiler::Program program;
+
+        compiler.compile(lines, program);
+
+        return program;
+    }
+
+    bool is_patch(const Instruction &instruction, int address, const std::vector<char> &bytes)
+    {
+        return instruction.type == Instruction::MemoryPatch && instruction.addressToken.empty() && instruction.address == address && instruction.bytes == bytes;
+    }
+
+    bool is_permission(const Instruction &instruction, int address, int length)
+    {
+        return instruction.type == Instruction::MemoryPermission && instruction.addressToken.empty() && instruction.address == address && instruction.length == length;
+    }
+
+    // Patch file like the ones shipped with the mods: comments, offsets, permissions and byte lists
+    std::vector<std::string> make_patch(size_t patches)
+    {
+        std::vector<std::string> lines = { "# Synthetic patch", "{{", "  multiline comment", "}}", "+0" };
+        char line[160];
+
+        for (size_t i = 0; i < patches; i++)
+        {
+            int address = 0x400000 + int(i) * 0x40;
+
+            if (i % 64 == 0)
+            {
+                snprintf(line, sizeof(line), "%s%X", i % 128 ? "-" : "+", unsigned(i * 0x10));
+                lines.push_back(line);
+            }
+            if (i % 8 == 0)
+            {
+                snprintf(line, sizeof(line), "%X:%X", address, 0x40 * 8);
+                lines.push_back(line);
+                lines.push_back("# Group of patches");
+            }
+            if (i % 4 == 3)
+            {
+                snprintf(line, sizeof(line), "%X+%X = 90:%d", address, unsigned(i % 16), int(i % 32) + 1);
+            }
+            else
+            {
+                snprintf(line, sizeof(line), "%X = E9 %02X %02X 00 00 C3 90 90 8B 45 08 89 04 24", address, unsigned(i & 0xFF), unsigned((i >> 8) & 0xFF));
+            }
+            lines.push_back(line);
+        }
+
+        return lines;
+    }
+}
+
+TEST_CASE(hext_patches)
+{
+    HextCompiler::Program program = compile({
+        "# comment",
+        "{ single line comment }",
+        ". dot comment",
+        "{{",
+        "4000 = 01 02",
+        "}}",
+        "401000 = 90 90,C3\t8B",
+        "401010 = FF:4",
+        "401020 = 00:0x3",
+        "401000:100",
+        "401000+10 = 01",
+        "401000-10 = 02",
+        "<< Some command  ",
+        "",
+    });
+
+    CHECK(program.errors.empty());
+    CHECK(program.checkpoint.empty());
+    CHECK(program.delayedInstructions.empty());
+    CHECK(program.instructions.size() == 7);
+    CHECK(is_patch(program.instructions[0], 0x401000, { char(0x90), char(0x90), char(0xC3), char(0x8B) }));
+    CHECK(is_patch(program.instructions[1], 0x401010, { char(0xFF), char(0xFF), char(0xFF), char(0xFF) }));
+    CHECK(is_patch(program.instructions[2], 0x401020, { 0, 0, 0 }));
+    CHECK(is_permission(program.instructions[3], 0x401000, 0x100));
+    CHECK(is_patch(program.instructions[4], 0x401010, { 1 }));
+    CHECK(is_patch(program.instructions[5], 0x400FF0, { 2 }));
+    CHECK(program.instructions[6].type == Instruction::Command);
+    CHECK(program.instructions[6].addressToken == "Some command");
+}
+
+TEST_CASE(hext_global_offset)
+{
+    HextCompiler::Program program = compile({
+        "1000 = 01",
+        "+200",
+        "1000 = 02",
+        "1000:10",
+        "-100",
+        "1000+8 = 03",
+        "+0",
+        "1000 = 04",
+    });
+
+    CHECK(program.errors.empty());
+    CHECK(program.instructions.size() == 5);
+    CHECK(is_patch(program.instructions[0], 0x1000, { 1 }));
+    CHECK(is_patch(program.instructions[1], 0x1200, { 2 }));
+    CHECK(is_permission(program.instructions[2], 0x1200, 0x10));
+    CHECK(is_patch(program.instructions[3], 0xF08, { 3 }));
+    CHECK(is_patch(program.instructions[4], 0x1000, { 4 }));
+
+    // A compile starts again without offset nor open comment
+    HextCompiler compiler;
+    HextCompiler::Program first, second;
+
+    compiler.compile({ "+100", "{{" }, first);
+    compiler.compile({ "1000 = 01" }, second);
+    CHECK(second.instructions.size() == 1);
+    CHECK(is_patch(second.instructions[0], 0x1000, { 1 }));
+}
+
+TEST_CASE(hext_pointers)
+{
+    std::map<int, int> memory = { { 0x2100, 0x5000 }, { 0x3000, 0x6000 } };
+    HextCompiler::PointerReader readPointer = [&](int address) { return memory.at(address); };
+    HextCompiler::Program program = compile({
+        "+100",
+        "2000^+8 = 01",
+        "2000^:20",
+        "-0",
+        "3000^-10 = 02",
+    });
+
+    CHECK(program.errors.empty());
+    CHECK(program.instructions.size() == 3);
+
+    // Pointers are kept as tokens and resolved against the memory when the patch is applied
+    for (const Instruction &instruction : program.instructions) CHECK(!instruction.addressToken.empty());
+
+    CHECK(HextCompiler::resolveAddress(program.instructions[0], readPointer) == 0x5000 + 8 + 0x100);
+    CHECK(HextCompiler::resolveAddress(program.instructions[1], readPointer) == 0x5000 + 0x100);
+    CHECK(program.instructions[1].length == 0x20);
+    CHECK(HextCompiler::resolveAddress(program.instructions[2], readPointer) == 0x6000 - 0x10);
+
+    memory[0x2100] = 0x7000;
+    CHECK(HextCompiler::resolveAddress(program.instructions[0], readPointer) == 0x7000 + 8 + 0x100);
+
+    // Without a reader, pointers cannot be resolved
+    bool thrown = false;
+    try { HextCompiler::resolveAddress(program.instructions[0], HextCompiler::PointerReader()); }
+    catch (const std::exception &) { thrown = true; }
+    CHECK(thrown);
+}
+
+TEST_CASE(hext_checkpoints)
+{
+    // Patches before the first checkpoint are applied right away, delayed ones need the file to start with it
+    HextCompiler::Program immediate = compile({
+        "1000 = 01",
+        "!checkpoint",
+        "2000 = 02",
+    });
+
+    CHECK(immediate.instructions.size() == 1);
+    CHECK(is_patch(immediate.instructions[0], 0x1000, { 1 }));
+    CHECK(immediate.checkpoint.empty());
+    CHECK(immediate.delayedInstructions.empty());
+
+    HextCompiler::Program delayed = compile({
+        "# Comments before the checkpoint",
+        "{{",
+        "!not a checkpoint",
+        "}}",
+        "!battle_start",
+        "+10",
+        "2000 = 02",
+        "!other checkpoint",
+        "3000 = 03",
+    });
+
+    CHECK(delayed.errors.empty());
+    CHECK(delayed.instructions.empty());
+    CHECK(delayed.checkpoint == "!battle_start");
+    CHECK(delayed.delayedInstructions.size() == 2);
+    CHECK(is_patch(delayed.delayedInstructions[0], 0x2010, { 2 }));
+    CHECK(is_patch(delayed.delayedInstructions[1], 0x3010, { 3 }));
+}
+
+TEST_CASE(hext_errors)
+{
+    HextCompiler::Program program = compile({
+        "1000 = 01",
+        "ZZZZ = 01",
+        "1000 = GG",
+        "+XYZ",
+        "1000:",
+        "unknown line",
+        "2000 = 02",
+    });
+
+    // Broken lines are reported and skipped, the others still apply
+    CHECK(program.errors.size() == 4);
+    CHECK(program.errors[0].find("ZZZZ = 01") != std::string::npos);
+    CHECK(program.instructions.size() == 2);
+    CHECK(is_patch(program.instructions[0], 0x1000, { 1 }));
+    CHECK(is_patch(program.instructions[1], 0x2000, { 2 }));
+}
+
+// Compilation of a large patch, what every checkpoint paid before the compiled plan was cached,
+// against replaying the cached plan (the patches are copied to a buffer instead of the game memory)
+BENCHMARK(hext)
+{
+    std::vector<char> memory(0x10000 + 0x100);
+
+    for (size_t patches : { 100, 2000 })
+    {
+        std::vector<std::string> lines = make_patch(patches);
+        HextCompiler compiler;
+        HextCompiler::Program program;
+        size_t iterations = std::max<size_t>(1, 2000 / patches) * ffnx_tests::benchScale();
+        char label[80];
+
+        compiler.compile(lines, program);
+        CHECK(program.errors.empty());
+
+        snprintf(label, sizeof(label), "compile %zu lines (%zu instructions)", lines.size(), program.instructions.size());
+        ffnx_tests::bench(label, iterations, [&] { compiler.compile(lines, program); ffnx_tests::keep(program.instructions.size()); });
+        snprintf(label, sizeof(label), "replay %zu instructions", program.instructions.size());
+        ffnx_tests::bench(label, iterations, [&] {
+            for (const Instruction &instruction : program.instructions)
+            {
+                if (instruction.type != Instruction::MemoryPatch) continue;
+
+                int address = HextCompiler::resolveAddress(instruction, HextCompiler::PointerReader());
+                memcpy(memory.data() + (address & 0xFFFF), instruction.bytes.data(), instruction.bytes.size());
+            }
+            ffnx_tests::keep(memory[0]);
+        });
+    }
+}
@@ -0,0 +1,159 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "ff7/battle/interpolation_table.h"
+
+#include <cstring>
+#include <unordered_map>
+
+using ff7::battle::InterpolationDataTable;
+using ff7::battle::getCantorHash;
+
+namespace
+{
+    // Same size as interpolationable_data in a 32-bit build, the table only moves it around
+    struct payload
+    {
+        uint32_t words[16];
+    };
+
+    payload make_payload(uint32_t seed)
+    {
+        payload p;
+        for (uint32_t i = 0; i < 16; i++) p.words[i] = seed * 31 + i;
+        return p;
+    }
+
+    // Draw calls of one effect frame: each (return address, texture call index) pair the decorator sees.
+    // Modeled on heavy summons: a few dozen call sites in the effect code, each drawing many sprites per frame.
+    struct effect_trace
+    {
+        std::vector<uint64_t> keys;
+
+        effect_trace(uint32_t callSites, uint32_t callsPerSite)
+        {
+            uint32_t callIdx = 0;
+            for (uint32_t site = 0; site < callSites; site++)
+            {
+                uint32_t returnAddress = 0x5B0000 + site * 0x1A4;
+                for (uint32_t call = 0; call < callsPerSite; call++) keys.push_back(getCantorHash(returnAddress, callIdx++));
+            }
+        }
+    };
+}
+
+TEST_CASE(interpolation_table_insert_find)
+{
+    InterpolationDataTable<payload> table(16);
+
+    for (uint32_t i = 0; i < 1000; i++) table.insert(getCantorHash(0x5B0000 + i * 4, i), make_payload(i));
+
+    CHECK(table.size() == 1000);
+    CHECK(table.capacity() >= 2000);
+
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        payload *p = table.find(getCantorHash(0x5B0000 + i * 4, i));
+        CHECK(p != nullptr);
+        if (p) CHECK(p->words[3] == i * 31 + 3);
+    }
+
+    CHECK(table.find(getCantorHash(0x400000, 7)) == nullptr);
+}
+
+TEST_CASE(interpolation_table_overwrite)
+{
+    InterpolationDataTable<payload> table;
+
+    table.insert(42, make_payload(1));
+    table.insert(42, make_payload(2));
+
+    CHECK(table.size() == 1);
+    CHECK(table.find(42) && table.find(42)->words[0] == 2 * 31);
+}
+
+TEST_CASE(interpolation_table_clear_keeps_storage)
+{
+    InterpolationDataTable<payload> table(64);
+
+    for (uint32_t i = 0; i < 500; i++) table.insert(i, make_payload(i));
+    size_t capacity = table.capacity();
+
+    table.clear();
+
+    CHECK(table.size() == 0);
+    CHECK(table.capacity() == capacity);
+    for (uint32_t i = 0; i < 500; i++) CHECK(table.find(i) == nullptr);
+
+    // Stale slots from the previous cycle must not break probing for the new one
+    for (uint32_t i = 250; i < 750; i++) table.insert(i, make_payload(i + 1));
+    for (uint32_t i = 0; i < 250; i++) CHECK(table.find(i) == nullptr);
+    for (uint32_t i = 250; i < 750; i++) CHECK(table.find(i) && table.find(i)->words[0] == (i + 1) * 31);
+}
+
+// Replays effect frames the way InterpolationEffectDecorator does with frequency 2 (30 FPS effects at 60 FPS):
+// one frame clears and saves every call, the next one looks every call up.
+BENCHMARK(interpolation_table)
+{
+    const size_t frames = 2000 * ffnx_tests::benchScale();
+
+    for (uint32_t callsPerSite : { 4u, 32u })
+    {
+        effect_trace trace(48, callsPerSite);
+        char label[64];
+
+        snprintf(label, sizeof(label), "unordered_map, %zu calls per frame", trace.keys.size());
+        {
+            std::unordered_map<uint64_t, payload> map;
+            size_t frame = 0;
+            ffnx_tests::bench(label, frames, [&] {
+                if (frame++ % 2 == 0)
+                {
+                    map.clear();
+                    for (uint64_t key : trace.keys) map[key] = make_payload(uint32_t(key));
+                }
+                else
+                {
+                    for (uint64_t key : trace.keys) if (map.contains(key)) ffnx_tests::keep(map[key].words[0]);
+                }
+            });
+        }
+
+        snprintf(label, sizeof(label), "InterpolationDataTable, %zu calls per frame", trace.keys.size());
+        {
+            InterpolationDataTable<payload> table;
+            size_t frame = 0;
+            ffnx_tests::bench(label, frames, [&] {
+                if (frame++ % 2 == 0)
+                {
+                    table.clear();
+                    for (uint64_t key : trace.keys) table.insert(key, make_payload(uint32_t(key)));
+                }
+                else
+                {
+                    for (uint64_t key : trace.keys) if (payload *p = table.find(key)) ffnx_tests::keep(p->words[0]);
+                }
+            });
+        }
+    }
+}
@@ -0,0 +1,287 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "ff7/lgp.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <strings.h>
+
+namespace
+{
+    struct lookup
+    {
+        bool found;
+        uint32_t offset;
+        bool resolved_conflict;
+
+        bool operator==(const lookup &other) const = default;
+    };
+
+    // Synthetic LGP archive as the game loads it: TOC sorted by lookup table bucket,
+    // and a conflict list per name found in several directories
+    struct archive
+    {
+        std::vector<lgp_toc_entry> toc;
+        std::vector<lookup_table_entry> lookup_table = std::vector<lookup_table_entry>(30 * 30);
+        std::vector<std::vector<conflict_entry>> conflict_entries;
+        std::vector<conflict_list> conflicts;
+        std::vector<std::string> names;
+        std::vector<std::string> directories;
+    };
+
+    int bucket(const char *name)
+    {
+        return lgp_lookup_value(name[0]) * 30 + lgp_lookup_value(name[1]) + 1;
+    }
+
+    archive make_archive(uint32_t fileCount, uint32_t seed)
+    {
+        static const char chars[] = "abcdefghijklmnopqrstuvwxyz0123456789_-";
+        std::mt19937 rng(seed);
+        archive a;
+        std::vector<std::pair<std::string, std::vector<std::string>>> files;
+
+        for (int i = 0; i < 6; i++) a.directories.push_back("dir" + std::to_string(i));
+
+        while (files.size() < fileCount)
+        {
+            std::string name;
+            // Few first characters so buckets hold many files, and never '-' or '_' first like in the game archives
+            name += chars[rng() % 4];
+            name += chars[rng() % 38];
+            for (uint32_t i = 0, len = rng() % 7; i < len; i++) name += chars[rng() % 38];
+            name += rng() % 2 ? ".tex" : ".p";
+
+            if (std::find(a.names.begin(), a.names.end(), name) != a.names.end()) continue;
+
+            std::vector<std::string> directories;
+            // One name in ten is found in several directories
+            if (rng() % 10 == 0) for (uint32_t i = 0, count = 2 + rng() % 3; i < count; i++) directories.push_back(a.directories[(i * 2 + rng() % 2) % a.directories.size()]);
+
+            a.names.push_back(name);
+            files.emplace_back(name, directories);
+        }
+
+        std::stable_sort(files.begin(), files.end(), [](const auto &l, const auto &r) { return bucket(l.first.c_str()) < bucket(r.first.c_str()); });
+
+        for (const auto &file : files)
+        {
+            uint16_t conflict = 0;
+
+            if (!file.second.empty())
+            {
+                a.conflict_entries.emplace_back();
+                conflict = uint16_t(a.conflict_entries.size());
+            }
+
+            for (size_t copy = 0; copy < std::max<size_t>(1, file.second.size()); copy++)
+            {
+                lgp_toc_entry entry = {};
+                strncpy(entry.name, file.first.c_str(), sizeof(entry.name));
+                entry.offset = uint32_t(a.toc.size()) * 1000 + 24;
+                entry.conflict = conflict;
+
+                if (conflict)
+                {
+                    conflict_entry c = {};
+                    strncpy(c.name, file.second[copy].c_str(), sizeof(c.name) - 1);
+                    c.toc_index = uint16_t(a.toc.size());
+                    a.conflict_entries.back().push_back(c);
+                }
+
+                lookup_table_entry &l = a.lookup_table[bucket(entry.name)];
+                if (!l.toc_offset) l.toc_offset = uint16_t(a.toc.size() + 1);
+                l.num_files++;
+
+                a.toc.push_back(entry);
+            }
+        }
+
+        for (std::vector<conflict_entry> &entries : a.conflict_entries) a.conflicts.push_back({ uint32_t(entries.size()), entries.data() });
+
+        return a;
+    }
+
+    // Breaks some buckets the way LGP Tools does, so the whole archive fallback runs
+    void break_lookup_table(archive &a, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+
+        for (lookup_table_entry &l : a.lookup_table)
+        {
+            if (!l.toc_offset || rng() % 4) continue;
+
+            switch (rng() % 3)
+            {
+                case 0: l.toc_offset = 0; break;
+                case 1: l.toc_offset++; break;
+                case 2: l.num_files = l.num_files > 1 ? l.num_files - 1 : 0; break;
+            }
+        }
+    }
+
+    // The open file logic FFNx used before the TOC index, scanning the lookup table bucket then the whole archive
+    lookup reference_lookup(const archive &a, const char *filename, const char *current_dir)
+    {
+        uint32_t lookup_value1 = lgp_lookup_value(filename[0]);
+        uint32_t lookup_value2 = lgp_lookup_value(filename[1]) + 1;
+        uint32_t toc_offset = a.lookup_table[lookup_value1 * 30 + lookup_value2].toc_offset;
+        uint32_t i;
+
+        if (toc_offset)
+        {
+            uint32_t num_files = a.lookup_table[lookup_value1 * 30 + lookup_value2].num_files;
+
+            for (i = 0; i < num_files; i++)
+            {
+                const lgp_toc_entry *toc_entry = &a.toc[toc_offset + i - 1];
+
+                if (!strcasecmp(toc_entry->name, filename))
+                {
+                    if (!toc_entry->conflict) return { true, toc_entry->offset, false };
+
+                    const conflict_list *conflict = &a.conflicts[toc_entry->conflict - 1];
+
+                    for (i = 0; i < conflict->num_conflicts; i++)
+                    {
+                        if (!strcasecmp(conflict->conflict_entries[i].name, current_dir)) return { true, a.toc[conflict->conflict_entries[i].toc_index].offset, true };
+                    }
+
+                    break;
+                }
+            }
+        }
+
+        for (i = 0; i < a.toc.size(); i++)
+        {
+            if (!strcasecmp(a.toc[i].name, filename) && !a.toc[i].conflict) return { true, a.toc[i].offset, false };
+        }
+
+        return { false, 0, false };
+    }
+
+    lookup indexed_lookup(const archive &a, const lgp_toc_index &index, const char *filename, const char *current_dir)
+    {
+        lgp_lookup found = lgp_find_file(index, filename, a.toc.data(), a.lookup_table.data(), a.conflicts.data(), current_dir);
+
+        if (found.toc_index < 0) return { false, 0, false };
+
+        return { true, a.toc[found.toc_index].offset, found.resolved_conflict };
+    }
+
+    // Every name in every directory, in upper case, and names missing from the archive
+    std::vector<std::pair<std::string, std::string>> make_queries(const archive &a)
+    {
+        std::vector<std::pair<std::string, std::string>> queries;
+        std::vector<std::string> directories = a.directories;
+
+        directories.push_back("");
+        directories.push_back("missing");
+
+        for (const std::string &name : a.names)
+        {
+            std::string upper = name;
+            std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+
+            for (const std::string &directory : directories) queries.emplace_back(name, directory);
+            queries.emplace_back(upper, "DIR1");
+            queries.emplace_back("x" + name, "");
+        }
+
+        return queries;
+    }
+
+    void check_archive(const archive &a, size_t &brokenLookups)
+    {
+        lgp_toc_index index;
+        index.build(a.toc.data(), uint32_t(a.toc.size()));
+
+        for (const auto &query : make_queries(a))
+        {
+            lgp_lookup found = lgp_find_file(index, query.first.c_str(), a.toc.data(), a.lookup_table.data(), a.conflicts.data(), query.second.c_str());
+
+            CHECK(indexed_lookup(a, index, query.first.c_str(), query.second.c_str()) == reference_lookup(a, query.first.c_str(), query.second.c_str()));
+            brokenLookups += found.broken_lookup_table;
+        }
+    }
+}
+
+TEST_CASE(lgp_lookup_matches_scan)
+{
+    size_t brokenLookups = 0;
+
+    for (uint32_t seed = 1; seed <= 3; seed++) check_archive(make_archive(1500, seed), brokenLookups);
+
+    // Conflicting names asked from a directory without them fall back to the whole archive
+    CHECK(brokenLookups > 0);
+}
+
+TEST_CASE(lgp_lookup_broken_table)
+{
+    size_t brokenLookups = 0;
+
+    for (uint32_t seed = 1; seed <= 3; seed++)
+    {
+        archive a = make_archive(1500, seed);
+        size_t before = brokenLookups;
+
+        break_lookup_table(a, seed);
+        check_archive(a, brokenLookups);
+        CHECK(brokenLookups > before);
+    }
+}
+
+TEST_CASE(lgp_toc_names_without_terminator)
+{
+    archive a = make_archive(10, 4);
+    lgp_toc_index index;
+
+    memcpy(a.toc[0].name, "abcdefghijklmnop", sizeof(a.toc[0].name));
+    a.toc[0].conflict = 0;
+    index.build(a.toc.data(), uint32_t(a.toc.size()));
+
+    CHECK(index.first.contains("abcdefghijklmnop"));
+    CHECK(index.first.size() <= a.toc.size());
+}
+
+// Per open cost of the bucket scan against the index, on an archive the size of char.lgp
+BENCHMARK(lgp_lookup)
+{
+    archive a = make_archive(6000, 9);
+    std::vector<std::pair<std::string, std::string>> queries;
+    lgp_toc_index index;
+    size_t iterations = 2 * ffnx_tests::benchScale();
+
+    for (size_t i = 0; i < a.names.size(); i += 3) queries.emplace_back(a.names[i], a.directories[i % a.directories.size()]);
+
+    ffnx_tests::bench("index build", iterations, [&] { index.build(a.toc.data(), uint32_t(a.toc.size())); ffnx_tests::keep(index.first.size()); });
+    ffnx_tests::bench("lookup table scan, all queries", iterations, [&] {
+        for (const auto &query : queries) ffnx_tests::keep(reference_lookup(a, query.first.c_str(), query.second.c_str()).offset);
+    });
+    ffnx_tests::bench("index, all queries", iterations, [&] {
+        for (const auto &query : queries) ffnx_tests::keep(indexed_lookup(a, index, query.first.c_str(), query.second.c_str()).offset);
+    });
+    printf("  %zu TOC entries, %zu queries\n", a.toc.size(), queries.size());
+}
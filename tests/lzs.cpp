@@ -0,0 +1,236 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "ff8/lzs.h"
+
+#include <cstring>
+#include <random>
+
+namespace
+{
+    uint8_t window_byte(const std::vector<uint8_t> &data, ptrdiff_t pos)
+    {
+        // Before the start of the data, the window is zeroes
+        return pos < 0 ? 0 : data[pos];
+    }
+
+    // Greedy LZS encoder producing the format of the FF8 archives: 8 items per flag byte, literals
+    // flagged with a 1, references of 3 to 18 bytes at a position in the 4 KB window starting at 0xFEE.
+    // It also references the zeroes before the data, and overlaps references with the bytes being written.
+    std::vector<uint8_t> lzs_compress(const std::vector<uint8_t> &data)
+    {
+        std::vector<uint8_t> out;
+        std::vector<int> head(1 << 16, -1), prev(data.size(), -1);
+        size_t flagsPos = 0;
+        int items = 8;
+
+        auto hash = [&](size_t pos) { return (data[pos] | (data[pos + 1] << 8)) ^ (data[pos + 2] << 5); };
+        auto match = [&](size_t pos, ptrdiff_t src) {
+            size_t length = 0;
+            while (length < 18 && pos + length < data.size() && window_byte(data, src + length) == data[pos + length]) length++;
+            return length;
+        };
+
+        for (size_t pos = 0; pos < data.size();)
+        {
+            size_t bestLength = 0;
+            ptrdiff_t bestSource = 0;
+
+            if (pos + 3 <= data.size())
+            {
+                for (int src = head[hash(pos) & 0xFFFF], tries = 0; src >= 0 && pos - src <= 4096 && tries < 64; src = prev[src], tries++)
+                {
+                    size_t length = match(pos, src);
+                    if (length > bestLength) { bestLength = length; bestSource = src; }
+                }
+
+                if (pos + 18 <= 4096)
+                {
+                    size_t length = match(pos, -18);
+                    if (length > bestLength) { bestLength = length; bestSource = -18; }
+                }
+            }
+
+            if (items == 8)
+            {
+                flagsPos = out.size();
+                out.push_back(0);
+                items = 0;
+            }
+
+            size_t advance = bestLength >= 3 ? bestLength : 1;
+
+            if (bestLength >= 3)
+            {
+                int offset = int((bestSource + 0xFEE) & 0xFFF);
+                out.push_back(uint8_t(offset));
+                out.push_back(uint8_t(((offset >> 4) & 0xF0) | (bestLength - 3)));
+            }
+            else
+            {
+                out[flagsPos] |= 1 << items;
+                out.push_back(data[pos]);
+            }
+
+            items++;
+
+            for (size_t end = pos + advance; pos < end; pos++)
+            {
+                if (pos + 3 <= data.size())
+                {
+                    int h = hash(pos) & 0xFFFF;
+                    prev[pos] = head[h];
+                    head[h] = int(pos);
+                }
+            }
+        }
+
+        return out;
+    }
+
+    // Ring buffer decoder as in the game, kept as the reference for the native one
+    size_t reference_lzs_uncompress(const uint8_t *source, size_t sourceSize, uint8_t *target, size_t targetSize)
+    {
+        uint8_t ring[4096] = {};
+        const uint8_t *sourceEnd = source + sourceSize;
+        int r = 0xFEE;
+        size_t pos = 0;
+        unsigned flags = 0;
+
+        while (source < sourceEnd && pos < targetSize)
+        {
+            if (((flags >>= 1) & 0x100) == 0)
+            {
+                flags = *source++ | 0xFF00;
+
+                if (source >= sourceEnd) break;
+            }
+
+            if (flags & 1)
+            {
+                ring[r++ & 0xFFF] = target[pos++] = *source++;
+                continue;
+            }
+
+            if (source + 1 >= sourceEnd) break;
+
+            int offset = source[0] | ((source[1] & 0xF0) << 4), length = (source[1] & 0x0F) + 3;
+            source += 2;
+
+            for (int i = 0; i < length && pos < targetSize; i++)
+            {
+                ring[r++ & 0xFFF] = target[pos++] = ring[(offset + i) & 0xFFF];
+            }
+        }
+
+        return pos;
+    }
+
+    enum corpus_kind { Text, Zeroes, Random, Runs };
+
+    std::vector<uint8_t> make_corpus(corpus_kind kind, size_t size, uint32_t seed)
+    {
+        static const char *words[] = { "field", "battle", "magic ", "Squall", "Rinoa", "\0\0\0\0", "\xFF\xFF", "gf_" };
+        std::mt19937 rng(seed);
+        std::vector<uint8_t> data;
+
+        while (data.size() < size)
+        {
+            switch (kind)
+            {
+                case Text: { const char *word = words[rng() % 8]; data.insert(data.end(), word, word + (word[0] ? strlen(word) : 4)); break; }
+                case Zeroes: data.insert(data.end(), rng() % 300, 0); data.push_back(uint8_t(rng())); break;
+                case Random: data.push_back(uint8_t(rng())); break;
+                case Runs: data.insert(data.end(), 1 + rng() % 40, uint8_t(rng() % 4)); break;
+            }
+        }
+
+        data.resize(size);
+
+        return data;
+    }
+}
+
+TEST_CASE(lzs_round_trip)
+{
+    for (corpus_kind kind : { Text, Zeroes, Random, Runs })
+    {
+        for (size_t size : { 0, 1, 2, 17, 4095, 4096, 4097, 70000 })
+        {
+            std::vector<uint8_t> data = make_corpus(kind, size, uint32_t(kind * 100 + size));
+            std::vector<uint8_t> compressed = lzs_compress(data);
+            std::vector<uint8_t> native(size + 1, 0xCD), reference(size + 1, 0xCD);
+
+            CHECK(ff8_fs_lzs_uncompress(compressed.data(), compressed.size(), native.data(), size) == size);
+            CHECK(reference_lzs_uncompress(compressed.data(), compressed.size(), reference.data(), size) == size);
+            CHECK(memcmp(native.data(), data.data(), size) == 0);
+            CHECK(native == reference);
+            // Nothing written past the target
+            CHECK(native[size] == 0xCD);
+        }
+    }
+}
+
+TEST_CASE(lzs_truncated)
+{
+    std::vector<uint8_t> data = make_corpus(Text, 20000, 5);
+    std::vector<uint8_t> compressed = lzs_compress(data);
+
+    // Truncated source: stops without reading past it, and what was decoded is right
+    for (size_t cut : { size_t(1), size_t(2), compressed.size() / 3, compressed.size() - 1 })
+    {
+        std::vector<uint8_t> source(compressed.begin(), compressed.begin() + cut), target(data.size(), 0xCD);
+        size_t size = ff8_fs_lzs_uncompress(source.data(), source.size(), target.data(), target.size());
+
+        CHECK(size < data.size());
+        CHECK(memcmp(target.data(), data.data(), size) == 0);
+        CHECK(size == reference_lzs_uncompress(source.data(), source.size(), target.data(), target.size()));
+    }
+
+    // Smaller target: stops in the middle of a reference
+    for (size_t targetSize : { size_t(0), size_t(5), data.size() / 2 + 1 })
+    {
+        std::vector<uint8_t> target(targetSize + 1, 0xCD);
+
+        CHECK(ff8_fs_lzs_uncompress(compressed.data(), compressed.size(), target.data(), targetSize) == targetSize);
+        CHECK(memcmp(target.data(), data.data(), targetSize) == 0);
+        CHECK(target[targetSize] == 0xCD);
+    }
+}
+
+// Decoding speed of field sized entries, the native decoder against the ring buffer one of the game
+BENCHMARK(lzs)
+{
+    for (corpus_kind kind : { Text, Zeroes })
+    {
+        std::vector<uint8_t> data = make_corpus(kind, 256 * 1024, 3);
+        std::vector<uint8_t> compressed = lzs_compress(data), target(data.size());
+        size_t iterations = 4 * ffnx_tests::benchScale();
+        char label[80];
+
+        snprintf(label, sizeof(label), "%s 256 KB (%zu KB compressed), ring buffer", kind == Text ? "text" : "zeroes", compressed.size() / 1024);
+        ffnx_tests::bench(label, iterations, [&] { ffnx_tests::keep(reference_lzs_uncompress(compressed.data(), compressed.size(), target.data(), target.size())); });
+        snprintf(label, sizeof(label), "%s 256 KB (%zu KB compressed), native", kind == Text ? "text" : "zeroes", compressed.size() / 1024);
+        ffnx_tests::bench(label, iterations, [&] { ffnx_tests::keep(ff8_fs_lzs_uncompress(compressed.data(), compressed.size(), target.data(), target.size())); });
+    }
+}
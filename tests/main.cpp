@@ -0,0 +1,92 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace ffnx_tests
+{
+    static int failures = 0;
+    static int scale = 1;
+
+    std::vector<entry> &registry()
+    {
+        static std::vector<entry> entries;
+        return entries;
+    }
+
+    void fail(const char *file, int line, const char *expression)
+    {
+        printf("  FAILED %s:%d: %s\n", file, line, expression);
+        failures++;
+    }
+
+    int benchScale()
+    {
+        return scale;
+    }
+}
+
+// Usage: ffnx_tests [--bench] [--scale N] [name prefix...]
+int main(int argc, char *argv[])
+{
+    bool benchmarks = false;
+    std::vector<const char *> prefixes;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--bench") == 0) benchmarks = true;
+        else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) ffnx_tests::scale = std::max(1, atoi(argv[++i]));
+        else prefixes.push_back(argv[i]);
+    }
+
+    int ran = 0;
+
+    for (const ffnx_tests::entry &entry : ffnx_tests::registry())
+    {
+        if (entry.benchmark != benchmarks) continue;
+
+        bool selected = prefixes.empty();
+        for (const char *prefix : prefixes) selected |= strncmp(entry.name, prefix, strlen(prefix)) == 0;
+        if (!selected) continue;
+
+        printf("%s %s\n", benchmarks ? "[bench]" : "[test]", entry.name);
+
+        int before = ffnx_tests::failures;
+        entry.run();
+        if (ffnx_tests::failures == before) printf("  ok\n");
+
+        ran++;
+    }
+
+    if (ran == 0)
+    {
+        printf("no %s matched\n", benchmarks ? "benchmark" : "test");
+        return 1;
+    }
+
+    printf("%d run, %d failed checks\n", ran, ffnx_tests::failures);
+
+    return ffnx_tests::failures == 0 ? 0 : 1;
+}
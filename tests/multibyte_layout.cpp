@@ -0,0 +1,210 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "ff7/multibyte_layout.h"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Width table with a different (pad<<5|width) value for every sheet and code
+    struct width_table
+    {
+        int widths[6][256];
+
+        width_table()
+        {
+            for (int sheet = 0; sheet < 6; sheet++)
+            {
+                for (int code = 0; code < 256; code++) widths[sheet][code] = (code * 7 + sheet * 31) & 0xFF;
+            }
+        }
+    };
+
+    // The glyph selection as common_submit_draw_char_from_buffer_6F564E_jp did it before it moved to multibyte_layout_glyph
+    bool reference_glyph(uint16_t letter, const int widths[6][256], bool multibyte_font, multibyte_glyph &glyph)
+    {
+        uint8_t lead = letter & 0xFF;
+        int offset_image_u = 0, offset_image_v = 0, image_u, image_v;
+        float image_u_width;
+
+        switch (lead)
+        {
+        case 0xD9:
+            if (!multibyte_font)
+            {
+                glyph.sheet = -1;
+                offset_image_u = 144;
+                offset_image_v = 208;
+                glyph.width = 0x1F;
+                glyph.left_padding = 0;
+                glyph.code = lead;
+                break;
+            }
+            [[fallthrough]];
+        default:
+            glyph.sheet = 0;
+            glyph.code = lead;
+            break;
+        case 0xF8:
+            return false;
+        case 0xFA: case 0xFB: case 0xFC: case 0xFD: case 0xFE:
+            glyph.sheet = lead - 0xF9;
+            glyph.code = letter >> 8;
+            break;
+        }
+
+        if (offset_image_u == 0)
+        {
+            glyph.width = widths[glyph.sheet][glyph.code] & 0x1F;
+            glyph.left_padding = widths[glyph.sheet][glyph.code] >> 5;
+            image_u = 32 * (glyph.code % 16);
+            image_v = 32 * (glyph.code / 16);
+            image_u_width = 32.0f;
+        }
+        else
+        {
+            image_u = offset_image_u;
+            image_v = offset_image_v;
+            image_u_width = 16.0f;
+        }
+
+        glyph.u = (double)image_u / 512.0f;
+        glyph.v = (double)image_v / 512.0f;
+        glyph.u_width = image_u_width / 512.0f;
+        // The heart texture is half as big
+        if (offset_image_u == 144)
+        {
+            glyph.u *= 2.0f;
+            glyph.v *= 2.0f;
+            glyph.u_width *= 2.0f;
+        }
+
+        return true;
+    }
+
+    // Dialog text: mostly jafont_1 codes, some 0xFA-0xFE pairs and a few hearts
+    std::vector<uint8_t> make_text(size_t size, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<uint8_t> text;
+
+        while (text.size() < size)
+        {
+            uint32_t r = rng() % 100;
+
+            if (r < 20)
+            {
+                text.push_back(uint8_t(0xFA + rng() % 5));
+                text.push_back(uint8_t(rng() % 256));
+            }
+            else if (r < 21) text.push_back(0xD9);
+            else text.push_back(uint8_t(rng() % 0xD0));
+        }
+
+        return text;
+    }
+
+    // Lays the text out in lines of a 600 units wide box, like the field and menu text loops feed
+    // common_submit_draw_char_from_buffer_6F564E_jp, and sums the quad corners they would write
+    template<typename Check>
+    float layout_text(const std::vector<uint8_t> &text, const int widths[6][256], bool half_width, Check &&check)
+    {
+        float sum = 0.0f;
+        int x = 0, y = 0;
+
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            uint16_t letter = text[i];
+            multibyte_glyph glyph;
+
+            if (letter >= 0xFA && letter <= 0xFE && i + 1 < text.size()) letter |= text[++i] << 8;
+
+            check();
+
+            if (!multibyte_layout_glyph(letter, widths, true, glyph)) continue;
+
+            int vertex_x = x + glyph.left_padding;
+            sum += float(vertex_x) + float(y) + glyph.u + glyph.v + glyph.u_width;
+            x = vertex_x + int(std::ceil(multibyte_advance_width(glyph.width, half_width)));
+
+            if (x > 600)
+            {
+                x = 0;
+                y += 16;
+            }
+        }
+
+        return sum;
+    }
+}
+
+TEST_CASE(multibyte_layout)
+{
+    width_table table;
+
+    // Every letter in both modes, against the selection that used to live in the draw function
+    for (bool multibyte_font : { false, true })
+    {
+        for (uint32_t letter = 0; letter < 0x10000; letter++)
+        {
+            multibyte_glyph glyph, expected;
+            bool drawn = multibyte_layout_glyph(uint16_t(letter), table.widths, multibyte_font, glyph);
+
+            CHECK(drawn == reference_glyph(uint16_t(letter), table.widths, multibyte_font, expected));
+            if (!drawn) continue;
+
+            CHECK(glyph.sheet == expected.sheet && glyph.code == expected.code);
+            CHECK(glyph.width == expected.width && glyph.left_padding == expected.left_padding);
+            CHECK(glyph.u == expected.u && glyph.v == expected.v && glyph.u_width == expected.u_width);
+        }
+    }
+
+    // The heart only exists in the JP edition
+    multibyte_glyph heart;
+    CHECK(multibyte_layout_glyph(0xD9, table.widths, false, heart) && heart.sheet == -1 && heart.u == 0.5625f);
+    CHECK(multibyte_layout_glyph(0xD9, table.widths, true, heart) && heart.sheet == 0);
+
+    // Half width rounds up, multibyte uses the table value as is
+    CHECK(multibyte_advance_width(31, true) == 16.0f && multibyte_advance_width(31, false) == 31.0f);
+}
+
+// A 64 KB dialog buffer laid out glyph by glyph, with and without the clock read
+// the draw function used to pay on every glyph to check the tuning files for changes
+BENCHMARK(multibyte_layout)
+{
+    width_table table;
+    std::vector<uint8_t> text = make_text(64 * 1024, 5);
+    size_t iterations = ffnx_tests::benchScale();
+    long long ticks = 0;
+
+    ffnx_tests::bench("64 KB text, tuning check per glyph", iterations, [&] {
+        ffnx_tests::keep(layout_text(text, table.widths, false, [&] { ticks += std::chrono::steady_clock::now().time_since_epoch().count() & 1; }));
+    });
+    ffnx_tests::bench("64 KB text", iterations, [&] {
+        ffnx_tests::keep(layout_text(text, table.widths, false, [] {}));
+    });
+    ffnx_tests::keep(ticks);
+}
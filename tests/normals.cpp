@@ -0,0 +1,198 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "gl/normals.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#ifdef FFNX_TESTS_XXHASH
+#include <xxhash.h>
+#endif
+
+namespace
+{
+    // Vertex layout of the game: position first, followed by color and uv
+    struct vertex
+    {
+        vector3<float> position;
+        float rhw;
+        uint32_t color;
+        uint32_t specular;
+        float u, v;
+    };
+
+    struct mesh
+    {
+        std::vector<vertex> vertices;
+        std::vector<uint16_t> indices;
+    };
+
+    // Height field of size x size vertices, two triangles per quad
+    mesh make_grid(uint32_t size, uint32_t seed)
+    {
+        mesh m;
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> height(-8.0f, 8.0f);
+
+        for (uint32_t y = 0; y < size; y++)
+            for (uint32_t x = 0; x < size; x++) m.vertices.push_back({ { x * 16.0f, height(rng), y * 16.0f } });
+
+        for (uint32_t y = 0; y + 1 < size; y++)
+        {
+            for (uint32_t x = 0; x + 1 < size; x++)
+            {
+                uint16_t i = y * size + x;
+                uint16_t quad[6] = { i, uint16_t(i + size), uint16_t(i + 1), uint16_t(i + 1), uint16_t(i + size), uint16_t(i + size + 1) };
+                m.indices.insert(m.indices.end(), quad, quad + 6);
+            }
+        }
+
+        return m;
+    }
+
+    // The scalar code gl_calculate_normals used before the cache, kept as the reference for the kernel
+    void reference_normals(const mesh &m, std::vector<vector3<float>> &normals)
+    {
+        normals.assign(m.vertices.size(), { 0.0f, 0.0f, 0.0f });
+
+        for (size_t idx = 0; idx < m.indices.size(); idx += 3)
+        {
+            const vector3<float> &v1 = m.vertices[m.indices[idx]].position;
+            const vector3<float> &v2 = m.vertices[m.indices[idx + 1]].position;
+            const vector3<float> &v3 = m.vertices[m.indices[idx + 2]].position;
+            vector3<float> e12 = { v2.x - v1.x, v2.y - v1.y, v2.z - v1.z };
+            vector3<float> e13 = { v3.x - v1.x, v3.y - v1.y, v3.z - v1.z };
+            vector3<float> tri = { e13.y * e12.z - e13.z * e12.y, e13.z * e12.x - e13.x * e12.z, e13.x * e12.y - e13.y * e12.x };
+
+            for (int corner = 0; corner < 3; corner++)
+            {
+                vector3<float> &n = normals[m.indices[idx + corner]];
+                n = { n.x + tri.x, n.y + tri.y, n.z + tri.z };
+            }
+        }
+
+        for (vector3<float> &n : normals)
+        {
+            float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+            n = { n.x / length, n.y / length, n.z / length };
+        }
+    }
+
+    uint64_t indices_hash(const mesh &m)
+    {
+#ifdef FFNX_TESTS_XXHASH
+        return XXH3_64bits(m.indices.data(), m.indices.size() * sizeof(uint16_t));
+#else
+        return m.indices.size();
+#endif
+    }
+
+    bool update(normals_cache_entry &entry, const mesh &m, const void *owner = nullptr)
+    {
+        return gl_update_normals(entry, owner, m.indices.data(), m.indices.size(), indices_hash(m), &m.vertices[0].position, sizeof(vertex), m.vertices.size());
+    }
+}
+
+TEST_CASE(normals_match_reference)
+{
+    // Odd sizes so both the four lane loops and their scalar tails run
+    for (uint32_t size : { 2u, 3u, 7u, 33u, 100u })
+    {
+        mesh m = make_grid(size, size);
+        normals_cache_entry entry;
+        std::vector<vector3<float>> expected;
+
+        // A vertex no face uses normalizes a zero vector on both paths
+        m.vertices.push_back({ { 1.0f, 2.0f, 3.0f } });
+
+        reference_normals(m, expected);
+        CHECK(update(entry, m));
+        CHECK(entry.normals.size() == expected.size());
+        CHECK(memcmp(entry.normals.data(), expected.data(), expected.size() * sizeof(expected[0])) == 0);
+    }
+}
+
+TEST_CASE(normals_cache_invalidation)
+{
+    mesh m = make_grid(20, 1);
+    normals_cache_entry entry;
+    std::vector<vector3<float>> expected;
+    int owner_a, owner_b;
+
+    CHECK(update(entry, m, &owner_a));
+    CHECK(!update(entry, m, &owner_a));
+
+    // Moving one vertex regenerates
+    m.vertices[57].position.y += 1.0f;
+    CHECK(update(entry, m, &owner_a));
+    reference_normals(m, expected);
+    CHECK(memcmp(entry.normals.data(), expected.data(), expected.size() * sizeof(expected[0])) == 0);
+    CHECK(!update(entry, m, &owner_a));
+
+    // A different owner rebuilds the adjacency even with the same data
+    CHECK(update(entry, m, &owner_b));
+
+    // Same counts but a different triangle order is a new topology
+    std::swap(m.indices[0], m.indices[3]);
+    std::swap(m.indices[1], m.indices[4]);
+    std::swap(m.indices[2], m.indices[5]);
+#ifdef FFNX_TESTS_XXHASH
+    CHECK(update(entry, m, &owner_b));
+    reference_normals(m, expected);
+    CHECK(memcmp(entry.normals.data(), expected.data(), expected.size() * sizeof(expected[0])) == 0);
+#endif
+}
+
+// Per draw cost of the three cases gl_calculate_normals can hit, on battle model sized and larger meshes:
+// the scalar code it replaced, a regeneration, and a cache hit which still hashes the indices and compares every position.
+BENCHMARK(normals)
+{
+    for (uint32_t size : { 24u, 64u, 180u })
+    {
+        mesh m = make_grid(size, 3);
+        std::vector<vector3<float>> reference;
+        normals_cache_entry entry;
+        size_t iterations = std::max<size_t>(20, 4000000 / m.indices.size()) * ffnx_tests::benchScale();
+        char label[80];
+
+        snprintf(label, sizeof(label), "%zu tris, previous scalar code", m.indices.size() / 3);
+        ffnx_tests::bench(label, iterations, [&] { reference_normals(m, reference); ffnx_tests::keep(reference[0].x); });
+
+        float wobble = 0.0f;
+        snprintf(label, sizeof(label), "%zu tris, regenerated", m.indices.size() / 3);
+        ffnx_tests::bench(label, iterations, [&] {
+            m.vertices[0].position.y = (wobble += 1.0f);
+            update(entry, m);
+            ffnx_tests::keep(entry.normals[0].x);
+        });
+
+#ifdef FFNX_TESTS_XXHASH
+        snprintf(label, sizeof(label), "%zu tris, cache hit (XXH3 + compare)", m.indices.size() / 3);
+#else
+        snprintf(label, sizeof(label), "%zu tris, cache hit (compare only, no xxHash)", m.indices.size() / 3);
+#endif
+        ffnx_tests::bench(label, iterations, [&] { update(entry, m); ffnx_tests::keep(entry.normals[0].x); });
+    }
+}
@@ -0,0 +1,402 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "audio/pcmstream/pcmcache.h"
+#include "audio/pcmstream/startprobe.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <future>
+#include <random>
+
+using SoLoud::PcmBuffer;
+using SoLoud::PcmCache;
+using SoLoud::StartProbe;
+
+namespace
+{
+    // Planar buffer where every sample holds its channel and position
+    std::shared_ptr<PcmBuffer> make_buffer(unsigned int channels, unsigned int samples, unsigned int loopStart = 0, unsigned int loopEnd = 0)
+    {
+        std::shared_ptr<PcmBuffer> buffer = std::make_shared<PcmBuffer>();
+
+        buffer->mSamplerate = 44100.0f;
+        buffer->mChannels = channels;
+        buffer->mSampleCount = samples;
+        buffer->mLoopStartSample = loopStart;
+        buffer->mLoopEndSample = loopEnd;
+        buffer->mLooping = loopEnd != 0;
+
+        for (unsigned int k = 0; k < channels; k++)
+        {
+            for (unsigned int i = 0; i < samples; i++) buffer->mData.push_back(float(k * 100000 + i));
+        }
+
+        return buffer;
+    }
+
+    bool sample_is(const std::vector<float> &out, unsigned int samplesToRead, unsigned int channel, unsigned int index, unsigned int position)
+    {
+        return out[channel * samplesToRead + index] == float(channel * 100000 + position);
+    }
+
+    // What a decoder pays for a short effect: 16-bit interleaved samples converted to float planes
+    struct synthetic_effect
+    {
+        std::vector<int16_t> samples;
+        unsigned int channels;
+
+        synthetic_effect(unsigned int channels, unsigned int count) : channels(channels)
+        {
+            for (unsigned int i = 0; i < count * channels; i++) samples.push_back(int16_t(8000.0 * sin(i * 0.01)));
+        }
+
+        std::shared_ptr<const PcmBuffer> decode() const
+        {
+            std::shared_ptr<PcmBuffer> buffer = std::make_shared<PcmBuffer>();
+            unsigned int count = unsigned(samples.size() / channels);
+
+            buffer->mSamplerate = 44100.0f;
+            buffer->mChannels = channels;
+            buffer->mSampleCount = count;
+            buffer->mData.resize(samples.size());
+
+            for (unsigned int i = 0; i < count; i++)
+            {
+                for (unsigned int k = 0; k < channels; k++) buffer->mData[k * count + i] = samples[i * channels + k] / float(0x8000);
+            }
+
+            return buffer;
+        }
+    };
+
+    void wait_until_cached(PcmCache &cache, const std::string &key)
+    {
+        while (!cache.find(key) && cache.isPending(key)) std::this_thread::yield();
+    }
+
+    // Voice line stored as raw 16-bit interleaved samples, what a cold start opens and reads from
+    struct voice_file
+    {
+        std::filesystem::path path;
+
+        voice_file(const synthetic_effect &voice)
+        {
+            path = std::filesystem::temp_directory_path() / ("ffnx_tests_voice_" + std::to_string(std::random_device()()) + ".raw");
+            FILE *f = fopen(path.string().c_str(), "wb");
+            fwrite(voice.samples.data(), sizeof(int16_t), voice.samples.size(), f);
+            fclose(f);
+        }
+
+        ~voice_file()
+        {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+
+        // Opens the file and converts its first block to float planes, like a stream started from the file
+        unsigned int read_first_block(unsigned int channels, std::vector<int16_t> &block, std::vector<float> &out, unsigned int samplesToRead) const
+        {
+            FILE *f = fopen(path.string().c_str(), "rb");
+            if (f == nullptr) return 0;
+
+            block.resize(samplesToRead * channels);
+            unsigned int count = unsigned(fread(block.data(), sizeof(int16_t) * channels, samplesToRead, f));
+            fclose(f);
+
+            for (unsigned int i = 0; i < count; i++)
+            {
+                for (unsigned int k = 0; k < channels; k++) out[k * samplesToRead + i] = block[i * channels + k] / float(0x8000);
+            }
+
+            return count;
+        }
+    };
+}
+
+TEST_CASE(pcm_buffer_read)
+{
+    std::shared_ptr<PcmBuffer> buffer = make_buffer(2, 10);
+    std::vector<float> out(2 * 4);
+    unsigned int offset = 0;
+
+    // Plays once, the last read is short
+    CHECK(buffer->read(offset, false, out.data(), 4) == 4);
+    CHECK(sample_is(out, 4, 0, 0, 0) && sample_is(out, 4, 1, 3, 3));
+    CHECK(buffer->read(offset, false, out.data(), 4) == 4);
+    CHECK(!buffer->hasEnded(offset, false));
+    CHECK(buffer->read(offset, false, out.data(), 4) == 2);
+    CHECK(sample_is(out, 4, 0, 1, 9) && sample_is(out, 4, 1, 0, 8));
+    CHECK(buffer->hasEnded(offset, false));
+    CHECK(buffer->read(offset, false, out.data(), 4) == 0);
+
+    // Loops between 3 and 7 and never ends
+    std::shared_ptr<PcmBuffer> looped = make_buffer(2, 10, 3, 7);
+    std::vector<float> longOut(2 * 12);
+    offset = 0;
+
+    CHECK(looped->read(offset, true, longOut.data(), 12) == 12);
+    for (unsigned int i = 0; i < 12; i++)
+    {
+        unsigned int position = i < 7 ? i : 3 + (i - 7) % 4;
+        CHECK(sample_is(longOut, 12, 0, i, position) && sample_is(longOut, 12, 1, i, position));
+    }
+    CHECK(!looped->hasEnded(offset, true));
+}
+
+TEST_CASE(pcm_buffer_degenerate_loop)
+{
+    // A loop end before or at the loop start cannot loop: the buffer plays once and ends, even when looping
+    for (unsigned int loopStart : { 4u, 9u })
+    {
+        std::shared_ptr<PcmBuffer> buffer = make_buffer(1, 10, loopStart, 4);
+        std::vector<float> out(16);
+        unsigned int offset = 0;
+
+        CHECK(!buffer->canLoop(true));
+        CHECK(buffer->read(offset, true, out.data(), 16) == 10);
+        CHECK(sample_is(out, 16, 0, 9, 9));
+        CHECK(buffer->hasEnded(offset, true));
+    }
+}
+
+TEST_CASE(pcm_cache_background)
+{
+    PcmCache cache(1 << 20);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::shared_ptr<PcmBuffer> buffer = make_buffer(2, 100);
+
+    // Nothing until the worker is done, the game thread never waits for it
+    CHECK(cache.request("a", [&] { released.wait(); return buffer; }));
+    CHECK(!cache.request("a", [&] { return buffer; }));
+    CHECK(cache.find("a") == nullptr);
+    CHECK(cache.isPending("a"));
+
+    release.set_value();
+    wait_until_cached(cache, "a");
+    CHECK(cache.find("a") == buffer);
+    CHECK(!cache.isPending("a"));
+    CHECK(cache.size() == buffer->size());
+    // Cached keys are not decoded again
+    CHECK(!cache.request("a", [&] { return buffer; }));
+
+    // Failed decodes are not retried
+    std::atomic<int> failures = 0;
+    CHECK(cache.request("broken", [&] { failures++; return std::shared_ptr<const PcmBuffer>(); }));
+    wait_until_cached(cache, "broken");
+    CHECK(cache.find("broken") == nullptr);
+    CHECK(!cache.request("broken", [&] { failures++; return std::shared_ptr<const PcmBuffer>(); }));
+    CHECK(failures == 1);
+
+    // Stopped, then started again by the next request
+    cache.stop();
+    CHECK(cache.request("b", [&] { return make_buffer(1, 10); }));
+    wait_until_cached(cache, "b");
+    CHECK(cache.find("b") != nullptr);
+}
+
+TEST_CASE(pcm_cache_cancel)
+{
+    PcmCache cache(1 << 20);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> decoded = 0;
+    std::atomic<bool> started = false;
+
+    CHECK(cache.request("running", [&] { started = true; released.wait(); decoded++; return make_buffer(1, 10); }));
+    while (!started) std::this_thread::yield();
+    for (const char *key : { "q1", "q2", "q3" }) CHECK(cache.request(key, [&] { decoded++; return make_buffer(1, 10); }));
+
+    // Queued decodes are dropped, the one in progress completes
+    cache.cancel();
+    CHECK(!cache.isPending("q1") && !cache.isPending("q3"));
+    release.set_value();
+    wait_until_cached(cache, "running");
+    CHECK(cache.find("running") != nullptr);
+    CHECK(cache.find("q2") == nullptr);
+    cache.stop();
+    CHECK(decoded == 1);
+
+    // A canceled key can be requested again
+    CHECK(cache.request("q2", [&] { return make_buffer(1, 10); }));
+}
+
+TEST_CASE(pcm_cache_eviction)
+{
+    std::shared_ptr<PcmBuffer> buffers[4];
+    for (auto &buffer : buffers) buffer = make_buffer(1, 256);
+    PcmCache cache(3 * buffers[0]->size());
+
+    for (int i = 0; i < 3; i++)
+    {
+        std::string key(1, char('a' + i));
+        cache.request(key, [&, i] { return buffers[i]; });
+        wait_until_cached(cache, key);
+    }
+    CHECK(cache.count() == 3);
+
+    // "a" is used again, "b" is then the least recently used one
+    CHECK(cache.find("a") == buffers[0]);
+    cache.request("d", [&] { return buffers[3]; });
+    wait_until_cached(cache, "d");
+    CHECK(cache.count() == 3);
+    CHECK(cache.size() == 3 * buffers[0]->size());
+    CHECK(cache.find("b") == nullptr);
+    CHECK(cache.find("a") == buffers[0] && cache.find("c") == buffers[2] && cache.find("d") == buffers[3]);
+
+    // An entry larger than the budget is kept alone
+    std::shared_ptr<PcmBuffer> large = make_buffer(1, 4096);
+    cache.request("large", [&] { return large; });
+    wait_until_cached(cache, "large");
+    CHECK(cache.count() == 1);
+    CHECK(cache.find("large") == large);
+
+    cache.clear();
+    CHECK(cache.count() == 0 && cache.size() == 0);
+}
+
+TEST_CASE(start_probe)
+{
+    StartProbe probe;
+
+    // Nothing read yet, then only the first read is kept
+    CHECK(probe.latency() == -1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    probe.mark();
+    long long first = probe.latency();
+    CHECK(first >= 2000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    probe.mark();
+    CHECK(probe.latency() == first);
+
+    // Marked from the mixer thread, read from the game thread
+    std::shared_ptr<StartProbe> shared = std::make_shared<StartProbe>();
+    std::thread mixer([shared] { shared->mark(); });
+    mixer.join();
+    CHECK(shared->latency() >= 0);
+}
+
+TEST_CASE(pcm_cache_voice_pages)
+{
+    // Dialog pages turned faster than their lines decode: each page cancels the previous request,
+    // so at most the decode in progress and the latest page are ever pending
+    PcmCache cache(1 << 20);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<bool> started = false;
+    std::atomic<int> decoded = 0;
+
+    CHECK(cache.request("page0", [&] { started = true; released.wait(); decoded++; return make_buffer(2, 10); }));
+    while (!started) std::this_thread::yield();
+
+    for (const char *page : { "page1", "page2", "page3" })
+    {
+        cache.cancel();
+        CHECK(cache.request(page, [&] { decoded++; return make_buffer(2, 10); }));
+    }
+    CHECK(!cache.isPending("page1") && !cache.isPending("page2") && cache.isPending("page3"));
+
+    release.set_value();
+    wait_until_cached(cache, "page3");
+    CHECK(cache.find("page0") != nullptr && cache.find("page3") != nullptr);
+    CHECK(cache.find("page1") == nullptr && cache.find("page2") == nullptr);
+
+    // Joins the worker, like NxAudioEngine::cleanup
+    cache.stop();
+    CHECK(decoded == 2);
+}
+
+// Page open to first 1024 samples of a 10 s stereo voice line, what StartProbe reports in game:
+// before, the line is opened from its file when the page opens,
+// after, it was decoded by the worker while the previous page was shown
+BENCHMARK(voice_page_open)
+{
+    synthetic_effect line(2, 441000);
+    voice_file file(line);
+    std::vector<int16_t> block;
+    std::vector<float> out(2 * 1024);
+    size_t iterations = 10 * ffnx_tests::benchScale();
+    char label[80];
+
+    snprintf(label, sizeof(label), "before: opened on page open");
+    ffnx_tests::bench(label, iterations, [&] {
+        ffnx_tests::keep(file.read_first_block(2, block, out, 1024));
+    });
+
+    PcmCache cache(32 * 1024 * 1024);
+    std::string next = file.path.string();
+
+    // Requested when the previous page opened, the player reads it long after
+    cache.request(next, [&] { return line.decode(); });
+    wait_until_cached(cache, next);
+
+    snprintf(label, sizeof(label), "after: prefetched on the previous page");
+    ffnx_tests::bench(label, iterations, [&] {
+        std::shared_ptr<const PcmBuffer> buffer = cache.find(next);
+        unsigned int offset = 0;
+        ffnx_tests::keep(buffer->read(offset, false, out.data(), 1024));
+    });
+
+    cache.stop();
+}
+
+// Game thread time to start an effect of 2 s stereo and produce its first 1024 samples:
+// decoding it right away on the game thread, queuing it for the worker, or playing the cached buffer
+BENCHMARK(pcm_cache)
+{
+    synthetic_effect effect(2, 88200);
+    std::vector<float> out(2 * 1024);
+    size_t iterations = 10 * ffnx_tests::benchScale();
+    char label[80];
+    int key = 0;
+
+    snprintf(label, sizeof(label), "synchronous decode");
+    ffnx_tests::bench(label, iterations, [&] {
+        std::shared_ptr<const PcmBuffer> buffer = effect.decode();
+        unsigned int offset = 0;
+        ffnx_tests::keep(buffer->read(offset, false, out.data(), 1024));
+    });
+
+    PcmCache cache(64 * 1024 * 1024);
+
+    snprintf(label, sizeof(label), "cold, queued on the worker");
+    ffnx_tests::bench(label, iterations, [&] {
+        ffnx_tests::keep(cache.find(std::to_string(key)) == nullptr);
+        ffnx_tests::keep(cache.request(std::to_string(key++), [&] { return effect.decode(); }));
+    });
+    cache.stop();
+
+    std::string cached = std::to_string(0);
+    cache.request(cached, [&] { return effect.decode(); });
+    wait_until_cached(cache, cached);
+
+    snprintf(label, sizeof(label), "cached");
+    ffnx_tests::bench(label, iterations, [&] {
+        std::shared_ptr<const PcmBuffer> buffer = cache.find(cached);
+        unsigned int offset = 0;
+        ffnx_tests::keep(buffer->read(offset, false, out.data(), 1024));
+    });
+}
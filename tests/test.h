@@ -0,0 +1,81 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Minimal test and benchmark runner for the platform independent parts of FFNx.
+// Tests and benchmarks register themselves and are selected by name prefix on the command line.
+namespace ffnx_tests
+{
+    struct entry
+    {
+        const char *name;
+        void (*run)();
+        bool benchmark;
+    };
+
+    std::vector<entry> &registry();
+    void fail(const char *file, int line, const char *expression);
+    // Iteration scale for benchmarks, small when run by ctest so the suite stays fast
+    int benchScale();
+
+    struct registrar
+    {
+        registrar(const char *name, void (*run)(), bool benchmark) { registry().push_back({ name, run, benchmark }); }
+    };
+
+    // Runs fn iterations times and prints the average time per iteration
+    template<typename F>
+    double bench(const char *label, size_t iterations, F &&fn)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; i++) fn();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+        printf("  %-48s %12.1f ns/iter\n", label, ns);
+        return ns;
+    }
+
+    // Keeps the optimizer from removing a computation whose result is otherwise unused
+    template<typename T>
+    inline void keep(const T &value)
+    {
+        static volatile T sink;
+        sink = value;
+    }
+}
+
+#define TEST_CASE(name) \
+    static void test_##name(); \
+    static ffnx_tests::registrar registrar_test_##name(#name, test_##name, false); \
+    static void test_##name()
+
+#define BENCHMARK(name) \
+    static void bench_##name(); \
+    static ffnx_tests::registrar registrar_bench_##name(#name, bench_##name, true); \
+    static void bench_##name()
+
+#define CHECK(expression) \
+    do { if (!(expression)) ffnx_tests::fail(__FILE__, __LINE__, #expression); } while (0)
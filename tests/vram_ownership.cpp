@@ -0,0 +1,219 @@
+/****************************************************************************/
+//    Copyright (C) 2009 Aali132                                            //
+//    Copyright (C) 2018 quantumpencil                                      //
+//    Copyright (C) 2018 Maxime Bacoux                                      //
+//    Copyright (C) 2020 myst6re                                            //
+//    Copyright (C) 2020 Chris Rizzitello                                   //
+//    Copyright (C) 2020 John Pritchard                                     //
+//    Copyright (C) 2026 Julian Xhokaxhiu                                   //
+//                                                                          //
+//    This file is part of FFNx                                             //
+//                                                                          //
+//    FFNx is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU General Public License as published by  //
+//    the Free Software Foundation, either version 3 of the License         //
+//                                                                          //
+//    FFNx is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of        //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         //
+//    GNU General Public License for more details.                          //
+/****************************************************************************/
+
+#include "test.h"
+
+#include "ff8/vram_ownership.h"
+
+#include <random>
+#include <set>
+
+namespace
+{
+    // The per pixel texture id array TexturePacker used before the rectangle index, kept as the reference
+    struct pixel_ownership
+    {
+        std::vector<ModdedTextureId> ids = std::vector<ModdedTextureId>(VRAM_WIDTH * VRAM_HEIGHT, INVALID_TEXTURE);
+
+        // Previous owners are reported once per overwritten pixel, like setVramTextureId called cleanTextures
+        size_t set(ModdedTextureId textureId, int x, int y, int w, int h, std::set<ModdedTextureId> *previous)
+        {
+            size_t cleans = 0;
+
+            for (int j = y; j < y + h && j < VRAM_HEIGHT; ++j)
+            {
+                for (int i = x; i < x + w && i < VRAM_WIDTH; ++i)
+                {
+                    ModdedTextureId &id = ids[i + j * VRAM_WIDTH];
+
+                    if (id != INVALID_TEXTURE)
+                    {
+                        cleans++;
+                        if (previous != nullptr) previous->insert(id);
+                    }
+
+                    id = textureId;
+                }
+            }
+
+            return cleans;
+        }
+
+        ModdedTextureId get(int x, int y) const
+        {
+            return ids[x + y * VRAM_WIDTH];
+        }
+
+        void collect(int x, int y, int w, int h, std::set<ModdedTextureId> &textureIds) const
+        {
+            for (int j = y; j < y + h && j < VRAM_HEIGHT; ++j)
+                for (int i = x; i < x + w && i < VRAM_WIDTH; ++i)
+                    if (ids[i + j * VRAM_WIDTH] != INVALID_TEXTURE) textureIds.insert(ids[i + j * VRAM_WIDTH]);
+        }
+    };
+
+    struct vram_op
+    {
+        enum kind_t { Upload, Match, Lookup } kind;
+        ModdedTextureId textureId;
+        int x, y, w, h;
+    };
+
+    // Synthetic field session shaped like the uploads TexturePacker sees in FF8 fields:
+    // background texture pages and CLUT rows at load, then per frame character and animated tile
+    // uploads, matches over the texture pages being drawn and animation lookups
+    std::vector<vram_op> make_field_trace(int frames, uint32_t seed)
+    {
+        std::vector<vram_op> ops;
+        std::mt19937 rng(seed);
+        auto id = [](int x, int y) { return ModdedTextureId(x + y * VRAM_WIDTH); };
+
+        for (int page = 0; page < 12; ++page)
+        {
+            int x = 640 + (page % 6) * 64, y = (page / 6) * 256;
+            ops.push_back({ vram_op::Upload, id(x, y), x, y, 64, 256 });
+        }
+
+        for (int row = 0; row < 16; ++row) ops.push_back({ vram_op::Upload, id(0, 480 + row) | 0x80000000, 0, 480 + row, 256, 1 });
+
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            for (int upload = 0; upload < 4; ++upload)
+            {
+                int x = 320 + int(rng() % 8) * 32, y = int(rng() % 4) * 64, w = 16 << (rng() % 2), h = 32 << (rng() % 2);
+                ops.push_back({ vram_op::Upload, id(x, y), x, y, w, h });
+            }
+
+            // Animated background tiles copied inside a texture page
+            int x = 640 + int(rng() % 24) * 16, y = int(rng() % 32) * 16;
+            ops.push_back({ vram_op::Upload, id(x, y), x, y, 16, 16 });
+
+            for (int draw = 0; draw < 16; ++draw)
+            {
+                int page = rng() % 18, px = page < 12 ? 640 + (page % 6) * 64 : 320 + (page - 12) * 64, py = page < 12 ? (page / 6) * 256 : 0;
+                ops.push_back({ vram_op::Match, 0, px, py, 64, 256 });
+            }
+
+            ops.push_back({ vram_op::Lookup, 0, int(rng() % VRAM_WIDTH), int(rng() % VRAM_HEIGHT), 1, 1 });
+        }
+
+        return ops;
+    }
+}
+
+TEST_CASE(vram_ownership_matches_pixels)
+{
+    VramOwnership index;
+    pixel_ownership reference;
+    std::vector<ModdedTextureId> ids;
+    std::set<ModdedTextureId> expected;
+
+    for (const vram_op &op : make_field_trace(400, 7))
+    {
+        ids.clear();
+        expected.clear();
+
+        if (op.kind == vram_op::Upload)
+        {
+            index.collect(op.x, op.y, op.w, op.h, ids);
+            index.set(op.textureId, op.x, op.y, op.w, op.h);
+            reference.set(op.textureId, op.x, op.y, op.w, op.h, &expected);
+        }
+        else
+        {
+            index.collect(op.x, op.y, op.w, op.h, ids);
+            reference.collect(op.x, op.y, op.w, op.h, expected);
+        }
+
+        CHECK(ids == std::vector<ModdedTextureId>(expected.begin(), expected.end()));
+    }
+
+    for (int y = 0; y < VRAM_HEIGHT; y += 3)
+        for (int x = 0; x < VRAM_WIDTH; x += 3) CHECK(index.get(x, y) == reference.get(x, y));
+}
+
+TEST_CASE(vram_ownership_clip_and_free)
+{
+    VramOwnership index;
+    std::vector<ModdedTextureId> ids;
+
+    // Partially outside the VRAM
+    index.set(1, VRAM_WIDTH - 8, VRAM_HEIGHT - 8, 16, 16);
+    CHECK(index.get(VRAM_WIDTH - 1, VRAM_HEIGHT - 1) == 1);
+    CHECK(index.get(VRAM_WIDTH - 9, VRAM_HEIGHT - 1) == INVALID_TEXTURE);
+
+    // Punching a hole keeps the four pieces around it
+    index.set(2, 0, 0, 64, 64);
+    index.set(INVALID_TEXTURE, 16, 16, 16, 16);
+    CHECK(index.rectCount() == 5);
+    CHECK(index.get(16, 16) == INVALID_TEXTURE);
+    CHECK(index.get(15, 16) == 2 && index.get(32, 16) == 2 && index.get(16, 15) == 2 && index.get(16, 32) == 2);
+
+    index.collect(0, 0, VRAM_WIDTH, VRAM_HEIGHT, ids);
+    CHECK(ids == std::vector<ModdedTextureId>({ 1, 2 }));
+
+    index.clear();
+    CHECK(index.rectCount() == 0 && index.get(0, 0) == INVALID_TEXTURE);
+}
+
+// Replays the synthetic field session against both implementations: uploads (with the previous owners
+// TexturePacker cleans), texture matches and animation lookups
+BENCHMARK(vram_ownership)
+{
+    std::vector<vram_op> trace = make_field_trace(200, 11);
+    size_t iterations = 2 * ffnx_tests::benchScale();
+    size_t pixelCleans = 0, textureCleans = 0;
+
+    ffnx_tests::bench("per pixel ids, whole trace", iterations, [&] {
+        pixel_ownership reference;
+        std::set<ModdedTextureId> textureIds;
+
+        for (const vram_op &op : trace)
+        {
+            textureIds.clear();
+            if (op.kind == vram_op::Upload) pixelCleans += reference.set(op.textureId, op.x, op.y, op.w, op.h, nullptr);
+            else if (op.kind == vram_op::Match) reference.collect(op.x, op.y, op.w, op.h, textureIds);
+            else textureIds.insert(reference.get(op.x, op.y));
+            ffnx_tests::keep(textureIds.size());
+        }
+    });
+
+    ffnx_tests::bench("rectangle index, whole trace", iterations, [&] {
+        VramOwnership index;
+        std::vector<ModdedTextureId> textureIds;
+
+        for (const vram_op &op : trace)
+        {
+            textureIds.clear();
+            if (op.kind == vram_op::Upload)
+            {
+                index.collect(op.x, op.y, op.w, op.h, textureIds);
+                textureCleans += textureIds.size();
+                index.set(op.textureId, op.x, op.y, op.w, op.h);
+            }
+            else if (op.kind == vram_op::Match) index.collect(op.x, op.y, op.w, op.h, textureIds);
+            else textureIds.push_back(index.get(op.x, op.y));
+            ffnx_tests::keep(textureIds.size());
+        }
+    });
+
+    printf("  %zu operations per trace, cleanTextures calls: %zu per pixel, %zu per texture\n", trace.size(), pixelCleans / iterations, textureCleans / iterations);
+}